@@ -212,6 +212,11 @@ void tscGetMetricMetaCacheKey(SQueryInfo* pQueryInfo, char* keyStr, uint64_t uid
 int  tscGetSTableVgroupInfo(SSqlObj* pSql, int32_t clauseIndex);
 int  tscGetTableMeta(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo);
 int  tscGetMeterMetaEx(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, bool createIfNotExists);
+int  tscGetTableMetaInBatch(SSqlObj* pSql, SArray* pNameList);
+
+void tscAddTableNotExistCache(const char* tableId);
+bool tscIsTableNotExistCached(const char* tableId);
+void tscRemoveTableNotExistCache(const char* tableId);
 
 void tscResetForNextRetrieve(SSqlRes* pRes);
 
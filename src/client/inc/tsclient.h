@@ -265,6 +265,7 @@ typedef struct {
 
   int32_t      clauseIndex;  // index of multiple subclause query
   int8_t       parseFinished;
+  int8_t       metaPrefetched;  // meta of tables in insert sql have been retrieved from mnode in batch
   short        numOfCols;
   uint32_t     allocSize;
   char *       payload;
@@ -325,6 +326,7 @@ typedef struct STscObj {
   char             sversion[TSDB_VERSION_LEN];
   char             writeAuth : 1;
   char             superAuth : 1;
+  int32_t          features;
   struct SSqlObj *pSql;
   struct SSqlObj *pHb;
   struct SSqlObj *sqlList;
@@ -378,6 +380,9 @@ typedef struct SSqlStream {
   int64_t slidingTime;
   int16_t precision;
   void *  pTimer;
+  int64_t lag;  // delay of the latest result against the end of its time window, ms
+
+  struct SStreamPanes *pPanes;  // partial results of sliding window, NULL if the window is computed as a whole
 
   void (*fp)();
   void *param;
@@ -459,6 +464,7 @@ int32_t tscToSQLCmd(SSqlObj* pSql, struct SSqlInfo* pInfo);
 extern void *     pVnodeConn;
 extern void *     pTscMgmtConn;
 extern void *     tscCacheHandle;
+extern void *     tscNegCacheHandle;
 extern int        slaveIndex;
 extern void *     tscTmr;
 extern void *     tscQhandle;
@@ -14,12 +14,13 @@
  */
 
 #include "os.h"
+#include "qaggkernel.h"
 #include "qast.h"
 #include "qextbuffer.h"
-#include "qhistogram.h"
 #include "qinterpolation.h"
 #include "qpercentile.h"
 #include "qsyntaxtreefunction.h"
+#include "qtdigest.h"
 #include "qtsbuf.h"
 #include "taosdef.h"
 #include "taosmsg.h"
@@ -71,6 +72,15 @@ for (int32_t i = 0; i < (ctx)->tagInfo.numOfTagCols; ++i) {                  \
     }     \
 } while(0);
 
+/*
+ * The aggregate kernels are not applicable when null value may exist in current block but the null bitmap is not
+ * built, e.g., during the merge stage at client side. The null value is checked row by row in that case.
+ */
+static FORCE_INLINE bool getKernelNullBitmap(SQLFunctionCtx *pCtx, const uint8_t **pNullBitmap) {
+  *pNullBitmap = pCtx->hasNull ? pCtx->pNullBitmap : NULL;
+  return (!pCtx->hasNull) || (pCtx->pNullBitmap != NULL);
+}
+
 void noop1(SQLFunctionCtx *UNUSED_PARAM(pCtx)) {}
 void noop2(SQLFunctionCtx *UNUSED_PARAM(pCtx), int32_t UNUSED_PARAM(index)) {}
 
@@ -132,7 +142,7 @@ typedef struct SLeastsquareInfo {
 } SLeastsquareInfo;
 
 typedef struct SAPercentileInfo {
-  SHistogramInfo *pHisto;
+  STDigest *pDigest;
 } SAPercentileInfo;
 
 typedef struct STSCompInfo {
@@ -227,7 +237,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
       return TSDB_CODE_SUCCESS;
     } else if (functionId == TSDB_FUNC_APERCT) {
       *type = TSDB_DATA_TYPE_BINARY;
-      *bytes = sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1) + sizeof(SHistogramInfo) + sizeof(SAPercentileInfo);
+      *bytes = sizeof(SAPercentileInfo) + TDIGEST_SIZE(TDIGEST_COMPRESSION);
       *intermediateResBytes = *bytes;
       
       return TSDB_CODE_SUCCESS;
@@ -258,8 +268,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
   } else if (functionId == TSDB_FUNC_APERCT) {
     *type = TSDB_DATA_TYPE_DOUBLE;
     *bytes = sizeof(double);
-    *intermediateResBytes =
-        sizeof(SAPercentileInfo) + sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1);
+    *intermediateResBytes = sizeof(SAPercentileInfo) + TDIGEST_SIZE(TDIGEST_COMPRESSION);
     return TSDB_CODE_SUCCESS;
   } else if (functionId == TSDB_FUNC_TWA) {
     *type = TSDB_DATA_TYPE_DOUBLE;
@@ -407,7 +416,9 @@ static void count_function(SQLFunctionCtx *pCtx) {
   if (usePreVal(pCtx)) {
     numOfElem = pCtx->size - pCtx->preAggVals.statis.numOfNull;
   } else {
-    if (pCtx->hasNull) {
+    if (pCtx->hasNull && pCtx->pNullBitmap != NULL) {
+      numOfElem = qCountNotNull(pCtx->pNullBitmap, pCtx->startOffset, pCtx->size);
+    } else if (pCtx->hasNull) {
       for (int32_t i = 0; i < pCtx->size; ++i) {
         char *val = GET_INPUT_CHAR_INDEX(pCtx, i);
         if (isNull(val, pCtx->inputType)) {
@@ -544,7 +555,12 @@ static void do_sum(SQLFunctionCtx *pCtx) {
     void *pData = GET_INPUT_CHAR(pCtx);
     notNullElems = 0;
     
-    if (pCtx->inputType >= TSDB_DATA_TYPE_TINYINT && pCtx->inputType <= TSDB_DATA_TYPE_BIGINT) {
+    const uint8_t *   pNullBitmap = NULL;
+    __agg_kernel_fn_t kernel = qGetSumKernel(pCtx->inputType);
+    
+    if (kernel != NULL && getKernelNullBitmap(pCtx, &pNullBitmap)) {
+      notNullElems = kernel(pData, pCtx->size, pNullBitmap, pCtx->startOffset, pCtx->aOutputBuf);
+    } else if (pCtx->inputType >= TSDB_DATA_TYPE_TINYINT && pCtx->inputType <= TSDB_DATA_TYPE_BIGINT) {
       int64_t *retVal = (int64_t*) pCtx->aOutputBuf;
       
       if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
@@ -773,7 +789,18 @@ static void avg_function(SQLFunctionCtx *pCtx) {
   } else {
     void *pData = GET_INPUT_CHAR(pCtx);
     
-    if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
+    const uint8_t *   pNullBitmap = NULL;
+    __agg_kernel_fn_t kernel = qGetSumKernel(pCtx->inputType);
+    
+    if (kernel != NULL && getKernelNullBitmap(pCtx, &pNullBitmap)) {
+      if (pCtx->inputType >= TSDB_DATA_TYPE_TINYINT && pCtx->inputType <= TSDB_DATA_TYPE_BIGINT) {
+        int64_t sum = 0;
+        notNullElems = kernel(pData, pCtx->size, pNullBitmap, pCtx->startOffset, &sum);
+        *pVal += sum;
+      } else {
+        notNullElems = kernel(pData, pCtx->size, pNullBitmap, pCtx->startOffset, pVal);
+      }
+    } else if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
       LIST_ADD_N(*pVal, pCtx, pData, int8_t, notNullElems, pCtx->inputType);
     } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
       LIST_ADD_N(*pVal, pCtx, pData, int16_t, notNullElems, pCtx->inputType);
@@ -922,6 +949,51 @@ static void avg_finalizer(SQLFunctionCtx *pCtx) {
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 
+#define UPDATE_MINMAX_VAL(type, output, val, isMin, updated) \
+  do {                                                       \
+    type *_o = (type *)(output);                             \
+    type  _v = *(type *)(val);                               \
+    if ((*_o < _v) ^ (isMin)) {                              \
+      *_o = _v;                                              \
+      (updated) = true;                                      \
+    }                                                        \
+  } while (0)
+
+/*
+ * The min/max value of current block is computed by the kernel first, and then the tag columns are updated only once
+ * with the position of the min/max value, if it replaces the previous result. Among the identical values, the last one
+ * for min and the first one for max are chosen, which is the same as the row-wise comparison.
+ */
+static void minMax_kernel_function(SQLFunctionCtx *pCtx, __agg_kernel_fn_t kernel, const uint8_t *pNullBitmap,
+                                   char *pOutput, int32_t isMin, int32_t *notNullElems) {
+  void *p = GET_INPUT_CHAR(pCtx);
+  
+  int64_t val = 0;  // large enough to hold any numeric type
+  *notNullElems = kernel(p, pCtx->size, pNullBitmap, pCtx->startOffset, &val);
+  if (*notNullElems == 0) {
+    return;
+  }
+  
+  bool updated = false;
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:  UPDATE_MINMAX_VAL(int8_t, pOutput, &val, isMin, updated);  break;
+    case TSDB_DATA_TYPE_SMALLINT: UPDATE_MINMAX_VAL(int16_t, pOutput, &val, isMin, updated); break;
+    case TSDB_DATA_TYPE_INT:      UPDATE_MINMAX_VAL(int32_t, pOutput, &val, isMin, updated); break;
+    case TSDB_DATA_TYPE_BIGINT:   UPDATE_MINMAX_VAL(int64_t, pOutput, &val, isMin, updated); break;
+    case TSDB_DATA_TYPE_FLOAT:    UPDATE_MINMAX_VAL(float, pOutput, &val, isMin, updated);   break;
+    case TSDB_DATA_TYPE_DOUBLE:   UPDATE_MINMAX_VAL(double, pOutput, &val, isMin, updated);  break;
+    default: assert(0);
+  }
+  
+  if (updated && pCtx->tagInfo.numOfTagCols > 0) {
+    int32_t index = qLocateValue(p, pCtx->size, pNullBitmap, pCtx->startOffset, pCtx->inputType, pOutput, isMin);
+    assert(index >= 0);
+    
+    TSKEY k = pCtx->ptsList[index];
+    DO_UPDATE_TAG_COLUMNS(pCtx, k);
+  }
+}
+
 static void minMax_function(SQLFunctionCtx *pCtx, char *pOutput, int32_t isMin, int32_t *notNullElems) {
   // data in current data block are qualified to the query
   if (usePreVal(pCtx)) {
@@ -997,6 +1069,14 @@ static void minMax_function(SQLFunctionCtx *pCtx, char *pOutput, int32_t isMin,
     return;
   }
   
+  const uint8_t *   pNullBitmap = NULL;
+  __agg_kernel_fn_t kernel = isMin ? qGetMinKernel(pCtx->inputType) : qGetMaxKernel(pCtx->inputType);
+  
+  if (kernel != NULL && getKernelNullBitmap(pCtx, &pNullBitmap)) {
+    minMax_kernel_function(pCtx, kernel, pNullBitmap, pOutput, isMin, notNullElems);
+    return;
+  }
+  
   void *p = GET_INPUT_CHAR(pCtx);
   *notNullElems = 0;
   
@@ -1841,6 +1921,7 @@ static void last_row_function(SQLFunctionCtx *pCtx) {
   SLastrowInfo *pInfo = (SLastrowInfo *)pResInfo->interResultBuf;
   pInfo->ts = pCtx->param[0].i64Key;
   pInfo->hasResult = DATA_SET_FLAG;
+  pResInfo->hasResult = DATA_SET_FLAG;
   
   // set the result to final result buffer
   if (pResInfo->superTableQ) {
@@ -2529,7 +2610,7 @@ static bool apercentile_function_setup(SQLFunctionCtx *pCtx) {
   SAPercentileInfo *pInfo = getAPerctInfo(pCtx);
   
   char *tmp = (char *)pInfo + sizeof(SAPercentileInfo);
-  pInfo->pHisto = tHistogramCreateFrom(tmp, MAX_HISTOGRAM_BIN);
+  pInfo->pDigest = tdigestCreateFrom(tmp, TDIGEST_COMPRESSION);
   return true;
 }
 
@@ -2569,7 +2650,7 @@ static void apercentile_function(SQLFunctionCtx *pCtx) {
         break;
     }
     
-    tHistogramAdd(&pInfo->pHisto, v);
+    tdigestAdd(pInfo->pDigest, v, 1);
   }
   
   if (!pCtx->hasNull) {
@@ -2614,7 +2695,7 @@ static void apercentile_function_f(SQLFunctionCtx *pCtx, int32_t index) {
       break;
   }
   
-  tHistogramAdd(&pInfo->pHisto, v);
+  tdigestAdd(pInfo->pDigest, v, 1);
   
   SET_VAL(pCtx, 1, 1);
   pResInfo->hasResult = DATA_SET_FLAG;
@@ -2626,30 +2707,14 @@ static void apercentile_func_merge(SQLFunctionCtx *pCtx) {
   
   SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_CHAR(pCtx);
   
-  pInput->pHisto = (SHistogramInfo*) ((char *)pInput + sizeof(SAPercentileInfo));
-  pInput->pHisto->elems = (SHistBin*) ((char *)pInput->pHisto + sizeof(SHistogramInfo));
-  
-  if (pInput->pHisto->numOfElems <= 0) {
+  // the digest is a flat buffer, only the pointer needs to be restored
+  pInput->pDigest = (STDigest*) ((char *)pInput + sizeof(SAPercentileInfo));
+  if (pInput->pDigest->totalWeight <= 0) {
     return;
   }
   
-  size_t size = sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1);
-  
   SAPercentileInfo *pOutput = getAPerctInfo(pCtx);  //(SAPercentileInfo *)pCtx->aOutputBuf;
-  SHistogramInfo *  pHisto = pOutput->pHisto;
-  
-  if (pHisto->numOfElems <= 0) {
-    memcpy(pHisto, pInput->pHisto, size);
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-  } else {
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-    
-    SHistogramInfo *pRes = tHistogramMerge(pHisto, pInput->pHisto, MAX_HISTOGRAM_BIN);
-    memcpy(pHisto, pRes, sizeof(SHistogramInfo) + sizeof(SHistBin) * MAX_HISTOGRAM_BIN);
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-    
-    tHistogramDestroy(&pRes);
-  }
+  tdigestMerge(pOutput->pDigest, pInput->pDigest);
   
   SET_VAL(pCtx, 1, 1);
   pResInfo->hasResult = DATA_SET_FLAG;
@@ -2658,26 +2723,13 @@ static void apercentile_func_merge(SQLFunctionCtx *pCtx) {
 static void apercentile_func_second_merge(SQLFunctionCtx *pCtx) {
   SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_CHAR(pCtx);
   
-  pInput->pHisto = (SHistogramInfo*) ((char *)pInput + sizeof(SAPercentileInfo));
-  pInput->pHisto->elems = (SHistBin*) ((char *)pInput->pHisto + sizeof(SHistogramInfo));
-  
-  if (pInput->pHisto->numOfElems <= 0) {
+  pInput->pDigest = (STDigest*) ((char *)pInput + sizeof(SAPercentileInfo));
+  if (pInput->pDigest->totalWeight <= 0) {
     return;
   }
   
   SAPercentileInfo *pOutput = getAPerctInfo(pCtx);
-  SHistogramInfo *  pHisto = pOutput->pHisto;
-  
-  if (pHisto->numOfElems <= 0) {
-    memcpy(pHisto, pInput->pHisto, sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1));
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-  } else {
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-    
-    SHistogramInfo *pRes = tHistogramMerge(pHisto, pInput->pHisto, MAX_HISTOGRAM_BIN);
-    tHistogramDestroy(&pOutput->pHisto);
-    pOutput->pHisto = pRes;
-  }
+  tdigestMerge(pOutput->pDigest, pInput->pDigest);
   
   SResultInfo *pResInfo = GET_RES_INFO(pCtx);
   pResInfo->hasResult = DATA_SET_FLAG;
@@ -2692,24 +2744,16 @@ static void apercentile_finalizer(SQLFunctionCtx *pCtx) {
   
   if (pCtx->currentStage == SECONDARY_STAGE_MERGE) {
     if (pResInfo->hasResult == DATA_SET_FLAG) {  // check for null
-      assert(pOutput->pHisto->numOfElems > 0);
+      assert(pOutput->pDigest->totalWeight > 0);
       
-      double  ratio[] = {v};
-      double *res = tHistogramUniform(pOutput->pHisto, ratio, 1);
-      
-      memcpy(pCtx->aOutputBuf, res, sizeof(double));
-      free(res);
+      *(double *)pCtx->aOutputBuf = tdigestQuantile(pOutput->pDigest, v / 100);
     } else {
       setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
       return;
     }
   } else {
-    if (pOutput->pHisto->numOfElems > 0) {
-      double ratio[] = {v};
-      
-      double *res = tHistogramUniform(pOutput->pHisto, ratio, 1);
-      memcpy(pCtx->aOutputBuf, res, sizeof(double));
-      free(res);
+    if (pOutput->pDigest->totalWeight > 0) {
+      *(double *)pCtx->aOutputBuf = tdigestQuantile(pOutput->pDigest, v / 100);
     } else {  // no need to free
       setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
       return;
@@ -21,6 +21,7 @@
 #include "os.h"
 
 #include "hash.h"
+#include "tcache.h"
 #include "tscUtil.h"
 #include "tschemautil.h"
 #include "tsclient.h"
@@ -958,6 +959,16 @@ static int32_t tscCheckIfCreateTable(char **sqlstr, SSqlObj *pSql) {
   return code;
 }
 
+static bool tscIsTableMetaCached(const char *name) {
+  void *pTableMeta = taosCacheAcquireByName(tscCacheHandle, name);
+  if (pTableMeta == NULL) {
+    return false;
+  }
+
+  taosCacheRelease(tscCacheHandle, &pTableMeta, false);
+  return true;
+}
+
 int validateTableName(char *tblName, int len) {
   char buf[TSDB_TABLE_ID_LEN] = {0};
   strncpy(buf, tblName, len);
@@ -968,6 +979,150 @@ int validateTableName(char *tblName, int len) {
   return tscValidateName(&token);
 }
 
+/*
+ * Skip the tokens until the right parenthesis that matches the consumed left one, return NULL if not found.
+ */
+static char *tscSkipParentheses(char *str) {
+  int32_t depth = 1;
+
+  while (depth > 0) {
+    int32_t   index = 0;
+    SSQLToken sToken = tStrGetToken(str, &index, false, 0, NULL);
+    if (sToken.n == 0) {
+      return NULL;
+    }
+
+    str += index;
+    if (sToken.type == TK_LP) {
+      depth++;
+    } else if (sToken.type == TK_RP) {
+      depth--;
+    }
+  }
+
+  return str;
+}
+
+/*
+ * Scan the rest of insert sql string to collect the tables that are neither in local cache nor known to be absent,
+ * and retrieve their table meta from mnode in one batch, instead of one round trip for each table during parsing.
+ * The scan stops silently at any unexpected token, and the error is left to be reported by the parser itself.
+ *
+ * usage: insert into table1 values()() table2 using stable tags() values() table3 file 'path'
+ */
+static int32_t tscPrefetchTableMeta(SSqlObj *pSql, char *str) {
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  SArray *  pNameList = taosArrayInit(4, TSDB_TABLE_ID_LEN);
+  SHashObj *pNameSet = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+  if (pNameList == NULL || pNameSet == NULL) {
+    goto _clean;
+  }
+
+  STableMetaInfo tableMetaInfo = {0};
+
+  while (taosArrayGetSize(pNameList) < TSDB_MULTI_METERMETA_MAX_NUM) {
+    int32_t   index = 0;
+    SSQLToken sToken = tStrGetToken(str, &index, false, 0, NULL);
+    str += index;
+
+    if (sToken.n == 0 || validateTableName(sToken.z, sToken.n) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    tableMetaInfo.name[0] = 0;
+    if (setMeterID(&tableMetaInfo, &sToken, pSql) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    char * name = tableMetaInfo.name;
+    size_t len = strlen(name);
+
+    if (taosHashGet(pNameSet, name, len) == NULL) {
+      int8_t dummy = 0;
+      taosHashPut(pNameSet, name, len, &dummy, sizeof(dummy));
+
+      if (!tscIsTableMetaCached(name) && !tscIsTableNotExistCached(name)) {
+        taosArrayPush(pNameList, name);
+      }
+    }
+
+    // skip the possibly exists column list, and the clause of creating table according to super table
+    index = 0;
+    sToken = tStrGetToken(str, &index, false, 0, NULL);
+    str += index;
+
+    if (sToken.type == TK_LP) {
+      if ((str = tscSkipParentheses(str)) == NULL) break;
+
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+    }
+
+    if (sToken.type == TK_USING) {
+      index = 0;
+      tStrGetToken(str, &index, false, 0, NULL);  // super table name
+      str += index;
+
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+
+      if (sToken.type == TK_LP) {
+        if ((str = tscSkipParentheses(str)) == NULL) break;
+
+        index = 0;
+        sToken = tStrGetToken(str, &index, false, 0, NULL);
+        str += index;
+      }
+
+      if (sToken.type != TK_TAGS) break;
+
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+
+      if (sToken.type != TK_LP || (str = tscSkipParentheses(str)) == NULL) break;
+
+      index = 0;
+      sToken = tStrGetToken(str, &index, false, 0, NULL);
+      str += index;
+    }
+
+    if (sToken.type == TK_VALUES) {
+      while (1) {
+        index = 0;
+        sToken = tStrGetToken(str, &index, false, 0, NULL);
+        if (sToken.type != TK_LP) break;
+
+        str += index;
+        if ((str = tscSkipParentheses(str)) == NULL) break;
+      }
+
+      if (str == NULL) break;
+    } else if (sToken.type == TK_FILE) {
+      index = 0;
+      tStrGetToken(str, &index, false, 0, NULL);  // file path
+      str += index;
+    } else {
+      break;
+    }
+  }
+
+  /*
+   * only one table absent in cache, there is no benefit to retrieve it in batch, it is left to the normal procedure.
+   */
+  if (taosArrayGetSize(pNameList) > 1) {
+    code = tscGetTableMetaInBatch(pSql, pNameList);
+  }
+
+_clean:
+  taosArrayDestroy(pNameList);
+  taosHashCleanup(pNameSet);
+  return code;
+}
+
 static int32_t validateDataSource(SSqlCmd *pCmd, int8_t type, const char *sql) {
   if (pCmd->dataSourceType != 0 && pCmd->dataSourceType != type) {
     return tscInvalidSQLErrMsg(pCmd->payload, "keyword VALUES and FILE are not allowed to mix up", sql);
@@ -1018,6 +1173,8 @@ int doParseInsertSql(SSqlObj *pSql, char *str) {
       code = TSDB_CODE_CLI_OUT_OF_MEMORY;
       goto _error_clean;
     }
+
+    pCmd->metaPrefetched = 0;
   } else {
     assert((NULL != pCmd->curSql) && (NULL != pCmd->pTableList));
     str = pCmd->curSql;
@@ -1064,7 +1221,21 @@ int doParseInsertSql(SSqlObj *pSql, char *str) {
     }
 
     ptrdiff_t pos = pCmd->curSql - pSql->sqlstr;
-    
+
+    /*
+     * At the first table that is absent in cache, try to retrieve the meta of all the absent tables in the rest of
+     * sql string in batch. The parse procedure is resumed from current table after the batch retrieval completes.
+     */
+    if (!pCmd->metaPrefetched && !tscIsTableMetaCached(pTableMetaInfo->name)) {
+      pCmd->metaPrefetched = 1;
+
+      if (tscPrefetchTableMeta(pSql, pCmd->curSql) == TSDB_CODE_ACTION_IN_PROGRESS) {
+        tscTrace("%p waiting for get table meta in batch during insert, then resume from offset: %" PRId64 " , %s",
+                 pSql, pos, pCmd->curSql);
+        return TSDB_CODE_ACTION_IN_PROGRESS;
+      }
+    }
+
     if ((code = tscCheckIfCreateTable(&str, pSql)) != TSDB_CODE_SUCCESS) {
       /*
        * For async insert, after get the table meta from server, the sql string will not be
@@ -375,6 +375,138 @@ static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
   return TSDB_CODE_SUCCESS;
 }
 
+static bool isBatchValueNull(TAOS_MULTI_BIND* bind, int32_t row) {
+  return bind->is_null != NULL && (bind->is_null[row >> 3] & (1u << (row & 7))) != 0;
+}
+
+static int checkBatchBindParam(SParamInfo* param, TAOS_MULTI_BIND* bind, int32_t num) {
+  if (bind->buffer_type != param->type || bind->num != num) {
+    return TSDB_CODE_INVALID_VALUE;
+  }
+
+  if (param->type == TSDB_DATA_TYPE_BINARY) {
+    for (int32_t r = 0; r < num; ++r) {
+      if (!isBatchValueNull(bind, r) && bind->length[r] > param->bytes) {
+        return TSDB_CODE_INVALID_VALUE;
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// the values of a column are copied to rows from the given one, stride is the size of row
+static int doBatchBindParam(char* data, int32_t stride, SParamInfo* param, TAOS_MULTI_BIND* bind) {
+  char* dst = data + param->offset;
+
+  for (int32_t r = 0; r < bind->num; ++r, dst += stride) {
+    if (isBatchValueNull(bind, r)) {
+      setNull(dst, param->type, param->bytes);
+      continue;
+    }
+
+    if (param->type == TSDB_DATA_TYPE_BINARY) {
+      memcpy(dst, (char*)bind->buffer + bind->buffer_length * r, bind->length[r]);
+      memset(dst + bind->length[r], 0, param->bytes - bind->length[r]);
+    } else if (param->type == TSDB_DATA_TYPE_NCHAR) {
+      if (!taosMbsToUcs4((char*)bind->buffer + bind->buffer_length * r, bind->length[r], dst, param->bytes)) {
+        return TSDB_CODE_INVALID_VALUE;
+      }
+    } else {
+      memcpy(dst, (char*)bind->buffer + param->bytes * r, param->bytes);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * Bind many rows at once, which is the same as binding and adding them one by one, but the data blocks are resized
+ * only once, and the values are copied without being converted row by row.
+ */
+static int insertStmtBindParamBatch(STscStmt* stmt, TAOS_MULTI_BIND* bind) {
+  SSqlCmd* pCmd = &stmt->pSql->cmd;
+
+  // the row bound but not added yet is kept, as it is by taos_stmt_execute
+  if ((pCmd->batchSize % 2) == 1) {
+    ++pCmd->batchSize;
+  }
+
+  int32_t alloced = 1, binded = 0;
+  if (pCmd->batchSize > 0) {
+    alloced = (pCmd->batchSize + 1) / 2;
+    binded = pCmd->batchSize / 2;
+  }
+
+  int32_t num = bind[0].num;
+  if (num <= 0) {
+    return TSDB_CODE_INVALID_VALUE;
+  }
+
+  int32_t total = MAX(alloced, binded + num);
+
+  // check and allocate before binding any value, so nothing is changed if it fails
+  for (int32_t i = 0; i < pCmd->pDataBlocks->nSize; ++i) {
+    STableDataBlocks* pBlock = pCmd->pDataBlocks->pData[i];
+
+    // the number of rows of a submit block is an int16_t
+    SSubmitBlk* pSubmit = (SSubmitBlk*)pBlock->pData;
+    if ((int64_t)pSubmit->numOfRows / alloced * total > INT16_MAX) {
+      tscError("%p too many rows in batch, %d rows bound and %d rows to bind", stmt->pSql, binded, num);
+      return TSDB_CODE_INVALID_VALUE;
+    }
+
+    for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+      SParamInfo* param = pBlock->params + j;
+      int code = checkBatchBindParam(param, bind + param->idx, num);
+      if (code != TSDB_CODE_SUCCESS) {
+        tscTrace("param %d: type mismatch or invalid", param->idx);
+        return code;
+      }
+    }
+
+    uint32_t dataSize = (pBlock->size - sizeof(SSubmitBlk)) / alloced;
+    uint32_t totalSize = sizeof(SSubmitBlk) + dataSize * total;
+    if (totalSize > pBlock->nAllocSize) {
+      void* tmp = realloc(pBlock->pData, totalSize);
+      if (tmp == NULL) {
+        return TSDB_CODE_CLI_OUT_OF_MEMORY;
+      }
+      pBlock->pData = (char*)tmp;
+      pBlock->nAllocSize = totalSize;
+    }
+  }
+
+  for (int32_t i = 0; i < pCmd->pDataBlocks->nSize; ++i) {
+    STableDataBlocks* pBlock = pCmd->pDataBlocks->pData[i];
+    uint32_t          dataSize = (pBlock->size - sizeof(SSubmitBlk)) / alloced;
+
+    char* data = pBlock->pData + sizeof(SSubmitBlk) + dataSize * binded;
+    for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+      SParamInfo* param = pBlock->params + j;
+      int code = doBatchBindParam(data, dataSize, param, bind + param->idx);
+      if (code != TSDB_CODE_SUCCESS) {
+        tscTrace("param %d: failed to convert value", param->idx);
+        return code;
+      }
+    }
+  }
+
+  for (int32_t i = 0; i < pCmd->pDataBlocks->nSize && total > alloced; ++i) {
+    STableDataBlocks* pBlock = pCmd->pDataBlocks->pData[i];
+
+    uint32_t totalDataSize = pBlock->size - sizeof(SSubmitBlk);
+    pBlock->size += totalDataSize / alloced * (total - alloced);
+
+    SSubmitBlk* pSubmit = (SSubmitBlk*)pBlock->pData;
+    pSubmit->numOfRows += pSubmit->numOfRows / alloced * (total - alloced);
+  }
+
+  // all rows are added to batch
+  pCmd->batchSize = (binded + num) * 2;
+  return TSDB_CODE_SUCCESS;
+}
+
 static int insertStmtAddBatch(STscStmt* stmt) {
   SSqlCmd* pCmd = &stmt->pSql->cmd;
   if ((pCmd->batchSize % 2) == 1) {
@@ -412,6 +544,17 @@ static int insertStmtReset(STscStmt* pStmt) {
   return TSDB_CODE_SUCCESS;
 }
 
+static void waitForStmtRsp(void* param, TAOS_RES* tres, int code) {
+  SSqlObj* pSql = (SSqlObj*)param;
+
+  // valid error code is less than 0
+  if (code < 0) {
+    pSql->res.code = code;
+  }
+
+  sem_post(&pSql->rspSem);
+}
+
 static int insertStmtExecute(STscStmt* stmt) {
   SSqlCmd* pCmd = &stmt->pSql->cmd;
   if (pCmd->batchSize == 0) {
@@ -451,7 +594,11 @@ static int insertStmtExecute(STscStmt* stmt) {
   
   pRes->qhandle = 0;
 
+  // wait for the response, as taos_query does
+  pSql->fp = waitForStmtRsp;
+  pSql->param = pSql;
   tscDoQuery(pSql);
+  sem_wait(&pSql->rspSem);
 
   // tscTrace("%p SQL result:%d, %s pObj:%p", pSql, pRes->code, taos_errstr(taos), pObj);
   if (pRes->code != TSDB_CODE_SUCCESS) {
@@ -546,6 +693,14 @@ int taos_stmt_bind_param(TAOS_STMT* stmt, TAOS_BIND* bind) {
   return normalStmtBindParam(pStmt, bind);
 }
 
+int taos_stmt_bind_param_batch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (pStmt->isInsert) {
+    return insertStmtBindParamBatch(pStmt, bind);
+  }
+  return TSDB_CODE_OPS_NOT_SUPPORT;
+}
+
 int taos_stmt_add_batch(TAOS_STMT* stmt) {
   STscStmt* pStmt = (STscStmt*)stmt;
   if (pStmt->isInsert) {
@@ -261,6 +261,7 @@ char *tscBuildQueryStreamDesc(char *pMsg, STscObj *pObj) {
 
     pSdesc->slidingTime = pStream->slidingTime;
     pSdesc->interval = pStream->interval;
+    pSdesc->lag = pStream->lag;
 
     pSList->numOfStreams++;
     pSdesc++;
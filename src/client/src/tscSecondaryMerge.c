@@ -164,6 +164,30 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
     return;
   }
 
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+
+  // one page of each sorted group is loaded into memory, the groups are merged in advance if they exceed the budget
+  int32_t maxNumOfGroups = (int32_t)MAX(((int64_t)tsSortMergeMemory << 20) / pMemBuffer[0]->pageSize, 2);
+  if (numOfFlush > maxNumOfGroups) {
+    int32_t num = tExtMemBufferMergeGroups(&pMemBuffer, numOfBuffer, pDesc, pQueryInfo->groupbyExpr.orderType,
+                                           maxNumOfGroups);
+    if (num < 0) {
+      tscError("%p failed to merge %d sorted groups", pSqlObjAddr, numOfFlush);
+
+      tscLocalReducerEnvDestroy(pMemBuffer, pDesc, finalmodel, numOfBuffer);
+      pRes->code = TSDB_CODE_CLI_NO_DISKSPACE;
+      return;
+    }
+
+    tscTrace("%p %d sorted groups are merged into %d groups", pSqlObjAddr, numOfFlush, num);
+
+    numOfBuffer = num;
+    numOfFlush = 0;
+    for (int32_t i = 0; i < numOfBuffer; ++i) {
+      numOfFlush += pMemBuffer[i]->fileMeta.flushoutData.nLength;
+    }
+  }
+
   if (pDesc->pColumnModel->capacity >= pMemBuffer[0]->pageSize) {
     tscError("%p Invalid value of buffer capacity %d and page size %d ", pSqlObjAddr, pDesc->pColumnModel->capacity,
              pMemBuffer[0]->pageSize);
@@ -243,7 +267,6 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
   param->pLocalData = pReducer->pLocalDataSrc;
   param->pDesc = pReducer->pDesc;
   param->numOfElems = pReducer->pLocalDataSrc[0]->pMemBuffer->numOfElemsPerPage;
-  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
 
   param->groupOrderType = pQueryInfo->groupbyExpr.orderType;
 
@@ -379,7 +402,8 @@ int32_t tscFlushTmpBuffer(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tF
     return -1;
   }
 
-  if (!tExtMemBufferFlush(pMemoryBuf)) {
+  // each sorted group is kept in memory if possible, and the temporary file is only used when it overflows
+  if (!tExtMemBufferSeal(pMemoryBuf)) {
     return -1;
   }
 
@@ -606,7 +630,9 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
   SQueryInfo *    pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
   STableMetaInfo *pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
 
-  (*pMemBuffer) = (tExtMemBuffer **)malloc(POINTER_BYTES * 1);
+  size_t numOfSubs = pTableMetaInfo->vgroupList->numOfVgroups;
+
+  (*pMemBuffer) = (tExtMemBuffer **)malloc(POINTER_BYTES * numOfSubs);
   if (*pMemBuffer == NULL) {
     tscError("%p failed to allocate memory", pSql);
     pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
@@ -637,7 +663,6 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
 
   pModel = createColumnModel(pSchema, pQueryInfo->exprsInfo.numOfExprs, capacity);
 
-  size_t numOfSubs = pTableMetaInfo->vgroupList->numOfVgroups;
   for (int32_t i = 0; i < numOfSubs; ++i) {
     (*pMemBuffer)[i] = createExtMemBuffer(nBufferSizes, rlen, pModel);
     (*pMemBuffer)[i]->flushModel = MULTIPLE_APPEND_MODEL;
@@ -328,6 +328,13 @@ void tscProcessMsgFromServer(SRpcMsg *rpcMsg) {
       pRes->code = TSDB_CODE_SUCCESS;
     }
 
+    // remember the table does not exist for a while, to avoid asking mnode for it again and again
+    if (pCmd->command == TSDB_SQL_META && pRes->code == TSDB_CODE_INVALID_TABLE) {
+      tscAddTableNotExistCache(tscGetTableMetaInfoFromCmd(pCmd, 0, 0)->name);
+    } else if (pCmd->command == TSDB_SQL_CREATE_TABLE && pRes->code == TSDB_CODE_SUCCESS) {
+      tscRemoveTableNotExistCache(tscGetTableMetaInfoFromCmd(pCmd, 0, 0)->name);
+    }
+
     /*
      * There is not response callback function for submit response.
      * The actual inserted number of points is the first number.
@@ -388,6 +395,7 @@ int doProcessSql(SSqlObj *pSql) {
       pCmd->command == TSDB_SQL_CONNECT ||
       pCmd->command == TSDB_SQL_HB ||
       pCmd->command == TSDB_SQL_META ||
+      pCmd->command == TSDB_SQL_MULTI_META ||
       pCmd->command == TSDB_SQL_STABLEVGROUP) {
     tscBuildMsg[pCmd->command](pSql, NULL);
   }
@@ -711,7 +719,17 @@ int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   pQueryMsg->slidingTimeUnit = pQueryInfo->slidingTimeUnit;
   pQueryMsg->numOfGroupCols = htons(pQueryInfo->groupbyExpr.numOfGroupCols);
 
-  pQueryMsg->queryType = htons(pQueryInfo->type);
+  // the vnode only scans the data after the subscription progress, and returns the new progress with result
+  uint16_t queryType = pQueryInfo->type;
+  if (pSql->pSubscription != NULL) {
+    TSDB_QUERY_SET_TYPE(queryType, TSDB_QUERY_TYPE_SUBSCRIBE);
+  }
+
+  if (tsQueryProfile) {
+    TSDB_QUERY_SET_TYPE(queryType, TSDB_QUERY_TYPE_PROFILE);
+  }
+
+  pQueryMsg->queryType = htons(queryType);
   pQueryMsg->numOfOutputCols = htons(pQueryInfo->exprsInfo.numOfExprs);
 
   int32_t numOfOutput = pQueryInfo->fieldsInfo.numOfOutputCols;
@@ -1550,42 +1568,38 @@ int tscBuildTableMetaMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
 
 /**
  *  multi table meta req pkg format:
- *  | SMgmtHead | SCMMultiTableInfoMsg | tableId0 | tableId1 | tableId2 | ......
- *      no used         4B
+ *  | SCMMultiTableInfoMsg | tableId0 | tableId1 | tableId2 | ......
+ *           4B
+ *
+ *  Before the msg is built, the table ids are kept in payload with the fixed length of TSDB_TABLE_ID_LEN each.
  **/
 int tscBuildMultiMeterMetaMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   SSqlCmd *pCmd = &pSql->cmd;
 
-  // copy payload content to temp buff
-  char *tmpData = 0;
-  if (pCmd->payloadLen > 0) {
-    tmpData = calloc(1, pCmd->payloadLen + 1);
-    if (NULL == tmpData) return -1;
-    memcpy(tmpData, pCmd->payload, pCmd->payloadLen);
-  }
-
-  // fill head info
-  SMgmtHead *pMgmt = (SMgmtHead *)(pCmd->payload + tsRpcHeadSize);
-  memset(pMgmt->db, 0, TSDB_TABLE_ID_LEN);  // server don't need the db
-
-  SCMMultiTableInfoMsg *pInfoMsg = (SCMMultiTableInfoMsg *)(pCmd->payload + tsRpcHeadSize + sizeof(SMgmtHead));
-  pInfoMsg->numOfTables = htonl((int32_t)pCmd->count);
+  // the table ids in payload are kept, while tscAllocPayload clears the payload
+  int32_t size = pCmd->payloadLen + sizeof(SCMMultiTableInfoMsg);
+  if (pCmd->allocSize < size) {
+    char *pPayload = realloc(pCmd->payload, size);
+    if (pPayload == NULL) {
+      tscError("%p failed to malloc for multi-metermeta msg", pSql);
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
 
-  if (pCmd->payloadLen > 0) {
-    memcpy(pInfoMsg->tableIds, tmpData, pCmd->payloadLen);
+    pCmd->payload = pPayload;
+    pCmd->allocSize = size;
   }
 
-  tfree(tmpData);
+  SCMMultiTableInfoMsg *pInfoMsg = (SCMMultiTableInfoMsg *)pCmd->payload;
+  memmove(pInfoMsg->tableIds, pCmd->payload, pCmd->payloadLen);
+  pInfoMsg->numOfTables = htonl((int32_t)pCmd->count);
 
-  pCmd->payloadLen += sizeof(SMgmtHead) + sizeof(SCMMultiTableInfoMsg);
+  pCmd->payloadLen += sizeof(SCMMultiTableInfoMsg);
   pCmd->msgType = TSDB_MSG_TYPE_CM_TABLES_META;
 
-  assert(pCmd->payloadLen + minMsgSize() <= pCmd->allocSize);
-
   tscTrace("%p build load multi-metermeta msg completed, numOfTables:%d, msg size:%d", pSql, pCmd->count,
            pCmd->payloadLen);
 
-  return pCmd->payloadLen;
+  return TSDB_CODE_SUCCESS;
 }
 
 static UNUSED_FUNC int32_t tscEstimateMetricMetaMsgSize(SSqlCmd *pCmd) {
@@ -1831,9 +1845,7 @@ int tscBuildHeartBeatMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   return msgLen;
 }
 
-int tscProcessTableMetaRsp(SSqlObj *pSql) {
-  STableMetaMsg *pMetaMsg = (STableMetaMsg *)pSql->res.pRsp;
-
+static int32_t tscDecodeTableMetaMsg(STableMetaMsg *pMetaMsg) {
   pMetaMsg->sid = htonl(pMetaMsg->sid);
   pMetaMsg->sversion = htons(pMetaMsg->sversion);
   
@@ -1876,6 +1888,17 @@ int tscProcessTableMetaRsp(SSqlObj *pSql) {
     pSchema++;
   }
 
+  return TSDB_CODE_SUCCESS;
+}
+
+int tscProcessTableMetaRsp(SSqlObj *pSql) {
+  STableMetaMsg *pMetaMsg = (STableMetaMsg *)pSql->res.pRsp;
+
+  int32_t code = tscDecodeTableMetaMsg(pMetaMsg);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
   size_t size = 0;
   STableMeta* pTableMeta = tscCreateTableMetaFromMsg(pMetaMsg, &size);
 
@@ -1909,110 +1932,72 @@ int tscProcessTableMetaRsp(SSqlObj *pSql) {
 
 /**
  *  multi table meta rsp pkg format:
- *  | STaosRsp | ieType | SCMMultiTableInfoMsg | SMeterMeta0 | SSchema0 | SMeterMeta1 | SSchema1 | SMeterMeta2 | SSchema2
- *  |...... 1B        1B            4B
+ *  | SMultiTableMeta | STableMetaMsg0 | SSchema0 | STableMetaMsg1 | SSchema1 | ...... | numOfAbsent | index0 | ......
+ *          8B                                                                                     4B         4B
+ *
+ *  Only the tables listed by their indexes in request as absent do not exist, and they are put into the negative
+ *  cache. A table may be left out of the metas for other reasons, e.g. its vgroup is not available.
  **/
 int tscProcessMultiMeterMetaRsp(SSqlObj *pSql) {
-#if 0
-  char *rsp = pSql->res.pRsp;
+  SSqlRes *pRes = &pSql->res;
+  SSqlCmd *pCmd = &pSql->cmd;
 
-  ieType = *rsp;
-  if (ieType != TSDB_IE_TYPE_META) {
-    tscError("invalid ie type:%d", ieType);
-    pSql->res.code = TSDB_CODE_INVALID_IE;
-    pSql->res.numOfTotal = 0;
-    return TSDB_CODE_OTHERS;
+  if (pRes->rspLen < sizeof(SMultiTableMeta)) {
+    tscError("%p invalid multi-metermeta rsp len:%d", pSql, pRes->rspLen);
+    return TSDB_CODE_INVALID_VALUE;
   }
 
-  rsp++;
+  SMultiTableMeta *pMultiMeta = (SMultiTableMeta *)pRes->pRsp;
+  pMultiMeta->numOfTables = htonl(pMultiMeta->numOfTables);
+  pMultiMeta->contLen = htonl(pMultiMeta->contLen);
 
-  SCMMultiTableInfoMsg *pInfo = (SCMMultiTableInfoMsg *)rsp;
-  totalNum = htonl(pInfo->numOfTables);
-  rsp += sizeof(SCMMultiTableInfoMsg);
+  char *pMsg = (char *)pMultiMeta->metas;
+  char *pEnd = pRes->pRsp + pRes->rspLen;
 
-  for (i = 0; i < totalNum; i++) {
-    SMultiTableMeta *pMultiMeta = (SMultiTableMeta *)rsp;
-    STableMeta *     pMeta = pMultiMeta->metas;
+  for (int32_t i = 0; i < pMultiMeta->numOfTables; ++i) {
+    STableMetaMsg *pMetaMsg = (STableMetaMsg *)pMsg;
+    if (pMsg + sizeof(STableMetaMsg) > pEnd) {
+      tscError("%p multi-metermeta rsp is truncated, %d of %d parsed", pSql, i, pMultiMeta->numOfTables);
+      return TSDB_CODE_INVALID_VALUE;
+    }
 
-    pMeta->sid = htonl(pMeta->sid);
-    pMeta->sversion = htons(pMeta->sversion);
-    pMeta->vgId = htonl(pMeta->vgId);
-    pMeta->uid = htobe64(pMeta->uid);
+    int32_t code = tscDecodeTableMetaMsg(pMetaMsg);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+
+    size_t      size = 0;
+    STableMeta *pTableMeta = tscCreateTableMetaFromMsg(pMetaMsg, &size);
 
-    if (pMeta->sid <= 0 || pMeta->vgId < 0) {
-      tscError("invalid meter vgId:%d, sid%d", pMeta->vgId, pMeta->sid);
-      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-      pSql->res.numOfTotal = i;
-      return TSDB_CODE_OTHERS;
+    void *p = taosCachePut(tscCacheHandle, pMetaMsg->tableId, pTableMeta, size, tsMeterMetaKeepTimer);
+    taosCacheRelease(tscCacheHandle, &p, false);
+    free(pTableMeta);
+
+    pMsg += pMetaMsg->contLen;
+  }
+
+  // the list of absent tables is not sent by an older mnode
+  SCMMultiTableInfoMsg *pInfo = (SCMMultiTableInfoMsg *)pCmd->payload;
+  if (pMsg + sizeof(int32_t) <= pEnd) {
+    int32_t  numOfAbsent = htonl(*(int32_t *)pMsg);
+    int32_t *indexes = (int32_t *)(pMsg + sizeof(int32_t));
+    if (numOfAbsent < 0 || (char *)(indexes + numOfAbsent) > pEnd) {
+      tscError("%p invalid absent tables in multi-metermeta rsp, num:%d", pSql, numOfAbsent);
+      return TSDB_CODE_INVALID_VALUE;
     }
 
-    //    pMeta->numOfColumns = htons(pMeta->numOfColumns);
-    //
-    //    if (pMeta->numOfTags > TSDB_MAX_TAGS || pMeta->numOfTags < 0) {
-    //      tscError("invalid tag value count:%d", pMeta->numOfTags);
-    //      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-    //      pSql->res.numOfTotal = i;
-    //      return TSDB_CODE_OTHERS;
-    //    }
-    //
-    //    if (pMeta->numOfTags > TSDB_MAX_TAGS || pMeta->numOfTags < 0) {
-    //      tscError("invalid numOfTags:%d", pMeta->numOfTags);
-    //      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-    //      pSql->res.numOfTotal = i;
-    //      return TSDB_CODE_OTHERS;
-    //    }
-    //
-    //    if (pMeta->numOfColumns > TSDB_MAX_COLUMNS || pMeta->numOfColumns < 0) {
-    //      tscError("invalid numOfColumns:%d", pMeta->numOfColumns);
-    //      pSql->res.code = TSDB_CODE_INVALID_VALUE;
-    //      pSql->res.numOfTotal = i;
-    //      return TSDB_CODE_OTHERS;
-    //    }
-    //
-    //    for (int j = 0; j < TSDB_REPLICA_MAX_NUM; ++j) {
-    //      pMeta->vpeerDesc[j].vnode = htonl(pMeta->vpeerDesc[j].vnode);
-    //    }
-    //
-    //    pMeta->rowSize = 0;
-    //    rsp += sizeof(SMultiTableMeta);
-    //    pSchema = (SSchema *)rsp;
-    //
-    //    int32_t numOfTotalCols = pMeta->numOfColumns + pMeta->numOfTags;
-    //    for (int j = 0; j < numOfTotalCols; ++j) {
-    //      pSchema->bytes = htons(pSchema->bytes);
-    //      pSchema->colId = htons(pSchema->colId);
-    //
-    //      // ignore the tags length
-    //      if (j < pMeta->numOfColumns) {
-    //        pMeta->rowSize += pSchema->bytes;
-    //      }
-    //      pSchema++;
-    //    }
-    //
-    //    rsp += numOfTotalCols * sizeof(SSchema);
-    //
-    //    int32_t  tagLen = 0;
-    //    SSchema *pTagsSchema = tscGetTableTagSchema(pMeta);
-    //
-    //    if (pMeta->tableType == TSDB_CHILD_TABLE) {
-    //      for (int32_t j = 0; j < pMeta->numOfTags; ++j) {
-    //        tagLen += pTagsSchema[j].bytes;
-    //      }
-    //    }
-    //
-    //    rsp += tagLen;
-    //    int32_t size = (int32_t)(rsp - ((char *)pMeta));  // Consistent with STableMeta in cache
-    //
-    //    pMeta->index = 0;
-    //    (void)taosCachePut(tscCacheHandle, pMeta->tableId, (char *)pMeta, size, tsMeterMetaKeepTimer);
-    //  }
-  }
-  
-  pSql->res.code = TSDB_CODE_SUCCESS;
-  pSql->res.numOfTotal = i;
-  tscTrace("%p load multi-metermeta resp complete num:%d", pSql, pSql->res.numOfTotal);
-#endif
-  
+    for (int32_t i = 0; i < numOfAbsent; ++i) {
+      int32_t index = htonl(indexes[i]);
+      if (index >= 0 && index < pCmd->count) {
+        tscAddTableNotExistCache(pInfo->tableIds + index * TSDB_TABLE_ID_LEN);
+      }
+    }
+  }
+
+  pRes->code = TSDB_CODE_SUCCESS;
+  pRes->numOfTotal = pMultiMeta->numOfTables;
+  tscTrace("%p load multi-metermeta resp complete, requested:%d, retrieved:%d", pSql, pCmd->count, pRes->numOfTotal);
+
   return TSDB_CODE_SUCCESS;
 }
 
@@ -2234,6 +2219,9 @@ int tscProcessConnectRsp(SSqlObj *pSql) {
   strcpy(pObj->sversion, pConnect->serverVersion);
   pObj->writeAuth = pConnect->writeAuth;
   pObj->superAuth = pConnect->superAuth;
+
+  // an older server sends a shorter response without the features
+  pObj->features = (pRes->rspLen >= sizeof(SCMConnectRsp)) ? htonl(pConnect->features) : 0;
   taosTmrReset(tscProcessActivityTimer, tsShellActivityTimer * 500, pObj, tscTmr, &pObj->pTimer);
 
   return 0;
@@ -2322,6 +2310,17 @@ int tscProcessQueryRsp(SSqlObj *pSql) {
   return 0;
 }
 
+static void tscPrintQueryProfile(SSqlObj *pSql, SQueryProfileMsg *pMsg) {
+  tscPrint("%p query profile, elapsed:%" PRId64 "us, load comp info:%" PRId64 "us, load blocks:%" PRId64
+           "us, apply functions:%" PRId64 "us, merge:%" PRId64 "us",
+           pSql, htobe64(pMsg->elapsedUs), htobe64(pMsg->loadCompInfoUs), htobe64(pMsg->loadBlocksUs),
+           htobe64(pMsg->applyFunctionUs), htobe64(pMsg->mergeUs));
+  tscPrint("%p query profile, files:%d, blocks:%d, file blocks:%d, cache blocks:%d, skipped blocks:%d, read bytes:%" PRId64
+           ", rows:%" PRId64 ", filtered rows:%" PRId64,
+           pSql, htonl(pMsg->numOfFiles), htonl(pMsg->totalBlocks), htonl(pMsg->fileBlocks), htonl(pMsg->cacheBlocks),
+           htonl(pMsg->skippedBlocks), htobe64(pMsg->readBytes), htobe64(pMsg->totalRows), htobe64(pMsg->filteredRows));
+}
+
 int tscProcessRetrieveRspFromVnode(SSqlObj *pSql) {
   SSqlRes *pRes = &pSql->res;
   SSqlCmd *pCmd = &pSql->cmd;
@@ -2338,17 +2337,22 @@ int tscProcessRetrieveRspFromVnode(SSqlObj *pSql) {
   SQueryInfo* pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
   tscSetResultPointer(pQueryInfo, pRes);
 
-  if (pSql->pSubscription != NULL) {
-    int32_t numOfCols = pQueryInfo->fieldsInfo.numOfOutputCols;
-    
+  // the subscription progress and the execution profile follow the result data in order
+  int32_t numOfCols = pQueryInfo->fieldsInfo.numOfOutputCols;
+  char*   p = pRes->data;
+  if (numOfCols > 0) {
     TAOS_FIELD *pField = tscFieldInfoGetField(pQueryInfo, numOfCols - 1);
     int16_t     offset = tscFieldInfoGetOffset(pQueryInfo, numOfCols - 1);
-    
-    char* p = pRes->data + (pField->bytes + offset) * pRes->numOfRows;
 
+    p += (pField->bytes + offset) * pRes->numOfRows;
+  }
+
+  // the vnode always writes the progress for a subscription query, with no table if the subscription is not supported
+  char* pEnd = pRes->pRsp + pRes->rspLen;
+  if (pSql->pSubscription != NULL && p + sizeof(int32_t) <= pEnd) {
     int32_t numOfTables = htonl(*(int32_t*)p);
     p += sizeof(int32_t);
-    for (int i = 0; i < numOfTables; i++) {
+    for (int i = 0; i < numOfTables && p + sizeof(int64_t) + sizeof(TSKEY) <= pEnd; i++) {
       int64_t uid = htobe64(*(int64_t*)p);
       p += sizeof(int64_t);
       TSKEY key = htobe64(*(TSKEY*)p);
@@ -2357,6 +2361,10 @@ int tscProcessRetrieveRspFromVnode(SSqlObj *pSql) {
     }
   }
 
+  if (tsQueryProfile && pRes->completed) {
+    tscPrintQueryProfile(pSql, (SQueryProfileMsg *)p);
+  }
+
   pRes->row = 0;
   tscTrace("%p numOfRows:%d, offset:%d", pSql, pRes->numOfRows, pRes->offset);
 
@@ -2422,6 +2430,116 @@ static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInf
   return code;
 }
 
+static void tscMultiTableMetaCallBack(void *param, TAOS_RES *res, int code) {
+  SSqlObj *pSql = (SSqlObj *)param;
+  if (pSql == NULL || pSql->signature != pSql) return;
+
+  /*
+   * the batch retrieval only warms up the cache. If it fails, the tables that are still missing in cache are
+   * retrieved one by one in the following parse procedure, so the error is not reported to the application.
+   */
+  if (code != TSDB_CODE_SUCCESS) {
+    tscWarn("%p failed to get table meta in batch, code:%s, continue", pSql, tstrerror(code));
+  }
+
+  tscTableMetaCallBack(param, res, TSDB_CODE_SUCCESS);
+}
+
+int32_t tscGetTableMetaInBatch(SSqlObj *pSql, SArray *pNameList) {
+  size_t numOfTables = taosArrayGetSize(pNameList);
+  assert(numOfTables > 0 && numOfTables <= TSDB_MULTI_METERMETA_MAX_NUM);
+
+  SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
+  if (NULL == pNew) {
+    tscError("%p malloc failed for new sqlobj to get table meta in batch", pSql);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pNew->pTscObj = pSql->pTscObj;
+  pNew->signature = pNew;
+  pNew->cmd.command = TSDB_SQL_MULTI_META;
+
+  tscAddSubqueryInfo(&pNew->cmd);
+
+  SQueryInfo *pNewQueryInfo = NULL;
+  tscGetQueryInfoDetailSafely(&pNew->cmd, 0, &pNewQueryInfo);
+
+  int32_t size = numOfTables * TSDB_TABLE_ID_LEN + sizeof(SCMMultiTableInfoMsg);
+  if (TSDB_CODE_SUCCESS != tscAllocPayload(&pNew->cmd, size)) {
+    tscError("%p malloc failed for payload to get table meta in batch", pSql);
+    tscFreeSqlObj(pNew);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  // the first table is used as the representative of this batch
+  STableMetaInfo *pNewMeterMetaInfo = tscAddEmptyMetaInfo(pNewQueryInfo);
+  strncpy(pNewMeterMetaInfo->name, taosArrayGet(pNameList, 0), tListLen(pNewMeterMetaInfo->name));
+
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    strncpy(pNew->cmd.payload + i * TSDB_TABLE_ID_LEN, taosArrayGet(pNameList, i), TSDB_TABLE_ID_LEN);
+  }
+
+  pNew->cmd.count = numOfTables;
+  pNew->cmd.payloadLen = numOfTables * TSDB_TABLE_ID_LEN;
+
+  tscTrace("%p new pSqlObj:%p to get meta of %d tables in batch", pSql, pNew, numOfTables);
+
+  pNew->fp = tscMultiTableMetaCallBack;
+  pNew->param = pSql;
+
+  int32_t code = tscProcessSql(pNew);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = TSDB_CODE_ACTION_IN_PROGRESS;
+  }
+
+  return code;
+}
+
+/*
+ * The "table not exist" answers of mnode are kept for tsNegMeterMetaKeepTimer seconds, so that the insertions into
+ * an absent table, which are usually issued repeatedly by applications, fail without asking mnode every time.
+ * The expire time is kept as the cache data, since the cache only removes the expired items periodically.
+ */
+void tscAddTableNotExistCache(const char *tableId) {
+  if (tsNegMeterMetaKeepTimer <= 0 || tscNegCacheHandle == NULL) {
+    return;
+  }
+
+  int64_t expireTime = taosGetTimestampMs() + tsNegMeterMetaKeepTimer * 1000L;
+
+  void *p = taosCachePut(tscNegCacheHandle, tableId, &expireTime, sizeof(int64_t), tsNegMeterMetaKeepTimer);
+  taosCacheRelease(tscNegCacheHandle, &p, false);
+
+  tscTrace("table:%s does not exist, keep the answer for %d seconds", tableId, tsNegMeterMetaKeepTimer);
+}
+
+bool tscIsTableNotExistCached(const char *tableId) {
+  if (tscNegCacheHandle == NULL) {
+    return false;
+  }
+
+  int64_t *pExpireTime = taosCacheAcquireByName(tscNegCacheHandle, tableId);
+  if (pExpireTime == NULL) {
+    return false;
+  }
+
+  bool notExist = (*pExpireTime > taosGetTimestampMs());
+  taosCacheRelease(tscNegCacheHandle, (void **)&pExpireTime, !notExist);
+
+  return notExist;
+}
+
+void tscRemoveTableNotExistCache(const char *tableId) {
+  if (tscNegCacheHandle == NULL) {
+    return;
+  }
+
+  void *p = taosCacheAcquireByName(tscNegCacheHandle, tableId);
+  if (p != NULL) {
+    taosCacheRelease(tscNegCacheHandle, &p, true);
+  }
+}
+
 int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
   assert(strlen(pTableMetaInfo->name) != 0);
 
@@ -2438,12 +2556,21 @@ int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
 
     return TSDB_CODE_SUCCESS;
   }
-  
+
+  if (pSql->cmd.command == TSDB_SQL_INSERT && tscIsTableNotExistCached(pTableMetaInfo->name)) {
+    tscTrace("%p table:%s does not exist according to negative cache", pSql, pTableMetaInfo->name);
+    return TSDB_CODE_INVALID_TABLE;
+  }
+
   return getTableMetaFromMgmt(pSql, pTableMetaInfo);
 }
 
 int tscGetMeterMetaEx(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo, bool createIfNotExists) {
   pSql->cmd.autoCreated = createIfNotExists;
+  if (createIfNotExists) {
+    tscRemoveTableNotExistCache(pTableMetaInfo->name);
+  }
+
   return tscGetTableMeta(pSql, pTableMetaInfo);
 }
 
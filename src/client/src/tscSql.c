@@ -1097,6 +1097,7 @@ static int tscParseTblNameList(SSqlObj *pSql, const char *tblNameList, int32_t t
     return code;
   }
 
+  // table ids are kept in payload with the fixed length, see tscBuildMultiMeterMetaMsg
   char *nextStr;
   char  tblName[TSDB_TABLE_ID_LEN];
   int   payloadLen = 0;
@@ -1136,8 +1137,8 @@ static int tscParseTblNameList(SSqlObj *pSql, const char *tblNameList, int32_t t
       return code;
     }
 
-    if (payloadLen + strlen(pTableMetaInfo->name) + 128 >= pCmd->allocSize) {
-      char *pNewMem = realloc(pCmd->payload, pCmd->allocSize + tblListLen);
+    if (payloadLen + TSDB_TABLE_ID_LEN >= pCmd->allocSize) {
+      char *pNewMem = realloc(pCmd->payload, pCmd->allocSize + tblListLen + TSDB_TABLE_ID_LEN);
       if (pNewMem == NULL) {
         code = TSDB_CODE_CLI_OUT_OF_MEMORY;
         sprintf(pCmd->payload, "failed to allocate memory");
@@ -1145,15 +1146,16 @@ static int tscParseTblNameList(SSqlObj *pSql, const char *tblNameList, int32_t t
       }
 
       pCmd->payload = pNewMem;
-      pCmd->allocSize = pCmd->allocSize + tblListLen;
+      pCmd->allocSize = pCmd->allocSize + tblListLen + TSDB_TABLE_ID_LEN;
       pMsg = pCmd->payload;
     }
 
-    payloadLen += sprintf(pMsg + payloadLen, "%s,", pTableMetaInfo->name);
+    memset(pMsg + payloadLen, 0, TSDB_TABLE_ID_LEN);
+    strncpy(pMsg + payloadLen, pTableMetaInfo->name, TSDB_TABLE_ID_LEN - 1);
+    payloadLen += TSDB_TABLE_ID_LEN;
   }
 
-  *(pMsg + payloadLen) = '\0';
-  pCmd->payloadLen = payloadLen + 1;
+  pCmd->payloadLen = payloadLen;
 
   return TSDB_CODE_SUCCESS;
 }
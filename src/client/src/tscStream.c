@@ -46,6 +46,234 @@ static bool isProjectStream(SQueryInfo* pQueryInfo) {
   return true;
 }
 
+/*
+ * When the interval is a multiple of the sliding time and all output functions can be merged, a window of stream is
+ * split into panes of the sliding time, and the result of a window is merged from its panes. The partial result of a
+ * closed pane is kept for the following windows, so each launch only queries the new panes after the last window.
+ * The same as a non-overlapped window, rows arrived after their pane is computed are not included in later windows.
+ */
+#define TSC_STREAM_MERGE_NONE 0
+#define TSC_STREAM_MERGE_SUM  1
+#define TSC_STREAM_MERGE_MIN  2
+#define TSC_STREAM_MERGE_MAX  3
+
+#define TSC_STREAM_EMPTY_PANE INT64_MIN
+
+typedef struct SStreamPanes {
+  int32_t numOfPanes;  // number of panes in one window
+  int32_t rowSize;
+  int64_t paneEnd;     // the panes before it have been computed
+  int8_t  mergeFn[TSDB_MAX_COLUMNS];
+  TSKEY * pKeys;       // start time of the pane in each slot, TSC_STREAM_EMPTY_PANE if no data
+  char *  pRows;       // result row of the pane in each slot
+  char *  pResult;     // merged result row of window
+} SStreamPanes;
+
+static void tscFreeStreamPanes(SStreamPanes *pPanes) {
+  if (pPanes == NULL) return;
+
+  tfree(pPanes->pKeys);
+  tfree(pPanes->pRows);
+  tfree(pPanes->pResult);
+  free(pPanes);
+}
+
+static SStreamPanes *tscCreateStreamPanes(SSqlStream *pStream, SQueryInfo *pQueryInfo) {
+  if (pStream->interval == pStream->slidingTime || pStream->interval % pStream->slidingTime != 0) {
+    return NULL;
+  }
+
+  if (pQueryInfo->interpoType != TSDB_INTERPO_NONE || pQueryInfo->groupbyExpr.numOfGroupCols > 0) {
+    return NULL;
+  }
+
+  int8_t  mergeFn[TSDB_MAX_COLUMNS] = {0};
+  int32_t numOfCols = pQueryInfo->fieldsInfo.numOfOutputCols;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SSqlExpr *pExpr = pQueryInfo->fieldsInfo.pSqlExpr[i];
+    if (pExpr == NULL || (pQueryInfo->fieldsInfo.pExpr != NULL && pQueryInfo->fieldsInfo.pExpr[i] != NULL)) {
+      return NULL;
+    }
+
+    switch (pExpr->functionId) {
+      case TSDB_FUNC_TS:
+        if (i != 0) return NULL;
+        mergeFn[i] = TSC_STREAM_MERGE_NONE;
+        break;
+      case TSDB_FUNC_COUNT:
+      case TSDB_FUNC_SUM:
+        mergeFn[i] = TSC_STREAM_MERGE_SUM;
+        break;
+      case TSDB_FUNC_MIN:
+        mergeFn[i] = TSC_STREAM_MERGE_MIN;
+        break;
+      case TSDB_FUNC_MAX:
+        mergeFn[i] = TSC_STREAM_MERGE_MAX;
+        break;
+      default:
+        return NULL;
+    }
+  }
+
+  if (pQueryInfo->fieldsInfo.pSqlExpr[0]->functionId != TSDB_FUNC_TS) {
+    return NULL;
+  }
+
+  SStreamPanes *pPanes = calloc(1, sizeof(SStreamPanes));
+  if (pPanes == NULL) {
+    return NULL;
+  }
+
+  pPanes->numOfPanes = (int32_t)(pStream->interval / pStream->slidingTime);
+  pPanes->rowSize = tscFieldInfoGetOffset(pQueryInfo, numOfCols - 1) + tscFieldInfoGetField(pQueryInfo, numOfCols - 1)->bytes;
+  pPanes->paneEnd = TSC_STREAM_EMPTY_PANE;
+  memcpy(pPanes->mergeFn, mergeFn, sizeof(mergeFn));
+
+  pPanes->pKeys = malloc(sizeof(TSKEY) * pPanes->numOfPanes);
+  pPanes->pRows = malloc((size_t)pPanes->rowSize * pPanes->numOfPanes);
+  pPanes->pResult = malloc(pPanes->rowSize);
+  if (pPanes->pKeys == NULL || pPanes->pRows == NULL || pPanes->pResult == NULL) {
+    tscFreeStreamPanes(pPanes);
+    return NULL;
+  }
+
+  for (int32_t i = 0; i < pPanes->numOfPanes; ++i) {
+    pPanes->pKeys[i] = TSC_STREAM_EMPTY_PANE;
+  }
+
+  return pPanes;
+}
+
+static int32_t tscGetStreamPaneSlot(SSqlStream *pStream, TSKEY key) {
+  int64_t index = key / pStream->slidingTime;
+  int32_t slot = (int32_t)(index % pStream->pPanes->numOfPanes);
+  return (slot < 0) ? slot + pStream->pPanes->numOfPanes : slot;
+}
+
+// only the panes that are not computed yet are queried, and one result row is returned for each pane
+static void tscSetStreamPaneQueryRange(SSqlStream *pStream, SQueryInfo *pQueryInfo) {
+  SStreamPanes *pPanes = pStream->pPanes;
+
+  if (pPanes->paneEnd > pQueryInfo->stime) {
+    pQueryInfo->stime = pPanes->paneEnd;
+  }
+
+  pQueryInfo->intervalTime = pStream->slidingTime;
+  pQueryInfo->slidingTime = pStream->slidingTime;
+}
+
+static void tscSaveStreamPane(SSqlStream *pStream, SQueryInfo *pQueryInfo, TAOS_ROW row) {
+  SStreamPanes *pPanes = pStream->pPanes;
+
+  TSKEY   key = *(TSKEY *)row[0];
+  int32_t slot = tscGetStreamPaneSlot(pStream, key);
+  char *  pRow = pPanes->pRows + (size_t)pPanes->rowSize * slot;
+
+  for (int32_t i = 0; i < pQueryInfo->fieldsInfo.numOfOutputCols; ++i) {
+    TAOS_FIELD *pField = tscFieldInfoGetField(pQueryInfo, i);
+    char *      pDst = pRow + tscFieldInfoGetOffset(pQueryInfo, i);
+
+    if (row[i] == NULL) {
+      setNull(pDst, pField->type, pField->bytes);
+    } else {
+      memcpy(pDst, row[i], pField->bytes);
+    }
+  }
+
+  pPanes->pKeys[slot] = key;
+}
+
+#define MERGE_STREAM_PANE_VALUE(_type, _dst, _src, _fn)       \
+  do {                                                        \
+    _type _v = *(_type *)(_src);                              \
+    _type *_d = (_type *)(_dst);                              \
+    if ((_fn) == TSC_STREAM_MERGE_SUM) {                      \
+      *_d += _v;                                              \
+    } else if ((_fn) == TSC_STREAM_MERGE_MIN && _v < *_d) {   \
+      *_d = _v;                                               \
+    } else if ((_fn) == TSC_STREAM_MERGE_MAX && _v > *_d) {   \
+      *_d = _v;                                               \
+    }                                                         \
+  } while (0)
+
+static void tscMergeStreamPaneValue(int8_t fn, int16_t type, char *dst, const char *src) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   MERGE_STREAM_PANE_VALUE(int8_t, dst, src, fn);  break;
+    case TSDB_DATA_TYPE_SMALLINT:  MERGE_STREAM_PANE_VALUE(int16_t, dst, src, fn); break;
+    case TSDB_DATA_TYPE_INT:       MERGE_STREAM_PANE_VALUE(int32_t, dst, src, fn); break;
+    case TSDB_DATA_TYPE_TIMESTAMP:
+    case TSDB_DATA_TYPE_BIGINT:    MERGE_STREAM_PANE_VALUE(int64_t, dst, src, fn); break;
+    case TSDB_DATA_TYPE_FLOAT:     MERGE_STREAM_PANE_VALUE(float, dst, src, fn);   break;
+    case TSDB_DATA_TYPE_DOUBLE:    MERGE_STREAM_PANE_VALUE(double, dst, src, fn);  break;
+    default:;
+  }
+}
+
+/*
+ * merge the panes of the window that ends at pStream->stime, and send the result to application. Nothing is sent if
+ * there is no data in all panes, which is the same as the query on the whole window.
+ */
+static int32_t tscOutputStreamPanes(SSqlStream *pStream, SSqlObj *pSql) {
+  SStreamPanes *pPanes = pStream->pPanes;
+  SQueryInfo *  pQueryInfo = tscGetQueryInfoDetail(&pSql->cmd, 0);
+  int32_t       numOfCols = pQueryInfo->fieldsInfo.numOfOutputCols;
+
+  pPanes->paneEnd = pStream->stime;
+
+  TSKEY   skey = pStream->stime - pStream->interval;
+  int32_t numOfMerged = 0;
+
+  for (int32_t i = 1; i < numOfCols; ++i) {
+    TAOS_FIELD *pField = tscFieldInfoGetField(pQueryInfo, i);
+    setNull(pPanes->pResult + tscFieldInfoGetOffset(pQueryInfo, i), pField->type, pField->bytes);
+  }
+
+  for (TSKEY key = skey; key < pStream->stime; key += pStream->slidingTime) {
+    int32_t slot = tscGetStreamPaneSlot(pStream, key);
+    if (pPanes->pKeys[slot] != key) {  // no data in pane, or the slot has been reused by a later pane
+      continue;
+    }
+
+    char *pRow = pPanes->pRows + (size_t)pPanes->rowSize * slot;
+    for (int32_t i = 1; i < numOfCols; ++i) {
+      TAOS_FIELD *pField = tscFieldInfoGetField(pQueryInfo, i);
+      int16_t     offset = tscFieldInfoGetOffset(pQueryInfo, i);
+
+      char *pSrc = pRow + offset;
+      char *pDst = pPanes->pResult + offset;
+      if (isNull(pSrc, pField->type)) {
+        continue;
+      }
+
+      if (isNull(pDst, pField->type)) {
+        memcpy(pDst, pSrc, pField->bytes);
+      } else {
+        tscMergeStreamPaneValue(pPanes->mergeFn[i], pField->type, pDst, pSrc);
+      }
+    }
+
+    numOfMerged += 1;
+  }
+
+  if (numOfMerged == 0) {
+    return 0;
+  }
+
+  void *row[TSDB_MAX_COLUMNS] = {0};
+
+  *(TSKEY *)pPanes->pResult = skey;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    row[i] = pPanes->pResult + tscFieldInfoGetOffset(pQueryInfo, i);
+  }
+
+  tscTrace("%p stream:%p, result of window:%" PRId64 " is merged from %d panes", pSql, pStream, skey, numOfMerged);
+
+  // user callback function
+  (*pStream->fp)(pStream->param, pSql, row);
+  return 1;
+}
+
 static int64_t tscGetRetryDelayTime(int64_t slidingTime, int16_t prec) {
   float retryRangeFactor = 0.3;
 
@@ -128,6 +356,10 @@ static void tscProcessStreamTimer(void *handle, void *tmrId) {
   } else {
     pQueryInfo->stime = pStream->stime - pStream->interval;
     pQueryInfo->etime = pStream->stime - 1;
+
+    if (pStream->pPanes != NULL) {
+      tscSetStreamPaneQueryRange(pStream, pQueryInfo);
+    }
   }
 
   // launch stream computing in a new thread
@@ -190,6 +422,11 @@ static void tscProcessStreamRetrieveResult(void *param, TAOS_RES *res, int numOf
     for(int32_t i = 0; i < numOfRows; ++i) {
       TAOS_ROW row = taos_fetch_row(res);
       tscTrace("%p stream:%p fetch result", pSql, pStream);
+      if (pStream->pPanes != NULL) {
+        tscSaveStreamPane(pStream, pQueryInfo, row);
+        continue;
+      }
+
       if (isProjectStream(pQueryInfo)) {
         pStream->stime = *(TSKEY *)row[0];
       } else {
@@ -200,68 +437,81 @@ static void tscProcessStreamRetrieveResult(void *param, TAOS_RES *res, int numOf
       (*pStream->fp)(pStream->param, res, row);
     }
 
-    // actually only one row is returned. this following is not necessary
-    taos_fetch_rows_a(res, tscProcessStreamRetrieveResult, pStream);
-  } else {  // numOfRows == 0, all data has been retrieved
-    pStream->useconds += pSql->res.useconds;
-
-    SQueryInfo* pQueryInfo = tscGetQueryInfoDetail(&pSql->cmd, 0);
-    
-    if (pStream->numOfRes == 0) {
-      if (pQueryInfo->interpoType == TSDB_INTERPO_SET_VALUE || pQueryInfo->interpoType == TSDB_INTERPO_NULL) {
-        SSqlRes *pRes = &pSql->res;
+    // the query is released by vnode along with its last result, so it can not be fetched again
+    if (!pSql->res.completed) {
+      taos_fetch_rows_a(res, tscProcessStreamRetrieveResult, pStream);
+      return;
+    }
+  }
 
-        /* failed to retrieve any result in this retrieve */
-        pSql->res.numOfRows = 1;
-        void *row[TSDB_MAX_COLUMNS] = {0};
-        char  tmpRes[TSDB_MAX_BYTES_PER_ROW] = {0};
+  // all data has been retrieved
+  pStream->useconds += pSql->res.useconds;
 
-        void *oldPtr = pSql->res.data;
-        pSql->res.data = tmpRes;
+  SQueryInfo* pQueryInfo = tscGetQueryInfoDetail(&pSql->cmd, 0);
   
-        for (int32_t i = 1; i < pQueryInfo->fieldsInfo.numOfOutputCols; ++i) {
-          int16_t     offset = tscFieldInfoGetOffset(pQueryInfo, i);
-          TAOS_FIELD *pField = tscFieldInfoGetField(pQueryInfo, i);
+  if (pStream->pPanes != NULL) {
+    pStream->numOfRes = tscOutputStreamPanes(pStream, pSql);
+  } else if (pStream->numOfRes == 0) {
+    if (pQueryInfo->interpoType == TSDB_INTERPO_SET_VALUE || pQueryInfo->interpoType == TSDB_INTERPO_NULL) {
+      SSqlRes *pRes = &pSql->res;
+
+      /* failed to retrieve any result in this retrieve */
+      pSql->res.numOfRows = 1;
+      void *row[TSDB_MAX_COLUMNS] = {0};
+      char  tmpRes[TSDB_MAX_BYTES_PER_ROW] = {0};
+
+      void *oldPtr = pSql->res.data;
+      pSql->res.data = tmpRes;
+
+      for (int32_t i = 1; i < pQueryInfo->fieldsInfo.numOfOutputCols; ++i) {
+        int16_t     offset = tscFieldInfoGetOffset(pQueryInfo, i);
+        TAOS_FIELD *pField = tscFieldInfoGetField(pQueryInfo, i);
+
+        assignVal(pSql->res.data + offset, (char *)(&pQueryInfo->defaultVal[i]), pField->bytes, pField->type);
+        row[i] = pSql->res.data + offset;
+      }
 
-          assignVal(pSql->res.data + offset, (char *)(&pQueryInfo->defaultVal[i]), pField->bytes, pField->type);
-          row[i] = pSql->res.data + offset;
-        }
+      tscSetTimestampForRes(pStream, pSql);
+      row[0] = pRes->data;
 
-        tscSetTimestampForRes(pStream, pSql);
-        row[0] = pRes->data;
-
-        //            char result[512] = {0};
-        //            taos_print_row(result, row, pQueryInfo->fieldsInfo.pFields, pQueryInfo->fieldsInfo.numOfOutputCols);
-        //            tscPrint("%p stream:%p query result: %s", pSql, pStream, result);
-        tscTrace("%p stream:%p fetch result", pSql, pStream);
-
-        // user callback function
-        (*pStream->fp)(pStream->param, res, row);
-
-        pRes->numOfRows = 0;
-        pRes->data = oldPtr;
-      } else if (isProjectStream(pQueryInfo)) {
-        /* no resuls in the query range, retry */
-        // todo set retry dynamic time
-        int32_t retry = tsProjectExecInterval;
-        tscError("%p stream:%p, retrieve no data, code:%d, retry in %" PRId64 "ms", pSql, pStream, numOfRows, retry);
-
-        tscSetRetryTimer(pStream, pStream->pSql, retry);
-        return;
-      }
-    } else {
-      if (isProjectStream(pQueryInfo)) {
-        pStream->stime += 1;
-      }
+      //            char result[512] = {0};
+      //            taos_print_row(result, row, pQueryInfo->fieldsInfo.pFields, pQueryInfo->fieldsInfo.numOfOutputCols);
+      //            tscPrint("%p stream:%p query result: %s", pSql, pStream, result);
+      tscTrace("%p stream:%p fetch result", pSql, pStream);
+
+      // user callback function
+      (*pStream->fp)(pStream->param, res, row);
+
+      pRes->numOfRows = 0;
+      pRes->data = oldPtr;
+    } else if (isProjectStream(pQueryInfo)) {
+      /* no resuls in the query range, retry */
+      // todo set retry dynamic time
+      int32_t retry = tsProjectExecInterval;
+      tscError("%p stream:%p, retrieve no data, code:%d, retry in %" PRId64 "ms", pSql, pStream, numOfRows, retry);
+
+      tscSetRetryTimer(pStream, pStream->pSql, retry);
+      return;
     }
+  } else {
+    if (isProjectStream(pQueryInfo)) {
+      pStream->stime += 1;
+    }
+  }
 
-    tscTrace("%p stream:%p, query on:%s, fetch result completed, fetched rows:%d", pSql, pStream, pTableMetaInfo->name,
-             pStream->numOfRes);
+  tscTrace("%p stream:%p, query on:%s, fetch result completed, fetched rows:%d", pSql, pStream, pTableMetaInfo->name,
+           pStream->numOfRes);
 
-    // release the metric/meter meta information reference, so data in cache can be updated
-    tscClearMeterMetaInfo(pTableMetaInfo, false);
-    tscSetNextLaunchTimer(pStream, pSql);
+  if (!isProjectStream(pQueryInfo)) {
+    pStream->lag = taosGetTimestamp(pStream->precision) - pStream->stime;
+    if (pStream->precision == TSDB_TIME_PRECISION_MICRO) {
+      pStream->lag = pStream->lag / 1000L;
+    }
   }
+
+  // release the metric/meter meta information reference, so data in cache can be updated
+  tscClearMeterMetaInfo(pTableMetaInfo, false);
+  tscSetNextLaunchTimer(pStream, pSql);
 }
 
 static void tscSetRetryTimer(SSqlStream *pStream, SSqlObj *pSql, int64_t timer) {
@@ -414,6 +664,10 @@ static void tscSetSlidingWindowInfo(SSqlObj *pSql, SSqlStream *pStream) {
   
   pQueryInfo->intervalTime = 0; // clear the interval value to avoid the force time window split by query processor
   pQueryInfo->slidingTime = 0;
+
+  if (!isProjectStream(pQueryInfo)) {
+    pStream->pPanes = tscCreateStreamPanes(pStream, pQueryInfo);
+  }
 }
 
 static int64_t tscGetStreamStartTimestamp(SSqlObj *pSql, SSqlStream *pStream, int64_t stime) {
@@ -587,6 +841,7 @@ void taos_close_stream(TAOS_STREAM *handle) {
     tscFreeSqlObj(pSql);
     pStream->pSql = NULL;
 
+    tscFreeStreamPanes(pStream->pPanes);
     tfree(pStream);
   }
 }
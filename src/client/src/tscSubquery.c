@@ -15,15 +15,26 @@
 
 #include "tscSubquery.h"
 #include "os.h"
+#include "hash.h"
 #include "qtsbuf.h"
 #include "tsclient.h"
 #include "tscLog.h"
+#include "tsched.h"
 
 typedef struct SInsertSupporter {
   SSubqueryState* pState;
   SSqlObj*  pSql;
 } SInsertSupporter;
 
+typedef struct SLocalMergeSupporter {
+  SSqlObj *         pParentSqlObj;
+  tExtMemBuffer **  pExtMemBuffer;
+  int32_t           numOfVnodes;
+  tOrderDescriptor *pOrderDescriptor;
+  SColumnModel *    pFinalColModel;
+  int16_t           precision;
+} SLocalMergeSupporter;
+
 static void freeSubqueryObj(SSqlObj* pSql);
 
 static bool doCompare(int32_t order, int64_t left, int64_t right) {
@@ -34,6 +45,181 @@ static bool doCompare(int32_t order, int64_t left, int64_t right) {
   }
 }
 
+typedef struct SJoinHashKey {
+  int64_t tag;
+  TSKEY   ts;
+} SJoinHashKey;
+
+// the elements with the same tag and timestamp may come from different vnodes, and they are kept in a list
+typedef struct SJoinHashVal {
+  int32_t head;  // index of the first element that is not matched yet, -1 if all elements are matched
+  int32_t tail;  // index of the last element
+} SJoinHashVal;
+
+typedef struct SJoinHashElem {
+  int32_t vnode;
+  int32_t next;  // index of the next element with the same tag and timestamp, -1 if it is the last one
+} SJoinHashElem;
+
+// approximate memory consumed by each element of the build side in hash table, including the node overhead
+#define JOIN_HASH_ELEM_SIZE 80
+
+static int64_t tsBufCompSize(STSBuf* pTSBuf) {
+  int64_t size = 0;
+  for (int32_t i = 0; i < pTSBuf->numOfVnodes; ++i) {
+    size += pTSBuf->pData[i].info.compLen;
+  }
+
+  return size;
+}
+
+static int32_t joinElemComparAsc(const void* p1, const void* p2) {
+  const STSElem* e1 = p1;
+  const STSElem* e2 = p2;
+
+  if (e1->vnode != e2->vnode) {
+    return (e1->vnode < e2->vnode) ? -1 : 1;
+  }
+
+  if (e1->tag != e2->tag) {
+    return (e1->tag < e2->tag) ? -1 : 1;
+  }
+
+  return (e1->ts == e2->ts) ? 0 : ((e1->ts < e2->ts) ? -1 : 1);
+}
+
+static int32_t joinElemComparDesc(const void* p1, const void* p2) {
+  const STSElem* e1 = p1;
+  const STSElem* e2 = p2;
+
+  if (e1->vnode != e2->vnode || e1->tag != e2->tag) {
+    return joinElemComparAsc(p1, p2);
+  }
+
+  return (e1->ts == e2->ts) ? 0 : ((e1->ts < e2->ts) ? 1 : -1);
+}
+
+/*
+ * Intersect the timestamps of two sides with an in-memory hash table on (tag, ts), which is built from the side of
+ * smaller size and probed by the other side. Different from the merge, the tags of both sides do not need to be in
+ * the same order, and the input buffers are scanned only once each.
+ *
+ * The matched elements of the probe side are appended to the output in the order of probe side, and the matched
+ * elements of the build side are sorted by vnode, tag and timestamp before being appended to its output.
+ *
+ * Return false if the build side exceeds the memory budget, and the merge on disk-based buffers is used instead.
+ */
+static bool doTSBlockHashIntersect(SSqlObj* pSql, STSBuf* pInput[2], STSBuf* pOutput[2], TSKEY* st, TSKEY* et,
+                                   int64_t numOfInput[2]) {
+  int64_t maxElems = ((int64_t)tsJoinHashMemory) * 1024 * 1024 / JOIN_HASH_ELEM_SIZE;
+  if (maxElems <= 0) {
+    return false;
+  }
+
+  SQueryInfo* pQueryInfo = tscGetQueryInfoDetail(&pSql->cmd, pSql->cmd.clauseIndex);
+  SLimitVal*  pLimit = &pQueryInfo->limit;
+  int32_t     order = pQueryInfo->order.order;
+
+  int32_t build = (tsBufCompSize(pInput[0]) <= tsBufCompSize(pInput[1])) ? 0 : 1;
+  int32_t probe = 1 - build;
+
+  SHashObj* pHashObj = taosHashInit(4096, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+  SArray*   pElems = taosArrayInit(4096, sizeof(SJoinHashElem));
+  SArray*   pMatched = taosArrayInit(4096, sizeof(STSElem));
+  if (pHashObj == NULL || pElems == NULL || pMatched == NULL) {
+    taosHashCleanup(pHashObj);
+    taosArrayDestroy(pElems);
+    taosArrayDestroy(pMatched);
+    return false;
+  }
+
+  numOfInput[0] = 0;
+  numOfInput[1] = 0;
+
+  tsBufResetPos(pInput[build]);
+  while (tsBufNextPos(pInput[build])) {
+    if (++numOfInput[build] > maxElems) {
+      tscTrace("%p build side of hash join exceeds %d MB, switch to merge on disk", pSql, tsJoinHashMemory);
+
+      taosHashCleanup(pHashObj);
+      taosArrayDestroy(pElems);
+      taosArrayDestroy(pMatched);
+      return false;
+    }
+
+    STSElem      elem = tsBufGetElem(pInput[build]);
+    SJoinHashKey key = {.tag = elem.tag, .ts = elem.ts};
+
+    int32_t       index = (int32_t)taosArrayGetSize(pElems);
+    SJoinHashElem hashElem = {.vnode = elem.vnode, .next = -1};
+    taosArrayPush(pElems, &hashElem);
+
+    // elements with the same key are matched in the order of the build side
+    SJoinHashVal* pVal = taosHashGet(pHashObj, (const char*)&key, sizeof(key));
+    if (pVal != NULL) {
+      SJoinHashElem* pTail = taosArrayGet(pElems, pVal->tail);
+      pTail->next = index;
+      pVal->tail = index;
+    } else {
+      SJoinHashVal val = {.head = index, .tail = index};
+      taosHashPut(pHashObj, (const char*)&key, sizeof(key), (char*)&val, sizeof(val));
+    }
+  }
+
+  tsBufResetPos(pInput[probe]);
+  while (tsBufNextPos(pInput[probe])) {
+    numOfInput[probe] += 1;
+
+    STSElem      elem = tsBufGetElem(pInput[probe]);
+    SJoinHashKey key = {.tag = elem.tag, .ts = elem.ts};
+
+    SJoinHashVal* pVal = taosHashGet(pHashObj, (const char*)&key, sizeof(key));
+    if (pVal == NULL || pVal->head < 0) {
+      continue;
+    }
+
+    SJoinHashElem* pHashElem = taosArrayGet(pElems, pVal->head);
+    pVal->head = pHashElem->next;
+
+    // the same as the merge, limit/offset is applied to the final results for interval and super table query
+    if (pLimit->offset == 0 || pQueryInfo->intervalTime > 0 || QUERY_IS_STABLE_QUERY(pQueryInfo->type)) {
+      if (*st > elem.ts) {
+        *st = elem.ts;
+      }
+
+      if (*et < elem.ts) {
+        *et = elem.ts;
+      }
+
+      tsBufAppend(pOutput[probe], elem.vnode, elem.tag, (const char*)&elem.ts, sizeof(elem.ts));
+
+      STSElem matched = {.ts = elem.ts, .tag = elem.tag, .vnode = pHashElem->vnode};
+      taosArrayPush(pMatched, &matched);
+    } else {
+      pLimit->offset -= 1;
+    }
+  }
+
+  size_t numOfMatched = taosArrayGetSize(pMatched);
+  if (numOfMatched > 0) {
+    qsort(pMatched->pData, numOfMatched, sizeof(STSElem),
+          (order == TSDB_ORDER_ASC) ? joinElemComparAsc : joinElemComparDesc);
+  }
+
+  for (int32_t i = 0; i < numOfMatched; ++i) {
+    STSElem* pElem = taosArrayGet(pMatched, i);
+    tsBufAppend(pOutput[build], pElem->vnode, pElem->tag, (const char*)&pElem->ts, sizeof(pElem->ts));
+  }
+
+  tscTrace("%p hash join, build side:%d, input1:%" PRId64 ", input2:%" PRId64 ", matched:%zu", pSql, build,
+           numOfInput[0], numOfInput[1], numOfMatched);
+
+  taosHashCleanup(pHashObj);
+  taosArrayDestroy(pElems);
+  taosArrayDestroy(pMatched);
+  return true;
+}
+
 static int64_t doTSBlockIntersect(SSqlObj* pSql, SJoinSubquerySupporter* pSupporter1,
                                   SJoinSubquerySupporter* pSupporter2, TSKEY* st, TSKEY* et) {
   STSBuf* output1 = tsBufCreate(true);
@@ -76,7 +262,23 @@ static int64_t doTSBlockIntersect(SSqlObj* pSql, SJoinSubquerySupporter* pSuppor
   int64_t numOfInput1 = 1;
   int64_t numOfInput2 = 1;
 
-  while (1) {
+  STSBuf* pInput[2] = {pSupporter1->pTSBuf, pSupporter2->pTSBuf};
+  STSBuf* pOutput[2] = {output1, output2};
+  int64_t numOfInput[2] = {0};
+
+  bool hashJoin = doTSBlockHashIntersect(pSql, pInput, pOutput, st, et, numOfInput);
+  if (hashJoin) {
+    numOfInput1 = numOfInput[0];
+    numOfInput2 = numOfInput[1];
+  } else {  // the cursors may be moved during building the hash table, reset them for the merge
+    tsBufResetPos(pSupporter1->pTSBuf);
+    tsBufResetPos(pSupporter2->pTSBuf);
+
+    tsBufNextPos(pSupporter1->pTSBuf);
+    tsBufNextPos(pSupporter2->pTSBuf);
+  }
+
+  while (!hashJoin) {
     STSElem elem1 = tsBufGetElem(pSupporter1->pTSBuf);
     STSElem elem2 = tsBufGetElem(pSupporter2->pTSBuf);
 
@@ -1229,6 +1431,35 @@ void tscHandleSubqueryError(SRetrieveSupport *trsupport, SSqlObj *pSql, int numO
   }
 }
 
+static void tscDoLocalMerge(SLocalMergeSupporter *pSupporter) {
+  SSqlObj *pPObj = pSupporter->pParentSqlObj;
+
+  SQueryInfo *pPQueryInfo = tscGetQueryInfoDetail(&pPObj->cmd, 0);
+  tscClearInterpInfo(pPQueryInfo);
+
+  tscCreateLocalReducer(pSupporter->pExtMemBuffer, pSupporter->numOfVnodes, pSupporter->pOrderDescriptor,
+                        pSupporter->pFinalColModel, &pPObj->cmd, &pPObj->res);
+  tscTrace("%p build loser tree completed", pPObj);
+
+  pPObj->res.precision = pSupporter->precision;
+  pPObj->res.numOfRows = 0;
+  pPObj->res.row = 0;
+
+  // set the command flag must be after the semaphore been correctly set.
+  pPObj->cmd.command = TSDB_SQL_RETRIEVE_METRIC;
+  if (pPObj->res.code == TSDB_CODE_SUCCESS) {
+    (*pPObj->fp)(pPObj->param, pPObj, 0);
+  } else {
+    tscQueueAsyncRes(pPObj);
+  }
+}
+
+static void tscProcessLocalMerge(SSchedMsg *pMsg) {
+  SLocalMergeSupporter *pSupporter = (SLocalMergeSupporter *)pMsg->ahandle;
+  tscDoLocalMerge(pSupporter);
+  free(pSupporter);
+}
+
 static void tscAllDataRetrievedFromDnode(SRetrieveSupport *trsupport, SSqlObj* pSql) {
   int32_t           idx = trsupport->subqueryIndex;
   SSqlObj *         pPObj = trsupport->pParentSqlObj;
@@ -1287,28 +1518,34 @@ static void tscAllDataRetrievedFromDnode(SRetrieveSupport *trsupport, SSqlObj* p
   tscTrace("%p retrieve from %d vnodes completed.final NumOfRows:%d,start to build loser tree", pPObj,
            pState->numOfTotal, pState->numOfRetrievedRows);
   
-  SQueryInfo *pPQueryInfo = tscGetQueryInfoDetail(&pPObj->cmd, 0);
-  tscClearInterpInfo(pPQueryInfo);
-  
-  tscCreateLocalReducer(trsupport->pExtMemBuffer, pState->numOfTotal, pDesc, trsupport->pFinalColModel,
-                        &pPObj->cmd, &pPObj->res);
-  tscTrace("%p build loser tree completed", pPObj);
-  
-  pPObj->res.precision = pSql->res.precision;
-  pPObj->res.numOfRows = 0;
-  pPObj->res.row = 0;
+  SLocalMergeSupporter supporter = {.pParentSqlObj = pPObj,
+                                    .pExtMemBuffer = trsupport->pExtMemBuffer,
+                                    .numOfVnodes = pState->numOfTotal,
+                                    .pOrderDescriptor = pDesc,
+                                    .pFinalColModel = trsupport->pFinalColModel,
+                                    .precision = pSql->res.precision};
   
   // only free once
   tfree(trsupport->pState);
   tscFreeSubSqlObj(trsupport, pSql);
   
-  // set the command flag must be after the semaphore been correctly set.
-  pPObj->cmd.command = TSDB_SQL_RETRIEVE_METRIC;
-  if (pPObj->res.code == TSDB_CODE_SUCCESS) {
-    (*pPObj->fp)(pPObj->param, pPObj, 0);
-  } else {
-    tscQueueAsyncRes(pPObj);
+  /*
+   * The loser tree is built on the scheduler of client instead of the rpc thread receiving the last response, since
+   * it loads the first page of all sorted groups, which may be on disk, and the rpc thread is released for the
+   * responses of other queries.
+   */
+  SLocalMergeSupporter *pSupporter = malloc(sizeof(SLocalMergeSupporter));
+  if (pSupporter == NULL) {
+    tscDoLocalMerge(&supporter);
+    return;
   }
+  
+  *pSupporter = supporter;
+  
+  SSchedMsg schedMsg = {0};
+  schedMsg.fp = tscProcessLocalMerge;
+  schedMsg.ahandle = pSupporter;
+  taosScheduleTask(tscQhandle, &schedMsg);
 }
 
 static void tscRetrieveFromDnodeCallBack(void *param, TAOS_RES *tres, int numOfRows) {
@@ -1366,18 +1603,36 @@ static void tscRetrieveFromDnodeCallBack(void *param, TAOS_RES *tres, int numOfR
       return;
     }
     
-    int32_t ret = saveToBuffer(trsupport->pExtMemBuffer[idx], pDesc, trsupport->localBuffer, pRes->data,
-                               pRes->numOfRows, pQueryInfo->groupbyExpr.orderType);
-    if (ret < 0) { // set no disk space error info, and abort retry
-      tscAbortFurtherRetryRetrieval(trsupport, tres, TSDB_CODE_CLI_NO_DISKSPACE);
-      
-    } else if (pRes->completed) {
-      tscAllDataRetrievedFromDnode(trsupport, pSql);
-      return;
+    if (pRes->completed) {
+      int32_t ret = saveToBuffer(trsupport->pExtMemBuffer[idx], pDesc, trsupport->localBuffer, pRes->data,
+                                 pRes->numOfRows, pQueryInfo->groupbyExpr.orderType);
+      if (ret < 0) { // set no disk space error info, and abort retry
+        return tscAbortFurtherRetryRetrieval(trsupport, tres, TSDB_CODE_CLI_NO_DISKSPACE);
+      }
       
-    } else { // continue fetch data from dnode
-      pthread_mutex_unlock(&trsupport->queryMutex);
-      taos_fetch_rows_a(tres, tscRetrieveFromDnodeCallBack, param);
+      return tscAllDataRetrievedFromDnode(trsupport, pSql);
+    }
+    
+    /*
+     * Take over the response, and request the next page from dnode before the rows are sorted and saved, so the
+     * retrieval of next page overlaps with the sort. The response of next page waits for the lock until the rows
+     * of current page are saved, so the pages of a vnode are still saved in order.
+     */
+    char *pRsp = pRes->pRsp;
+    char *data = pRes->data;
+    pRes->pRsp = NULL;
+    
+    taos_fetch_rows_a(tres, tscRetrieveFromDnodeCallBack, param);
+    
+    int32_t ret = saveToBuffer(trsupport->pExtMemBuffer[idx], pDesc, trsupport->localBuffer, data, numOfRows,
+                               pQueryInfo->groupbyExpr.orderType);
+    free(pRsp);
+    
+    // the error is handled when the response of next page is received
+    if (ret < 0) {
+      tscError("%p sub:%p failed to save retrieved rows, orderOfSub:%d", pPObj, pSql, idx);
+      atomic_val_compare_exchange_32(&pState->code, TSDB_CODE_SUCCESS, -TSDB_CODE_CLI_NO_DISKSPACE);
+      trsupport->numOfRetry = MAX_NUM_OF_SUBQUERY_RETRY;
     }
     
     pthread_mutex_unlock(&trsupport->queryMutex);
@@ -37,6 +37,7 @@ void *  pVMeterConn;
 void *  pTscMgmtConn;
 void *  pSlaveConn;
 void *  tscCacheHandle;
+void *  tscNegCacheHandle;
 int     slaveIndex;
 void *  tscTmr;
 void *  tscQhandle;
@@ -197,6 +198,10 @@ void taos_init_imp() {
     tscCacheHandle = taosCacheInit(tscTmr, refreshTime);
   }
 
+  if (tscNegCacheHandle == NULL) {
+    tscNegCacheHandle = taosCacheInit(tscTmr, 1);
+  }
+
   tscTrace("client is initialized successfully");
 }
 
@@ -206,6 +211,10 @@ void taos_cleanup() {
   if (tscCacheHandle != NULL) {
     taosCacheCleanup(tscCacheHandle);
   }
+
+  if (tscNegCacheHandle != NULL) {
+    taosCacheCleanup(tscNegCacheHandle);
+  }
   
   if (tscQhandle != NULL) {
     taosCleanUpScheduler(tscQhandle);
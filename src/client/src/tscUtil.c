@@ -755,6 +755,54 @@ static void trimDataBlock(void* pDataBlock, STableDataBlocks* pTableDataBlock) {
   }
 }
 
+static bool isColumnarDataBlock(STableDataBlocks* pTableDataBlock) {
+  STableComInfo tinfo = tscGetTableInfo(pTableDataBlock->pTableMeta);
+  SSchema* pSchema = tscGetTableSchema(pTableDataBlock->pTableMeta);
+
+  for(int32_t i = 0; i < tinfo.numOfColumns; ++i) {
+    if (pSchema[i].type == TSDB_DATA_TYPE_BINARY || pSchema[i].type == TSDB_DATA_TYPE_NCHAR) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * transpose the rows into columns, each column is a null bitmap followed by the values of all rows, see the layout
+ * of TSDB_SUBMIT_BLK_COLUMNAR
+ */
+static void transposeDataBlock(char* pDataBlock, STableDataBlocks* pTableDataBlock, int32_t rows) {
+  STableComInfo tinfo = tscGetTableInfo(pTableDataBlock->pTableMeta);
+  SSchema* pSchema = tscGetTableSchema(pTableDataBlock->pTableMeta);
+
+  memcpy(pDataBlock, pTableDataBlock->pData, sizeof(SSubmitBlk));
+  pDataBlock += sizeof(SSubmitBlk);
+
+  int32_t bitmapLen = TSDB_SUBMIT_BITMAP_LEN(rows);
+  char* pRows = pTableDataBlock->pData + sizeof(SSubmitBlk);
+
+  int32_t offset = 0;
+  for(int32_t i = 0; i < tinfo.numOfColumns; ++i) {
+    uint8_t* bitmap = (uint8_t*) pDataBlock;
+    char* values = pDataBlock + bitmapLen;
+    int16_t bytes = pSchema[i].bytes;
+
+    memset(bitmap, 0, bitmapLen);
+    for(int32_t j = 0; j < rows; ++j) {
+      char* src = pRows + pTableDataBlock->rowSize * j + offset;
+      if (isNull(src, pSchema[i].type)) {
+        bitmap[j >> 3] |= (1u << (j & 7));
+      }
+
+      memcpy(values + bytes * j, src, bytes);
+    }
+
+    offset += bytes;
+    pDataBlock = values + bytes * rows;
+  }
+}
+
 int32_t tscMergeTableDataBlocks(SSqlObj* pSql, SDataBlockList* pTableDataBlockList) {
   SSqlCmd* pCmd = &pSql->cmd;
 
@@ -805,17 +853,31 @@ int32_t tscMergeTableDataBlocks(SSqlObj* pSql, SDataBlockList* pTableDataBlockLi
     tscTrace("%p tableId:%s, sid:%d rows:%d sversion:%d skey:%" PRId64 ", ekey:%" PRId64, pSql, pOneTableBlock->tableId,
         pBlocks->tid, pBlocks->numOfRows, pBlocks->sversion, GET_INT64_VAL(pBlocks->data), GET_INT64_VAL(e));
 
-    int32_t len = pBlocks->numOfRows * (pOneTableBlock->rowSize + sizeof(int32_t) * 2);
+    int32_t rows = pBlocks->numOfRows;
+    bool    columnar = (pSql->pTscObj->features & TSDB_FEATURE_COLUMNAR_SUBMIT) && isColumnarDataBlock(pOneTableBlock);
+
+    int32_t len = 0;
+    if (columnar) {
+      int32_t numOfCols = tscGetNumOfColumns(pOneTableBlock->pTableMeta);
+      len = rows * pOneTableBlock->rowSize + numOfCols * TSDB_SUBMIT_BITMAP_LEN(rows);
+    } else {
+      len = rows * (pOneTableBlock->rowSize + sizeof(int32_t) * 2);
+    }
     
     pBlocks->tid = htonl(pBlocks->tid);
     pBlocks->uid = htobe64(pBlocks->uid);
     pBlocks->sversion = htonl(pBlocks->sversion);
     pBlocks->numOfRows = htons(pBlocks->numOfRows);
+    pBlocks->flag = htonl(columnar ? TSDB_SUBMIT_BLK_COLUMNAR : 0);
     
     pBlocks->len = htonl(len);
     
-    // erase the empty space reserved for binary data
-    trimDataBlock(dataBuf->pData + dataBuf->size, pOneTableBlock);
+    if (columnar) {
+      transposeDataBlock(dataBuf->pData + dataBuf->size, pOneTableBlock, rows);
+    } else {
+      // erase the empty space reserved for binary data
+      trimDataBlock(dataBuf->pData + dataBuf->size, pOneTableBlock);
+    }
     dataBuf->size += (len + sizeof(SSubmitBlk));
     dataBuf->numOfTables += 1;
   }
@@ -1775,6 +1837,12 @@ bool tscShouldFreeAsyncSqlObj(SSqlObj* pSql) {
   }
 
   int32_t command = pSql->cmd.command;
+
+  // the SqlObj of a prepared statement is kept for the next execution, and freed by taos_stmt_close
+  if (command == TSDB_SQL_INSERT && pSql->cmd.numOfParams > 0) {
+    return false;
+  }
+
   if (command == TSDB_SQL_CONNECT || command == TSDB_SQL_INSERT) {
     return true;
   } else {
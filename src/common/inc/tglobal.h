@@ -67,6 +67,7 @@ extern int tsVnodePeerHBTimer;
 extern int tsMgmtPeerHBTimer;
 extern int tsMeterMetaKeepTimer;
 extern int tsMetricMetaKeepTimer;
+extern int tsNegMeterMetaKeepTimer;
 
 extern float tsNumOfThreadsPerCore;
 extern float tsRatioOfQueryThreads;
@@ -84,6 +85,13 @@ extern int tsCacheBlockSize;
 
 extern int   tsRowsInFileBlock;
 extern float tsFileBlockMinPercent;
+extern int   tsBlockCacheSize;
+extern int   tsBlockPrefetchNum;
+extern int   tsCompactInterval;
+extern int   tsCompactMaxMBPerSec;
+extern char  tsTierDataDir[];
+extern int   tsTierDays;
+extern char  tsRollupInterval[];
 
 extern short tsNumOfBlocksPerMeter;
 extern short tsCommitTime;  // seconds
@@ -118,6 +126,10 @@ extern int tsRestRowLimit;
 extern int tsCompressMsgSize;
 extern int tsMaxSQLStringLen;
 extern int tsMaxNumOfOrderedResults;
+extern int tsJoinHashMemory;
+extern int tsSortMergeMemory;
+extern int tsQueryProfile;
+extern int tsQuerySplitTables;
 
 extern char tsSocketType[4];
 
@@ -405,16 +405,55 @@ static int tdFLenFromSchema(STSchema *pSchema) {
   return ret;
 }
 
+// Append rows [start, start + rows) of the source to the target, one memcpy per column
+static void tdAppendDataColsRange(SDataCols *target, SDataCols *source, int start, int rows) {
+  ASSERT(target->numOfPoints + rows <= target->maxPoints);
+
+  for (int i = 0; i < source->numOfCols; i++) {
+    ASSERT(target->cols[i].type == source->cols[i].type);
+    int bytes = TYPE_BYTES[target->cols[i].type];
+    memcpy((void *)((char *)(target->cols[i].pData) + bytes * target->numOfPoints),
+           (void *)((char *)(source->cols[i].pData) + bytes * start), bytes * rows);
+    target->cols[i].len += bytes * rows;
+  }
+
+  target->numOfPoints += rows;
+}
+
+// Return the number of rows in [start, end) of the data cols whose key is less than the key
+static int tdGetRowsBeforeKey(SDataCols *pCols, int start, int end, TSKEY key) {
+  TSKEY *keys = (TSKEY *)(pCols->cols[0].pData);
+  if (keys[end - 1] < key) return end - start;
+
+  int low = start, high = end - 1;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (keys[mid] < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low - start;
+}
+
 int tdMergeDataCols(SDataCols *target, SDataCols *source, int rowsToMerge) {
   ASSERT(rowsToMerge > 0 && rowsToMerge <= source->numOfPoints);
 
+  if (target->numOfPoints == 0 || dataColsKeyLast(target) < dataColsKeyFirst(source)) {  // Just append
+    tdAppendDataColsRange(target, source, 0, rowsToMerge);
+    return 0;
+  }
+
   SDataCols *pTarget = tdDupDataCols(target, true);
   if (pTarget == NULL) goto _err;
   // tdResetDataCols(target);
 
   int iter1 = 0;
   int iter2 = 0;
-  tdMergeTwoDataCols(target,pTarget, &iter1, source, &iter2, pTarget->numOfPoints + rowsToMerge);
+  tdMergeTwoDataCols(target, pTarget, &iter1, pTarget->numOfPoints, source, &iter2, rowsToMerge,
+                     pTarget->numOfPoints + rowsToMerge);
 
   tdFreeDataCols(pTarget);
   return 0;
@@ -424,39 +463,36 @@ _err:
   return -1;
 }
 
-void tdMergeTwoDataCols(SDataCols *target, SDataCols *src1, int *iter1, SDataCols *src2, int *iter2, int tRows) {
+/*
+ * Merge rows [*iter1, limit1) of src1 and rows [*iter2, limit2) of src2 into the target, up to tRows rows. The rows of
+ * one source before the current key of the other are contiguous in the target, so they are copied as a run instead of
+ * row by row. Appending rows after a block or splicing them into a gap of it needs only a few runs. src1 holds the data
+ * written before, so a row of src2 with a key already in src1 is dropped, as a duplicate key is in the cache.
+ */
+void tdMergeTwoDataCols(SDataCols *target, SDataCols *src1, int *iter1, int limit1, SDataCols *src2, int *iter2,
+                        int limit2, int tRows) {
   tdResetDataCols(target);
+  ASSERT(limit1 <= src1->numOfPoints && limit2 <= src2->numOfPoints);
 
   while (target->numOfPoints < tRows) {
-    if (*iter1 >= src1->numOfPoints && *iter2 >= src2->numOfPoints) break;
+    if (*iter1 >= limit1 && *iter2 >= limit2) break;
 
-    TSKEY key1 = (*iter1 >= src1->numOfPoints) ? INT64_MAX : ((TSKEY *)(src1->cols[0].pData))[*iter1];
-    TSKEY key2 = (*iter2 >= src2->numOfPoints) ? INT64_MAX : ((TSKEY *)(src2->cols[0].pData))[*iter2];
+    TSKEY key1 = (*iter1 >= limit1) ? INT64_MAX : dataColsKeyAt(src1, *iter1);
+    TSKEY key2 = (*iter2 >= limit2) ? INT64_MAX : dataColsKeyAt(src2, *iter2);
+    int   rows = 0;
 
     if (key1 < key2) {
-      for (int i = 0; i < src1->numOfCols; i++) {
-        ASSERT(target->cols[i].type == src1->cols[i].type);
-        memcpy((void *)((char *)(target->cols[i].pData) + TYPE_BYTES[target->cols[i].type] * target->numOfPoints),
-               (void *)((char *)(src1->cols[i].pData) + TYPE_BYTES[target->cols[i].type] * (*iter1)),
-               TYPE_BYTES[target->cols[i].type]);
-        target->cols[i].len += TYPE_BYTES[target->cols[i].type];
-      }
-
-      target->numOfPoints++;
-      (*iter1)++;
+      rows = tdGetRowsBeforeKey(src1, *iter1, limit1, key2);
+      rows = MIN(rows, tRows - target->numOfPoints);
+      tdAppendDataColsRange(target, src1, *iter1, rows);
+      (*iter1) += rows;
     } else if (key1 > key2) {
-      for (int i = 0; i < src2->numOfCols; i++) {
-        ASSERT(target->cols[i].type == src2->cols[i].type);
-        memcpy((void *)((char *)(target->cols[i].pData) + TYPE_BYTES[target->cols[i].type] * target->numOfPoints),
-               (void *)((char *)(src2->cols[i].pData) + TYPE_BYTES[src2->cols[i].type] * (*iter2)),
-               TYPE_BYTES[target->cols[i].type]);
-        target->cols[i].len += TYPE_BYTES[target->cols[i].type];
-      }
-
-      target->numOfPoints++;
-      (*iter2)++;
+      rows = tdGetRowsBeforeKey(src2, *iter2, limit2, key1);
+      rows = MIN(rows, tRows - target->numOfPoints);
+      tdAppendDataColsRange(target, src2, *iter2, rows);
+      (*iter2) += rows;
     } else {
-      ASSERT(false);
+      (*iter2)++;
     }
   }
 }
\ No newline at end of file
@@ -74,6 +74,7 @@ int32_t tsVnodePeerHBTimer = 1;       // second
 int32_t tsMgmtPeerHBTimer = 1;        // second
 int32_t tsMeterMetaKeepTimer = 7200;  // second
 int32_t tsMetricMetaKeepTimer = 600;  // second
+int32_t tsNegMeterMetaKeepTimer = 2;  // second, how long the "table not exist" answer of mnode is cached
 int tsRpcTimer = 300;
 int tsRpcMaxTime = 600;      // seconds;
 
@@ -103,6 +104,27 @@ int16_t tsAffectedRowsMod = 0;
 int32_t tsRowsInFileBlock = 4096;
 float   tsFileBlockMinPercent = 0.05;
 
+// size of the cache of block data read from files for each vnode, MB, 0 means disabled
+int32_t tsBlockCacheSize = 16;
+
+// number of the following data blocks to read ahead in a file scan, 0 means disabled
+int32_t tsBlockPrefetchNum = 4;
+
+// interval to check the file groups to compact in seconds, 0 means disabled
+int32_t tsCompactInterval = 3600;
+
+// read and write bandwidth used by compaction and disk tier migration of each vnode, MB per second
+int32_t tsCompactMaxMBPerSec = 20;
+
+// mount points of the lower disk tiers separated by comma, empty means all data files are in dataDir
+char tsTierDataDir[TSDB_FILENAME_LEN * 2] = {0};
+
+// the file groups older than tierDays are moved to the next disk tier
+int32_t tsTierDays = 30;
+
+// intervals of the rollups maintained at commit time separated by comma, e.g. 1m,1h, empty means no rollup
+char tsRollupInterval[64] = {0};
+
 int16_t tsNumOfBlocksPerMeter = 100;
 int16_t tsCommitTime = 3600;  // seconds
 int16_t tsCommitLog = 1;
@@ -152,6 +174,20 @@ int tsNumOfLogLines = 10000000;
 // one virtual node, to order according to timestamp
 int32_t tsMaxNumOfOrderedResults = 100000;
 
+// the memory budget, in MB, of the in-memory hash join on timestamp for join query at client side, 0 means disabled
+int32_t tsJoinHashMemory = 64;
+
+// the memory budget, in MB, of the pages loaded by the merge of sorted data at client side. If one page of each sorted
+// group does not fit in it, the groups are merged in several passes
+int32_t tsSortMergeMemory = 16;
+
+// request the execution profile of query from vnodes, and print it to log of client
+int32_t tsQueryProfile = 0;
+
+// the minimum number of tables scanned by each thread, if a super table query in one vnode involves more tables, the
+// scan is split into several parts and they are scanned in parallel. 0 means the query is always scanned by one thread
+int32_t tsQuerySplitTables = 5000;
+
 /*
  * denote if the server needs to compress response message at the application layer to client, including query rsp,
  * metricmeta rsp, and multi-meter query rsp message body. The client compress the submit message to server.
@@ -625,6 +661,16 @@ static void doInitGlobalConfig() {
   cfg.unitType = TAOS_CFG_UTYPE_SECOND;
   taosInitConfigOption(cfg);
 
+  cfg.option = "negMeterMetaKeepTimer";
+  cfg.ptr = &tsNegMeterMetaKeepTimer;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 0;
+  cfg.maxValue = 600;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_SECOND;
+  taosInitConfigOption(cfg);
+
   cfg.option = "minSlidingTime";
   cfg.ptr = &tsMinSlidingTime;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
@@ -766,6 +812,76 @@ static void doInitGlobalConfig() {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "blockCacheSize";
+  cfg.ptr = &tsBlockCacheSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_Mb;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "blockPrefetchNum";
+  cfg.ptr = &tsBlockPrefetchNum;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "compactInterval";
+  cfg.ptr = &tsCompactInterval;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 86400 * 30;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_SECOND;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "compactMaxMBPerSec";
+  cfg.ptr = &tsCompactMaxMBPerSec;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 10240;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tierDataDir";
+  cfg.ptr = tsTierDataDir;
+  cfg.valType = TAOS_CFG_VTYPE_STRING;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 0;
+  cfg.ptrLength = TSDB_FILENAME_LEN * 2;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tierDays";
+  cfg.ptr = &tsTierDays;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 3650;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "rollupInterval";
+  cfg.ptr = tsRollupInterval;
+  cfg.valType = TAOS_CFG_VTYPE_STRING;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 0;
+  cfg.ptrLength = 64;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "fileBlockMinPercent";
   cfg.ptr = &tsFileBlockMinPercent;
   cfg.valType = TAOS_CFG_VTYPE_FLOAT;
@@ -868,6 +984,46 @@ static void doInitGlobalConfig() {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "joinHashMemory";
+  cfg.ptr = &tsJoinHashMemory;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_Mb;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "sortMergeMemory";
+  cfg.ptr = &tsSortMergeMemory;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_Mb;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "queryProfile";
+  cfg.ptr = &tsQueryProfile;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "querySplitTables";
+  cfg.ptr = &tsQuerySplitTables;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1000000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   // locale & charset
   cfg.option = "timezone";
   cfg.ptr = tsTimezone;
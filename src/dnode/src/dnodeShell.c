@@ -20,6 +20,7 @@
 #include "taosmsg.h"
 #include "trpc.h"
 #include "tglobal.h"
+#include "tsdb.h"
 #include "dnode.h"
 #include "dnodeLog.h"
 #include "dnodeRead.h"
@@ -113,6 +114,7 @@ SDnodeStatisInfo dnodeGetStatisInfo() {
     //info.httpReqNum   = httpGetReqCount();
     info.queryReqNum  = atomic_exchange_32(&tsDnodeQueryReqNum, 0);
     info.submitReqNum = atomic_exchange_32(&tsDnodeSubmitReqNum, 0);
+    tsdbGetBlockCacheStatis(&info.blockCacheHitNum, &info.blockCacheMissNum);
   }
 
   return info;
@@ -18,6 +18,7 @@
 #include "taosmsg.h"
 #include "taoserror.h"
 #include "tqueue.h"
+#include "tmetrics.h"
 #include "trpc.h"
 #include "tsdb.h"
 #include "twal.h"
@@ -53,6 +54,9 @@ static void  dnodeHandleIdleWorker(SWriteWorker *pWorker);
 
 SWriteWorkerPool wWorkerPool;
 
+// number of write messages from rpc waiting in the write queues of all vnodes
+static SMetric *dnodeWriteQueueMetric = NULL;
+
 int32_t dnodeInitWrite() {
   wWorkerPool.max = tsNumOfCores;
   wWorkerPool.writeWorker = (SWriteWorker *)calloc(sizeof(SWriteWorker), wWorkerPool.max);
@@ -62,6 +66,9 @@ int32_t dnodeInitWrite() {
     wWorkerPool.writeWorker[i].workerId = i;
   }
 
+  dnodeWriteQueueMetric =
+      taosRegisterMetric("taosd_write_queue_depth", "write messages waiting in write queues", TAOS_METRIC_GAUGE);
+
   dPrint("dnode write is opened");
   return 0;
 }
@@ -101,6 +108,7 @@ void dnodeWrite(SRpcMsg *pMsg) {
     pWrite->contLen   = pHead->contLen;
 
     taosWriteQitem(queue, TAOS_QTYPE_RPC, pWrite);
+    taosMetricInc(dnodeWriteQueueMetric, 1);
   } else {
     SRpcMsg rpcRsp = {
       .handle  = pMsg->handle,
@@ -197,6 +205,7 @@ static void *dnodeProcessWriteQueue(void *param) {
         pHead->msgType = pWrite->rpcMsg.msgType;
         pHead->version = 0;
         pHead->len = pWrite->contLen;
+        taosMetricInc(dnodeWriteQueueMetric, -1);
       } else {
         pHead = (SWalHead *)item;
       }
@@ -24,6 +24,8 @@ typedef struct {
   int32_t queryReqNum;
   int32_t submitReqNum;
   int32_t httpReqNum;
+  int64_t blockCacheHitNum;
+  int64_t blockCacheMissNum;
 } SDnodeStatisInfo;
 
 typedef enum {
@@ -67,9 +67,20 @@ typedef struct TAOS_BIND {
   int *          error;        // unused
 } TAOS_BIND;
 
+// bind the values of many rows column by column, a value of binary or nchar takes buffer_length bytes in buffer
+typedef struct TAOS_MULTI_BIND {
+  int            buffer_type;
+  void *         buffer;
+  unsigned long  buffer_length;
+  int32_t *      length;   // length of each binary or nchar value
+  unsigned char *is_null;  // null bitmap, bit (i % 8) of byte (i / 8) is set if the value of row i is null
+  int            num;      // number of rows
+} TAOS_MULTI_BIND;
+
 TAOS_STMT *taos_stmt_init(TAOS *taos);
 int        taos_stmt_prepare(TAOS_STMT *stmt, const char *sql, unsigned long length);
 int        taos_stmt_bind_param(TAOS_STMT *stmt, TAOS_BIND *bind);
+int        taos_stmt_bind_param_batch(TAOS_STMT *stmt, TAOS_MULTI_BIND *bind);
 int        taos_stmt_add_batch(TAOS_STMT *stmt);
 int        taos_stmt_execute(TAOS_STMT *stmt);
 TAOS_RES * taos_stmt_use_result(TAOS_STMT *stmt);
@@ -298,6 +298,8 @@ void tsDataSwap(void *pLeft, void *pRight, int32_t type, int32_t size);
 
 #define TSDB_QUERY_TYPE_INSERT                        0x100U    // insert type
 #define TSDB_QUERY_TYPE_IMPORT                        0x200U    // import data
+#define TSDB_QUERY_TYPE_SUBSCRIBE                     0x400U    // incremental query of subscription
+#define TSDB_QUERY_TYPE_PROFILE                       0x800U    // execution profile is returned with result
 
 #define TSDB_QUERY_HAS_TYPE(x, _type)         (((x) & (_type)) != 0)
 #define TSDB_QUERY_SET_TYPE(x, _type)         ((x) |= (_type))
@@ -200,11 +200,23 @@ typedef struct SMsgHead {
   int32_t vgId;
 } SMsgHead;
 
+/*
+ * The data of a submit block is rows of SDataRow by default. If TSDB_SUBMIT_BLK_COLUMNAR is set in flag, it is
+ * the columns of the table in schema order instead, each column is a null bitmap of TSDB_SUBMIT_BITMAP_LEN(numOfRows)
+ * bytes followed by the values of all rows. Bit (i % 8) of byte (i / 8) in bitmap is set if the value of row i is
+ * null. Only the tables of fixed length columns are sent in columns, and only to a server with
+ * TSDB_FEATURE_COLUMNAR_SUBMIT in the features of its connect response, as an older one takes the flag as padding.
+ */
+#define TSDB_SUBMIT_BLK_COLUMNAR 0x1
+#define TSDB_SUBMIT_BITMAP_LEN(rows) (((rows) + 7) / 8)
+
+#define TSDB_FEATURE_COLUMNAR_SUBMIT 0x1
+
 // Submit message for one table
 typedef struct SSubmitBlk {
   int64_t uid;        // table unique id
   int32_t tid;        // table id
-  int32_t padding;    // TODO just for padding here
+  int32_t flag;       // format of the data part
   int32_t sversion;   // data schema version
   int32_t len;        // data part length, not including the SSubmitBlk head
   int16_t numOfRows;  // total number of rows in current submit block
@@ -299,6 +311,7 @@ typedef struct {
   int8_t    writeAuth;
   int8_t    superAuth;
   SRpcIpSet ipList;
+  int32_t   features;  // TSDB_FEATURE_*, absent in the response of an older server
 } SCMConnectRsp;
 
 typedef struct {
@@ -502,6 +515,23 @@ typedef struct SRetrieveTableRsp {
   char    data[];
 } SRetrieveTableRsp;
 
+// execution profile of query in vnode, appended to the retrieve rsp if TSDB_QUERY_TYPE_PROFILE is set
+typedef struct SQueryProfileMsg {
+  int64_t elapsedUs;        // total time of query execution
+  int64_t loadCompInfoUs;   // time to load the index of data blocks in files
+  int64_t loadBlocksUs;     // time to read data blocks from files
+  int64_t applyFunctionUs;  // time to apply functions on data blocks
+  int64_t mergeUs;          // time to merge the results of tables
+  int64_t readBytes;        // bytes of data blocks read from files
+  int64_t totalRows;        // rows of all checked data blocks
+  int64_t filteredRows;     // rows discarded by filter condition
+  int32_t numOfFiles;
+  int32_t totalBlocks;      // data blocks checked, both in files and cache
+  int32_t fileBlocks;       // data blocks loaded from files
+  int32_t cacheBlocks;      // data blocks in cache
+  int32_t skippedBlocks;    // data blocks without data loaded
+} SQueryProfileMsg;
+
 typedef struct {
   int32_t vgId;
   int64_t totalStorage;
@@ -726,6 +756,10 @@ typedef struct STableMetaMsg {
   SSchema       schema[];
 } STableMetaMsg;
 
+/*
+ * The metas are followed by an int32_t count and the int32_t indexes in request of the tables which do not exist, so
+ * the client caches only them as nonexistent. The list is absent in the response of an older mnode.
+ */
 typedef struct SMultiTableMeta {
   int32_t       numOfTables;
   int32_t       contLen;
@@ -790,6 +824,7 @@ typedef struct {
   int64_t  stime;
   int64_t  slidingTime;
   int64_t  interval;
+  int64_t  lag;  // ms
 } SStreamDesc;
 
 typedef struct {
@@ -132,6 +132,11 @@ STableInfo *tsdbGetTableInfo(TsdbRepoT *pRepo, STableId tid);
  */
 int32_t tsdbInsertData(TsdbRepoT *pRepo, SSubmitMsg *pMsg);
 
+/**
+ * Get the hit and miss number of the block cache of all repositories since last call
+ */
+void tsdbGetBlockCacheStatis(int64_t *hitNum, int64_t *missNum);
+
 // -- FOR QUERY TIME SERIES DATA
 
 typedef void *TsdbQueryHandleT;  // Use void to hide implementation details
@@ -147,6 +152,7 @@ typedef struct STsdbQueryCond {
   int32_t          order;  // desc/asc order to iterate the data block
   int32_t          numOfCols;
   SColumnInfoData *colList;
+  int64_t          rollupInterval;  // read the rollups of this interval in ascending order, 0 if not used
 } STsdbQueryCond;
 
 typedef struct SBlockInfo {
@@ -192,6 +198,27 @@ typedef void *TsdbPosT;
  */
 TsdbQueryHandleT *tsdbQueryTables(TsdbRepoT *tsdb, STsdbQueryCond *pCond, STableGroupInfo *groupInfo);
 
+/**
+ * Get the iterator of the last row of tables, which returns the last row of the table with the largest last key in
+ * each group as a data block of one row. The last rows are got from the last row cache of tables, so neither the
+ * buffer nor the data files are scanned.
+ *
+ * @param pCond  query condition, the last row out of the time window is not returned
+ * @param groupInfo  table groups
+ * @return
+ */
+TsdbQueryHandleT *tsdbQueryLastRow(TsdbRepoT *tsdb, STsdbQueryCond *pCond, STableGroupInfo *groupInfo);
+
+/**
+ * Get the interval of rollups which can be read by an interval query instead of the data blocks in files, i.e. the
+ * largest one that both the interval and the start of the first time window are multiples of.
+ *
+ * @param interval  interval of query in the precision of repository
+ * @param start  start of the first time window
+ * @return the rollup interval to set in STsdbQueryCond, 0 if no rollup fits
+ */
+int64_t tsdbGetRollupInterval(TsdbRepoT *tsdb, int64_t interval, int64_t start);
+
 /**
  * move to next block
  * @param pQueryHandle
@@ -213,6 +240,7 @@ SDataBlockInfo tsdbRetrieveDataBlockInfo(TsdbQueryHandleT *pQueryHandle);
  *
  * In case of data block in cache, the pBlockStatis will always be NULL.
  * If a block is not completed loaded from disk, the pBlockStatis will be NULL.
+ * If the block is a bucket of rollup, the pBlockStatis has the count, sum, min and max of all the columns.
 
  * @pBlockStatis the pre-calculated value for current data blocks. if the block is a cache block, always return 0
  * @return
@@ -224,6 +252,8 @@ int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT *pQueryHandle, SDataSta
  * the returned data block must be satisfied with the time window condition in any cases,
  * which means the SData data block is not actually the completed disk data blocks.
  *
+ * A bucket of rollup has no rows to return, NULL is returned and only its statistics are available.
+ *
  * @param pQueryHandle
  * @return
  */
@@ -283,6 +313,23 @@ int32_t tsdbQueryByTagsCond(TsdbRepoT *tsdb, int64_t uid, const char *pTagCond,
 
 int32_t tsdbGetOneTableGroup(TsdbRepoT *tsdb, int64_t uid, STableGroupInfo *pGroupInfo);
 
+// the cost of reading data from files and cache by a query handle
+typedef struct STsdbQueryCost {
+  int64_t loadCompInfoUs;    // time to load the index of data blocks in files
+  int64_t loadBlocksUs;      // time to read data blocks from files
+  int64_t readBytes;         // bytes of data blocks read from files
+  int32_t numOfFiles;        // number of file groups checked
+  int32_t numOfFileBlocks;   // number of data blocks loaded from files
+  int32_t numOfCacheBlocks;  // number of data blocks from cache
+} STsdbQueryCost;
+
+/**
+ * Get the cost of query handle since it is created, the cost is accumulated into pCost
+ * @param queryHandle
+ * @param pCost
+ */
+void tsdbGetQueryCost(TsdbQueryHandleT queryHandle, STsdbQueryCost *pCost);
+
 /**
  * clean up the query handle
  * @param queryHandle
@@ -42,8 +42,17 @@ extern char configDir[];
 #define MAX_TB_NAME_SIZE 64
 #define MAX_DATA_SIZE    1024
 #define MAX_NUM_DATATYPE 8
+#define MAX_QUERY_THREADS 256
 #define OPT_ABORT        1 /* –abort */
 
+/*
+ * Latency histogram in microseconds like HdrHistogram: values less than HIST_SUB_BUCKETS are counted exactly, and
+ * each larger power of two range is split into HIST_SUB_BUCKETS / 2 linear buckets, so the error is below 1/64.
+ */
+#define HIST_SUB_BUCKETS 128
+#define HIST_MAX_SHIFT   34
+#define HIST_BUCKETS     (HIST_SUB_BUCKETS + HIST_MAX_SHIFT * HIST_SUB_BUCKETS / 2)
+
 /* The options we understand. */
 static struct argp_option options[] = {
   {0, 'h', "host",                     0, "The host to connect to TDEngine. Default is localhost.",                                                           0},
@@ -64,6 +73,11 @@ static struct argp_option options[] = {
   {0, 'n', "num_of_records_per_table", 0, "The number of records per table. Default is 100000.",                                                              12},
   {0, 'f', "config_directory",         0, "Configuration directory. Default is '/etc/taos/'.",                                                                14},
   {0, 'x', 0,                          0, "Insert only flag.",                                                                                                13},
+  {0, 'Q', "query_types",              0, "Query templates run by query threads: 'lastrow', 'interval', 'groupby', 'scan' or 'all'. Default is 'all'.",     15},
+  {0, 'T', "num_of_query_threads",     0, "The number of query threads running alongside the insertion. Default is 0.",                                      15},
+  {0, 'O', "disorder_ratio",           0, "The percentage of records inserted out of order. Default is 0.",                                                  16},
+  {0, 'R', "disorder_range",           0, "The max delay in ms of the out of order records, which take the gaps between strided records. Default is 1000.", 16},
+  {0, 'j', "json_file",                0, "Write the results in JSON to the named file for regression tracking.",                                            14},
   {0}};
 
 /* Used by main to communicate with parse_opt. */
@@ -85,10 +99,21 @@ struct arguments {
   int    num_of_RPR;
   int    num_of_tables;
   int    num_of_DPT;
+  int    query_types;
+  int    num_of_query_threads;
+  int    disorder_ratio;
+  int    disorder_range;
+  char  *json_file;
   int    abort;
   char **arg_list;
 };
 
+enum QUERY_TYPE {
+  QUERY_LAST_ROW, QUERY_INTERVAL, QUERY_GROUP_BY, QUERY_SCAN, NUM_OF_QUERY_TYPES
+};
+
+char *queryTypeName[] = {"lastrow", "interval", "groupby", "scan"};
+
 /* Parse a single option. */
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
   /* Get the input argument from argp_parse, which we
@@ -176,6 +201,49 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case 'x':
       arguments->insert_only = true;
       break;
+    case 'Q': {
+      char *dupstr = strdup(arg);
+      char *running = dupstr;
+      char *token = strsep(&running, ",");
+      while (token != NULL) {
+        int type = 0;
+        for (; type < NUM_OF_QUERY_TYPES; type++) {
+          if (strcasecmp(token, queryTypeName[type]) == 0) break;
+        }
+
+        if (strcasecmp(token, "all") == 0) {
+          arguments->query_types = (1 << NUM_OF_QUERY_TYPES) - 1;
+        } else if (type < NUM_OF_QUERY_TYPES) {
+          arguments->query_types |= (1 << type);
+        } else {
+          argp_error(state, "Invalid query_type!");
+        }
+        token = strsep(&running, ",");
+      }
+      free(dupstr);
+      break;
+    }
+    case 'T':
+      arguments->num_of_query_threads = atoi(arg);
+      if (arguments->num_of_query_threads < 0 || arguments->num_of_query_threads > MAX_QUERY_THREADS) {
+        argp_error(state, "Invalid num_of_query_threads!");
+      }
+      break;
+    case 'O':
+      arguments->disorder_ratio = atoi(arg);
+      if (arguments->disorder_ratio < 0 || arguments->disorder_ratio > 100) {
+        argp_error(state, "Invalid disorder_ratio!");
+      }
+      break;
+    case 'R':
+      arguments->disorder_range = atoi(arg);
+      if (arguments->disorder_range <= 0) {
+        argp_error(state, "Invalid disorder_range!");
+      }
+      break;
+    case 'j':
+      arguments->json_file = arg;
+      break;
     case 'f':
       if (wordexp(arg, &full_path, 0) != 0) {
         fprintf(stderr, "Invalid path %s\n", arg);
@@ -219,6 +287,10 @@ typedef struct {
   int nrecords_per_request;
   int64_t start_time;
   bool do_aggreFunc;
+  bool use_metric;
+  int query_types;
+  int disorder_ratio;
+  int disorder_range;
 
   sem_t mutex_sem;
   int notFinished;
@@ -229,23 +301,38 @@ typedef struct {
   TAOS  *taos;
 
   char   tb_name[MAX_TB_NAME_SIZE];
-  int64_t   timestamp;
+  int64_t   start_time;
   int    target;
   int    counter;
   int    nrecords_per_request;
   int    ncols_per_record;
   char **data_type;
   int    len_of_binary;
+  int    disorder_ratio;
+  int    disorder_range;
+  unsigned int seed;
+  double send_time;
 
   sem_t *mutex_sem;
   int   *notFinished;
   sem_t *lock_sem;
 } sTable;
 
+typedef struct {
+  int64_t count;
+  int64_t sum;
+  int64_t buckets[HIST_BUCKETS];
+} SLatencyHist;
+
 /* ******************************* Global
  * variables*******************************  */
 char *aggreFunc[] = {"*", "count(*)", "avg(f1)", "sum(f1)", "max(f1)", "min(f1)", "first(f1)", "last(f1)"};
 
+// the histograms are updated by all threads and callbacks with atomic operations
+SLatencyHist writeHist;
+SLatencyHist queryHist[NUM_OF_QUERY_TYPES];
+int          writeFinished = 0;
+
 /* ******************************* Global
  * functions*******************************  */
 static struct argp argp = {options, parse_opt, 0, 0};
@@ -260,6 +347,20 @@ void *syncWrite(void *sarg);
 
 void *asyncWrite(void *sarg);
 
+void *queryWorkload(void *sarg);
+
+int getDisorderStep(int disorder_ratio, int disorder_range);
+
+int64_t getDataTime(int64_t start_time, int64_t index, int step, int disorder_ratio, unsigned int *seed);
+
+void histAdd(SLatencyHist *hist, int64_t us);
+
+double histPercentile(SLatencyHist *hist, double percentile);
+
+void printLatency(FILE *fp, char *name, SLatencyHist *hist, double seconds);
+
+void writeJsonLatency(FILE *fp, SLatencyHist *hist, double seconds);
+
 void generateData(char *res, char **data_type, int num_of_cols, int64_t timestamp, int len_of_binary);
 
 void rand_string(char *str, int size);
@@ -295,6 +396,11 @@ int main(int argc, char *argv[]) {
                                 1,               // num_of_RPR
                                 1,               // num_of_tables
                                 50000,           // num_of_DPT
+                                0,               // query_types
+                                0,               // num_of_query_threads
+                                0,               // disorder_ratio
+                                1000,            // disorder_range
+                                NULL,            // json_file
                                 0,               // abort
                                 NULL             // arg_list
                                 };
@@ -337,12 +443,24 @@ int main(int argc, char *argv[]) {
   bool use_metric = arguments.use_metric;
   bool insert_only = arguments.insert_only;
   char **data_type = arguments.datatype;
+  int nquery_threads = arguments.num_of_query_threads;
+  int query_types = arguments.query_types;
+  int disorder_ratio = arguments.disorder_ratio;
+  int disorder_range = arguments.disorder_range;
   int count_data_type = 0;
   char dataString[512];
   bool do_aggreFunc = true;
   if (strcasecmp(data_type[0], "BINARY") == 0 || strcasecmp(data_type[0], "BOOL") == 0) {
     do_aggreFunc = false;
   }
+  if (query_types == 0) {
+    query_types = (1 << NUM_OF_QUERY_TYPES) - 1;
+  }
+  if (!use_metric && (query_types & (1 << QUERY_GROUP_BY))) {
+    printf("Group by tags is not supported without metric, the query type is ignored.\n");
+    query_types &= ~(1 << QUERY_GROUP_BY);
+  }
+
   for (; count_data_type <= MAX_NUM_DATATYPE; count_data_type++) {
     if (strcasecmp(data_type[count_data_type], "") == 0) {
       break;
@@ -375,6 +493,9 @@ int main(int argc, char *argv[]) {
   fprintf(fp, "# Records/Request:                   %d\n", nrecords_per_request);
   fprintf(fp, "# Database name:                     %s\n", db_name);
   fprintf(fp, "# Table prefix:                      %s\n", tb_prefix);
+  fprintf(fp, "# Number of Query Threads:           %d\n", nquery_threads);
+  fprintf(fp, "# Out of Order Ratio(%%):             %d\n", disorder_ratio);
+  fprintf(fp, "# Out of Order Range(ms):            %d\n", disorder_range);
   fprintf(fp, "# Test time:                         %d-%02d-%02d %02d:%02d:%02d\n", tm.tm_year + 1900, tm.tm_mon + 1,
           tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
   fprintf(fp, "###################################################################\n\n");
@@ -483,6 +604,8 @@ int main(int argc, char *argv[]) {
     t_info->taos = taos_connect(ip_addr, user, pass, db_name, port);
     t_info->len_of_binary = len_of_binary;
     t_info->nrecords_per_request = nrecords_per_request;
+    t_info->disorder_ratio = disorder_ratio;
+    t_info->disorder_range = disorder_range;
     t_info->start_table_id = last;
     t_info->end_table_id = i < b ? last + a : last + a - 1;
     last = t_info->end_table_id + 1;
@@ -497,11 +620,37 @@ int main(int argc, char *argv[]) {
       pthread_create(pids + i, NULL, asyncWrite, t_info);
     }
   }
+
+  /* Query threads run the query templates alongside the insertion */
+  pthread_t *qpids = malloc(nquery_threads * sizeof(pthread_t));
+  info *qinfos = malloc(nquery_threads * sizeof(info));
+  for (int i = 0; i < nquery_threads; i++) {
+    info *t_info = qinfos + i;
+    t_info->threadID = i;
+    strcpy(t_info->db_name, db_name);
+    strcpy(t_info->tb_prefix, tb_prefix);
+    t_info->taos = taos_connect(ip_addr, user, pass, db_name, port);
+    t_info->start_table_id = 0;
+    t_info->end_table_id = ntables - 1;
+    t_info->start_time = 1500000000000;
+    t_info->do_aggreFunc = do_aggreFunc;
+    t_info->use_metric = use_metric;
+    t_info->query_types = query_types;
+    pthread_create(qpids + i, NULL, queryWorkload, t_info);
+  }
+
   for (int i = 0; i < nconnections; i++) {
     pthread_join(pids[i], NULL);
   }
 
   double t = getCurrentTime() - ts;
+
+  __atomic_store_n(&writeFinished, 1, __ATOMIC_SEQ_CST);
+  for (int i = 0; i < nquery_threads; i++) {
+    pthread_join(qpids[i], NULL);
+    taos_close(qinfos[i].taos);
+  }
+  double qt = getCurrentTime() - ts;
   if (query_mode == SYNC) {
     printf("SYNC Insert with %d connections:\n", nconnections);
   } else {
@@ -517,6 +666,41 @@ int main(int argc, char *argv[]) {
          t, ntables * nrecords_per_table, nrecords_per_request,
          ntables * nrecords_per_table / t);
 
+  fprintf(fp, "|  Workload  |   Requests   |  Requests/Second |  P50(ms)  |  P99(ms)  | P99.9(ms) |  Max(ms)  |\n");
+  printLatency(fp, "insert", &writeHist, t);
+  for (int i = 0; i < NUM_OF_QUERY_TYPES; i++) {
+    if (queryHist[i].count > 0) printLatency(fp, queryTypeName[i], queryHist + i, qt);
+  }
+  fprintf(fp, "\n");
+
+  if (arguments.json_file != NULL) {
+    FILE *jfp = fopen(arguments.json_file, "w");
+    if (jfp == NULL) {
+      fprintf(stderr, "Failed to open %s for writing\n", arguments.json_file);
+    } else {
+      fprintf(jfp, "{\n  \"config\": {\"tables\": %d, \"records_per_table\": %d, \"records_per_request\": %d, "
+              "\"columns_per_record\": %d, \"connections\": %d, \"query_threads\": %d, \"disorder_ratio\": %d, "
+              "\"disorder_range\": %d, \"use_metric\": %s, \"mode\": \"%s\"},\n",
+              ntables, nrecords_per_table, nrecords_per_request, ncols_per_record, nconnections, nquery_threads,
+              disorder_ratio, disorder_range, use_metric ? "true" : "false", query_mode == SYNC ? "sync" : "async");
+      fprintf(jfp, "  \"insert\": {\"records\": %d, \"seconds\": %.4f, \"records_per_second\": %.2f, ",
+              ntables * nrecords_per_table, t, ntables * nrecords_per_table / t);
+      writeJsonLatency(jfp, &writeHist, t);
+      fprintf(jfp, "},\n  \"query\": {");
+
+      bool first = true;
+      for (int i = 0; i < NUM_OF_QUERY_TYPES; i++) {
+        if (queryHist[i].count == 0) continue;
+        fprintf(jfp, "%s\n    \"%s\": {", first ? "" : ",", queryTypeName[i]);
+        writeJsonLatency(jfp, queryHist + i, qt);
+        fprintf(jfp, "}");
+        first = false;
+      }
+      fprintf(jfp, "%s}\n}\n", first ? "" : "\n  ");
+      fclose(jfp);
+    }
+  }
+
   for (int i = 0; i < nconnections; i++) {
     info *t_info = infos + i;
     taos_close(t_info->taos);
@@ -526,6 +710,8 @@ int main(int argc, char *argv[]) {
 
   free(pids);
   free(infos);
+  free(qpids);
+  free(qinfos);
   fclose(fp);
 
   if (!insert_only) {
@@ -680,6 +866,66 @@ void *readMetric(void *sarg) {
   return NULL;
 }
 
+void *queryWorkload(void *sarg) {
+  info *qinfo = (info *)sarg;
+  TAOS *taos = qinfo->taos;
+  char command[BUFFER_SIZE] = "\0";
+  unsigned int seed = (unsigned int)time(NULL) + qinfo->threadID;
+  int num_of_tables = qinfo->end_table_id - qinfo->start_table_id + 1;
+  char *aggr = qinfo->do_aggreFunc ? "avg(f1), max(f1)" : "count(f1)";
+
+  // every template runs at least once, even if the insertion finishes earlier
+  bool first_round = true;
+  while (first_round || !__atomic_load_n(&writeFinished, __ATOMIC_SEQ_CST)) {
+    for (int type = 0; type < NUM_OF_QUERY_TYPES; type++) {
+      if ((qinfo->query_types & (1 << type)) == 0) continue;
+
+      int tID = qinfo->start_table_id + rand_r(&seed) % num_of_tables;
+      switch (type) {
+        case QUERY_LAST_ROW:
+          sprintf(command, "select last_row(*) from %s.%s%d", qinfo->db_name, qinfo->tb_prefix, tID);
+          break;
+        case QUERY_INTERVAL:
+          sprintf(command, "select count(*), %s from %s.%s%d where ts >= %" PRId64 " interval(1s)", aggr,
+                  qinfo->db_name, qinfo->tb_prefix, tID, qinfo->start_time);
+          break;
+        case QUERY_GROUP_BY:
+          sprintf(command, "select count(*), %s from %s.meters group by areaid", aggr, qinfo->db_name);
+          break;
+        default:
+          if (qinfo->use_metric) {
+            sprintf(command, "select count(*), %s from %s.meters", aggr, qinfo->db_name);
+          } else {
+            sprintf(command, "select count(*), %s from %s.%s%d", aggr, qinfo->db_name, qinfo->tb_prefix, tID);
+          }
+          break;
+      }
+
+      double t = getCurrentTime();
+      if (taos_query(taos, command) != 0) {
+        fprintf(stderr, "Failed to run %s, reason: %s\n", command, taos_errstr(taos));
+        continue;
+      }
+
+      TAOS_RES *result = taos_use_result(taos);
+      if (result == NULL) {
+        fprintf(stderr, "Failed to retreive results:%s\n", taos_errstr(taos));
+        continue;
+      }
+
+      while (taos_fetch_row(result) != NULL) {
+      }
+
+      taos_free_result(result);
+      histAdd(&queryHist[type], (int64_t)((getCurrentTime() - t) * 1E6));
+    }
+
+    first_round = false;
+  }
+
+  return NULL;
+}
+
 void queryDB(TAOS *taos, char *command) {
   int i = 5;
   while (i > 0) {
@@ -702,17 +948,20 @@ void *syncWrite(void *sarg) {
   int len_of_binary = winfo->len_of_binary;
   int ncols_per_record = winfo->ncols_per_record;
   srand(time(NULL));
-  int64_t time_counter = winfo->start_time;
+  unsigned int seed = (unsigned int)time(NULL) + winfo->threadID;
+  int step = getDisorderStep(winfo->disorder_ratio, winfo->disorder_range);
+  int64_t row_counter = 0;
   for (int i = 0; i < winfo->nrecords_per_table;) {
     for (int tID = winfo->start_table_id; tID <= winfo->end_table_id; tID++) {
       int inserted = i;
-      int64_t tmp_time = time_counter;
+      int64_t row_index = row_counter;
 
       char *pstr = buffer;
       pstr += sprintf(pstr, "insert into %s.%s%d values", winfo->db_name, winfo->tb_prefix, tID);
       int k;
       for (k = 0; k < winfo->nrecords_per_request;) {
-        generateData(data, data_type, ncols_per_record, tmp_time++, len_of_binary);
+        generateData(data, data_type, ncols_per_record,
+                     getDataTime(winfo->start_time, row_index++, step, winfo->disorder_ratio, &seed), len_of_binary);
         pstr += sprintf(pstr, " %s", data);
         inserted++;
         k++;
@@ -721,11 +970,13 @@ void *syncWrite(void *sarg) {
       }
 
       /* puts(buffer); */
+      double t = getCurrentTime();
       queryDB(winfo->taos, buffer);
+      histAdd(&writeHist, (int64_t)((getCurrentTime() - t) * 1E6));
 
       if (tID == winfo->end_table_id) {
         i = inserted;
-        time_counter = tmp_time;
+        row_counter = row_index;
       }
     }
   }
@@ -743,11 +994,14 @@ void *asyncWrite(void *sarg) {
     tb_info->ncols_per_record = winfo->ncols_per_record;
     tb_info->taos = winfo->taos;
     sprintf(tb_info->tb_name, "%s.%s%d", winfo->db_name, winfo->tb_prefix, tID);
-    tb_info->timestamp = winfo->start_time;
+    tb_info->start_time = winfo->start_time;
     tb_info->counter = 0;
     tb_info->target = winfo->nrecords_per_table;
     tb_info->len_of_binary = winfo->len_of_binary;
     tb_info->nrecords_per_request = winfo->nrecords_per_request;
+    tb_info->disorder_ratio = winfo->disorder_ratio;
+    tb_info->disorder_range = winfo->disorder_range;
+    tb_info->seed = (unsigned int)time(NULL) + tID;
     tb_info->mutex_sem = &(winfo->mutex_sem);
     tb_info->notFinished = &(winfo->notFinished);
     tb_info->lock_sem = &(winfo->lock_sem);
@@ -770,13 +1024,18 @@ void callBack(void *param, TAOS_RES *res, int code) {
   char **datatype = tb_info->data_type;
   int ncols_per_record = tb_info->ncols_per_record;
   int len_of_binary = tb_info->len_of_binary;
-  int64_t tmp_time = tb_info->timestamp;
+  int step = getDisorderStep(tb_info->disorder_ratio, tb_info->disorder_range);
 
   if (code < 0) {
     fprintf(stderr, "failed to insert data %d:reason; %s\n", code, taos_errstr(tb_info->taos));
     exit(EXIT_FAILURE);
   }
 
+  // the first callback is for "show databases" issued by asyncWrite
+  if (tb_info->counter > 0) {
+    histAdd(&writeHist, (int64_t)((getCurrentTime() - tb_info->send_time) * 1E6));
+  }
+
   // If finished;
   if (tb_info->counter >= tb_info->target) {
     sem_wait(tb_info->mutex_sem);
@@ -792,7 +1051,9 @@ void callBack(void *param, TAOS_RES *res, int code) {
   pstr += sprintf(pstr, "insert into %s values", tb_info->tb_name);
 
   for (int i = 0; i < tb_info->nrecords_per_request; i++) {
-    generateData(data, datatype, ncols_per_record, tmp_time++, len_of_binary);
+    generateData(data, datatype, ncols_per_record,
+                 getDataTime(tb_info->start_time, tb_info->counter, step, tb_info->disorder_ratio, &tb_info->seed),
+                 len_of_binary);
     pstr += sprintf(pstr, "%s", data);
     tb_info->counter++;
 
@@ -801,6 +1062,7 @@ void callBack(void *param, TAOS_RES *res, int code) {
     }
   }
 
+  tb_info->send_time = getCurrentTime();
   taos_query_a(tb_info->taos, buffer, callBack, tb_info);
 
   taos_free_result(res);
@@ -867,3 +1129,91 @@ void rand_string(char *str, int size) {
     }
   }
 }
+
+/*
+ * Late arriving records are generated into the gaps between in-order records, so none of them overwrites a record
+ * written before. The in-order records are strided by step ms, and a record delayed by d (1 <= d < step) steps takes
+ * the timestamp of d ms before the record d steps earlier, which is unique to each record. The delay is d * (step + 1)
+ * ms, so the step is the largest one keeping the max delay within disorder_range, and it is at least 2.
+ */
+int getDisorderStep(int disorder_ratio, int disorder_range) {
+  if (disorder_ratio <= 0) return 1;
+
+  int step = 2;
+  while ((step + 1) * (step + 1) - 1 <= disorder_range) step++;
+  return step;
+}
+
+// the timestamp of the index-th record of a table
+int64_t getDataTime(int64_t start_time, int64_t index, int step, int disorder_ratio, unsigned int *seed) {
+  if (disorder_ratio > 0 && rand_r(seed) % 100 < disorder_ratio) {
+    int64_t delay = 1 + rand_r(seed) % (step - 1);
+    if (index > delay) {
+      return start_time + (index - delay) * step - delay;
+    }
+  }
+
+  return start_time + index * step;
+}
+
+static int histIndex(int64_t us) {
+  if (us < HIST_SUB_BUCKETS) return (us < 0) ? 0 : (int)us;
+
+  // (us >> shift) is in [HIST_SUB_BUCKETS / 2, HIST_SUB_BUCKETS)
+  int shift = 63 - __builtin_clzll((uint64_t)us) - 6;
+  if (shift > HIST_MAX_SHIFT) return HIST_BUCKETS - 1;
+
+  return HIST_SUB_BUCKETS + (shift - 1) * (HIST_SUB_BUCKETS / 2) + (int)((us >> shift) - HIST_SUB_BUCKETS / 2);
+}
+
+// the highest value of the bucket
+static int64_t histValue(int index) {
+  if (index < HIST_SUB_BUCKETS) return index;
+
+  int     shift = (index - HIST_SUB_BUCKETS) / (HIST_SUB_BUCKETS / 2) + 1;
+  int64_t sub = (index - HIST_SUB_BUCKETS) % (HIST_SUB_BUCKETS / 2) + HIST_SUB_BUCKETS / 2;
+  return ((sub + 1) << shift) - 1;
+}
+
+void histAdd(SLatencyHist *hist, int64_t us) {
+  __atomic_add_fetch(&hist->buckets[histIndex(us)], 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&hist->sum, us, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&hist->count, 1, __ATOMIC_RELAXED);
+}
+
+// the latency in ms below which the given percentage of requests fall
+double histPercentile(SLatencyHist *hist, double percentile) {
+  if (hist->count == 0) return 0;
+
+  int64_t target = (int64_t)(hist->count * percentile / 100 + 0.5);
+  if (target < 1) target = 1;
+
+  int64_t count = 0;
+  for (int i = 0; i < HIST_BUCKETS; i++) {
+    count += hist->buckets[i];
+    if (count >= target) return histValue(i) / 1000.0;
+  }
+
+  return histValue(HIST_BUCKETS - 1) / 1000.0;
+}
+
+void printLatency(FILE *fp, char *name, SLatencyHist *hist, double seconds) {
+  double p50 = histPercentile(hist, 50);
+  double p99 = histPercentile(hist, 99);
+  double p999 = histPercentile(hist, 99.9);
+  double max = histPercentile(hist, 100);
+
+  fprintf(fp, "|%10s  | %12" PRId64 " |  %12.2f    | %9.3f | %9.3f | %9.3f | %9.3f |\n", name, hist->count,
+          hist->count / seconds, p50, p99, p999, max);
+  printf("%-8s %" PRId64 " requests, %.2f requests/second, latency(ms) p50: %.3f, p99: %.3f, p99.9: %.3f, max: %.3f\n",
+         name, hist->count, hist->count / seconds, p50, p99, p999, max);
+}
+
+void writeJsonLatency(FILE *fp, SLatencyHist *hist, double seconds) {
+  fprintf(fp,
+          "\"requests\": %" PRId64 ", \"requests_per_second\": %.2f, \"latency_ms\": {\"avg\": %.3f, \"p50\": %.3f, "
+          "\"p90\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}",
+          hist->count, hist->count / seconds, hist->count > 0 ? hist->sum / 1000.0 / hist->count : 0,
+          histPercentile(hist, 50), histPercentile(hist, 90), histPercentile(hist, 99), histPercentile(hist, 99.9),
+          histPercentile(hist, 100));
+}
@@ -34,9 +34,20 @@
 #include "tsclient.h"
 #include "taosdef.h"
 #include "tutil.h"
+#include "tscompression.h"
 
 #define COMMAND_SIZE 65536
 #define DEFAULT_DUMP_FILE "taosdump.sql"
+#define DEFAULT_DUMP_DIR "taosdump"
+
+// binary dump: the schema and tags are in the manifest as sql, the data of tables is in the data files
+#define DUMP_MANIFEST_FILE "manifest.sql"
+#define DUMP_DATA_FILE_PREFIX "data."
+// written after all data files are completed, it has the number of data files
+#define DUMP_META_FILE "meta"
+#define DUMP_META_DATA_FILES "dataFiles"
+#define DUMP_BLOCK_ROWS 4096
+#define DUMP_MAX_THREADS 128
 
 int  converStringToReadable(char *str, int size, char *buf, int bufsize);
 int  convertNCharToReadable(char *str, int size, char *buf, int bufsize);
@@ -125,6 +136,31 @@ typedef struct {
   STableRecord tableRecord;
 } STableRecordInfo;
 
+/*
+ * Layout of a binary data file, the tables of the same super table are dumped next to each other:
+ * 1. SDumpTableHead, SOColInfo of each column
+ * 2. blocks of the table, each is the number of rows, then the length and compressed data of each column
+ * 3. a block of 0 rows ends the table, and the next table follows
+ */
+typedef struct {
+  char    db[TSDB_DB_NAME_LEN + 1];
+  char    name[TSDB_TABLE_NAME_LEN + 1];
+  int32_t numOfCols;
+} SDumpTableHead;
+
+typedef struct {
+  char         db[TSDB_DB_NAME_LEN + 1];
+  STableRecord tableRecord;
+} SDumpTask;
+
+typedef struct {
+  pthread_t         thread;
+  int32_t           index;
+  int32_t           code;
+  int64_t           numOfRows;
+  struct arguments *arguments;
+} SDumpThreadInfo;
+
 SDbInfo **dbInfos = NULL;
 
 const char *argp_program_version = version;
@@ -166,6 +202,8 @@ static struct argp_option options[] = {
   {"end-time",      'E', "END_TIME",   0, "End time to dump.",                                        3},
   {"data-batch",    'N', "DATA_BATCH", 0, "Number of data point per insert statement. Default is 1.", 3},
   {"allow-sys",     'a', 0,            0, "Allow to dump sys database",                               3},
+  {"binary",        'b', 0,            0, "Dump in compressed binary format, the output or input is a directory.", 3},
+  {"thread-num",    'T', "THREAD_NUM", 0, "Number of threads for binary dump. A data file is restored by one thread. Default is 1.", 3},
   {0}};
 
 /* Used by main to communicate with parse_opt. */
@@ -189,6 +227,8 @@ struct arguments {
   int64_t end_time;
   int data_batch;
   bool allow_sys;
+  bool binary;
+  int thread_num;
   // other options
   int abort;
   char **arg_list;
@@ -273,6 +313,12 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case 'N':
       arguments->data_batch = atoi(arg);
       break;
+    case 'b':
+      arguments->binary = true;
+      break;
+    case 'T':
+      arguments->thread_num = atoi(arg);
+      break;
     case OPT_ABORT:
       arguments->abort = 1;
       break;
@@ -297,10 +343,23 @@ char *command = NULL;
 char *lcommand = NULL;
 char *buffer = NULL;
 
+// database in use when dumping out, and the tables whose data are dumped by threads in binary mode
+char       dumpDb[TSDB_DB_NAME_LEN + 1] = {0};
+SDumpTask *dumpTasks = NULL;
+int32_t    numOfDumpTasks = 0;
+int32_t    maxDumpTasks = 0;
+char **    dumpFiles = NULL;
+int32_t    numOfDumpFiles = 0;
+int32_t    nextDumpTask = 0;  // index of the next table or file taken by dump threads
+
 int taosDumpOut(struct arguments *arguments);
 
 int taosDumpIn(struct arguments *arguments);
 
+int taosDumpOutBinary(struct arguments *arguments);
+
+int taosDumpInBinary(struct arguments *arguments);
+
 void taosDumpCreateDbClause(SDbInfo *dbInfo, bool isDumpProperty, FILE *fp);
 
 int taosDumpDb(SDbInfo *dbInfo, struct arguments *arguments, FILE *fp);
@@ -316,6 +375,8 @@ int32_t taosDumpMetric(char *metric, struct arguments *arguments, FILE *fp);
 
 int taosDumpTableData(FILE *fp, char *tbname, struct arguments *arguments);
 
+int taosAddDumpTask(char *table, char *metric, struct arguments *arguments);
+
 int taosCheckParam(struct arguments *arguments);
 
 void taosFreeDbInfos();
@@ -329,7 +390,7 @@ int main(int argc, char *argv[]) {
     // dump unit option
     false, false,
     // dump format option
-    false, false, 0, INT64_MAX, 1, false,
+    false, false, 0, INT64_MAX, 1, false, false, 1,
     // other options
     0, NULL, 0, false};
 
@@ -350,7 +411,11 @@ int main(int argc, char *argv[]) {
   }
 
   if (arguments.isDumpIn) {
-    if (taosDumpIn(&arguments) < 0) return -1;
+    if (arguments.binary) {
+      if (taosDumpInBinary(&arguments) < 0) return -1;
+    } else {
+      if (taosDumpIn(&arguments) < 0) return -1;
+    }
   } else {
     if (taosDumpOut(&arguments) < 0) return -1;
   }
@@ -433,8 +498,27 @@ int taosDumpOut(struct arguments *arguments) {
   FILE *fp = NULL;
   int count = 0;
   STableRecordInfo tableRecordInfo;
+  char manifest[TSDB_FILENAME_LEN * 2];
+
+  if (arguments->binary) {
+    if (mkdir(arguments->output, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0 && errno != EEXIST) {
+      fprintf(stderr, "failed to create directory %s, reason: %s\n", arguments->output, strerror(errno));
+      return -1;
+    }
+
+    // the meta of an earlier dump in the directory is removed, so an interrupted dump is never restored
+    snprintf(manifest, sizeof(manifest), "%s/%s", arguments->output, DUMP_META_FILE);
+    if (remove(manifest) != 0 && errno != ENOENT) {
+      fprintf(stderr, "failed to remove file %s, reason: %s\n", manifest, strerror(errno));
+      return -1;
+    }
+
+    snprintf(manifest, sizeof(manifest), "%s/%s", arguments->output, DUMP_MANIFEST_FILE);
+    fp = fopen(manifest, "w");
+  } else {
+    fp = fopen(arguments->output, "w");
+  }
 
-  fp = fopen(arguments->output, "w");
   if (fp == NULL) {
     fprintf(stderr, "failed to open file %s\n", arguments->output);
     return -1;
@@ -557,6 +641,8 @@ int taosDumpOut(struct arguments *arguments) {
         goto _exit_failure;
       }
 
+      strcpy(dumpDb, dbInfos[0]->name);
+
       fprintf(fp, "USE %s;\n\n", dbInfos[0]->name);
 
       for (int i = 1; arguments->arg_list[i]; i++) {
@@ -574,12 +660,18 @@ int taosDumpOut(struct arguments *arguments) {
     }
   }
 
+  // the schema is all in the manifest now, and the data of tables are dumped by threads
+  if (arguments->binary && taosDumpOutBinary(arguments) < 0) {
+    goto _exit_failure;
+  }
+
   /* Close the handle and return */
   fclose(fp);
   taos_close(taos);
   taos_free_result(result);
   free(temp);
   taosFreeDbInfos();
+  tfree(dumpTasks);
   return 0;
 
 _exit_failure:
@@ -588,6 +680,7 @@ _exit_failure:
   taos_free_result(result);
   free(temp);
   taosFreeDbInfos();
+  tfree(dumpTasks);
   return -1;
 }
 
@@ -618,6 +711,7 @@ int taosDumpDb(SDbInfo *dbInfo, struct arguments *arguments, FILE *fp) {
     return -1;
   }
 
+  strcpy(dumpDb, dbInfo->name);
   fprintf(fp, "USE %s\n\n", dbInfo->name);
 
   sprintf(command, "show tables");
@@ -828,6 +922,10 @@ int32_t taosDumpTable(char *table, char *metric, struct arguments *arguments, FI
 
   free(tableDes);
 
+  if (arguments->binary) {
+    return taosAddDumpTask(table, metric, arguments);
+  }
+
   return taosDumpTableData(fp, table, arguments);
 }
 
@@ -990,6 +1088,30 @@ int taosDumpTableData(FILE *fp, char *tbname, struct arguments *arguments) {
   return 0;
 }
 
+int taosAddDumpTask(char *table, char *metric, struct arguments *arguments) {
+  if (arguments->schemaonly) return 0;
+
+  if (numOfDumpTasks >= maxDumpTasks) {
+    int32_t    num = (maxDumpTasks == 0) ? 1024 : maxDumpTasks * 2;
+    SDumpTask *tmp = (SDumpTask *)realloc(dumpTasks, sizeof(SDumpTask) * num);
+    if (tmp == NULL) {
+      fprintf(stderr, "No enough memory\n");
+      return -1;
+    }
+
+    dumpTasks = tmp;
+    maxDumpTasks = num;
+  }
+
+  SDumpTask *pTask = &dumpTasks[numOfDumpTasks++];
+  memset(pTask, 0, sizeof(SDumpTask));
+  strcpy(pTask->db, dumpDb);
+  strcpy(pTask->tableRecord.name, table);
+  if (metric != NULL) strcpy(pTask->tableRecord.metric, metric);
+
+  return 0;
+}
+
 int taosCheckParam(struct arguments *arguments) {
   if (arguments->all_databases && arguments->databases) {
     fprintf(stderr, "conflict option --all-databases and --databases\n");
@@ -1017,6 +1139,15 @@ int taosCheckParam(struct arguments *arguments) {
     return -1;
   }
 
+  if (arguments->thread_num < 1 || arguments->thread_num > DUMP_MAX_THREADS) {
+    fprintf(stderr, "thread number should be between 1 and %d\n", DUMP_MAX_THREADS);
+    return -1;
+  }
+
+  if (arguments->binary && !arguments->isDumpIn && strcmp(arguments->output, DEFAULT_DUMP_FILE) == 0) {
+    strcpy(arguments->output, DEFAULT_DUMP_DIR);
+  }
+
   return 0;
 }
 
@@ -1237,6 +1368,560 @@ _dumpin_exit_failure:
   return -1;
 }
 
+// ------------------------------------------- BINARY DUMP -------------------------------------------
+typedef struct {
+  int32_t    numOfCols;
+  int32_t    numOfRows;
+  SOColInfo *cols;
+  int32_t *  len;   // length of the raw data of each column
+  char **    data;  // raw data of each column, the binary or nchar value is prefixed with its length
+  char *     compBuf;
+  char *     assistBuf;
+  int32_t    bufSize;
+} SDumpBlock;
+
+static bool taosIsVarType(int8_t type) { return type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR; }
+
+static int32_t taosDumpColumnSize(SOColInfo *pCol) {
+  int32_t bytes = taosIsVarType(pCol->type) ? sizeof(int16_t) + pCol->bytes : pCol->bytes;
+  return bytes * DUMP_BLOCK_ROWS;
+}
+
+static void taosFreeDumpBlock(SDumpBlock *pBlock) {
+  if (pBlock == NULL) return;
+
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    tfree(pBlock->data[i]);
+  }
+
+  tfree(pBlock->data);
+  tfree(pBlock->len);
+  tfree(pBlock->compBuf);
+  tfree(pBlock->assistBuf);
+  free(pBlock);
+}
+
+static SDumpBlock *taosNewDumpBlock(SOColInfo *cols, int32_t numOfCols) {
+  SDumpBlock *pBlock = (SDumpBlock *)calloc(1, sizeof(SDumpBlock));
+  if (pBlock == NULL) return NULL;
+
+  pBlock->numOfCols = numOfCols;
+  pBlock->cols = cols;
+  pBlock->len = (int32_t *)calloc(numOfCols, sizeof(int32_t));
+  pBlock->data = (char **)calloc(numOfCols, POINTER_BYTES);
+  if (pBlock->len == NULL || pBlock->data == NULL) goto _err;
+
+  int32_t maxSize = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int32_t size = taosDumpColumnSize(&cols[i]);
+    if (size > maxSize) maxSize = size;
+
+    pBlock->data[i] = (char *)malloc(size);
+    if (pBlock->data[i] == NULL) goto _err;
+  }
+
+  // the first stage of compression may enlarge the data of random values in the worst case
+  pBlock->bufSize = maxSize + DUMP_BLOCK_ROWS * sizeof(int64_t) * 2 + 1024;
+  pBlock->compBuf = (char *)malloc(pBlock->bufSize);
+  pBlock->assistBuf = (char *)malloc(pBlock->bufSize);
+  if (pBlock->compBuf == NULL || pBlock->assistBuf == NULL) goto _err;
+
+  return pBlock;
+
+_err:
+  taosFreeDumpBlock(pBlock);
+  return NULL;
+}
+
+static void taosAppendDumpRow(SDumpBlock *pBlock, TAOS_ROW row) {
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    SOColInfo *pCol = &pBlock->cols[i];
+    char *     dst = pBlock->data[i] + pBlock->len[i];
+
+    if (taosIsVarType(pCol->type)) {
+      int16_t len = (row[i] == NULL) ? -1 : (int16_t)strnlen((char *)row[i], pCol->bytes);
+      memcpy(dst, &len, sizeof(int16_t));
+      if (len > 0) memcpy(dst + sizeof(int16_t), row[i], len);
+      pBlock->len[i] += sizeof(int16_t) + ((len > 0) ? len : 0);
+    } else {
+      if (row[i] == NULL) {
+        setNull(dst, pCol->type, pCol->bytes);
+      } else {
+        memcpy(dst, row[i], pCol->bytes);
+      }
+      pBlock->len[i] += pCol->bytes;
+    }
+  }
+
+  pBlock->numOfRows++;
+}
+
+static int taosCompressDumpColumn(SOColInfo *pCol, char *input, int32_t inputSize, int32_t rows, char *output,
+                                  int32_t outputSize, char *buf, int32_t bufSize) {
+  switch (pCol->type) {
+    case TSDB_DATA_TYPE_BOOL:
+      return tsCompressBool(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_TINYINT:
+      return tsCompressTinyint(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_SMALLINT:
+      return tsCompressSmallint(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_INT:
+      return tsCompressInt(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_BIGINT:
+      return tsCompressBigint(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_FLOAT:
+      return tsCompressFloat(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_DOUBLE:
+      return tsCompressDouble(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      return tsCompressTimestamp(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    default:
+      return tsCompressString(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+  }
+}
+
+static int taosDecompressDumpColumn(SOColInfo *pCol, char *input, int32_t inputSize, int32_t rows, char *output,
+                                    int32_t outputSize, char *buf, int32_t bufSize) {
+  switch (pCol->type) {
+    case TSDB_DATA_TYPE_BOOL:
+      return tsDecompressBool(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_TINYINT:
+      return tsDecompressTinyint(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_SMALLINT:
+      return tsDecompressSmallint(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_INT:
+      return tsDecompressInt(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_BIGINT:
+      return tsDecompressBigint(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_FLOAT:
+      return tsDecompressFloat(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_DOUBLE:
+      return tsDecompressDouble(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      return tsDecompressTimestamp(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+    default:
+      return tsDecompressString(input, inputSize, rows, output, outputSize, TWO_STAGE_COMP, buf, bufSize);
+  }
+}
+
+static int taosWriteDumpBlock(SDumpBlock *pBlock, FILE *fp) {
+  if (fwrite(&pBlock->numOfRows, sizeof(int32_t), 1, fp) != 1) return -1;
+
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    int32_t len = taosCompressDumpColumn(&pBlock->cols[i], pBlock->data[i], pBlock->len[i], pBlock->numOfRows,
+                                         pBlock->compBuf, pBlock->bufSize, pBlock->assistBuf, pBlock->bufSize);
+    if (fwrite(&len, sizeof(int32_t), 1, fp) != 1 || fwrite(pBlock->compBuf, len, 1, fp) != 1) return -1;
+
+    pBlock->len[i] = 0;
+  }
+
+  pBlock->numOfRows = 0;
+  return 0;
+}
+
+// return the number of rows in block, 0 if the table ends, -1 if the file is broken
+static int32_t taosReadDumpBlock(SDumpBlock *pBlock, FILE *fp) {
+  int32_t numOfRows = 0;
+  if (fread(&numOfRows, sizeof(int32_t), 1, fp) != 1 || numOfRows < 0 || numOfRows > DUMP_BLOCK_ROWS) return -1;
+  if (numOfRows == 0) return 0;
+
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    int32_t len = 0;
+    if (fread(&len, sizeof(int32_t), 1, fp) != 1 || len <= 0 || len > pBlock->bufSize) return -1;
+    if (fread(pBlock->compBuf, len, 1, fp) != 1) return -1;
+
+    pBlock->len[i] = taosDecompressDumpColumn(&pBlock->cols[i], pBlock->compBuf, len, numOfRows, pBlock->data[i],
+                                              taosDumpColumnSize(&pBlock->cols[i]), pBlock->assistBuf, pBlock->bufSize);
+  }
+
+  pBlock->numOfRows = numOfRows;
+  return numOfRows;
+}
+
+static int taosDumpTableBinary(TAOS *con, SDumpTask *pTask, struct arguments *arguments, FILE *fp,
+                               int64_t *numOfRows) {
+  char       sql[1024];
+  SOColInfo  cols[TSDB_MAX_COLUMNS];
+  TAOS_ROW   row = NULL;
+  int        code = 0;
+
+  snprintf(sql, sizeof(sql), "select * from %s.%s where _c0 >= %" PRId64 " and _c0 <= %" PRId64 " order by _c0 asc",
+           pTask->db, pTask->tableRecord.name, arguments->start_time, arguments->end_time);
+  if (taos_query(con, sql) != 0) {
+    fprintf(stderr, "failed to run command %s, reason: %s\n", sql, taos_errstr(con));
+    return -1;
+  }
+
+  TAOS_RES *res = taos_use_result(con);
+  if (res == NULL) {
+    fprintf(stderr, "failed to use result\n");
+    return -1;
+  }
+
+  SDumpTableHead head = {0};
+  strcpy(head.db, pTask->db);
+  strcpy(head.name, pTask->tableRecord.name);
+  head.numOfCols = taos_num_fields(res);
+
+  TAOS_FIELD *fields = taos_fetch_fields(res);
+  for (int32_t i = 0; i < head.numOfCols; ++i) {
+    cols[i].type = fields[i].type;
+    cols[i].bytes = fields[i].bytes;
+  }
+
+  SDumpBlock *pBlock = taosNewDumpBlock(cols, head.numOfCols);
+  if (pBlock == NULL) {
+    fprintf(stderr, "No enough memory\n");
+    taos_free_result(res);
+    return -1;
+  }
+
+  if (fwrite(&head, sizeof(SDumpTableHead), 1, fp) != 1 ||
+      fwrite(cols, sizeof(SOColInfo), head.numOfCols, fp) != head.numOfCols) {
+    code = -1;
+  }
+
+  while (code == 0 && (row = taos_fetch_row(res)) != NULL) {
+    taosAppendDumpRow(pBlock, row);
+    (*numOfRows)++;
+
+    if (pBlock->numOfRows >= DUMP_BLOCK_ROWS) code = taosWriteDumpBlock(pBlock, fp);
+  }
+
+  if (code == 0 && pBlock->numOfRows > 0) code = taosWriteDumpBlock(pBlock, fp);
+
+  int32_t end = 0;
+  if (code == 0 && fwrite(&end, sizeof(int32_t), 1, fp) != 1) code = -1;
+
+  if (code != 0) {
+    fprintf(stderr, "failed to write data of table %s.%s, reason: %s\n", pTask->db, pTask->tableRecord.name,
+            strerror(errno));
+  }
+
+  taosFreeDumpBlock(pBlock);
+  taos_free_result(res);
+  return code;
+}
+
+// the rows of a block are bound to one statement, and sent to vnodes as batched submit messages
+static int taosInsertDumpBlock(TAOS *con, char *sql, SDumpBlock *pBlock) {
+  TAOS_BIND     binds[TSDB_MAX_COLUMNS];
+  unsigned long lengths[TSDB_MAX_COLUMNS];
+  int           isNulls[TSDB_MAX_COLUMNS];
+  char *        cursors[TSDB_MAX_COLUMNS];
+
+  TAOS_STMT *stmt = taos_stmt_init(con);
+  if (stmt == NULL) return TSDB_CODE_CLI_OUT_OF_MEMORY;
+
+  memset(binds, 0, sizeof(TAOS_BIND) * pBlock->numOfCols);
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    binds[i].buffer_type = pBlock->cols[i].type;
+    binds[i].length = &lengths[i];
+    binds[i].is_null = &isNulls[i];
+    cursors[i] = pBlock->data[i];
+  }
+
+  int code = taos_stmt_prepare(stmt, sql, 0);
+
+  for (int32_t r = 0; code == TSDB_CODE_SUCCESS && r < pBlock->numOfRows; ++r) {
+    for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+      SOColInfo *pCol = &pBlock->cols[i];
+
+      if (taosIsVarType(pCol->type)) {
+        int16_t len = 0;
+        memcpy(&len, cursors[i], sizeof(int16_t));
+        isNulls[i] = (len < 0);
+        lengths[i] = (len < 0) ? 0 : len;
+        binds[i].buffer = cursors[i] + sizeof(int16_t);
+        cursors[i] += sizeof(int16_t) + lengths[i];
+      } else {
+        isNulls[i] = isNull(cursors[i], pCol->type);
+        lengths[i] = pCol->bytes;
+        binds[i].buffer = cursors[i];
+        cursors[i] += pCol->bytes;
+      }
+    }
+
+    code = taos_stmt_bind_param(stmt, binds);
+    if (code == TSDB_CODE_SUCCESS) code = taos_stmt_add_batch(stmt);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) code = taos_stmt_execute(stmt);
+
+  taos_stmt_close(stmt);
+  return code;
+}
+
+static int taosDumpInTableBinary(TAOS *con, SDumpTableHead *pHead, FILE *fp, SDumpThreadInfo *pInfo) {
+  SOColInfo cols[TSDB_MAX_COLUMNS];
+
+  if (pHead->numOfCols <= 0 || pHead->numOfCols > TSDB_MAX_COLUMNS ||
+      fread(cols, sizeof(SOColInfo), pHead->numOfCols, fp) != pHead->numOfCols) {
+    return -1;
+  }
+
+  char *sql = (char *)malloc(sizeof(SDumpTableHead) + pHead->numOfCols * 2 + 64);
+  SDumpBlock *pBlock = taosNewDumpBlock(cols, pHead->numOfCols);
+  if (sql == NULL || pBlock == NULL) {
+    fprintf(stderr, "No enough memory\n");
+    tfree(sql);
+    taosFreeDumpBlock(pBlock);
+    return -1;
+  }
+
+  char *pstr = sql + sprintf(sql, "insert into %s.%s values(?", pHead->db, pHead->name);
+  for (int32_t i = 1; i < pHead->numOfCols; ++i) {
+    pstr += sprintf(pstr, ",?");
+  }
+  sprintf(pstr, ")");
+
+  int32_t numOfRows = 0;
+  while ((numOfRows = taosReadDumpBlock(pBlock, fp)) > 0) {
+    int code = taosInsertDumpBlock(con, sql, pBlock);
+    if (code != TSDB_CODE_SUCCESS) {
+      fprintf(stderr, "failed to insert %d rows into %s.%s, reason: %s\ncontinue...\n", numOfRows, pHead->db,
+              pHead->name, tstrerror(code));
+      pInfo->code = -1;
+      continue;
+    }
+
+    pInfo->numOfRows += numOfRows;
+  }
+
+  free(sql);
+  taosFreeDumpBlock(pBlock);
+  return (numOfRows < 0) ? -1 : 0;
+}
+
+static int taosCompareDumpTask(const void *p1, const void *p2) {
+  const SDumpTask *pTask1 = (const SDumpTask *)p1;
+  const SDumpTask *pTask2 = (const SDumpTask *)p2;
+
+  int ret = strcmp(pTask1->db, pTask2->db);
+  if (ret != 0) return ret;
+
+  ret = strcmp(pTask1->tableRecord.metric, pTask2->tableRecord.metric);
+  if (ret != 0) return ret;
+
+  return strcmp(pTask1->tableRecord.name, pTask2->tableRecord.name);
+}
+
+static void *taosDumpOutThreadFp(void *param) {
+  SDumpThreadInfo * pInfo = (SDumpThreadInfo *)param;
+  struct arguments *arguments = pInfo->arguments;
+  char              fname[TSDB_FILENAME_LEN * 2];
+
+  snprintf(fname, sizeof(fname), "%s/%s%d", arguments->output, DUMP_DATA_FILE_PREFIX, pInfo->index);
+  FILE *fp = fopen(fname, "wb");
+  if (fp == NULL) {
+    fprintf(stderr, "failed to open file %s\n", fname);
+    pInfo->code = -1;
+    return NULL;
+  }
+
+  TAOS *con = taos_connect(arguments->host, arguments->user, arguments->password, NULL, arguments->port);
+  if (con == NULL) {
+    fprintf(stderr, "failed to connect to TDengine server\n");
+    pInfo->code = -1;
+    fclose(fp);
+    return NULL;
+  }
+
+  while (1) {
+    int32_t index = atomic_fetch_add_32(&nextDumpTask, 1);
+    if (index >= numOfDumpTasks) break;
+
+    // the rest of the file can not be parsed if a table is partly written
+    if (taosDumpTableBinary(con, &dumpTasks[index], arguments, fp, &pInfo->numOfRows) < 0) {
+      pInfo->code = -1;
+      break;
+    }
+  }
+
+  taos_close(con);
+  fclose(fp);
+  return NULL;
+}
+
+static void *taosDumpInThreadFp(void *param) {
+  SDumpThreadInfo * pInfo = (SDumpThreadInfo *)param;
+  struct arguments *arguments = pInfo->arguments;
+  SDumpTableHead    head;
+
+  TAOS *con = taos_connect(arguments->host, arguments->user, arguments->password, NULL, arguments->port);
+  if (con == NULL) {
+    fprintf(stderr, "failed to connect to TDengine server\n");
+    pInfo->code = -1;
+    return NULL;
+  }
+
+  while (1) {
+    int32_t index = atomic_fetch_add_32(&nextDumpTask, 1);
+    if (index >= numOfDumpFiles) break;
+
+    FILE *fp = fopen(dumpFiles[index], "rb");
+    if (fp == NULL) {
+      fprintf(stderr, "failed to open file %s\n", dumpFiles[index]);
+      pInfo->code = -1;
+      continue;
+    }
+
+    while (fread(&head, sizeof(SDumpTableHead), 1, fp) == 1) {
+      head.db[TSDB_DB_NAME_LEN] = 0;
+      head.name[TSDB_TABLE_NAME_LEN] = 0;
+
+      if (taosDumpInTableBinary(con, &head, fp, pInfo) < 0) {
+        fprintf(stderr, "file %s is broken at table %s.%s\n", dumpFiles[index], head.db, head.name);
+        pInfo->code = -1;
+        break;
+      }
+    }
+
+    fclose(fp);
+  }
+
+  taos_close(con);
+  return NULL;
+}
+
+static int taosRunDumpThreads(struct arguments *arguments, int32_t numOfThreads, void *(*fp)(void *)) {
+  int     code = 0;
+  int64_t numOfRows = 0;
+
+  SDumpThreadInfo *pInfos = (SDumpThreadInfo *)calloc(numOfThreads, sizeof(SDumpThreadInfo));
+  if (pInfos == NULL) {
+    fprintf(stderr, "failed to allocate memory\n");
+    return -1;
+  }
+
+  nextDumpTask = 0;
+
+  int32_t i = 0;
+  for (; i < numOfThreads; ++i) {
+    pInfos[i].index = i;
+    pInfos[i].arguments = arguments;
+    if (pthread_create(&pInfos[i].thread, NULL, fp, &pInfos[i]) != 0) {
+      fprintf(stderr, "failed to create thread, reason: %s\n", strerror(errno));
+      code = -1;
+      break;
+    }
+  }
+
+  // the tasks are taken by the threads created, even though some of them failed to create
+  for (int32_t j = 0; j < i; ++j) {
+    pthread_join(pInfos[j].thread, NULL);
+    if (pInfos[j].code != 0) code = -1;
+    numOfRows += pInfos[j].numOfRows;
+  }
+
+  fprintf(stdout, "%" PRId64 " rows are %s by %d threads\n", numOfRows, arguments->isDumpIn ? "restored" : "dumped",
+          i);
+
+  free(pInfos);
+  return code;
+}
+
+static int taosDumpWriteMeta(struct arguments *arguments, int32_t numOfFiles) {
+  char fname[TSDB_FILENAME_LEN * 2];
+
+  snprintf(fname, sizeof(fname), "%s/%s", arguments->output, DUMP_META_FILE);
+  FILE *fp = fopen(fname, "w");
+  if (fp == NULL) {
+    fprintf(stderr, "failed to open file %s\n", fname);
+    return -1;
+  }
+
+  int code = (fprintf(fp, "%s %d\n", DUMP_META_DATA_FILES, numOfFiles) > 0) ? 0 : -1;
+  if (fclose(fp) != 0) code = -1;
+
+  if (code != 0) {
+    fprintf(stderr, "failed to write file %s\n", fname);
+  }
+
+  return code;
+}
+
+static int32_t taosDumpReadMeta(char *dir) {
+  char    fname[TSDB_FILENAME_LEN * 2];
+  char    key[32] = {0};
+  int32_t numOfFiles = -1;
+
+  snprintf(fname, sizeof(fname), "%s/%s", dir, DUMP_META_FILE);
+  FILE *fp = fopen(fname, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "failed to open file %s, the dump is not completed\n", fname);
+    return -1;
+  }
+
+  if (fscanf(fp, "%31s %d", key, &numOfFiles) != 2 || strcmp(key, DUMP_META_DATA_FILES) != 0 || numOfFiles < 0) {
+    fprintf(stderr, "file %s is broken\n", fname);
+    numOfFiles = -1;
+  }
+
+  fclose(fp);
+  return numOfFiles;
+}
+
+int taosDumpOutBinary(struct arguments *arguments) {
+  int32_t numOfThreads = 0;
+
+  if (numOfDumpTasks > 0) {
+    // the tables of a super table are taken by threads in sequence, so they are mostly in the same data file
+    qsort(dumpTasks, numOfDumpTasks, sizeof(SDumpTask), taosCompareDumpTask);
+
+    // each thread writes one data file
+    numOfThreads = (arguments->thread_num < numOfDumpTasks) ? arguments->thread_num : numOfDumpTasks;
+    if (taosRunDumpThreads(arguments, numOfThreads, taosDumpOutThreadFp) < 0) return -1;
+  }
+
+  return taosDumpWriteMeta(arguments, numOfThreads);
+}
+
+int taosDumpInBinary(struct arguments *arguments) {
+  char dir[TSDB_FILENAME_LEN + 1];
+  int  code = 0;
+
+  strcpy(dir, arguments->input);
+
+  // only the data files of a completed dump are restored, other files in the directory are not touched
+  int32_t numOfFiles = taosDumpReadMeta(dir);
+  if (numOfFiles < 0) return -1;
+
+  // the databases, tables and tags are created from the manifest first
+  snprintf(arguments->input, sizeof(arguments->input), "%s/%s", dir, DUMP_MANIFEST_FILE);
+  if (taosDumpIn(arguments) < 0) return -1;
+
+  if (numOfFiles > 0) {
+    dumpFiles = (char **)calloc(numOfFiles, POINTER_BYTES);
+    if (dumpFiles == NULL) code = -1;
+  }
+
+  for (; code == 0 && numOfDumpFiles < numOfFiles; ++numOfDumpFiles) {
+    dumpFiles[numOfDumpFiles] = (char *)malloc(TSDB_FILENAME_LEN * 2);
+    if (dumpFiles[numOfDumpFiles] == NULL) {
+      code = -1;
+      break;
+    }
+
+    snprintf(dumpFiles[numOfDumpFiles], TSDB_FILENAME_LEN * 2, "%s/%s%d", dir, DUMP_DATA_FILE_PREFIX, numOfDumpFiles);
+  }
+
+  if (code != 0) {
+    fprintf(stderr, "failed to allocate memory\n");
+  } else if (numOfDumpFiles > 0) {
+    // a data file is read by one thread, so the restore runs at most as many threads as the dump
+    int32_t numOfThreads = (arguments->thread_num < numOfDumpFiles) ? arguments->thread_num : numOfDumpFiles;
+    code = taosRunDumpThreads(arguments, numOfThreads, taosDumpInThreadFp);
+  }
+
+  for (int32_t i = 0; i < numOfDumpFiles; ++i) {
+    free(dumpFiles[i]);
+  }
+  tfree(dumpFiles);
+
+  return code;
+}
+
 char *ascii_literal_list[] = {
     "\\x00", "\\x01", "\\x02", "\\x03", "\\x04", "\\x05", "\\x06", "\\x07", "\\x08", "\\t",   "\\n",   "\\x0b", "\\x0c",
     "\\r",   "\\x0e", "\\x0f", "\\x10", "\\x11", "\\x12", "\\x13", "\\x14", "\\x15", "\\x16", "\\x17", "\\x18", "\\x19",
@@ -424,6 +424,7 @@ static void mgmtProcessConnectMsg(SQueuedMsg *pMsg) {
   strcpy(pConnectRsp->serverVersion, version);
   pConnectRsp->writeAuth = pUser->writeAuth;
   pConnectRsp->superAuth = pUser->superAuth;
+  pConnectRsp->features  = htonl(TSDB_FEATURE_COLUMNAR_SUBMIT);
 
   mgmtGetMnodeIpSet(&pConnectRsp->ipList, pMsg->usePublicIp);
   
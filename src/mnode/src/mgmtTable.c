@@ -1887,43 +1887,100 @@ static void mgmtProcessMultiTableMetaMsg(SQueuedMsg *pMsg) {
     return;
   }
 
+  // a table may be left out for other reasons, e.g. its db or vgroup is not available, so the tables which do not
+  // exist are listed explicitly
+  int32_t *pAbsent = malloc(sizeof(int32_t) * (pInfo->numOfTables + 1));
+  int32_t  numOfAbsent = 0;
+  if (pAbsent == NULL) {
+    rpcFreeCont(pMultiMeta);
+    mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_SERV_OUT_OF_MEMORY);
+    return;
+  }
+
   pMultiMeta->contLen = sizeof(SMultiTableMeta);
   pMultiMeta->numOfTables = 0;
 
   for (int t = 0; t < pInfo->numOfTables; ++t) {
     char *tableId = (char*)(pInfo->tableIds + t * TSDB_TABLE_ID_LEN);
     SChildTableObj *pTable = mgmtGetChildTable(tableId);
-    if (pTable == NULL) continue;
+    if (pTable == NULL) {
+      pAbsent[numOfAbsent++] = htonl(t);
+      continue;
+    }
 
     SDbObj *pDb = mgmtGetDbByTableId(tableId);
-    if (pDb == NULL) continue;
+    if (pDb == NULL) {
+      mgmtDecTableRef(pTable);
+      continue;
+    }
 
     int availLen = totalMallocLen - pMultiMeta->contLen;
     if (availLen <= sizeof(STableMetaMsg) + sizeof(SSchema) * TSDB_MAX_COLUMNS) {
-      //TODO realloc
-      //totalMallocLen *= 2;
-      //pMultiMeta = rpcReMalloc(pMultiMeta, totalMallocLen);
-      //if (pMultiMeta == NULL) {
-      ///  rpcSendResponse(ahandle, TSDB_CODE_SERV_OUT_OF_MEMORY, NULL, 0);
-      //  return TSDB_CODE_SERV_OUT_OF_MEMORY;
-      //} else {
-      //  t--;
-      //  continue;
-      //}
+      totalMallocLen *= 2;
+      SMultiTableMeta *pNew = rpcReallocCont(pMultiMeta, totalMallocLen);
+      if (pNew == NULL) {
+        mgmtDecTableRef(pTable);
+        mgmtDecDbRef(pDb);
+        rpcFreeCont(pMultiMeta);
+        free(pAbsent);
+        mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_SERV_OUT_OF_MEMORY);
+        return;
+      }
+
+      pMultiMeta = pNew;
     }
 
-    STableMetaMsg *pMeta = (STableMetaMsg *)(pMultiMeta->metas + pMultiMeta->contLen);
+    // the refs of table, db and vgroup are released for each table, since pMsg only holds one of each
+    pMsg->pTable = (STableObj *)pTable;
+    pMsg->pDb = pDb;
+
+    STableMetaMsg *pMeta = (STableMetaMsg *)((char *)pMultiMeta + pMultiMeta->contLen);
     int32_t code = mgmtDoGetChildTableMeta(pMsg, pMeta);
     if (code == TSDB_CODE_SUCCESS) {
       pMultiMeta->numOfTables ++;
       pMultiMeta->contLen += pMeta->contLen;
+      pMeta->contLen = htons(pMeta->contLen);
+    }
+
+    mgmtDecTableRef(pMsg->pTable);
+    mgmtDecDbRef(pMsg->pDb);
+    if (pMsg->pVgroup != NULL) mgmtDecVgroupRef(pMsg->pVgroup);
+
+    pMsg->pTable = NULL;
+    pMsg->pDb = NULL;
+    pMsg->pVgroup = NULL;
+  }
+
+  int32_t absentLen = sizeof(int32_t) * (numOfAbsent + 1);
+  if (totalMallocLen - pMultiMeta->contLen < absentLen) {
+    totalMallocLen = pMultiMeta->contLen + absentLen;
+    SMultiTableMeta *pNew = rpcReallocCont(pMultiMeta, totalMallocLen);
+    if (pNew == NULL) {
+      rpcFreeCont(pMultiMeta);
+      free(pAbsent);
+      mgmtSendSimpleResp(pMsg->thandle, TSDB_CODE_SERV_OUT_OF_MEMORY);
+      return;
     }
+
+    pMultiMeta = pNew;
   }
 
+  char *pTail = (char *)pMultiMeta + pMultiMeta->contLen;
+  *(int32_t *)pTail = htonl(numOfAbsent);
+  memcpy(pTail + sizeof(int32_t), pAbsent, sizeof(int32_t) * numOfAbsent);
+  pMultiMeta->contLen += absentLen;
+  free(pAbsent);
+
+  mTrace("multi table meta msg is processed, tables requested:%d retrieved:%d absent:%d, thandle:%p",
+         pInfo->numOfTables, pMultiMeta->numOfTables, numOfAbsent, pMsg->thandle);
+
   SRpcMsg rpcRsp = {0};
   rpcRsp.handle = pMsg->thandle;
   rpcRsp.pCont = pMultiMeta;
   rpcRsp.contLen = pMultiMeta->contLen;
+
+  pMultiMeta->numOfTables = htonl(pMultiMeta->numOfTables);
+  pMultiMeta->contLen = htonl(pMultiMeta->contLen);
   rpcSendResponse(&rpcRsp);
 }
 
@@ -27,6 +27,7 @@ enum _httpRespTempl {
   HTTP_RESPONSE_CHUNKED_COMPRESS,
   HTTP_RESPONSE_OPTIONS,
   HTTP_RESPONSE_GRAFANA,
+  HTTP_RESPONSE_METRICS,
   HTTP_RESP_END
 };
 
@@ -38,5 +39,6 @@ void httpSendTaosdErrorResp(HttpContext *pContext, int errCode);
 void httpSendTaosdInvalidSqlErrorResp(HttpContext *pContext, char* errMsg);
 void httpSendSuccResp(HttpContext *pContext, char *desc);
 void httpSendOptionResp(HttpContext *pContext, char *desc);
+void httpSendMetricsResp(HttpContext *pContext, char *body, int bodyLen);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_METRICS_HANDLE_H
+#define TDENGINE_METRICS_HANDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "http.h"
+#include "httpCode.h"
+#include "httpHandle.h"
+#include "httpResp.h"
+
+// the initial size of buffer to dump metrics, it is doubled until all metrics are dumped
+#define METRICS_BUF_SIZE     (64 * 1024)
+#define METRICS_MAX_BUF_SIZE (4 * 1024 * 1024)
+
+void metricsInitHandle(HttpServer* pServer);
+bool metricsProcessRequest(struct HttpContext* pContext);
+
+#endif
@@ -41,7 +41,9 @@ const char *httpRespTemplate[] = {
     // HTTP_RESPONSE_OPTIONS
     "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\nAccess-Control-Allow-Methods: *\r\nAccess-Control-Max-Age: 3600\r\nAccess-Control-Allow-Headers: Origin, X-Requested-With, Content-Type, Accept, authorization\r\n\r\n",
     // HTTP_RESPONSE_GRAFANA
-    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sAccess-Control-Allow-Methods:POST, GET, OPTIONS, DELETE, PUT\r\nAccess-Control-Allow-Headers:Accept, Content-Type\r\nContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\n\r\n"
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sAccess-Control-Allow-Methods:POST, GET, OPTIONS, DELETE, PUT\r\nAccess-Control-Allow-Headers:Accept, Content-Type\r\nContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\n\r\n",
+    // HTTP_RESPONSE_METRICS, in the text format of Prometheus
+    "%s 200 OK\r\n%sContent-Type: text/plain; version=0.0.4;charset=utf-8\r\nContent-Length: %d\r\n\r\n"
 };
 
 void httpSendErrorRespImp(HttpContext *pContext, int httpCode, char *httpCodeStr, int errNo, char *desc) {
@@ -216,6 +218,16 @@ void httpSendSuccResp(HttpContext *pContext, char *desc) {
   httpCloseContextByApp(pContext);
 }
 
+void httpSendMetricsResp(HttpContext *pContext, char *body, int bodyLen) {
+  char head[1024] = {0};
+  int  headLen = sprintf(head, httpRespTemplate[HTTP_RESPONSE_METRICS], httpVersionStr[pContext->httpVersion],
+                        httpKeepAliveStr[pContext->httpKeepAlive], bodyLen);
+
+  httpWriteBuf(pContext, head, headLen);
+  httpWriteBuf(pContext, body, bodyLen);
+  httpCloseContextByApp(pContext);
+}
+
 void httpSendOptionResp(HttpContext *pContext, char *desc) {
   char head[1024] = {0};
   char body[1024] = {0};
@@ -30,6 +30,7 @@
 #include "httpHandle.h"
 #include "restHandle.h"
 #include "tgHandle.h"
+#include "metricsHandle.h"
 
 #ifndef _ADMIN
 
@@ -65,6 +66,7 @@ int httpInitSystem() {
   gcInitHandle(httpServer);
   tgInitHandle(httpServer);
   opInitHandle(httpServer);
+  metricsInitHandle(httpServer);
 
   return 0;
 }
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "tmetrics.h"
+#include "metricsHandle.h"
+#include "httpLog.h"
+
+static HttpDecodeMethod metricsDecodeMethod = {"metrics", metricsProcessRequest};
+
+void metricsInitHandle(HttpServer* pServer) { httpAddMethod(pServer, &metricsDecodeMethod); }
+
+/*
+ * The metrics are read from the registry of this process directly, neither authentication nor connection to
+ * taosd is required, so that it is cheap enough to be scraped every second.
+ * Since the response is sent here, false is returned to skip the processing of sql.
+ */
+bool metricsProcessRequest(struct HttpContext* pContext) {
+  httpTrace("context:%p, fd:%d, ip:%s, process metrics request", pContext, pContext->fd, pContext->ipstr);
+
+  int32_t size = METRICS_BUF_SIZE;
+  char*   buf = NULL;
+  int32_t len = -1;
+
+  while (len < 0 && size <= METRICS_MAX_BUF_SIZE) {
+    char* p = realloc(buf, (size_t)size);
+    if (p == NULL) break;
+
+    buf = p;
+    len = taosDumpMetrics(buf, size);
+    size *= 2;
+  }
+
+  if (len < 0) {
+    httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
+  } else {
+    httpSendMetricsResp(pContext, buf, len);
+  }
+
+  free(buf);
+  return false;
+}
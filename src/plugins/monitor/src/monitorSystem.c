@@ -56,6 +56,8 @@ typedef enum {
   MONITOR_CMD_CREATE_MT_DN,
   MONITOR_CMD_CREATE_MT_ACCT,
   MONITOR_CMD_CREATE_TB_DN,
+  MONITOR_CMD_CREATE_MT_BLK_CACHE,
+  MONITOR_CMD_CREATE_TB_BLK_CACHE,
   MONITOR_CMD_CREATE_TB_ACCT_ROOT,
   MONITOR_CMD_CREATE_TB_SLOWQUERY,
   MONITOR_CMD_MAX
@@ -181,6 +183,14 @@ void dnodeBuildMonitorSql(char *sql, int cmd) {
   } else if (cmd == MONITOR_CMD_CREATE_TB_DN) {
     snprintf(sql, SQL_LENGTH, "create table if not exists %s.dn_%s using %s.dn tags('%s')", tsMonitorDbName,
              monitor->privateIpStr, tsMonitorDbName, tsPrivateIp);
+  } else if (cmd == MONITOR_CMD_CREATE_MT_BLK_CACHE) {
+    // kept out of the dn table, so the dn table created by the previous version is still written
+    snprintf(sql, SQL_LENGTH,
+             "create table if not exists %s.blk_cache(ts timestamp, hit bigint, miss bigint) tags (ipaddr binary(%d))",
+             tsMonitorDbName, IP_LEN_STR + 1);
+  } else if (cmd == MONITOR_CMD_CREATE_TB_BLK_CACHE) {
+    snprintf(sql, SQL_LENGTH, "create table if not exists %s.blk_cache_%s using %s.blk_cache tags('%s')",
+             tsMonitorDbName, monitor->privateIpStr, tsMonitorDbName, tsPrivateIp);
   } else if (cmd == MONITOR_CMD_CREATE_MT_ACCT) {
     snprintf(sql, SQL_LENGTH,
              "create table if not exists %s.acct(ts timestamp "
@@ -345,12 +355,13 @@ int monitorBuildBandSql(char *sql) {
   return sprintf(sql, ", %f", bandSpeedKb);
 }
 
-int monitorBuildReqSql(char *sql) {
-  SDnodeStatisInfo info;
-  info.httpReqNum = info.submitReqNum = info.queryReqNum = 0;
-  (*mnodeCountRequestFp)(&info);
+int monitorBuildReqSql(char *sql, SDnodeStatisInfo *info) {
+  return sprintf(sql, ", %d, %d, %d)", info->httpReqNum, info->queryReqNum, info->submitReqNum);
+}
 
-  return sprintf(sql, ", %d, %d, %d)", info.httpReqNum, info.queryReqNum, info.submitReqNum);
+int monitorBuildBlockCacheSql(char *sql, int64_t ts, SDnodeStatisInfo *info) {
+  return sprintf(sql, " %s.blk_cache_%s values(%" PRId64 ", %" PRId64 ", %" PRId64 ")", tsMonitorDbName,
+                 monitor->privateIpStr, ts, info->blockCacheHitNum, info->blockCacheMissNum);
 }
 
 int monitorBuildIoSql(char *sql) {
@@ -381,7 +392,11 @@ void monitorSaveSystemInfo() {
   pos += monitorBuildDiskSql(sql + pos);
   pos += monitorBuildBandSql(sql + pos);
   pos += monitorBuildIoSql(sql + pos);
-  pos += monitorBuildReqSql(sql + pos);
+
+  SDnodeStatisInfo info = {0};
+  (*mnodeCountRequestFp)(&info);
+  pos += monitorBuildReqSql(sql + pos, &info);
+  pos += monitorBuildBlockCacheSql(sql + pos, ts, &info);
 
   monitorTrace("monitor:%p, save system info, sql:%s", monitor->conn, sql);
   taos_query_a(monitor->conn, sql, dnodeMontiorInsertSysCallback, "log");
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QAGGKERNEL_H
+#define TDENGINE_QAGGKERNEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/*
+ * Aggregate kernels on fixed-length numeric columns. One loop is generated for each combination of function and data
+ * type, so the type dispatch is done once for each block instead of once for each row.
+ *
+ * Null values are described by a bitmap, in which bit i is set when row i is null. The bitmap is built once when a
+ * data block is loaded, and all kernels accept a NULL bitmap for blocks without null value, in which case the loop
+ * is branch free and can be vectorized by compiler.
+ */
+#define QAGG_NULL_BITMAP_BYTES(_rows) (((_rows) + 7) >> 3)
+#define QAGG_IS_NULL_BIT(_bitmap, _i) (((_bitmap)[(_i) >> 3] >> ((_i)&7)) & 1)
+
+/**
+ * @param pData         first element of input data
+ * @param numOfRows     number of elements
+ * @param pNullBitmap   null bitmap, NULL if no null value exists
+ * @param bitOffset     position of the first element in null bitmap
+ * @param pRes          accumulated result. int64_t for integer types and double for float/double in sum kernel,
+ *                      and the same type of input for min/max kernels, which is only updated when not-null value exists
+ * @return              number of not-null elements
+ */
+typedef int32_t (*__agg_kernel_fn_t)(const void *pData, int32_t numOfRows, const uint8_t *pNullBitmap,
+                                     int32_t bitOffset, void *pRes);
+
+/**
+ * build the null bitmap of a column data block
+ * @param pData       column data
+ * @param numOfRows   number of rows in block
+ * @param type        data type of column
+ * @param bytes       bytes of each element
+ * @param pBitmap     output bitmap, at least QAGG_NULL_BITMAP_BYTES(numOfRows) bytes
+ * @return            number of null values
+ */
+int32_t qBuildNullBitmap(const char *pData, int32_t numOfRows, int16_t type, int16_t bytes, uint8_t *pBitmap);
+
+/**
+ * number of not-null values in range of [bitOffset, bitOffset + numOfRows) in bitmap
+ */
+int32_t qCountNotNull(const uint8_t *pNullBitmap, int32_t bitOffset, int32_t numOfRows);
+
+__agg_kernel_fn_t qGetSumKernel(int16_t type);
+__agg_kernel_fn_t qGetMinKernel(int16_t type);
+__agg_kernel_fn_t qGetMaxKernel(int16_t type);
+
+/**
+ * find the position of not-null element that equals to pVal
+ * @param lastOne  return the last matched position if true, otherwise the first one
+ * @return         position of matched element, -1 if not found
+ */
+int32_t qLocateValue(const void *pData, int32_t numOfRows, const uint8_t *pNullBitmap, int32_t bitOffset, int16_t type,
+                     const void *pVal, bool lastOne);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QAGGKERNEL_H
@@ -111,10 +111,13 @@ typedef struct tExtMemBuffer {
 
   tFilePagesItem *pHead;
   tFilePagesItem *pTail;
+  SArray *        pSealedPages;  // pages of sealed groups that are kept in memory, indexed by page id
 
   char *    path;
   FILE *    file;
   SExtFileInfo fileMeta;
+  SArray *  pPageOffset;  // offset of each page in file, since pages are compressed. The last one is the end of file
+  char *    pCompBuffer;  // the buffer of compressed page, allocated along with the file
 
   SColumnModel *         pColumnModel;
   EXT_BUFFER_FLUSH_MODEL flushModel;
@@ -158,6 +161,16 @@ int16_t tExtMemBufferPut(tExtMemBuffer *pMemBuffer, void *data, int32_t numOfRow
  */
 bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer);
 
+/**
+ * close current group of data in the same way as tExtMemBufferFlush, but the pages are kept in memory instead of
+ * being written into the temporary file, as long as the pages of all groups still fit in the in-memory capacity.
+ * Otherwise, all pages are flushed to disk, and the following groups are always flushed to disk.
+ *
+ * @param pMemBuffer
+ * @return
+ */
+bool tExtMemBufferSeal(tExtMemBuffer *pMemBuffer);
+
 /**
  *
  * remove all data that has been put into buffer, including in buffer or
@@ -179,6 +192,21 @@ bool tExtMemBufferLoadData(tExtMemBuffer *pMemBuffer, tFilePage *pFilePage, int3
  */
 bool tExtMemBufferIsAllDataInMem(tExtMemBuffer *pMemBuffer);
 
+/**
+ * merge the sorted groups of data in buffers, in one or more passes, until there are no more than maxNumOfGroups
+ * groups, so that the final merge only needs to load one page of at most maxNumOfGroups groups at the same time.
+ * Each merged group is kept in a new buffer, and the buffers that have been merged are destroyed.
+ *
+ * @param pMemBuffer     the array of buffers, which is replaced by the array of merged buffers
+ * @param numOfBuffer    number of buffers in array
+ * @param pDesc          the order descriptor of the sorted groups
+ * @param orderType      the order of the sorted groups
+ * @param maxNumOfGroups the maximum number of groups merged at the same time
+ * @return               number of buffers in the new array, or -1 if failed, and the array is not changed
+ */
+int32_t tExtMemBufferMergeGroups(tExtMemBuffer ***pMemBuffer, int32_t numOfBuffer, tOrderDescriptor *pDesc,
+                                 int32_t orderType, int32_t maxNumOfGroups);
+
 /**
  *
  * @param fields
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TDIGEST_H
+#define TDENGINE_TDIGEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TDIGEST_COMPRESSION 100
+
+// the centroids and the buffered points share the same slots, so the number of slots must be much larger than the
+// number of centroids after compressed, which is at most compression + 2
+#define TDIGEST_SLOTS(compression) ((compression) * 3)
+#define TDIGEST_SIZE(compression) (sizeof(STDigest) + sizeof(SCentroid) * TDIGEST_SLOTS(compression))
+
+typedef struct SCentroid {
+  double  mean;
+  int64_t weight;
+} SCentroid;
+
+/*
+ * The digest is a flat buffer without any pointer, so it can be copied between vnode and client as the intermediate
+ * result of apercentile and merged there without any conversion. The compressed centroids are kept in the slots
+ * [0, numOfCentroids), and the points not merged yet are appended after them.
+ */
+typedef struct STDigest {
+  int32_t   compression;
+  int32_t   numOfSlots;
+  int32_t   numOfCentroids;
+  int32_t   numOfBuffered;
+  int64_t   totalWeight;  // including the buffered points
+  double    min;
+  double    max;
+  SCentroid slots[];
+} STDigest;
+
+STDigest *tdigestCreate(int32_t compression);
+STDigest *tdigestCreateFrom(void *pBuf, int32_t compression);
+void      tdigestDestroy(STDigest *pDigest);
+
+void   tdigestAdd(STDigest *pDigest, double val, int64_t weight);
+void   tdigestMerge(STDigest *pDigest, STDigest *pOther);
+void   tdigestCompress(STDigest *pDigest);
+double tdigestQuantile(STDigest *pDigest, double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TDIGEST_H
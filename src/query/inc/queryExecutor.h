@@ -142,6 +142,13 @@ typedef struct SQuery {
 } SQuery;
 
 typedef struct SQueryCostSummary {
+  int64_t        applyFunctionUs;  // time to apply functions on data blocks
+  int64_t        mergeUs;          // time to merge the results of tables, super table query only
+  int64_t        totalRows;        // rows of all checked data blocks
+  int64_t        filteredRows;     // rows discarded by filter condition
+  int32_t        totalBlocks;      // number of checked data blocks
+  int32_t        skippedBlocks;    // number of data blocks of which data are not required, or discarded by statistics
+  STsdbQueryCost tsdbCost;         // cost of query handles that have been cleaned up
 } SQueryCostSummary;
 
 typedef struct SQueryRuntimeEnv {
@@ -161,6 +168,10 @@ typedef struct SQueryRuntimeEnv {
   void*              pQueryHandle;
   void*              pSecQueryHandle; // another thread for
   SDiskbasedResultBuf* pResultBuf;  // query result buffer based on blocked-wised disk file
+  uint8_t*           pNullBitmapBuf;   // null bitmap buffer of all output columns for aggregate kernels
+  int32_t            nullBitmapRows;   // max number of rows in one block that pNullBitmapBuf can hold
+  TSKEY*             pBucketKeys;      // timestamp column of a bucket of rollup, all rows take the first key of the bucket
+  int32_t            bucketKeyRows;    // max number of rows that pBucketKeys can hold
 } SQueryRuntimeEnv;
 
 typedef struct SQInfo {
@@ -187,6 +198,11 @@ typedef struct SQInfo {
   int32_t         tableIndex;
   int32_t         numOfGroupResultPages;
   TSKEY*          tsList;
+  bool            subscribe;     // return the subscription progress with result, for a subscription query
+  int64_t         subscribeUid;  // uid of the subscribed table, 0 if it is not supported, e.g. a super table
+  TSKEY           subscribeKey;  // key of the last row returned to the subscription
+  bool            profile;       // return the execution profile with result
+  struct SQInfo*  pParent;       // the query that this part of split scan belongs to, NULL for a query
 } SQInfo;
 
 #endif  // TDENGINE_QUERYEXECUTOR_H
@@ -170,6 +170,7 @@ typedef struct SQLFunctionCtx {
   int16_t  outputType;
   int16_t  outputBytes;  // size of results, determined by function and input column data type
   bool     hasNull;      // null value exist in current block
+  uint8_t *pNullBitmap;  // null bitmap of current block built during block load, NULL if not available
   int16_t  functionId;   // function id
   int32_t  blockStatus;  // Indicate if data is loaded, it is first/last/internal block. Only for file blocks
   void *   aInputElemBuf;
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+
+#include "qaggkernel.h"
+#include "taosdef.h"
+
+#define BUILD_NULL_BITMAP(_type, _null)                                                \
+  do {                                                                                 \
+    const _type *_p = (const _type *)pData;                                            \
+    for (int32_t _i = 0; _i < numOfRows; _i += 8) {                                    \
+      int32_t _end = (_i + 8 < numOfRows) ? _i + 8 : numOfRows;                        \
+      uint8_t _b = 0;                                                                  \
+      for (int32_t _j = _i; _j < _end; ++_j) {                                         \
+        int32_t _isNull = (_p[_j] == (_type)(_null));                                  \
+        _b |= (uint8_t)(_isNull << (_j - _i));                                         \
+        numOfNull += _isNull;                                                          \
+      }                                                                                \
+      pBitmap[_i >> 3] = _b;                                                           \
+    }                                                                                  \
+  } while (0)
+
+int32_t qBuildNullBitmap(const char *pData, int32_t numOfRows, int16_t type, int16_t bytes, uint8_t *pBitmap) {
+  int32_t numOfNull = 0;
+
+  // compare the bit pattern of null value, since the null value of float/double is a NaN
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   BUILD_NULL_BITMAP(uint8_t, TSDB_DATA_TINYINT_NULL);   break;
+    case TSDB_DATA_TYPE_SMALLINT:  BUILD_NULL_BITMAP(uint16_t, TSDB_DATA_SMALLINT_NULL); break;
+    case TSDB_DATA_TYPE_INT:       BUILD_NULL_BITMAP(uint32_t, TSDB_DATA_INT_NULL);      break;
+    case TSDB_DATA_TYPE_TIMESTAMP:
+    case TSDB_DATA_TYPE_BIGINT:    BUILD_NULL_BITMAP(uint64_t, TSDB_DATA_BIGINT_NULL);   break;
+    case TSDB_DATA_TYPE_FLOAT:     BUILD_NULL_BITMAP(uint32_t, TSDB_DATA_FLOAT_NULL);    break;
+    case TSDB_DATA_TYPE_DOUBLE:    BUILD_NULL_BITMAP(uint64_t, TSDB_DATA_DOUBLE_NULL);   break;
+    default: {
+      memset(pBitmap, 0, QAGG_NULL_BITMAP_BYTES(numOfRows));
+      for (int32_t i = 0; i < numOfRows; ++i) {
+        if (isNull(pData + i * bytes, type)) {
+          pBitmap[i >> 3] |= (uint8_t)(1 << (i & 7));
+          numOfNull += 1;
+        }
+      }
+    }
+  }
+
+  return numOfNull;
+}
+
+int32_t qCountNotNull(const uint8_t *pNullBitmap, int32_t bitOffset, int32_t numOfRows) {
+  int32_t numOfNull = 0;
+  for (int32_t i = bitOffset; i < bitOffset + numOfRows; ++i) {
+    numOfNull += QAGG_IS_NULL_BIT(pNullBitmap, i);
+  }
+
+  return numOfRows - numOfNull;
+}
+
+/*
+ * The sum of dense block is accumulated in four independent lanes, which breaks the dependency chain of the
+ * additions, so that the loop can be vectorized for float/double without reassociation by compiler.
+ * For block with null values, the null element is replaced with 0 by a select instead of a branch.
+ */
+#define DEFINE_SUM_KERNEL(_name, _type, _resType)                                                              \
+  static int32_t _name(const void *pData, int32_t numOfRows, const uint8_t *pNullBitmap, int32_t bitOffset,    \
+                       void *pRes) {                                                                           \
+    const _type *p = (const _type *)pData;                                                                     \
+    _resType     s0 = 0, s1 = 0, s2 = 0, s3 = 0;                                                               \
+    int32_t      numOfNull = 0;                                                                                \
+    int32_t      i = 0;                                                                                        \
+                                                                                                               \
+    if (pNullBitmap == NULL) {                                                                                 \
+      for (; i + 4 <= numOfRows; i += 4) {                                                                     \
+        s0 += p[i];                                                                                            \
+        s1 += p[i + 1];                                                                                        \
+        s2 += p[i + 2];                                                                                        \
+        s3 += p[i + 3];                                                                                        \
+      }                                                                                                        \
+                                                                                                               \
+      for (; i < numOfRows; ++i) {                                                                             \
+        s0 += p[i];                                                                                            \
+      }                                                                                                        \
+    } else {                                                                                                   \
+      for (; i < numOfRows; ++i) {                                                                             \
+        int32_t isNull = QAGG_IS_NULL_BIT(pNullBitmap, i + bitOffset);                                         \
+        s0 += isNull ? 0 : p[i];                                                                               \
+        numOfNull += isNull;                                                                                   \
+      }                                                                                                        \
+    }                                                                                                          \
+                                                                                                               \
+    *(_resType *)pRes += (s0 + s1) + (s2 + s3);                                                                \
+    return numOfRows - numOfNull;                                                                              \
+  }
+
+/*
+ * the null element is replaced with the initial value of min/max, which never changes the result
+ */
+#define DEFINE_MINMAX_KERNEL(_name, _type, _initVal, _op)                                                      \
+  static int32_t _name(const void *pData, int32_t numOfRows, const uint8_t *pNullBitmap, int32_t bitOffset,    \
+                       void *pRes) {                                                                           \
+    const _type *p = (const _type *)pData;                                                                     \
+    _type        v = (_initVal);                                                                               \
+    int32_t      numOfNull = 0;                                                                                \
+                                                                                                               \
+    if (pNullBitmap == NULL) {                                                                                 \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                                                \
+        v = (p[i] _op v) ? p[i] : v;                                                                           \
+      }                                                                                                        \
+    } else {                                                                                                   \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                                                \
+        int32_t isNull = QAGG_IS_NULL_BIT(pNullBitmap, i + bitOffset);                                         \
+        _type   d = isNull ? (_initVal) : p[i];                                                                \
+        v = (d _op v) ? d : v;                                                                                 \
+        numOfNull += isNull;                                                                                   \
+      }                                                                                                        \
+    }                                                                                                          \
+                                                                                                               \
+    if (numOfRows > numOfNull) {                                                                               \
+      *(_type *)pRes = v;                                                                                      \
+    }                                                                                                          \
+                                                                                                               \
+    return numOfRows - numOfNull;                                                                              \
+  }
+
+DEFINE_SUM_KERNEL(sumKernel_i8, int8_t, int64_t)
+DEFINE_SUM_KERNEL(sumKernel_i16, int16_t, int64_t)
+DEFINE_SUM_KERNEL(sumKernel_i32, int32_t, int64_t)
+DEFINE_SUM_KERNEL(sumKernel_i64, int64_t, int64_t)
+DEFINE_SUM_KERNEL(sumKernel_float, float, double)
+DEFINE_SUM_KERNEL(sumKernel_double, double, double)
+
+DEFINE_MINMAX_KERNEL(minKernel_i8, int8_t, INT8_MAX, <)
+DEFINE_MINMAX_KERNEL(minKernel_i16, int16_t, INT16_MAX, <)
+DEFINE_MINMAX_KERNEL(minKernel_i32, int32_t, INT32_MAX, <)
+DEFINE_MINMAX_KERNEL(minKernel_i64, int64_t, INT64_MAX, <)
+DEFINE_MINMAX_KERNEL(minKernel_float, float, FLT_MAX, <)
+DEFINE_MINMAX_KERNEL(minKernel_double, double, DBL_MAX, <)
+
+DEFINE_MINMAX_KERNEL(maxKernel_i8, int8_t, INT8_MIN, >)
+DEFINE_MINMAX_KERNEL(maxKernel_i16, int16_t, INT16_MIN, >)
+DEFINE_MINMAX_KERNEL(maxKernel_i32, int32_t, INT32_MIN, >)
+DEFINE_MINMAX_KERNEL(maxKernel_i64, int64_t, INT64_MIN, >)
+DEFINE_MINMAX_KERNEL(maxKernel_float, float, -FLT_MAX, >)
+DEFINE_MINMAX_KERNEL(maxKernel_double, double, -DBL_MAX, >)
+
+// indexed by data type, from TSDB_DATA_TYPE_NULL to TSDB_DATA_TYPE_DOUBLE
+static __agg_kernel_fn_t sumKernels[] = {
+    NULL, NULL, sumKernel_i8, sumKernel_i16, sumKernel_i32, sumKernel_i64, sumKernel_float, sumKernel_double,
+};
+
+static __agg_kernel_fn_t minKernels[] = {
+    NULL, NULL, minKernel_i8, minKernel_i16, minKernel_i32, minKernel_i64, minKernel_float, minKernel_double,
+};
+
+static __agg_kernel_fn_t maxKernels[] = {
+    NULL, NULL, maxKernel_i8, maxKernel_i16, maxKernel_i32, maxKernel_i64, maxKernel_float, maxKernel_double,
+};
+
+__agg_kernel_fn_t qGetSumKernel(int16_t type) {
+  return (type >= TSDB_DATA_TYPE_TINYINT && type <= TSDB_DATA_TYPE_DOUBLE) ? sumKernels[type] : NULL;
+}
+
+__agg_kernel_fn_t qGetMinKernel(int16_t type) {
+  return (type >= TSDB_DATA_TYPE_TINYINT && type <= TSDB_DATA_TYPE_DOUBLE) ? minKernels[type] : NULL;
+}
+
+__agg_kernel_fn_t qGetMaxKernel(int16_t type) {
+  return (type >= TSDB_DATA_TYPE_TINYINT && type <= TSDB_DATA_TYPE_DOUBLE) ? maxKernels[type] : NULL;
+}
+
+#define LOCATE_VALUE(_type)                                                                      \
+  do {                                                                                           \
+    const _type *_p = (const _type *)pData;                                                      \
+    _type        _v = *(const _type *)pVal;                                                      \
+    for (int32_t _i = 0; _i < numOfRows; ++_i) {                                                 \
+      int32_t _j = lastOne ? numOfRows - 1 - _i : _i;                                            \
+      if (_p[_j] == _v && (pNullBitmap == NULL || !QAGG_IS_NULL_BIT(pNullBitmap, _j + bitOffset))) { \
+        return _j;                                                                               \
+      }                                                                                          \
+    }                                                                                            \
+  } while (0)
+
+int32_t qLocateValue(const void *pData, int32_t numOfRows, const uint8_t *pNullBitmap, int32_t bitOffset, int16_t type,
+                     const void *pVal, bool lastOne) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:  LOCATE_VALUE(int8_t);  break;
+    case TSDB_DATA_TYPE_SMALLINT: LOCATE_VALUE(int16_t); break;
+    case TSDB_DATA_TYPE_INT:      LOCATE_VALUE(int32_t); break;
+    case TSDB_DATA_TYPE_BIGINT:   LOCATE_VALUE(int64_t); break;
+    case TSDB_DATA_TYPE_FLOAT:    LOCATE_VALUE(float);   break;
+    case TSDB_DATA_TYPE_DOUBLE:   LOCATE_VALUE(double);  break;
+    default:;
+  }
+
+  return -1;
+}
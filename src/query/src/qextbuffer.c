@@ -18,6 +18,8 @@
 #include "taos.h"
 #include "taosdef.h"
 #include "taosmsg.h"
+#include "tlosertree.h"
+#include "tscompression.h"
 #include "tsqlfunction.h"
 #include "ttime.h"
 #include "tutil.h"
@@ -26,6 +28,12 @@
 #define COLMODEL_GET_VAL(data, schema, allrow, rowId, colId) \
   (data + (schema)->pFields[colId].offset * (allrow) + (rowId) * (schema)->pFields[colId].field.bytes)
 
+// the minimum number of rows sorted by radix sort, the short array is sorted by quick sort
+#define RADIX_SORT_THRESHOLD 256
+
+// the page is compressed by LZ4 with one byte of indicator, which may be a little larger than the page
+#define COMP_PAGE_BUFFER_SIZE(_size) ((_size) + (_size) / 255 + 16 + 1)
+
 /*
  * SColumnModel is deeply copy
  */
@@ -54,10 +62,26 @@ tExtMemBuffer* createExtMemBuffer(int32_t inMemSize, int32_t elemSize, SColumnMo
 
   pMemBuffer->pColumnModel = cloneColumnModel(pModel);
   pMemBuffer->pColumnModel->capacity = pMemBuffer->numOfElemsPerPage;
+
+  pMemBuffer->pSealedPages = taosArrayInit(4, POINTER_BYTES);
+
+  int64_t offset = 0;
+  pMemBuffer->pPageOffset = taosArrayInit(4, sizeof(int64_t));
+  taosArrayPush(pMemBuffer->pPageOffset, &offset);
   
   return pMemBuffer;
 }
 
+static void releaseSealedPages(tExtMemBuffer *pMemBuffer) {
+  size_t numOfPages = taosArrayGetSize(pMemBuffer->pSealedPages);
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePagesItem *pItem = taosArrayGetP(pMemBuffer->pSealedPages, i);
+    tfree(pItem);
+  }
+
+  pMemBuffer->pSealedPages->size = 0;
+}
+
 void* destoryExtMemBuffer(tExtMemBuffer *pMemBuffer) {
   if (pMemBuffer == NULL) {
     return NULL;
@@ -77,6 +101,9 @@ void* destoryExtMemBuffer(tExtMemBuffer *pMemBuffer) {
     tfree(pTmp);
   }
 
+  releaseSealedPages(pMemBuffer);
+  taosArrayDestroy(pMemBuffer->pSealedPages);
+
   // close temp file
   if (pMemBuffer->file != 0) {
     if (fclose(pMemBuffer->file) != 0) {
@@ -88,7 +115,9 @@ void* destoryExtMemBuffer(tExtMemBuffer *pMemBuffer) {
   }
 
   destroyColumnModel(pMemBuffer->pColumnModel);
+  taosArrayDestroy(pMemBuffer->pPageOffset);
 
+  tfree(pMemBuffer->pCompBuffer);
   tfree(pMemBuffer->path);
   tfree(pMemBuffer);
   
@@ -117,7 +146,8 @@ static bool tExtMemBufferAlloc(tExtMemBuffer *pMemBuffer) {
    * the in-mem buffer is full.
    * To flush data to disk to accommodate more data
    */
-  if (pMemBuffer->numOfInMemPages > 0 && pMemBuffer->numOfInMemPages == pMemBuffer->inMemCapacity) {
+  int32_t numOfPages = pMemBuffer->numOfInMemPages + (int32_t)taosArrayGetSize(pMemBuffer->pSealedPages);
+  if (numOfPages > 0 && numOfPages >= pMemBuffer->inMemCapacity) {
     if (!tExtMemBufferFlush(pMemBuffer)) {
       return false;
     }
@@ -245,6 +275,51 @@ static void tExtMemBufferClearFlushoutInfo(tExtMemBuffer *pMemBuffer) {
   memset(pFileMeta->flushoutData.pFlushoutInfo, 0, sizeof(tFlushoutInfo) * pFileMeta->flushoutData.nAllocSize);
 }
 
+/*
+ * the page is compressed before written into file, so the offset of each page in file is recorded
+ */
+static bool tExtMemBufferWritePage(tExtMemBuffer *pMemBuffer, tFilePage *pPage) {
+  int32_t len = tsCompressString((char *)pPage, pMemBuffer->pageSize, 1, pMemBuffer->pCompBuffer,
+                                 COMP_PAGE_BUFFER_SIZE(pMemBuffer->pageSize), ONE_STAGE_COMP, NULL, 0);
+
+  size_t retVal = fwrite(pMemBuffer->pCompBuffer, len, 1, pMemBuffer->file);
+
+  size_t  numOfPages = taosArrayGetSize(pMemBuffer->pPageOffset);
+  int64_t offset = *(int64_t *)taosArrayGet(pMemBuffer->pPageOffset, numOfPages - 1) + len;
+  taosArrayPush(pMemBuffer->pPageOffset, &offset);
+
+  pMemBuffer->fileMeta.numOfElemsInFile += pPage->numOfElems;
+  pMemBuffer->fileMeta.nFileSize += 1;
+
+  return (retVal > 0);
+}
+
+/*
+ * the sealed pages are always in front of the pages in file, so they are written into file in the order of page id
+ * before any other pages
+ */
+static bool tExtMemBufferSpillSealedPages(tExtMemBuffer *pMemBuffer) {
+  size_t numOfPages = taosArrayGetSize(pMemBuffer->pSealedPages);
+  if (numOfPages == 0) {
+    return true;
+  }
+
+  assert(pMemBuffer->fileMeta.nFileSize == 0);
+
+  bool ret = true;
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePagesItem *pItem = taosArrayGetP(pMemBuffer->pSealedPages, i);
+    if (!tExtMemBufferWritePage(pMemBuffer, &pItem->item)) {
+      ret = false;
+    }
+  }
+
+  uTrace("%d sealed pages are spilled to file:%s", (int32_t)numOfPages, pMemBuffer->path);
+
+  releaseSealedPages(pMemBuffer);
+  return ret;
+}
+
 bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
   if (pMemBuffer->numOfTotalElems == 0) {
     return true;
@@ -254,6 +329,15 @@ bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
     if ((pMemBuffer->file = fopen(pMemBuffer->path, "wb+")) == NULL) {
       return false;
     }
+
+    pMemBuffer->pCompBuffer = malloc(COMP_PAGE_BUFFER_SIZE(pMemBuffer->pageSize));
+    if (pMemBuffer->pCompBuffer == NULL) {
+      return false;
+    }
+  }
+
+  if (!tExtMemBufferSpillSealedPages(pMemBuffer)) {
+    return false;
   }
 
   /* all data has been flushed to disk, ignore flush operation */
@@ -266,14 +350,10 @@ bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
   tFilePagesItem *first = pMemBuffer->pHead;
 
   while (first != NULL) {
-    size_t retVal = fwrite((char *)&(first->item), pMemBuffer->pageSize, 1, pMemBuffer->file);
-    if (retVal <= 0) {  // failed to write to buffer, may be not enough space
+    if (!tExtMemBufferWritePage(pMemBuffer, &first->item)) {  // failed to write to buffer, may be not enough space
       ret = false;
     }
 
-    pMemBuffer->fileMeta.numOfElemsInFile += first->item.numOfElems;
-    pMemBuffer->fileMeta.nFileSize += 1;
-
     tFilePagesItem *ptmp = first;
     first = first->pNext;
 
@@ -292,6 +372,35 @@ bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
   return ret;
 }
 
+bool tExtMemBufferSeal(tExtMemBuffer *pMemBuffer) {
+  if (pMemBuffer->numOfElemsInBuffer == 0) {
+    return true;
+  }
+
+  // once data are flushed to disk, keep the following groups in file too
+  size_t numOfSealed = taosArrayGetSize(pMemBuffer->pSealedPages);
+  if (pMemBuffer->fileMeta.nFileSize > 0 || numOfSealed + pMemBuffer->numOfInMemPages > pMemBuffer->inMemCapacity) {
+    return tExtMemBufferFlush(pMemBuffer);
+  }
+
+  tFilePagesItem *first = pMemBuffer->pHead;
+  while (first != NULL) {
+    taosArrayPush(pMemBuffer->pSealedPages, &first);
+    first = first->pNext;
+  }
+
+  if (!tExtMemBufferUpdateFlushoutInfo(pMemBuffer)) {
+    return false;
+  }
+
+  pMemBuffer->numOfElemsInBuffer = 0;
+  pMemBuffer->numOfInMemPages = 0;
+  pMemBuffer->pHead = NULL;
+  pMemBuffer->pTail = NULL;
+
+  return true;
+}
+
 void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
   if (pMemBuffer == NULL || pMemBuffer->numOfTotalElems == 0) {
     return;
@@ -305,6 +414,8 @@ void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
     tfree(ptmp);
   }
 
+  releaseSealedPages(pMemBuffer);
+
   pMemBuffer->fileMeta.numOfElemsInFile = 0;
   pMemBuffer->fileMeta.nFileSize = 0;
 
@@ -316,6 +427,9 @@ void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
 
   tExtMemBufferClearFlushoutInfo(pMemBuffer);
 
+  // only the offset of the first page is kept
+  pMemBuffer->pPageOffset->size = 1;
+
   // reset the write pointer to the header
   if (pMemBuffer->file != NULL) {
     fseek(pMemBuffer->file, 0, SEEK_SET);
@@ -332,14 +446,238 @@ bool tExtMemBufferLoadData(tExtMemBuffer *pMemBuffer, tFilePage *pFilePage, int3
     return false;
   }
 
-  size_t ret = fseek(pMemBuffer->file, (pInfo->startPageId + pageIdx) * pMemBuffer->pageSize, SEEK_SET);
-  ret = fread(pFilePage, pMemBuffer->pageSize, 1, pMemBuffer->file);
+  // the page of sealed groups is still in memory
+  uint32_t pageId = pInfo->startPageId + pageIdx;
+  if (pageId < taosArrayGetSize(pMemBuffer->pSealedPages)) {
+    tFilePagesItem *pItem = taosArrayGetP(pMemBuffer->pSealedPages, pageId);
+    memcpy(pFilePage, &pItem->item, pMemBuffer->pageSize);
+    return true;
+  }
+
+  if (pMemBuffer->file == NULL || pageId + 1 >= taosArrayGetSize(pMemBuffer->pPageOffset)) {
+    return false;
+  }
 
-  return (ret > 0);
+  int64_t offset = *(int64_t *)taosArrayGet(pMemBuffer->pPageOffset, pageId);
+  int32_t len = (int32_t)(*(int64_t *)taosArrayGet(pMemBuffer->pPageOffset, pageId + 1) - offset);
+
+  if (fseek(pMemBuffer->file, offset, SEEK_SET) != 0 || fread(pMemBuffer->pCompBuffer, len, 1, pMemBuffer->file) <= 0) {
+    uError("failed to read page:%d from file:%s, reason:%s", pageId, pMemBuffer->path, strerror(errno));
+    return false;
+  }
+
+  tsDecompressString(pMemBuffer->pCompBuffer, len, 1, (char *)pFilePage, pMemBuffer->pageSize, ONE_STAGE_COMP, NULL, 0);
+  return true;
 }
 
 bool tExtMemBufferIsAllDataInMem(tExtMemBuffer *pMemBuffer) { return (pMemBuffer->fileMeta.nFileSize == 0); }
 
+typedef struct SMergeGroupSource {
+  tExtMemBuffer *pMemBuffer;
+  int32_t        flushoutIdx;
+  int32_t        pageId;
+  int32_t        rowIdx;
+  tFilePage *    pPage;
+} SMergeGroupSource;
+
+typedef struct SMergeGroupParam {
+  SMergeGroupSource *pSource;
+  tOrderDescriptor * pDesc;
+  int32_t            numOfElems;
+  int32_t            orderType;
+} SMergeGroupParam;
+
+static int32_t mergeGroupComparator(const void *pLeft, const void *pRight, void *param) {
+  SMergeGroupParam * pParam = (SMergeGroupParam *)param;
+  SMergeGroupSource *pLeftSrc = &pParam->pSource[*(int32_t *)pLeft];
+  SMergeGroupSource *pRightSrc = &pParam->pSource[*(int32_t *)pRight];
+
+  // the exhausted source is always the loser
+  if (pLeftSrc->rowIdx == -1) {
+    return 1;
+  }
+
+  if (pRightSrc->rowIdx == -1) {
+    return -1;
+  }
+
+  if (pParam->orderType == TSDB_ORDER_DESC) {
+    return compare_d(pParam->pDesc, pParam->numOfElems, pLeftSrc->rowIdx, pLeftSrc->pPage->data, pParam->numOfElems,
+                     pRightSrc->rowIdx, pRightSrc->pPage->data);
+  } else {
+    return compare_a(pParam->pDesc, pParam->numOfElems, pLeftSrc->rowIdx, pLeftSrc->pPage->data, pParam->numOfElems,
+                     pRightSrc->rowIdx, pRightSrc->pPage->data);
+  }
+}
+
+/*
+ * load the next page of the source, and the source is exhausted if no more pages in current group
+ */
+static bool mergeGroupLoadNextPage(SMergeGroupSource *pSource) {
+  tFlushoutInfo *pInfo = &pSource->pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[pSource->flushoutIdx];
+
+  pSource->rowIdx = -1;
+  pSource->pageId += 1;
+
+  for (; pSource->pageId < pInfo->numOfPages; ++pSource->pageId) {
+    if (!tExtMemBufferLoadData(pSource->pMemBuffer, pSource->pPage, pSource->flushoutIdx, pSource->pageId)) {
+      return false;
+    }
+
+    if (pSource->pPage->numOfElems > 0) {
+      pSource->rowIdx = 0;
+      break;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * merge the groups of sources into one group of a new buffer by the loser tree, and the rows are written in pages
+ * of the new buffer, which are flushed to disk when the in-memory pages of it are full.
+ */
+static tExtMemBuffer *mergeGroupsIntoBuffer(SMergeGroupSource *pSource, int32_t numOfSources, tOrderDescriptor *pDesc,
+                                            int32_t orderType) {
+  tExtMemBuffer *pInput = pSource[0].pMemBuffer;
+  tExtMemBuffer *pOutput =
+      createExtMemBuffer(pInput->inMemCapacity * pInput->pageSize, pInput->nElemSize, pInput->pColumnModel);
+
+  SColumnModel *   pModel = pOutput->pColumnModel;
+  tFilePage *      pPage = calloc(1, pOutput->pageSize);
+  SLoserTreeInfo * pTree = NULL;
+  SMergeGroupParam param = {.pSource = pSource, .pDesc = pDesc, .numOfElems = pInput->numOfElemsPerPage,
+                            .orderType = orderType};
+
+  bool ret = (pPage != NULL);
+  for (int32_t i = 0; i < numOfSources && ret; ++i) {
+    pSource[i].pageId = -1;
+    ret = mergeGroupLoadNextPage(&pSource[i]);
+  }
+
+  if (ret && tLoserTreeCreate(&pTree, numOfSources, &param, mergeGroupComparator) != TSDB_CODE_SUCCESS) {
+    ret = false;
+  }
+
+  while (ret) {
+    int32_t            idx = pTree->pNode[0].index;
+    SMergeGroupSource *pWinner = &pSource[idx];
+    if (pWinner->rowIdx == -1) {  // all sources are exhausted
+      break;
+    }
+
+    tColModelAppend(pModel, pPage, pWinner->pPage->data, pWinner->rowIdx, 1, pInput->numOfElemsPerPage);
+    if (pPage->numOfElems == pModel->capacity) {
+      ret = (tExtMemBufferPut(pOutput, pPage->data, pPage->numOfElems) >= 0);
+      pPage->numOfElems = 0;
+    }
+
+    pWinner->rowIdx += 1;
+    if (pWinner->rowIdx >= pWinner->pPage->numOfElems && !mergeGroupLoadNextPage(pWinner)) {
+      ret = false;
+    }
+
+    tLoserTreeAdjust(pTree, idx + pTree->numOfEntries);
+  }
+
+  if (ret && pPage->numOfElems > 0) {
+    tColModelCompact(pModel, pPage, pModel->capacity);
+    ret = (tExtMemBufferPut(pOutput, pPage->data, pPage->numOfElems) >= 0);
+  }
+
+  if (ret) {
+    ret = tExtMemBufferFlush(pOutput);
+  }
+
+  tfree(pTree);
+  tfree(pPage);
+
+  if (!ret) {
+    uError("failed to merge %d groups into file:%s", numOfSources, pOutput->path);
+    pOutput = destoryExtMemBuffer(pOutput);
+  }
+
+  return pOutput;
+}
+
+int32_t tExtMemBufferMergeGroups(tExtMemBuffer ***pMemBuffer, int32_t numOfBuffer, tOrderDescriptor *pDesc,
+                                 int32_t orderType, int32_t maxNumOfGroups) {
+  assert(maxNumOfGroups >= 2);
+
+  while (1) {
+    tExtMemBuffer **pBuffer = *pMemBuffer;
+
+    int32_t numOfGroups = 0;
+    for (int32_t i = 0; i < numOfBuffer; ++i) {
+      numOfGroups += pBuffer[i]->fileMeta.flushoutData.nLength;
+    }
+
+    if (numOfGroups <= maxNumOfGroups) {
+      return numOfBuffer;
+    }
+
+    // each pass merges every maxNumOfGroups groups into one group
+    int32_t            numOfOutput = (numOfGroups + maxNumOfGroups - 1) / maxNumOfGroups;
+    tExtMemBuffer **   pOutput = calloc(numOfOutput, POINTER_BYTES);
+    SMergeGroupSource *pSource = calloc(maxNumOfGroups, sizeof(SMergeGroupSource));
+    tFilePage *        pPages = calloc(maxNumOfGroups, pBuffer[0]->pageSize);
+    if (pOutput == NULL || pSource == NULL || pPages == NULL) {
+      tfree(pOutput);
+      tfree(pSource);
+      tfree(pPages);
+      return -1;
+    }
+
+    uTrace("merge %d groups of %d buffers into %d groups", numOfGroups, numOfBuffer, numOfOutput);
+
+    int32_t numOfSources = 0;
+    int32_t numOfMerged = 0;
+
+    bool ret = true;
+    for (int32_t i = 0; i < numOfBuffer && ret; ++i) {
+      for (int32_t j = 0; j < pBuffer[i]->fileMeta.flushoutData.nLength && ret; ++j) {
+        SMergeGroupSource *pSrc = &pSource[numOfSources];
+
+        pSrc->pMemBuffer = pBuffer[i];
+        pSrc->flushoutIdx = j;
+        pSrc->pPage = (tFilePage *)((char *)pPages + numOfSources * pBuffer[0]->pageSize);
+        numOfSources += 1;
+
+        bool lastGroup = (i == numOfBuffer - 1) && (j == pBuffer[i]->fileMeta.flushoutData.nLength - 1);
+        if (numOfSources == maxNumOfGroups || lastGroup) {
+          pOutput[numOfMerged] = mergeGroupsIntoBuffer(pSource, numOfSources, pDesc, orderType);
+          ret = (pOutput[numOfMerged] != NULL);
+
+          numOfMerged += 1;
+          numOfSources = 0;
+        }
+      }
+    }
+
+    tfree(pSource);
+    tfree(pPages);
+
+    if (!ret) {
+      for (int32_t i = 0; i < numOfMerged; ++i) {
+        destoryExtMemBuffer(pOutput[i]);
+      }
+
+      tfree(pOutput);
+      return -1;
+    }
+
+    assert(numOfMerged == numOfOutput);
+    for (int32_t i = 0; i < numOfBuffer; ++i) {
+      destoryExtMemBuffer(pBuffer[i]);
+    }
+
+    tfree(pBuffer);
+
+    *pMemBuffer = pOutput;
+    numOfBuffer = numOfOutput;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 static FORCE_INLINE int32_t primaryKeyComparator(int64_t f1, int64_t f2, int32_t colIdx, int32_t tsOrder) {
   if (f1 == f2) {
@@ -624,10 +962,152 @@ static UNUSED_FUNC void tRowModelDisplay(tOrderDescriptor *pDescriptor, int32_t
   printf("\n");
 }
 
+typedef struct SRadixSortElem {
+  uint64_t key;
+  int32_t  index;
+} SRadixSortElem;
+
+/*
+ * map the signed integer to unsigned key with the same order, and reverse the order for descending sort
+ */
+static FORCE_INLINE uint64_t radixSortKey(char *val, int32_t type, bool desc) {
+  int64_t v = 0;
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:   v = *(int8_t *)val;  break;
+    case TSDB_DATA_TYPE_SMALLINT:  v = *(int16_t *)val; break;
+    case TSDB_DATA_TYPE_INT:       v = *(int32_t *)val; break;
+    default:                       v = *(int64_t *)val; break;
+  }
+
+  uint64_t key = ((uint64_t)v) ^ (1ULL << 63u);
+  return desc ? ~key : key;
+}
+
+/*
+ * Least significant digit radix sort for data that is ordered by one integer or timestamp column, which takes
+ * O(n) time instead of O(nlogn) comparisons of the quick sort. The sort is applied to the row index first, and each
+ * column is moved to its final position only once. The pass is skipped if all keys have the same value in the digit.
+ *
+ * return false if the order descriptor is not applicable or out of memory, and quick sort is used instead.
+ */
+static bool tColDataRadixSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end, char *data,
+                              int32_t orderType) {
+  SColumnModel *pModel = pDescriptor->pColumnModel;
+  if (pDescriptor->orderIdx.numOfCols != 1) {
+    return false;
+  }
+
+  int32_t colIdx = pDescriptor->orderIdx.pData[0];
+  int32_t type = pModel->pFields[colIdx].field.type;
+  if (type != TSDB_DATA_TYPE_BOOL && type != TSDB_DATA_TYPE_TINYINT && type != TSDB_DATA_TYPE_SMALLINT &&
+      type != TSDB_DATA_TYPE_INT && type != TSDB_DATA_TYPE_BIGINT && type != TSDB_DATA_TYPE_TIMESTAMP) {
+    return false;
+  }
+
+  // the same order as the comparator of compare_sa/compare_sd
+  bool desc = false;
+  if (type == TSDB_DATA_TYPE_TIMESTAMP) {
+    desc = (colIdx == 0 && pDescriptor->tsOrder == TSDB_ORDER_DESC);
+  } else {
+    desc = (orderType == TSDB_ORDER_DESC);
+  }
+
+  int32_t         num = end - start + 1;
+  SRadixSortElem *pElem = malloc(sizeof(SRadixSortElem) * num * 2);
+  if (pElem == NULL) {
+    return false;
+  }
+
+  SRadixSortElem *pSrc = pElem;
+  SRadixSortElem *pDst = pElem + num;
+
+  for (int32_t i = 0; i < num; ++i) {
+    pSrc[i].key = radixSortKey(COLMODEL_GET_VAL(data, pModel, numOfRows, start + i, colIdx), type, desc);
+    pSrc[i].index = start + i;
+  }
+
+  // the high bytes of key are sign extended from the value, so only the low bytes and the sign bit are significant
+  int32_t bytes = pModel->pFields[colIdx].field.bytes;
+  for (int32_t shift = 0; shift < bytes * 8; shift += 8) {
+    int32_t count[256] = {0};
+    for (int32_t i = 0; i < num; ++i) {
+      count[(pSrc[i].key >> shift) & 0xFF] += 1;
+    }
+
+    if (count[(pSrc[0].key >> shift) & 0xFF] == num) {
+      continue;
+    }
+
+    int32_t offset = 0;
+    for (int32_t j = 0; j < 256; ++j) {
+      int32_t c = count[j];
+      count[j] = offset;
+      offset += c;
+    }
+
+    for (int32_t i = 0; i < num; ++i) {
+      pDst[count[(pSrc[i].key >> shift) & 0xFF]++] = pSrc[i];
+    }
+
+    SRadixSortElem *pTmp = pSrc;
+    pSrc = pDst;
+    pDst = pTmp;
+  }
+
+  if (bytes < sizeof(int64_t)) {
+    // one more pass on the sign bit for the types that are narrower than 64 bits
+    int32_t count[2] = {0};
+    for (int32_t i = 0; i < num; ++i) {
+      count[pSrc[i].key >> 63u] += 1;
+    }
+
+    if (count[0] != num && count[1] != num) {
+      int32_t pos[2] = {0, count[0]};
+      for (int32_t i = 0; i < num; ++i) {
+        pDst[pos[pSrc[i].key >> 63u]++] = pSrc[i];
+      }
+
+      SRadixSortElem *pTmp = pSrc;
+      pSrc = pDst;
+      pDst = pTmp;
+    }
+  }
+
+  // move the data of each column according to the sorted row index
+  int32_t maxBytes = 0;
+  for (int32_t i = 0; i < pModel->numOfCols; ++i) {
+    maxBytes = MAX(maxBytes, pModel->pFields[i].field.bytes);
+  }
+
+  char *buf = malloc((size_t)maxBytes * num);
+  if (buf == NULL) {
+    free(pElem);
+    return false;
+  }
+
+  for (int32_t i = 0; i < pModel->numOfCols; ++i) {
+    int32_t colBytes = pModel->pFields[i].field.bytes;
+    for (int32_t j = 0; j < num; ++j) {
+      memcpy(buf + j * colBytes, COLMODEL_GET_VAL(data, pModel, numOfRows, pSrc[j].index, i), colBytes);
+    }
+
+    memcpy(COLMODEL_GET_VAL(data, pModel, numOfRows, start, i), buf, (size_t)colBytes * num);
+  }
+
+  free(buf);
+  free(pElem);
+  return true;
+}
+
 static int32_t qsort_call = 0;
 
 void tColDataQSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end, char *data,
                    int32_t orderType) {
+  if (end - start + 1 >= RADIX_SORT_THRESHOLD && tColDataRadixSort(pDescriptor, numOfRows, start, end, data, orderType)) {
+    return;
+  }
+
   // short array sort, incur another sort procedure instead of quick sort process
   __col_compar_fn_t compareFn = (orderType == TSDB_ORDER_ASC) ? compare_sa : compare_sd;
 
@@ -58,11 +58,8 @@ static tFilePage *loadIntoBucketFromDisk(tMemBucket *pMemBucket, int32_t segIdx,
     for (int32_t i = 0; i < pMemBuffer->fileMeta.flushoutData.nLength; ++i) {
       tFlushoutInfo *pFlushInfo = &pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[i];
       
-      int32_t ret = fseek(pMemBuffer->file, pFlushInfo->startPageId * pMemBuffer->pageSize, SEEK_SET);
-      UNUSED(ret);
-      
       for (uint32_t j = 0; j < pFlushInfo->numOfPages; ++j) {
-        ret = fread(pPage, pMemBuffer->pageSize, 1, pMemBuffer->file);
+        bool ret = tExtMemBufferLoadData(pMemBuffer, pPage, i, j);
         UNUSED(ret);
         assert(pPage->numOfElems > 0);
         
@@ -875,11 +872,8 @@ double getPercentileImpl(tMemBucket *pMemBucket, int32_t count, double fraction)
           tFlushoutInfo *pFlushInfo = &pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[0];
           assert(pFlushInfo->numOfPages == pMemBuffer->fileMeta.nFileSize);
 
-          int32_t ret = fseek(pMemBuffer->file, pFlushInfo->startPageId * pMemBuffer->pageSize, SEEK_SET);
-          UNUSED(ret);
-
           for (uint32_t jx = 0; jx < pFlushInfo->numOfPages; ++jx) {
-            ret = fread(pPage, pMemBuffer->pageSize, 1, pMemBuffer->file);
+            bool ret = tExtMemBufferLoadData(pMemBuffer, pPage, 0, jx);
             UNUSED(ret);
             tMemBucketPut(pMemBucket, pPage->data, pPage->numOfElems);
           }
@@ -888,6 +882,8 @@ double getPercentileImpl(tMemBucket *pMemBucket, int32_t count, double fraction)
           if (unlink(pMemBuffer->path) != 0) {
             uError("MemBucket:%p, remove tmp file %s failed", pMemBucket, pMemBuffer->path);
           }
+          taosArrayDestroy(pMemBuffer->pPageOffset);
+          tfree(pMemBuffer->pCompBuffer);
           tfree(pMemBuffer);
           tfree(pPage);
 
@@ -966,8 +962,7 @@ char *getFirstElemOfMemBuffer(tMemBucketSegment *pSeg, int32_t slotIdx, tFilePag
     tFlushoutInfo *pFlushInfo = &pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[0];
     assert(pFlushInfo->numOfPages == pMemBuffer->fileMeta.nFileSize);
 
-    fseek(pMemBuffer->file, pFlushInfo->startPageId * pMemBuffer->pageSize, SEEK_SET);
-    size_t ret = fread(pPage, pMemBuffer->pageSize, 1, pMemBuffer->file);
+    bool ret = tExtMemBufferLoadData(pMemBuffer, pPage, 0, 0);
     UNUSED(ret);
     thisVal = pPage->data;
   }
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+
+#include "qtdigest.h"
+
+/**
+ *
+ * implement the merging t-digest based on the paper:
+ * Ted Dunning, Otmar Ertl. Computing Extremely Accurate Quantiles Using t-Digests
+ * https://arxiv.org/abs/1902.04023
+ *
+ * The scale function k1 is used, so the centroids near the tails are much smaller than those in the middle, which
+ * gives accurate results for the extreme quantiles like p99 and p999.
+ *
+ */
+
+static int tdigestCompareCentroid(const void *pLeft, const void *pRight) {
+  double left = ((SCentroid *)pLeft)->mean;
+  double right = ((SCentroid *)pRight)->mean;
+
+  if (left == right) return 0;
+  return (left < right) ? -1 : 1;
+}
+
+// k1(q) = compression / (2 * PI) * asin(2q - 1), which is in range [-compression/4, compression/4]
+static double tdigestScale(double compression, double q) {
+  return compression / (2 * M_PI) * asin(2 * q - 1);
+}
+
+static double tdigestScaleInverse(double compression, double k) {
+  if (k >= compression / 4) return 1;
+  return (sin(k * (2 * M_PI) / compression) + 1) / 2;
+}
+
+STDigest *tdigestCreate(int32_t compression) {
+  void *pBuf = malloc(TDIGEST_SIZE(compression));
+  if (pBuf == NULL) return NULL;
+
+  return tdigestCreateFrom(pBuf, compression);
+}
+
+STDigest *tdigestCreateFrom(void *pBuf, int32_t compression) {
+  STDigest *pDigest = (STDigest *)pBuf;
+  memset(pDigest, 0, sizeof(STDigest));
+
+  pDigest->compression = compression;
+  pDigest->numOfSlots = TDIGEST_SLOTS(compression);
+  pDigest->min = DBL_MAX;
+  pDigest->max = -DBL_MAX;
+
+  return pDigest;
+}
+
+void tdigestDestroy(STDigest *pDigest) { free(pDigest); }
+
+/*
+ * Sort the centroids and the buffered points together, and merge the adjacent ones from left to right as long as the
+ * merged centroid spans no more than one unit of k. The merge is done in place, since the number of the merged
+ * centroids never exceeds the number of those have been read.
+ */
+void tdigestCompress(STDigest *pDigest) {
+  if (pDigest->numOfBuffered == 0) return;
+
+  int32_t    num = pDigest->numOfCentroids + pDigest->numOfBuffered;
+  SCentroid *pSlots = pDigest->slots;
+  double     total = (double)pDigest->totalWeight;
+
+  qsort(pSlots, num, sizeof(SCentroid), tdigestCompareCentroid);
+
+  int32_t cur = 0;
+  double  weightSoFar = 0;
+  double  weightLimit = total * tdigestScaleInverse(pDigest->compression, tdigestScale(pDigest->compression, 0) + 1);
+
+  for (int32_t i = 1; i < num; ++i) {
+    SCentroid *pCur = &pSlots[cur];
+    int64_t    weight = pCur->weight + pSlots[i].weight;
+
+    if (weightSoFar + weight <= weightLimit) {
+      pCur->mean += (pSlots[i].mean - pCur->mean) * pSlots[i].weight / weight;
+      pCur->weight = weight;
+    } else {
+      weightSoFar += pCur->weight;
+
+      double k = tdigestScale(pDigest->compression, weightSoFar / total);
+      weightLimit = total * tdigestScaleInverse(pDigest->compression, k + 1);
+
+      pSlots[++cur] = pSlots[i];
+    }
+  }
+
+  pDigest->numOfCentroids = cur + 1;
+  pDigest->numOfBuffered = 0;
+}
+
+void tdigestAdd(STDigest *pDigest, double val, int64_t weight) {
+  if (weight <= 0 || isnan(val)) return;
+
+  if (pDigest->numOfCentroids + pDigest->numOfBuffered >= pDigest->numOfSlots) {
+    tdigestCompress(pDigest);
+  }
+
+  SCentroid *pPoint = &pDigest->slots[pDigest->numOfCentroids + pDigest->numOfBuffered];
+  pPoint->mean = val;
+  pPoint->weight = weight;
+
+  pDigest->numOfBuffered += 1;
+  pDigest->totalWeight += weight;
+
+  if (val < pDigest->min) pDigest->min = val;
+  if (val > pDigest->max) pDigest->max = val;
+}
+
+/*
+ * Each centroid of the other digest is added as a weighted point, so the merged digest is the same as the one built
+ * from all the points with the same accuracy bound, no matter in which order the digests are merged.
+ */
+void tdigestMerge(STDigest *pDigest, STDigest *pOther) {
+  int32_t num = pOther->numOfCentroids + pOther->numOfBuffered;
+  if (num == 0) return;
+
+  for (int32_t i = 0; i < num; ++i) {
+    tdigestAdd(pDigest, pOther->slots[i].mean, pOther->slots[i].weight);
+  }
+
+  // the mean of a centroid is not the extreme value it contains unless its weight is 1
+  if (pOther->min < pDigest->min) pDigest->min = pOther->min;
+  if (pOther->max > pDigest->max) pDigest->max = pOther->max;
+}
+
+static double tdigestWeightedAverage(double x1, double w1, double x2, double w2) {
+  if (x1 > x2) {
+    double t = x1;
+    x1 = x2;
+    x2 = t;
+    t = w1;
+    w1 = w2;
+    w2 = t;
+  }
+
+  double x = (x1 * w1 + x2 * w2) / (w1 + w2);
+  return MAX(x1, MIN(x, x2));
+}
+
+/*
+ * The quantile q is in range [0, 1]. Each centroid is assumed to spread its weight evenly around the mean, so the
+ * result is interpolated between the two centroids the q-th point falls in, and between the min/max and the centroids
+ * at the two ends. A centroid of weight 1 is an exact point and is never interpolated. NaN is returned if the digest is
+ * empty.
+ */
+double tdigestQuantile(STDigest *pDigest, double q) {
+  tdigestCompress(pDigest);
+
+  int32_t    num = pDigest->numOfCentroids;
+  SCentroid *pSlots = pDigest->slots;
+  if (num == 0) return NAN;
+
+  if (q <= 0) return pDigest->min;
+  if (q >= 1) return pDigest->max;
+
+  double total = (double)pDigest->totalWeight;
+  double index = q * total;
+
+  // the first and the last point are the min and max value
+  if (index < 1) return pDigest->min;
+  if (index > total - 1) return pDigest->max;
+
+  double first = (double)pSlots[0].weight;
+  if (first > 1 && index < first / 2) {
+    return pDigest->min + (index - 1) / (first / 2 - 1) * (pSlots[0].mean - pDigest->min);
+  }
+
+  double last = (double)pSlots[num - 1].weight;
+  if (last > 1 && total - index < last / 2) {
+    return pDigest->max - (total - index - 1) / (last / 2 - 1) * (pDigest->max - pSlots[num - 1].mean);
+  }
+
+  double weightSoFar = first / 2;
+  for (int32_t i = 0; i < num - 1; ++i) {
+    double delta = (pSlots[i].weight + pSlots[i + 1].weight) / 2.0;
+
+    if (weightSoFar + delta > index) {
+      double leftUnit = 0;
+      if (pSlots[i].weight == 1) {
+        if (index - weightSoFar < 0.5) return pSlots[i].mean;
+        leftUnit = 0.5;
+      }
+
+      double rightUnit = 0;
+      if (pSlots[i + 1].weight == 1) {
+        if (weightSoFar + delta - index <= 0.5) return pSlots[i + 1].mean;
+        rightUnit = 0.5;
+      }
+
+      double z1 = index - weightSoFar - leftUnit;
+      double z2 = weightSoFar + delta - index - rightUnit;
+      return tdigestWeightedAverage(pSlots[i].mean, z2, pSlots[i + 1].mean, z1);
+    }
+
+    weightSoFar += delta;
+  }
+
+  return pSlots[num - 1].mean;
+}
@@ -17,9 +17,13 @@
 #include "hash.h"
 #include "hashfunc.h"
 #include "taosmsg.h"
+#include "tglobal.h"
 #include "tlosertree.h"
 #include "tscompression.h"
+#include "tsched.h"
 #include "ttime.h"
+#include "tmetrics.h"
+#include "qaggkernel.h"
 #include "qast.h"
 #include "qresultBuf.h"
 #include "queryExecutor.h"
@@ -887,6 +891,64 @@ char *getDataBlocks(SQueryRuntimeEnv *pRuntimeEnv, SArithmeticSupport *sas, int3
   return dataBlock;
 }
 
+/*
+ * The null bitmap is built once for each loaded block, and shared by all time windows in this block. It is only
+ * built for the aggregate functions that run with kernels, and the functions fall back to check null values row
+ * by row if it is not available.
+ */
+static void setNullBitmap(SQueryRuntimeEnv *pRuntimeEnv, int32_t col, char *dataBlock, int32_t rows) {
+  SQuery *        pQuery = pRuntimeEnv->pQuery;
+  SQLFunctionCtx *pCtx = &pRuntimeEnv->pCtx[col];
+
+  int32_t functionId = pQuery->pSelectExpr[col].pBase.functionId;
+  if (!pCtx->hasNull || dataBlock == NULL || rows <= 0) {
+    return;
+  }
+
+  if (functionId != TSDB_FUNC_COUNT && functionId != TSDB_FUNC_SUM && functionId != TSDB_FUNC_AVG &&
+      functionId != TSDB_FUNC_MIN && functionId != TSDB_FUNC_MAX) {
+    return;
+  }
+
+  if (rows > pRuntimeEnv->nullBitmapRows) {
+    size_t   size = QAGG_NULL_BITMAP_BYTES(rows) * pQuery->numOfOutputCols;
+    uint8_t *pBuf = realloc(pRuntimeEnv->pNullBitmapBuf, size);
+    if (pBuf == NULL) {
+      return;
+    }
+
+    pRuntimeEnv->pNullBitmapBuf = pBuf;
+    pRuntimeEnv->nullBitmapRows = rows;
+  }
+
+  pCtx->pNullBitmap = pRuntimeEnv->pNullBitmapBuf + QAGG_NULL_BITMAP_BYTES(pRuntimeEnv->nullBitmapRows) * col;
+  qBuildNullBitmap(dataBlock, rows, pCtx->inputType, pCtx->inputBytes, pCtx->pNullBitmap);
+}
+
+/*
+ * A bucket of rollup has only the pre-aggregated values and no timestamp column. All of its rows are in the
+ * time window of its first key, so the timestamp column is built with the first key for each row.
+ */
+static TSKEY *getBucketPrimaryKeys(SQueryRuntimeEnv *pRuntimeEnv, SDataBlockInfo *pDataBlockInfo) {
+  int32_t rows = pDataBlockInfo->rows;
+
+  if (rows > pRuntimeEnv->bucketKeyRows) {
+    TSKEY *pKeys = realloc(pRuntimeEnv->pBucketKeys, sizeof(TSKEY) * rows);
+    if (pKeys == NULL) {
+      return NULL;
+    }
+
+    pRuntimeEnv->pBucketKeys = pKeys;
+    pRuntimeEnv->bucketKeyRows = rows;
+  }
+
+  for (int32_t i = 0; i < rows; ++i) {
+    pRuntimeEnv->pBucketKeys[i] = pDataBlockInfo->window.skey;
+  }
+
+  return pRuntimeEnv->pBucketKeys;
+}
+
 /**
  *
  * @param pRuntimeEnv
@@ -909,6 +971,13 @@ static void blockwiseApplyAllFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStati
   if (pDataBlock != NULL) {
     pColInfo = taosArrayGet(pDataBlock, 0);
     primaryKeyCol = (TSKEY *)(pColInfo->pData);
+  } else if (pStatis != NULL && isIntervalQuery(pQuery)) {
+    primaryKeyCol = getBucketPrimaryKeys(pRuntimeEnv, pDataBlockInfo);
+    if (primaryKeyCol == NULL) {
+      SQInfo *pQInfo = GET_QINFO_ADDR(pRuntimeEnv);
+      pQInfo->code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+      return;
+    }
   }
 
   pQuery->pos = QUERY_IS_ASC_QUERY(pQuery) ? 0 : pDataBlockInfo->rows - 1;
@@ -924,6 +993,7 @@ static void blockwiseApplyAllFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStati
 
     setExecParams(pQuery, &pCtx[k], dataBlock, primaryKeyCol, pDataBlockInfo->rows, functionId, tpField,
                   hasNull, &sasArray[k], pRuntimeEnv->scanFlag);
+    setNullBitmap(pRuntimeEnv, k, dataBlock, pDataBlockInfo->rows);
   }
 
   int32_t step = GET_FORWARD_DIRECTION_FACTOR(pQuery->order.order);
@@ -1175,6 +1245,7 @@ static int32_t rowwiseApplyAllFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStat
     }
 
     if (pQuery->numOfFilterCols > 0 && (!vnodeDoFilterData(pQuery, offset))) {
+      pRuntimeEnv->summary.filteredRows += 1;
       continue;
     }
 
@@ -1351,6 +1422,7 @@ void setExecParams(SQuery *pQuery, SQLFunctionCtx *pCtx, void *inputData, TSKEY
 
   pCtx->aInputElemBuf = inputData;
   pCtx->hasNull = hasNull;
+  pCtx->pNullBitmap = NULL;
 
   if (pStatis != NULL) {
     pCtx->preAggVals.isSet = true;
@@ -1388,6 +1460,10 @@ void setExecParams(SQuery *pQuery, SQLFunctionCtx *pCtx, void *inputData, TSKEY
 
   } else if (functionId == TSDB_FUNC_ARITHM) {
     pCtx->param[1].pz = param;
+  } else if (functionId == TSDB_FUNC_LAST_ROW && tsCol != NULL) {
+    // the last row is the only row in block from the handle of last rows
+    pCtx->param[0].i64Key = tsCol[size - 1];
+    pCtx->param[0].nType = TSDB_DATA_TYPE_BIGINT;
   }
 
   pCtx->startOffset = 0;
@@ -1522,6 +1598,12 @@ _error_clean:
   return TSDB_CODE_SERV_OUT_OF_MEMORY;
 }
 
+// the cost of query handle is kept in the summary of query before it is cleaned up
+static void doCleanupQueryHandle(SQueryRuntimeEnv *pRuntimeEnv, TsdbQueryHandleT pQueryHandle) {
+  tsdbGetQueryCost(pQueryHandle, &pRuntimeEnv->summary.tsdbCost);
+  tsdbCleanupQueryHandle(pQueryHandle);
+}
+
 static void teardownQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv) {
   if (pRuntimeEnv->pQuery == NULL) {
     return;
@@ -1549,6 +1631,12 @@ static void teardownQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv) {
     tfree(pRuntimeEnv->pCtx);
   }
 
+  tfree(pRuntimeEnv->pNullBitmapBuf);
+  pRuntimeEnv->nullBitmapRows = 0;
+
+  tfree(pRuntimeEnv->pBucketKeys);
+  pRuntimeEnv->bucketKeyRows = 0;
+
   taosDestoryInterpoInfo(&pRuntimeEnv->interpoInfo);
 
   if (pRuntimeEnv->pInterpoBuf != NULL) {
@@ -1560,13 +1648,18 @@ static void teardownQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv) {
   }
 
   destroyResultBuf(pRuntimeEnv->pResultBuf);
-  tsdbCleanupQueryHandle(pRuntimeEnv->pQueryHandle);
-  tsdbCleanupQueryHandle(pRuntimeEnv->pSecQueryHandle);
+  doCleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pQueryHandle);
+  doCleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pSecQueryHandle);
   
   pRuntimeEnv->pTSBuf = tsBufDestory(pRuntimeEnv->pTSBuf);
 }
 
 static bool isQueryKilled(SQInfo *pQInfo) {
+  // the part of split scan is stopped along with the query
+  if (pQInfo->pParent != NULL && pQInfo->pParent->code == TSDB_CODE_QUERY_CANCELLED) {
+    return true;
+  }
+
   return (pQInfo->code == TSDB_CODE_QUERY_CANCELLED);
 #if 0
   /*
@@ -1662,6 +1755,41 @@ bool notHasQueryTimeRange(SQuery *pQuery) {
          (pQuery->window.skey == INT64_MAX && pQuery->window.ekey == 0 && (!QUERY_IS_ASC_QUERY(pQuery)));
 }
 
+/*
+ * The interval query reads the rollups of tables instead of the data blocks in files if each time window is made up of
+ * whole buckets, and all the functions are answered by the count, sum, min and max of buckets.
+ */
+static int64_t getRollupInterval(SQueryRuntimeEnv *pRuntimeEnv, void *tsdb) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  if (!isIntervalQuery(pQuery) || pQuery->slidingTime != pQuery->intervalTime || !QUERY_IS_ASC_QUERY(pQuery) ||
+      pQuery->numOfFilterCols > 0 || pRuntimeEnv->pTSBuf != NULL || isGroupbyNormalCol(pQuery->pGroupbyExpr)) {
+    return 0;
+  }
+
+  for (int32_t i = 0; i < pQuery->numOfOutputCols; ++i) {
+    SSqlFuncExprMsg *pExprMsg = &pQuery->pSelectExpr[i].pBase;
+    int16_t          functionId = pExprMsg->functionId;
+    if (functionId == TSDB_FUNC_TS || functionId == TSDB_FUNC_TAG) {
+      continue;
+    }
+
+    if (functionId != TSDB_FUNC_COUNT && functionId != TSDB_FUNC_SUM && functionId != TSDB_FUNC_AVG &&
+        functionId != TSDB_FUNC_MIN && functionId != TSDB_FUNC_MAX) {
+      return 0;
+    }
+
+    if (TSDB_COL_IS_TAG(pExprMsg->colInfo.flag) ||
+        (functionId != TSDB_FUNC_COUNT && pExprMsg->colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX)) {
+      return 0;
+    }
+  }
+
+  int64_t start = taosGetIntervalStartTimestamp(pQuery->window.skey, pQuery->intervalTime, pQuery->slidingTimeUnit,
+                                                pQuery->precision);
+  return tsdbGetRollupInterval(tsdb, pQuery->intervalTime, start);
+}
+
 static bool needReverseScan(SQuery *pQuery) {
   for (int32_t i = 0; i < pQuery->numOfOutputCols; ++i) {
     int32_t functionId = pQuery->pSelectExpr[i].pBase.functionId;
@@ -2036,8 +2164,8 @@ void pointInterpSupporterSetData(SQInfo *pQInfo, SPointInterpoSupporter *pPointI
   SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
   SQuery *          pQuery = pRuntimeEnv->pQuery;
 
-  // not point interpolation query, abort
-  if (!isPointInterpoQuery(pQuery)) {
+  // not point interpolation query, abort. The timestamp of last row query is set when the row is applied
+  if (!isPointInterpoQuery(pQuery) || isFirstLastRowQuery(pQuery)) {
     return;
   }
 
@@ -2359,6 +2487,9 @@ SArray *loadDataBlockOnDemand(SQueryRuntimeEnv *pRuntimeEnv, SDataBlockInfo *pBl
   uint32_t r = 0;
   SArray * pDataBlock = NULL;
 
+  pRuntimeEnv->summary.totalBlocks += 1;
+  pRuntimeEnv->summary.totalRows += pBlockInfo->rows;
+
   if (pQuery->numOfFilterCols > 0) {
     r = BLK_DATA_ALL_NEEDED;
   } else {
@@ -2406,6 +2537,10 @@ SArray *loadDataBlockOnDemand(SQueryRuntimeEnv *pRuntimeEnv, SDataBlockInfo *pBl
     pDataBlock = tsdbRetrieveDataBlock(pRuntimeEnv->pQueryHandle, NULL);
   }
 
+  if (pDataBlock == NULL) {
+    pRuntimeEnv->summary.skippedBlocks += 1;
+  }
+
   return pDataBlock;
 }
 
@@ -2534,8 +2669,11 @@ static int64_t doScanAllDataBlocks(SQueryRuntimeEnv *pRuntimeEnv) {
 
     SDataStatis *pStatis = NULL;
     SArray *pDataBlock = loadDataBlockOnDemand(pRuntimeEnv, &blockInfo, &pStatis);
+
+    int64_t s = taosGetTimestampUs();
     int32_t numOfRes = tableApplyFunctionsOnBlock(pRuntimeEnv, &blockInfo, pStatis, binarySearchForKey,
                                                      &pRuntimeEnv->windowResInfo, pDataBlock);
+    pRuntimeEnv->summary.applyFunctionUs += (taosGetTimestampUs() - s);
 
     qTrace("QInfo:%p check data block, brange:%" PRId64 "-%" PRId64 ", rows:%d, res:%d",
                GET_QINFO_ADDR(pRuntimeEnv), blockInfo.window.skey, blockInfo.window.ekey, blockInfo.rows, numOfRes);
@@ -2813,6 +2951,7 @@ int32_t tableResultComparFn(const void *pLeft, const void *pRight, void *param)
 
 int32_t mergeIntoGroupResult(SQInfo *pQInfo) {
   int64_t st = taosGetTimestampMs();
+  int64_t stUs = taosGetTimestampUs();
   int32_t ret = TSDB_CODE_SUCCESS;
 
   int32_t numOfGroups = taosArrayGetSize(pQInfo->groupInfo.pGroupList);
@@ -2838,6 +2977,7 @@ int32_t mergeIntoGroupResult(SQInfo *pQInfo) {
   qTrace("QInfo:%p merge res data into group, index:%d, total group:%d, elapsed time:%lldms",
   pQInfo, pQInfo->groupIndex - 1, numOfGroups, taosGetTimestampMs() - st);
 
+  pQInfo->runtimeEnv.summary.mergeUs += (taosGetTimestampUs() - stUs);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -3387,7 +3527,7 @@ static void setEnvBeforeReverseScan(SQueryRuntimeEnv* pRuntimeEnv, SQueryStatusI
   
   // clean unused handle
   if (pRuntimeEnv->pSecQueryHandle != NULL) {
-    tsdbCleanupQueryHandle(pRuntimeEnv->pSecQueryHandle);
+    doCleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pSecQueryHandle);
   }
   
   pRuntimeEnv->pSecQueryHandle = tsdbQueryTables(pQInfo->tsdb, &cond, &pQInfo->groupInfo);
@@ -3452,7 +3592,7 @@ void scanAllDataBlocks(SQueryRuntimeEnv *pRuntimeEnv) {
     };
   
     if (pRuntimeEnv->pSecQueryHandle != NULL) {
-      tsdbCleanupQueryHandle(pRuntimeEnv->pSecQueryHandle);
+      doCleanupQueryHandle(pRuntimeEnv, pRuntimeEnv->pSecQueryHandle);
     }
     
     pRuntimeEnv->pSecQueryHandle = tsdbQueryTables(pQInfo->tsdb, &cond, &pQInfo->groupInfo);
@@ -4012,50 +4152,40 @@ int32_t vnodeQueryResultInterpolate(SQInfo *pQInfo, tFilePage **pDst, tFilePage
   return 0;
 }
 
-void vnodePrintQueryStatistics(SQInfo *pQInfo) {
-#if 0
-  SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
+static void getQueryProfile(SQInfo *pQInfo, SQueryProfileMsg *pProfile) {
+  SQueryRuntimeEnv * pRuntimeEnv = &pQInfo->runtimeEnv;
+  SQueryCostSummary *pSummary = &pRuntimeEnv->summary;
 
-  SQuery *pQuery = pRuntimeEnv->pQuery;
+  // the cost of query handles in use is added to that of the handles cleaned up
+  STsdbQueryCost cost = pSummary->tsdbCost;
+  tsdbGetQueryCost(pRuntimeEnv->pQueryHandle, &cost);
+  tsdbGetQueryCost(pRuntimeEnv->pSecQueryHandle, &cost);
+
+  pProfile->elapsedUs = pQInfo->elapsedTime;
+  pProfile->loadCompInfoUs = cost.loadCompInfoUs;
+  pProfile->loadBlocksUs = cost.loadBlocksUs;
+  pProfile->applyFunctionUs = pSummary->applyFunctionUs;
+  pProfile->mergeUs = pSummary->mergeUs;
+  pProfile->readBytes = cost.readBytes;
+  pProfile->totalRows = pSummary->totalRows;
+  pProfile->filteredRows = pSummary->filteredRows;
+  pProfile->numOfFiles = cost.numOfFiles;
+  pProfile->totalBlocks = pSummary->totalBlocks;
+  pProfile->fileBlocks = cost.numOfFileBlocks;
+  pProfile->cacheBlocks = cost.numOfCacheBlocks;
+  pProfile->skippedBlocks = pSummary->skippedBlocks;
+}
 
-  SQueryCostSummary *pSummary = &pRuntimeEnv->summary;
-  if (pRuntimeEnv->pResultBuf == NULL) {
-    pSummary->tmpBufferInDisk = 0;
-  } else {
-    pSummary->tmpBufferInDisk = getResBufSize(pRuntimeEnv->pResultBuf);
-  }
-  
-  qTrace("QInfo:%p statis: comp blocks:%d, size:%d Bytes, elapsed time:%.2f ms", pQInfo, pSummary->readCompInfo,
-         pSummary->totalCompInfoSize, pSummary->loadCompInfoUs / 1000.0);
-  
-  qTrace("QInfo:%p statis: field info: %d, size:%d Bytes, avg size:%.2f Bytes, elapsed time:%.2f ms", pQInfo,
-         pSummary->readField, pSummary->totalFieldSize, (double)pSummary->totalFieldSize / pSummary->readField,
-         pSummary->loadFieldUs / 1000.0);
-  
-  qTrace(
-      "QInfo:%p statis: file blocks:%d, size:%d Bytes, elapsed time:%.2f ms, skipped:%d, in-memory gen null:%d Bytes",
-      pQInfo, pSummary->readDiskBlocks, pSummary->totalBlockSize, pSummary->loadBlocksUs / 1000.0,
-      pSummary->skippedFileBlocks, pSummary->totalGenData);
-  
-  qTrace("QInfo:%p statis: cache blocks:%d", pQInfo, pSummary->blocksInCache, 0);
-  qTrace("QInfo:%p statis: temp file:%d Bytes", pQInfo, pSummary->tmpBufferInDisk);
-  
-  qTrace("QInfo:%p statis: file:%d, table:%d", pQInfo, pSummary->numOfFiles, pSummary->numOfTables);
-  qTrace("QInfo:%p statis: seek ops:%d", pQInfo, pSummary->numOfSeek);
-  
-  double total = pSummary->fileTimeUs + pSummary->cacheTimeUs;
-  double io = pSummary->loadCompInfoUs + pSummary->loadBlocksUs + pSummary->loadFieldUs;
-  
-  // todo add the intermediate result save cost!!
-  double computing = total - io;
-  
-  qTrace(
-      "QInfo:%p statis: total elapsed time:%.2f ms, file:%.2f ms(%.2f%), cache:%.2f ms(%.2f%). io:%.2f ms(%.2f%),"
-      "comput:%.2fms(%.2f%)",
-      pQInfo, total / 1000.0, pSummary->fileTimeUs / 1000.0, pSummary->fileTimeUs * 100 / total,
-      pSummary->cacheTimeUs / 1000.0, pSummary->cacheTimeUs * 100 / total, io / 1000.0, io * 100 / total,
-      computing / 1000.0, computing * 100 / total);
-#endif
+void vnodePrintQueryStatistics(SQInfo *pQInfo) {
+  SQueryProfileMsg p = {0};
+  getQueryProfile(pQInfo, &p);
+
+  qTrace("QInfo:%p statis: elapsed:%" PRId64 "us, load comp info:%" PRId64 "us, load blocks:%" PRId64
+         "us, apply functions:%" PRId64 "us, merge:%" PRId64 "us", pQInfo, p.elapsedUs, p.loadCompInfoUs,
+         p.loadBlocksUs, p.applyFunctionUs, p.mergeUs);
+  qTrace("QInfo:%p statis: files:%d, blocks:%d, file blocks:%d, cache blocks:%d, skipped blocks:%d, read bytes:%" PRId64
+         ", rows:%" PRId64 ", filtered rows:%" PRId64, pQInfo, p.numOfFiles, p.totalBlocks, p.fileBlocks,
+         p.cacheBlocks, p.skippedBlocks, p.readBytes, p.totalRows, p.filteredRows);
 }
 
 int32_t doInitQInfo(SQInfo *pQInfo, void *param, void* tsdb, bool isSTableQuery) {
@@ -4075,9 +4205,16 @@ int32_t doInitQInfo(SQInfo *pQInfo, void *param, void* tsdb, bool isSTableQuery)
     .order     = pQuery->order.order,
     .colList   = pQuery->colList,
     .numOfCols = pQuery->numOfCols,
+    .rollupInterval = getRollupInterval(pRuntimeEnv, tsdb),
   };
   
-  pRuntimeEnv->pQueryHandle = tsdbQueryTables(tsdb, &cond, &pQInfo->groupInfo);
+  // the last row query without time range is answered by the last row cache of tables, without scanning data
+  if (isFirstLastRowQuery(pQuery) && notHasQueryTimeRange(pQuery)) {
+    pRuntimeEnv->pQueryHandle = tsdbQueryLastRow(tsdb, &cond, &pQInfo->groupInfo);
+  } else {
+    pRuntimeEnv->pQueryHandle = tsdbQueryTables(tsdb, &cond, &pQInfo->groupInfo);
+  }
+
   pQInfo->tsdb = tsdb;
   
   pRuntimeEnv->pQuery = pQuery;
@@ -4268,7 +4405,9 @@ static int64_t queryOnDataBlocks(SQInfo *pQInfo) {
       }
     }
 
+    int64_t s = taosGetTimestampUs();
     stableApplyFunctionsOnBlock(pRuntimeEnv, pTableDataInfo, &blockInfo, pStatis, pDataBlock, binarySearchForKey);
+    pRuntimeEnv->summary.applyFunctionUs += (taosGetTimestampUs() - s);
   }
   
   int64_t et = taosGetTimestampMs();
@@ -4307,6 +4446,7 @@ static bool multiTableMultioutputHelper(SQInfo *pQInfo, int32_t index) {
   STableGroupInfo gp = {.numOfTables = 1, .pGroupList = g1};
   
   // include only current table
+  tsdbGetQueryCost(pRuntimeEnv->pQueryHandle, &pRuntimeEnv->summary.tsdbCost);
   pRuntimeEnv->pQueryHandle = tsdbQueryTables(pQInfo->tsdb, &cond, &gp);
 
   if (pRuntimeEnv->pTSBuf != NULL) {
@@ -4686,6 +4826,316 @@ static void doCloseAllTimeWindowAfterScan(SQInfo* pQInfo) {
   }
 }
 
+/*
+ * The scan of an interval query on super table is split into several parts by tables if many tables are involved,
+ * and the parts are scanned by different threads. Each part has its own runtime env, query handle and result buffer,
+ * while the STableQueryInfo of each table is shared with the query, since one table is scanned by only one part.
+ * The results of tables in interval query are independent of each other, so after all parts are completed, the
+ * result pages are moved into the result buffer of query and merged into group results by mergeIntoGroupResult,
+ * the same as the scan by one thread.
+ */
+#define QUERY_SPLIT_QUEUE_SIZE 1024
+
+typedef struct SScanSplitSupporter {
+  int32_t numOfRemain;  // number of parts that are not completed
+  sem_t   done;
+} SScanSplitSupporter;
+
+static pthread_once_t queryScanInit = PTHREAD_ONCE_INIT;
+static void*          queryScanQhandle = NULL;
+static int32_t        queryScanThreads = 0;
+
+static void initQueryScanScheduler() {
+  // the number of parts is bounded by the read worker pool of dnode
+  queryScanThreads = (int32_t)(tsNumOfCores * tsNumOfThreadsPerCore);
+  if (queryScanThreads < 1) {
+    queryScanThreads = 1;
+  }
+
+  queryScanQhandle = taosInitScheduler(QUERY_SPLIT_QUEUE_SIZE, queryScanThreads, "qscan");
+}
+
+static int32_t getNumOfScanSplits(SQInfo *pQInfo) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
+  SQuery *          pQuery = pRuntimeEnv->pQuery;
+
+  // the reversed scan and ts comp query share the scan states between tables, they are scanned by one thread
+  if (tsQuerySplitTables <= 0 || !isIntervalQuery(pQuery) || needReverseScan(pQuery) || pRuntimeEnv->pTSBuf != NULL) {
+    return 1;
+  }
+
+  int32_t num = pQInfo->groupInfo.numOfTables / tsQuerySplitTables;
+  if (num <= 1) {
+    return 1;
+  }
+
+  pthread_once(&queryScanInit, initQueryScanScheduler);
+  if (queryScanQhandle == NULL) {
+    return 1;
+  }
+
+  return MIN(num, queryScanThreads);
+}
+
+// split the tables into parts with the same number of tables, the tables in one group may be put into different parts
+static void splitTableGroupInfo(STableGroupInfo *pGroupInfo, int32_t numOfSplits, STableGroupInfo *pSplits) {
+  size_t numOfGroups = taosArrayGetSize(pGroupInfo->pGroupList);
+  for (int32_t i = 0; i < numOfSplits; ++i) {
+    pSplits[i].numOfTables = 0;
+    pSplits[i].pGroupList = taosArrayInit(numOfGroups, POINTER_BYTES);
+  }
+
+  int32_t index = 0;
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SArray *group = taosArrayGetP(pGroupInfo->pGroupList, i);
+    SArray *sub = NULL;
+    int32_t prev = -1;
+
+    size_t num = taosArrayGetSize(group);
+    for (int32_t j = 0; j < num; ++j, ++index) {
+      int32_t k = (int32_t)(((int64_t)index) * numOfSplits / pGroupInfo->numOfTables);
+      if (k != prev) {
+        sub = taosArrayInit(4, sizeof(SPair));
+        taosArrayPush(pSplits[k].pGroupList, &sub);
+        prev = k;
+      }
+
+      taosArrayPush(sub, taosArrayGet(group, j));
+      pSplits[k].numOfTables += 1;
+    }
+  }
+}
+
+static void destroyTableGroupInfo(STableGroupInfo *pGroupInfo) {
+  size_t numOfGroups = taosArrayGetSize(pGroupInfo->pGroupList);
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SArray *p = taosArrayGetP(pGroupInfo->pGroupList, i);
+    taosArrayDestroy(p);
+  }
+
+  taosArrayDestroy(pGroupInfo->pGroupList);
+  pGroupInfo->pGroupList = NULL;
+}
+
+static void destroyScanSplit(SQInfo *pQInfo, SQInfo *pSplit) {
+  SQueryCostSummary *pDst = &pQInfo->runtimeEnv.summary;
+  SQueryCostSummary *pSrc = &pSplit->runtimeEnv.summary;
+
+  // the cost of query handle is kept in summary during teardown
+  SQuery *pQuery = pSplit->runtimeEnv.pQuery;
+  teardownQueryRuntimeEnv(&pSplit->runtimeEnv);
+
+  pDst->applyFunctionUs += pSrc->applyFunctionUs;
+  pDst->totalRows += pSrc->totalRows;
+  pDst->filteredRows += pSrc->filteredRows;
+  pDst->totalBlocks += pSrc->totalBlocks;
+  pDst->skippedBlocks += pSrc->skippedBlocks;
+
+  pDst->tsdbCost.loadCompInfoUs += pSrc->tsdbCost.loadCompInfoUs;
+  pDst->tsdbCost.loadBlocksUs += pSrc->tsdbCost.loadBlocksUs;
+  pDst->tsdbCost.readBytes += pSrc->tsdbCost.readBytes;
+  pDst->tsdbCost.numOfFiles += pSrc->tsdbCost.numOfFiles;
+  pDst->tsdbCost.numOfFileBlocks += pSrc->tsdbCost.numOfFileBlocks;
+  pDst->tsdbCost.numOfCacheBlocks += pSrc->tsdbCost.numOfCacheBlocks;
+
+  destroyTableGroupInfo(&pSplit->groupInfo);
+  tfree(pQuery);
+  tfree(pSplit);
+}
+
+/*
+ * create the context of one part, the SQuery object is copied since the query range of it is changed during the scan
+ * of each table, all pointers in it are shared with the query and are not changed.
+ */
+static SQInfo *createScanSplit(SQInfo *pQInfo, STableGroupInfo *pGroupInfo, int32_t *code) {
+  SQuery *pQuery = pQInfo->runtimeEnv.pQuery;
+
+  SQInfo *pSplit = calloc(1, sizeof(SQInfo));
+  SQuery *pSplitQuery = malloc(sizeof(SQuery));
+  if (pSplit == NULL || pSplitQuery == NULL) {
+    tfree(pSplit);
+    tfree(pSplitQuery);
+    destroyTableGroupInfo(pGroupInfo);
+
+    *code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  *pSplitQuery = *pQuery;
+
+  pSplit->signature = pSplit;
+  pSplit->tsdb = pQInfo->tsdb;
+  pSplit->groupInfo = *pGroupInfo;
+  pSplit->pParent = pQInfo;
+
+  SQueryRuntimeEnv *pRuntimeEnv = &pSplit->runtimeEnv;
+  pRuntimeEnv->pQuery = pSplitQuery;
+  pRuntimeEnv->stableQuery = true;
+  pRuntimeEnv->scanFlag = pQInfo->runtimeEnv.scanFlag;
+  pRuntimeEnv->cur.vnodeIndex = -1;
+  pRuntimeEnv->numOfRowsPerPage = pQInfo->runtimeEnv.numOfRowsPerPage;
+
+  *code = setupQueryRuntimeEnv(pRuntimeEnv, NULL, pSplitQuery->order.order);
+  if (*code == TSDB_CODE_SUCCESS) {
+    *code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, getInitialPageNum(pSplit), pSplitQuery->rowSize);
+  }
+
+  if (*code != TSDB_CODE_SUCCESS) {
+    destroyScanSplit(pQInfo, pSplit);
+    return NULL;
+  }
+
+  STsdbQueryCond cond = {
+    .twindow   = pSplitQuery->window,
+    .order     = pSplitQuery->order.order,
+    .colList   = pSplitQuery->colList,
+    .numOfCols = pSplitQuery->numOfCols,
+    .rollupInterval = getRollupInterval(pRuntimeEnv, pSplit->tsdb),
+  };
+
+  pRuntimeEnv->pQueryHandle = tsdbQueryTables(pSplit->tsdb, &cond, &pSplit->groupInfo);
+  return pSplit;
+}
+
+static void doScanSplit(SSchedMsg *pMsg) {
+  SQInfo *             pSplit = pMsg->ahandle;
+  SScanSplitSupporter *pSupporter = pMsg->thandle;
+
+  queryOnDataBlocks(pSplit);
+
+  if (atomic_sub_fetch_32(&pSupporter->numOfRemain, 1) == 0) {
+    sem_post(&pSupporter->done);
+  }
+}
+
+// move the result pages of tables scanned by one part into the result buffer of query
+static int32_t moveSplitResultPages(SQInfo *pQInfo, SQInfo *pSplit) {
+  SDiskbasedResultBuf *pDst = pQInfo->runtimeEnv.pResultBuf;
+  SDiskbasedResultBuf *pSrc = pSplit->runtimeEnv.pResultBuf;
+
+  size_t numOfGroups = taosArrayGetSize(pSplit->groupInfo.pGroupList);
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SArray *group = taosArrayGetP(pSplit->groupInfo.pGroupList, i);
+
+    size_t num = taosArrayGetSize(group);
+    for (int32_t j = 0; j < num; ++j) {
+      SPair *          p = taosArrayGet(group, j);
+      STableQueryInfo *pTableQueryInfo = ((STableDataInfo *)p->sec)->pTableQInfo;
+
+      SIDList list = getDataBufPagesIdList(pSrc, pTableQueryInfo->tid);
+      if (list.size == 0) {
+        continue;
+      }
+
+      int32_t *pageId = malloc(list.size * sizeof(int32_t));
+      if (pageId == NULL) {
+        return TSDB_CODE_SERV_OUT_OF_MEMORY;
+      }
+
+      for (int32_t k = 0; k < list.size; ++k) {
+        tFilePage *pData = getNewDataBuf(pDst, pTableQueryInfo->tid, &pageId[k]);
+        if (pData == NULL) {
+          tfree(pageId);
+          return TSDB_CODE_SERV_NO_DISKSPACE;
+        }
+
+        memcpy(pData, getResultBufferPageById(pSrc, list.pData[k]), DEFAULT_INTERN_BUF_SIZE);
+      }
+
+      // the position of results in pages is not changed
+      SWindowResInfo *pWindowResInfo = &pTableQueryInfo->windowResInfo;
+      for (int32_t k = 0; k < pWindowResInfo->size; ++k) {
+        SWindowResult *pWindowRes = getWindowResult(pWindowResInfo, k);
+
+        for (int32_t m = 0; m < list.size; ++m) {
+          if (list.pData[m] == pWindowRes->pos.pageId) {
+            pWindowRes->pos.pageId = pageId[m];
+            break;
+          }
+        }
+      }
+
+      tfree(pageId);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * The first part is scanned by current thread, and the others are scanned by the threads of scheduler. If the
+ * scheduler is busy, the query still completes when the queued parts are scanned.
+ */
+static int64_t splitQueryOnDataBlocks(SQInfo *pQInfo, int32_t numOfSplits) {
+  int64_t st = taosGetTimestampMs();
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  STableGroupInfo *pGroupInfo = calloc(numOfSplits, sizeof(STableGroupInfo));
+  SQInfo **        pSplits = calloc(numOfSplits, POINTER_BYTES);
+  if (pGroupInfo == NULL || pSplits == NULL) {
+    tfree(pGroupInfo);
+    tfree(pSplits);
+
+    pQInfo->code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+    return taosGetTimestampMs() - st;
+  }
+
+  splitTableGroupInfo(&pQInfo->groupInfo, numOfSplits, pGroupInfo);
+
+  int32_t i = 0;
+  for (; i < numOfSplits; ++i) {
+    pSplits[i] = createScanSplit(pQInfo, &pGroupInfo[i], &code);
+    if (pSplits[i] == NULL) {
+      break;
+    }
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    qError("QInfo:%p failed to split scan into %d parts, code:%d", pQInfo, numOfSplits, code);
+
+    for (int32_t j = i + 1; j < numOfSplits; ++j) {
+      destroyTableGroupInfo(&pGroupInfo[j]);
+    }
+
+    numOfSplits = i;
+    pQInfo->code = code;
+  } else {
+    qTrace("QInfo:%p scan of %d tables is split into %d parts", pQInfo, pQInfo->groupInfo.numOfTables, numOfSplits);
+
+    SScanSplitSupporter supporter = {.numOfRemain = numOfSplits};
+    sem_init(&supporter.done, 0, 0);
+
+    for (int32_t j = 1; j < numOfSplits; ++j) {
+      SSchedMsg msg = {.fp = doScanSplit, .ahandle = pSplits[j], .thandle = &supporter};
+      taosScheduleTask(queryScanQhandle, &msg);
+    }
+
+    queryOnDataBlocks(pSplits[0]);
+    if (atomic_sub_fetch_32(&supporter.numOfRemain, 1) > 0) {
+      sem_wait(&supporter.done);
+    }
+
+    sem_destroy(&supporter.done);
+  }
+
+  for (int32_t j = 0; j < numOfSplits; ++j) {
+    if (pQInfo->code == TSDB_CODE_SUCCESS) {
+      pQInfo->code = pSplits[j]->code;
+    }
+
+    if (pQInfo->code == TSDB_CODE_SUCCESS) {
+      pQInfo->code = moveSplitResultPages(pQInfo, pSplits[j]);
+    }
+
+    destroyScanSplit(pQInfo, pSplits[j]);
+  }
+
+  tfree(pGroupInfo);
+  tfree(pSplits);
+
+  return taosGetTimestampMs() - st;
+}
+
 static void multiTableQueryProcess(SQInfo *pQInfo) {
   SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
   SQuery *          pQuery = pRuntimeEnv->pQuery;
@@ -4722,7 +5172,14 @@ static void multiTableQueryProcess(SQInfo *pQInfo) {
   createTableDataInfo(pQInfo);
   
   // do check all qualified data blocks
-  int64_t el = queryOnDataBlocks(pQInfo);
+  int64_t el = 0;
+  int32_t numOfSplits = getNumOfScanSplits(pQInfo);
+  if (numOfSplits > 1) {
+    el = splitQueryOnDataBlocks(pQInfo, numOfSplits);
+  } else {
+    el = queryOnDataBlocks(pQInfo);
+  }
+
   qTrace("QInfo:%p forward scan completed, elapsed time: %lldms, reversed scan start, order:%d", pQInfo, el,
          pQuery->order.order ^ 1u);
   
@@ -4771,6 +5228,19 @@ static void multiTableQueryProcess(SQInfo *pQInfo) {
   qTrace("QInfo:%p points returned:%d, total:%d", pQInfo, pQuery->rec.rows, pQuery->rec.total + pQuery->rec.rows);
 }
 
+// the last row function is applied to no row if the table is empty
+static bool hasLastRowResult(SQueryRuntimeEnv *pRuntimeEnv) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  for (int32_t j = 0; j < pQuery->numOfOutputCols; ++j) {
+    if (pQuery->pSelectExpr[j].pBase.functionId == TSDB_FUNC_LAST_ROW) {
+      return GET_RES_INFO(&pRuntimeEnv->pCtx[j])->hasResult == DATA_SET_FLAG;
+    }
+  }
+
+  return true;
+}
+
 /*
  * in each query, this function will be called only once, no retry for further result.
  *
@@ -4791,6 +5261,11 @@ static void tableFixedOutputProcess(SQInfo *pQInfo) {
   // since the numOfOutputElems must be identical for all sql functions that are allowed to be executed simutanelously.
   pQuery->rec.rows = getNumOfResult(pRuntimeEnv);
 
+  // the last row query on an empty table has no result
+  if (isFirstLastRowQuery(pQuery) && !hasLastRowResult(pRuntimeEnv)) {
+    pQuery->rec.rows = 0;
+  }
+
   // must be top/bottom query if offset > 0
   if (pQuery->limit.offset > 0) {
     assert(isTopBottomQuery(pQuery));
@@ -5025,8 +5500,10 @@ static void stableQueryImpl(SQInfo* pQInfo) {
   
   int64_t st = taosGetTimestampUs();
   
-  if (isIntervalQuery(pQuery) ||
-      (isFixedOutputQuery(pQuery) && (!isPointInterpoQuery(pQuery)) && !isGroupbyNormalCol(pQuery->pGroupbyExpr))) {
+  // the last row query without time range gets one row for each group from the handle of last rows
+  bool lastRowQuery = isFirstLastRowQuery(pQuery) && notHasQueryTimeRange(pQuery);
+  if (isIntervalQuery(pQuery) || (isFixedOutputQuery(pQuery) && (!isPointInterpoQuery(pQuery) || lastRowQuery) &&
+                                  !isGroupbyNormalCol(pQuery->pGroupbyExpr))) {
     multiTableQueryProcess(pQInfo);
   } else {
     assert((pQuery->checkBuffer == 1 && pQuery->intervalTime == 0) || isPointInterpoQuery(pQuery) ||
@@ -5108,6 +5585,12 @@ static char* createTableIdList(SQueryTableMsg* pQueryMsg, char* pMsg, SArray** p
   STableId id = {.uid = pTableIdInfo->uid, .tid = pTableIdInfo->sid};
   taosArrayPush(*pTableIdList, &id);
   
+  // the data before the progress of subscription has been consumed, so it is excluded from the query range
+  if (TSDB_QUERY_HAS_TYPE(pQueryMsg->queryType, TSDB_QUERY_TYPE_SUBSCRIBE) && pQueryMsg->order == TSDB_ORDER_ASC &&
+      pTableIdInfo->key >= pQueryMsg->window.skey) {
+    pQueryMsg->window.skey = pTableIdInfo->key + 1;
+  }
+  
   pMsg += sizeof(STableIdInfo);
   
   for (int32_t j = 1; j < pQueryMsg->numOfTables; ++j) {
@@ -5881,10 +6364,28 @@ static int32_t doDumpQueryResult(SQInfo *pQInfo, char *data) {
   // todo if interpolation exists, the result may be dump to client by several rounds
 }
 
+// duration of each phase of query: create query info, execute and dump the result
+static pthread_once_t queryMetricsInit = PTHREAD_ONCE_INIT;
+static SMetric*       queryPrepareMetric = NULL;
+static SMetric*       queryExecMetric = NULL;
+static SMetric*       queryDumpMetric = NULL;
+
+static void initQueryMetrics() {
+  queryPrepareMetric = taosRegisterMetric("taosd_query_prepare_duration_seconds", "duration of query preparation",
+                                          TAOS_METRIC_HISTOGRAM);
+  queryExecMetric = taosRegisterMetric("taosd_query_exec_duration_seconds", "duration of query execution",
+                                       TAOS_METRIC_HISTOGRAM);
+  queryDumpMetric = taosRegisterMetric("taosd_query_dump_duration_seconds", "duration of dumping query result",
+                                       TAOS_METRIC_HISTOGRAM);
+}
+
 int32_t qCreateQueryInfo(void* tsdb, SQueryTableMsg *pQueryMsg, qinfo_t *pQInfo) {
   assert(pQueryMsg != NULL);
 
+  pthread_once(&queryMetricsInit, initQueryMetrics);
+
   int32_t code = TSDB_CODE_SUCCESS;
+  int64_t st = taosGetTimestampUs();
   
   char* tagCond = NULL;
   SArray *pTableIdList = NULL;
@@ -5925,7 +6426,6 @@ int32_t qCreateQueryInfo(void* tsdb, SQueryTableMsg *pQueryMsg, qinfo_t *pQInfo)
     isSTableQuery = true;
     
     STableId* id = taosArrayGet(pTableIdList, 0);
-    id->uid = -1;  //todo fix me
     
     /*int32_t ret =*/ tsdbQueryByTagsCond(tsdb, id->uid, tagCond, pQueryMsg->tagCondLen, &groupInfo, pGroupColIndex, pQueryMsg->numOfGroupCols);
     if (groupInfo.numOfTables == 0) { // no qualified tables no need to do query
@@ -5946,10 +6446,28 @@ int32_t qCreateQueryInfo(void* tsdb, SQueryTableMsg *pQueryMsg, qinfo_t *pQInfo)
     code = TSDB_CODE_SERV_OUT_OF_MEMORY;
   }
   
+  // the progress is returned for a subscription query, but only the subscription of a single table is supported
+  if ((*pQInfo) != NULL && TSDB_QUERY_HAS_TYPE(pQueryMsg->queryType, TSDB_QUERY_TYPE_SUBSCRIBE)) {
+    ((SQInfo*)(*pQInfo))->subscribe = true;
+  }
+  
+  if ((*pQInfo) != NULL && !isSTableQuery && TSDB_QUERY_HAS_TYPE(pQueryMsg->queryType, TSDB_QUERY_TYPE_SUBSCRIBE)) {
+    STableId* id = taosArrayGet(pTableIdList, 0);
+    ((SQInfo*)(*pQInfo))->subscribeUid = id->uid;
+    
+    // the window starts right after the progress of subscription, see createTableIdList
+    ((SQInfo*)(*pQInfo))->subscribeKey = (pQueryMsg->order == TSDB_ORDER_ASC)? pQueryMsg->window.skey - 1:0;
+  }
+  
+  if ((*pQInfo) != NULL && TSDB_QUERY_HAS_TYPE(pQueryMsg->queryType, TSDB_QUERY_TYPE_PROFILE)) {
+    ((SQInfo*)(*pQInfo))->profile = true;
+  }
+  
   code = initQInfo(pQueryMsg, tsdb, *pQInfo, isSTableQuery);
   
 _query_over:
   taosArrayDestroy(pTableIdList);
+  taosMetricObserve(queryPrepareMetric, taosGetTimestampUs() - st);
 
   // if failed to add ref for all meters in this query, abort current query
   //  atomic_fetch_add_32(&vnodeSelectReqNum, 1);
@@ -5958,6 +6476,7 @@ _query_over:
 
 void qDestroyQueryInfo(qinfo_t pQInfo) {
   qTrace("QInfo:%p query completed", pQInfo);
+  vnodePrintQueryStatistics(pQInfo);
   freeQInfo(pQInfo);
 }
 
@@ -5976,12 +6495,15 @@ void qTableQuery(qinfo_t qinfo) {
   
   qTrace("QInfo:%p query task is launched", pQInfo);
   
+  int64_t st = taosGetTimestampUs();
   if (pQInfo->runtimeEnv.stableQuery) {
     stableQueryImpl(pQInfo);
   } else {
     tableQueryImpl(pQInfo);
   }
   
+  taosMetricObserve(queryExecMetric, taosGetTimestampUs() - st);
+  
   //  vnodeDecRefCount(pQInfo);
 }
 
@@ -6024,6 +6546,81 @@ bool qHasMoreResultsToRetrieve(qinfo_t qinfo) {
   }
 }
 
+static int32_t getSubscriptionProgressSize(SQInfo *pQInfo) {
+  if (!pQInfo->subscribe) {
+    return 0;
+  }
+  
+  return sizeof(int32_t) + ((pQInfo->subscribeUid != 0)? sizeof(int64_t) + sizeof(TSKEY):0);
+}
+
+/*
+ * The progress of subscription is appended to the result, and the client starts the next query of subscription from
+ * it. It is the key of the last row returned so far, so the rows scanned but not yet returned are queried again.
+ * The number of tables is always written, which is 0 if the subscription of the table is not supported.
+ */
+static void doDumpSubscriptionProgress(SQInfo *pQInfo, char *data) {
+  SQuery *pQuery = pQInfo->runtimeEnv.pQuery;
+  
+  if (pQInfo->subscribeUid == 0) {
+    *(int32_t *)data = htonl(0);
+    return;
+  }
+  
+  int32_t tsCol = -1;
+  for (int32_t col = 0; col < pQuery->numOfOutputCols; ++col) {
+    SSqlFuncExprMsg *pBase = &pQuery->pSelectExpr[col].pBase;
+    if ((pBase->functionId == TSDB_FUNC_PRJ || pBase->functionId == TSDB_FUNC_TS) &&
+        pBase->colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+      tsCol = col;
+      break;
+    }
+  }
+  
+  if (QUERY_IS_ASC_QUERY(pQuery)) {
+    if (tsCol >= 0 && pQuery->rec.rows > 0) {
+      pQInfo->subscribeKey = ((TSKEY *)pQuery->sdata[tsCol]->data)[pQuery->rec.rows - 1];
+    } else if (tsCol < 0 && Q_STATUS_EQUAL(pQuery->status, QUERY_OVER) && pQuery->limit.limit <= 0) {
+      // the keys of rows are not in the result, but all rows scanned have been returned when the query is over
+      pQInfo->subscribeKey = pQuery->lastKey - 1;
+    }
+  }
+  
+  TSKEY key = pQInfo->subscribeKey;
+  
+  *(int32_t *)data = htonl(1);
+  data += sizeof(int32_t);
+  *(int64_t *)data = htobe64(pQInfo->subscribeUid);
+  data += sizeof(int64_t);
+  *(TSKEY *)data = htobe64(key);
+  
+  qTrace("QInfo:%p subscription progress of uid:%" PRId64 " is %" PRId64, pQInfo, pQInfo->subscribeUid, key);
+}
+
+/*
+ * The execution profile accumulated so far is appended to every response, and the one with the last result is the
+ * profile of the whole query.
+ */
+static void doDumpQueryProfile(SQInfo *pQInfo, char *data) {
+  SQueryProfileMsg p = {0};
+  getQueryProfile(pQInfo, &p);
+  
+  SQueryProfileMsg *pMsg = (SQueryProfileMsg *)data;
+  pMsg->elapsedUs = htobe64(p.elapsedUs);
+  pMsg->loadCompInfoUs = htobe64(p.loadCompInfoUs);
+  pMsg->loadBlocksUs = htobe64(p.loadBlocksUs);
+  pMsg->applyFunctionUs = htobe64(p.applyFunctionUs);
+  pMsg->mergeUs = htobe64(p.mergeUs);
+  pMsg->readBytes = htobe64(p.readBytes);
+  pMsg->totalRows = htobe64(p.totalRows);
+  pMsg->filteredRows = htobe64(p.filteredRows);
+  pMsg->numOfFiles = htonl(p.numOfFiles);
+  pMsg->totalBlocks = htonl(p.totalBlocks);
+  pMsg->fileBlocks = htonl(p.fileBlocks);
+  pMsg->cacheBlocks = htonl(p.cacheBlocks);
+  pMsg->skippedBlocks = htonl(p.skippedBlocks);
+}
+
 int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp** pRsp, int32_t* contLen) {
   SQInfo* pQInfo = (SQInfo*) qinfo;
   
@@ -6031,10 +6628,17 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp** pRsp, int32_t* co
     return TSDB_CODE_INVALID_QHANDLE;
   }
   
+  int64_t st = taosGetTimestampUs();
   SQuery* pQuery = pQInfo->runtimeEnv.pQuery;
   size_t size = getResultSize(pQInfo, &pQuery->rec.rows);
   *contLen = size + sizeof(SRetrieveTableRsp);
   
+  *contLen += getSubscriptionProgressSize(pQInfo);
+  
+  if (pQInfo->profile) {
+    *contLen += sizeof(SQueryProfileMsg);
+  }
+  
   // todo handle failed to allocate memory
   *pRsp = (SRetrieveTableRsp *)rpcMallocCont(*contLen);
   (*pRsp)->numOfRows = htonl(pQuery->rec.rows);
@@ -6059,6 +6663,17 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp** pRsp, int32_t* co
     (*pRsp)->completed = 1; // notify no more result to client
   }
   
+  char* pTail = (*pRsp)->data + size;
+  if (pQInfo->subscribe) {
+    doDumpSubscriptionProgress(pQInfo, pTail);
+    pTail += getSubscriptionProgressSize(pQInfo);
+  }
+  
+  if (pQInfo->profile) {
+    doDumpQueryProfile(pQInfo, pTail);
+  }
+  
+  taosMetricObserve(queryDumpMetric, taosGetTimestampUs() - st);
   return code;
   
 //  if (numOfRows == 0 && (pRetrieve->qhandle == (uint64_t)pObj->qhandle) && (code != TSDB_CODE_ACTION_IN_PROGRESS)) {
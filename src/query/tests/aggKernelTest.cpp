@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "tsdb.h"
+#include "ttime.h"
+
+#include "qaggkernel.h"
+
+namespace {
+const int32_t numOfRows = 4096;
+
+template <typename T>
+void setNullValue(T* p, int16_t type) {
+  setNull((char*)p, type, sizeof(T));
+}
+
+// put one null value in every 7 rows if withNull is true
+template <typename T>
+void genData(T* data, int32_t rows, int16_t type, bool withNull) {
+  for (int32_t i = 0; i < rows; ++i) {
+    if (withNull && i % 7 == 3) {
+      setNullValue(&data[i], type);
+    } else {
+      data[i] = (T)((i * 37) % 101 - 50);
+    }
+  }
+}
+
+template <typename T, typename R>
+void kernelTest(int16_t type) {
+  T* data = (T*)malloc(sizeof(T) * numOfRows);
+  uint8_t bitmap[QAGG_NULL_BITMAP_BYTES(numOfRows)] = {0};
+
+  for (int32_t k = 0; k < 2; ++k) {
+    bool withNull = (k == 1);
+    genData(data, numOfRows, type, withNull);
+
+    int32_t numOfNull = qBuildNullBitmap((const char*)data, numOfRows, type, sizeof(T), bitmap);
+    const uint8_t* pBitmap = withNull ? bitmap : NULL;
+
+    // the result computed row by row
+    R       sum = 0;
+    T       minVal = 0, maxVal = 0;
+    int32_t notNull = 0;
+    int32_t minIndex = -1, maxIndex = -1;
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      bool n = isNull((const char*)&data[i], type);
+      ASSERT_EQ(n, (bool)QAGG_IS_NULL_BIT(bitmap, i));
+      if (n) continue;
+
+      sum += data[i];
+      if (notNull == 0 || data[i] <= minVal) {
+        minVal = data[i];
+        minIndex = i;
+      }
+
+      if (notNull == 0 || data[i] > maxVal) {
+        maxVal = data[i];
+        maxIndex = i;
+      }
+
+      notNull += 1;
+    }
+
+    ASSERT_EQ(numOfNull, numOfRows - notNull);
+    ASSERT_EQ(qCountNotNull(bitmap, 0, numOfRows), notNull);
+
+    R s = 0;
+    ASSERT_EQ(qGetSumKernel(type)(data, numOfRows, pBitmap, 0, &s), notNull);
+    ASSERT_EQ(s, sum);
+
+    T v = 0;
+    ASSERT_EQ(qGetMinKernel(type)(data, numOfRows, pBitmap, 0, &v), notNull);
+    ASSERT_EQ(v, minVal);
+    ASSERT_EQ(qLocateValue(data, numOfRows, pBitmap, 0, type, &v, true), minIndex);
+
+    ASSERT_EQ(qGetMaxKernel(type)(data, numOfRows, pBitmap, 0, &v), notNull);
+    ASSERT_EQ(v, maxVal);
+    ASSERT_EQ(qLocateValue(data, numOfRows, pBitmap, 0, type, &v, false), maxIndex);
+
+    // sub range of block, the same as a time window in block
+    int32_t offset = 100, rows = 1000;
+    int32_t num = qCountNotNull(bitmap, offset, rows);
+
+    R s1 = 0, s2 = 0;
+    ASSERT_EQ(qGetSumKernel(type)(data + offset, rows, pBitmap, offset, &s1), withNull ? num : rows);
+    for (int32_t i = offset; i < offset + rows; ++i) {
+      if (!QAGG_IS_NULL_BIT(bitmap, i)) s2 += data[i];
+    }
+    ASSERT_EQ(s1, s2);
+  }
+
+  // all data are null, the result of min/max is not changed
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    setNullValue(&data[i], type);
+  }
+
+  ASSERT_EQ(qBuildNullBitmap((const char*)data, numOfRows, type, sizeof(T), bitmap), numOfRows);
+
+  T v = 1;
+  ASSERT_EQ(qGetMinKernel(type)(data, numOfRows, bitmap, 0, &v), 0);
+  ASSERT_EQ(v, 1);
+
+  free(data);
+}
+
+template <typename T, typename R>
+void kernelPerfTest(int16_t type, const char* name) {
+  const int32_t rows = 1000000;
+  const int32_t loops = 20;
+
+  T* data = (T*)malloc(sizeof(T) * rows);
+  uint8_t* bitmap = (uint8_t*)malloc(QAGG_NULL_BITMAP_BYTES(rows));
+
+  for (int32_t k = 0; k < 2; ++k) {
+    bool withNull = (k == 1);
+    genData(data, rows, type, withNull);
+    qBuildNullBitmap((const char*)data, rows, type, sizeof(T), bitmap);
+
+    const uint8_t* pBitmap = withNull ? bitmap : NULL;
+
+    // row by row with null value check, which is the same as the original implementation
+    R       res = 0;
+    int64_t st = taosGetTimestampUs();
+    for (int32_t j = 0; j < loops; ++j) {
+      for (int32_t i = 0; i < rows; ++i) {
+        if (isNull((const char*)&data[i], type)) continue;
+        res += data[i];
+      }
+    }
+    int64_t rowwise = taosGetTimestampUs() - st;
+
+    R s = 0;
+    st = taosGetTimestampUs();
+    for (int32_t j = 0; j < loops; ++j) {
+      qGetSumKernel(type)(data, rows, pBitmap, 0, &s);
+    }
+    int64_t sumKernel = taosGetTimestampUs() - st;
+
+    T v = 0;
+    st = taosGetTimestampUs();
+    for (int32_t j = 0; j < loops; ++j) {
+      qGetMaxKernel(type)(data, rows, pBitmap, 0, &v);
+    }
+    int64_t maxKernel = taosGetTimestampUs() - st;
+
+    printf("%-8s %s rows:%d, loops:%d, row-wise sum:%" PRId64 "us, sum kernel:%" PRId64 "us, max kernel:%" PRId64
+           "us\n", name, withNull ? "null " : "dense", rows, loops, rowwise, sumKernel, maxKernel);
+    ASSERT_EQ(res, s);
+  }
+
+  free(bitmap);
+  free(data);
+}
+}  // namespace
+
+TEST(testCase, aggKernel_test) {
+  kernelTest<int8_t, int64_t>(TSDB_DATA_TYPE_TINYINT);
+  kernelTest<int16_t, int64_t>(TSDB_DATA_TYPE_SMALLINT);
+  kernelTest<int32_t, int64_t>(TSDB_DATA_TYPE_INT);
+  kernelTest<int64_t, int64_t>(TSDB_DATA_TYPE_BIGINT);
+  kernelTest<float, double>(TSDB_DATA_TYPE_FLOAT);
+  kernelTest<double, double>(TSDB_DATA_TYPE_DOUBLE);
+
+  ASSERT_TRUE(qGetSumKernel(TSDB_DATA_TYPE_BINARY) == NULL);
+  ASSERT_TRUE(qGetMinKernel(TSDB_DATA_TYPE_BOOL) == NULL);
+}
+
+TEST(testCase, aggKernel_perf_test) {
+  kernelPerfTest<int8_t, int64_t>(TSDB_DATA_TYPE_TINYINT, "tinyint");
+  kernelPerfTest<int16_t, int64_t>(TSDB_DATA_TYPE_SMALLINT, "smallint");
+  kernelPerfTest<int32_t, int64_t>(TSDB_DATA_TYPE_INT, "int");
+  kernelPerfTest<int64_t, int64_t>(TSDB_DATA_TYPE_BIGINT, "bigint");
+  kernelPerfTest<float, double>(TSDB_DATA_TYPE_FLOAT, "float");
+  kernelPerfTest<double, double>(TSDB_DATA_TYPE_DOUBLE, "double");
+}
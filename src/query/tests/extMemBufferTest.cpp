@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "taos.h"
+#include "qextbuffer.h"
+#include "tsdb.h"
+#include "ttime.h"
+
+namespace {
+SColumnModel* createBigintModel() {
+  SSchema s = {0};
+  s.type = TSDB_DATA_TYPE_BIGINT;
+  s.bytes = sizeof(int64_t);
+  strcpy(s.name, "k");
+
+  return createColumnModel(&s, 1, 1000);
+}
+
+// put numOfRows values starting from start as one group
+void putGroup(tExtMemBuffer* pBuf, int64_t start, int32_t numOfRows, bool seal) {
+  int64_t* data = (int64_t*)malloc(sizeof(int64_t) * numOfRows);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    data[i] = start + i;
+  }
+
+  ASSERT_GE(tExtMemBufferPut(pBuf, data, numOfRows), 0);
+  ASSERT_TRUE(seal ? tExtMemBufferSeal(pBuf) : tExtMemBufferFlush(pBuf));
+  free(data);
+}
+
+// all data are loaded in the order of flush
+void checkAll(tExtMemBuffer* pBuf, const std::vector<int64_t>& expected) {
+  tFilePage* pPage = (tFilePage*)malloc(pBuf->pageSize);
+
+  std::vector<int64_t> res;
+  for (int32_t k = 0; k < pBuf->fileMeta.flushoutData.nLength; ++k) {
+    tFlushoutInfo* pInfo = &pBuf->fileMeta.flushoutData.pFlushoutInfo[k];
+    for (int32_t i = 0; i < pInfo->numOfPages; ++i) {
+      ASSERT_TRUE(tExtMemBufferLoadData(pBuf, pPage, k, i));
+      res.insert(res.end(), (int64_t*)pPage->data, (int64_t*)pPage->data + pPage->numOfElems);
+    }
+  }
+
+  ASSERT_EQ(res, expected);
+  free(pPage);
+}
+
+void appendExpected(std::vector<int64_t>& expected, int64_t start, int32_t numOfRows) {
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    expected.push_back(start + i);
+  }
+}
+
+// sealed groups are kept in memory, until the in-memory capacity is exhausted
+void sealTest() {
+  SColumnModel*  pModel = createBigintModel();
+  tExtMemBuffer* pBuf = createExtMemBuffer(DEFAULT_PAGE_SIZE * 4, sizeof(int64_t), pModel);
+  pBuf->flushModel = MULTIPLE_APPEND_MODEL;
+
+  int32_t              rowsPerPage = pBuf->numOfElemsPerPage;
+  std::vector<int64_t> expected;
+
+  putGroup(pBuf, 0, rowsPerPage + 10, true);
+  putGroup(pBuf, 100000, 100, true);
+  appendExpected(expected, 0, rowsPerPage + 10);
+  appendExpected(expected, 100000, 100);
+
+  ASSERT_TRUE(tExtMemBufferIsAllDataInMem(pBuf));
+  ASSERT_TRUE(pBuf->file == NULL);
+  ASSERT_EQ(pBuf->fileMeta.flushoutData.nLength, 2);
+  checkAll(pBuf, expected);
+
+  // exceeds the capacity, all groups are moved to disk
+  putGroup(pBuf, 200000, rowsPerPage * 2, true);
+  appendExpected(expected, 200000, rowsPerPage * 2);
+  ASSERT_FALSE(tExtMemBufferIsAllDataInMem(pBuf));
+  checkAll(pBuf, expected);
+
+  // once data are in disk, the following groups are flushed too
+  int32_t numOfFlush = pBuf->fileMeta.flushoutData.nLength;
+  putGroup(pBuf, 300000, 10, true);
+  appendExpected(expected, 300000, 10);
+  ASSERT_EQ(pBuf->fileMeta.flushoutData.nLength, numOfFlush + 1);
+  ASSERT_EQ(taosArrayGetSize(pBuf->pSealedPages), 0);
+  checkAll(pBuf, expected);
+
+  // the buffer is reusable after being cleared
+  tExtMemBufferClear(pBuf);
+  ASSERT_EQ(pBuf->fileMeta.flushoutData.nLength, 0);
+
+  destoryExtMemBuffer(pBuf);
+  destroyColumnModel(pModel);
+}
+
+// the groups of several buffers are merged in passes, until no more than maxNumOfGroups groups are left
+void mergeGroupsTest(int32_t orderType) {
+  const int32_t numOfBuffer = 3;
+  const int32_t numOfGroups = 7;
+  const int32_t maxNumOfGroups = 4;
+
+  SColumnModel*     pModel = createBigintModel();
+  int32_t           orderIdx = 0;
+  tOrderDescriptor* pDesc = tOrderDesCreate(&orderIdx, 1, pModel, orderType);
+
+  tExtMemBuffer** pBuf = (tExtMemBuffer**)malloc(POINTER_BYTES * numOfBuffer);
+  for (int32_t i = 0; i < numOfBuffer; ++i) {
+    pBuf[i] = createExtMemBuffer(DEFAULT_PAGE_SIZE * 4, sizeof(int64_t), pModel);
+    pBuf[i]->flushModel = MULTIPLE_APPEND_MODEL;
+  }
+
+  // the values of all groups are interleaved, and each group is sorted
+  std::vector<int64_t> expected;
+  int32_t              rowsPerPage = pBuf[0]->numOfElemsPerPage;
+  for (int32_t i = 0; i < numOfBuffer; ++i) {
+    for (int32_t j = 0; j < numOfGroups; ++j) {
+      int32_t numOfRows = rowsPerPage * (j % 3) + 100 * (i + 1);
+      int64_t* data = (int64_t*)malloc(sizeof(int64_t) * numOfRows);
+      for (int32_t k = 0; k < numOfRows; ++k) {
+        int32_t n = (orderType == TSDB_ORDER_ASC) ? k : numOfRows - 1 - k;
+        data[k] = (int64_t)n * numOfBuffer * numOfGroups + i * numOfGroups + j;
+        expected.push_back(data[k]);
+      }
+
+      ASSERT_GE(tExtMemBufferPut(pBuf[i], data, numOfRows), 0);
+      ASSERT_TRUE(tExtMemBufferSeal(pBuf[i]));
+      free(data);
+    }
+  }
+
+  // 21 groups are merged into 6 groups, and then into 2 groups
+  int32_t num = tExtMemBufferMergeGroups(&pBuf, numOfBuffer, pDesc, orderType, maxNumOfGroups);
+  ASSERT_EQ(num, 2);
+
+  std::vector<int64_t> res;
+  tFilePage*           pPage = (tFilePage*)malloc(DEFAULT_PAGE_SIZE);
+  for (int32_t i = 0; i < num; ++i) {
+    ASSERT_EQ(pBuf[i]->fileMeta.flushoutData.nLength, 1);
+
+    std::vector<int64_t> group;
+    for (int32_t k = 0; k < pBuf[i]->fileMeta.flushoutData.pFlushoutInfo[0].numOfPages; ++k) {
+      ASSERT_TRUE(tExtMemBufferLoadData(pBuf[i], pPage, 0, k));
+      group.insert(group.end(), (int64_t*)pPage->data, (int64_t*)pPage->data + pPage->numOfElems);
+    }
+
+    if (orderType == TSDB_ORDER_ASC) {
+      ASSERT_TRUE(std::is_sorted(group.begin(), group.end()));
+    } else {
+      ASSERT_TRUE(std::is_sorted(group.rbegin(), group.rend()));
+    }
+
+    res.insert(res.end(), group.begin(), group.end());
+
+    // the pages in file are compressed
+    size_t  numOfPages = taosArrayGetSize(pBuf[i]->pPageOffset);
+    int64_t fileSize = *(int64_t*)taosArrayGet(pBuf[i]->pPageOffset, numOfPages - 1);
+    ASSERT_LT(fileSize, (int64_t)pBuf[i]->fileMeta.nFileSize * DEFAULT_PAGE_SIZE);
+  }
+
+  std::sort(res.begin(), res.end());
+  std::sort(expected.begin(), expected.end());
+  ASSERT_EQ(res, expected);
+
+  for (int32_t i = 0; i < num; ++i) {
+    destoryExtMemBuffer(pBuf[i]);
+  }
+
+  free(pBuf);
+  free(pPage);
+  tOrderDescDestroy(pDesc);  // the column model is destroyed along with the descriptor
+}
+
+// the order column and a bigint column that keeps the same value of the order column
+template <typename T>
+void sortTest(int16_t type, int32_t orderType, int32_t tsOrder) {
+  const int32_t numOfRows = 10000;
+
+  SSchema s[2] = {{0}};
+  s[0].type = type;
+  s[0].bytes = sizeof(T);
+  strcpy(s[0].name, "k");
+  s[1].type = TSDB_DATA_TYPE_BIGINT;
+  s[1].bytes = sizeof(int64_t);
+  strcpy(s[1].name, "v");
+
+  SColumnModel*     pModel = createColumnModel(s, 2, numOfRows);
+  int32_t           orderIdx = 0;
+  tOrderDescriptor* pDesc = tOrderDesCreate(&orderIdx, 1, pModel, tsOrder);
+
+  char* data = (char*)malloc(pModel->rowSize * numOfRows);
+  T*    key = (T*)data;
+  int64_t* val = (int64_t*)(data + sizeof(T) * numOfRows);
+
+  int64_t sum = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (std::is_integral<T>::value && i % 100 == 7) {
+      setNull((char*)&key[i], type, sizeof(T));
+    } else {
+      key[i] = (T)(((int64_t)i * 7919) % 20011 - 10000);
+    }
+
+    val[i] = key[i];
+    sum += val[i];
+  }
+
+  tColDataQSort(pDesc, numOfRows, 0, numOfRows - 1, data, orderType);
+
+  bool desc = (type == TSDB_DATA_TYPE_TIMESTAMP) ? (tsOrder == TSDB_ORDER_DESC) : (orderType == TSDB_ORDER_DESC);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ASSERT_EQ(val[i], (int64_t)key[i]);
+    if (i > 0) {
+      ASSERT_TRUE(desc ? key[i - 1] >= key[i] : key[i - 1] <= key[i]);
+    }
+    sum -= val[i];
+  }
+
+  ASSERT_EQ(sum, 0);
+
+  free(data);
+  tOrderDescDestroy(pDesc);
+}
+
+void sortPerfTest() {
+  const int32_t numOfRows = 1000000;
+
+  SSchema s[2] = {{0}};
+  s[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  s[0].bytes = sizeof(int64_t);
+  strcpy(s[0].name, "ts");
+  s[1].type = TSDB_DATA_TYPE_BIGINT;
+  s[1].bytes = sizeof(int64_t);
+  strcpy(s[1].name, "v");
+
+  SColumnModel* pModel = createColumnModel(s, 2, numOfRows);
+  char*         data = (char*)malloc(pModel->rowSize * numOfRows);
+
+  // the second order column has the same value, which makes the descriptor fall back to quick sort
+  int32_t           orderIdx[2] = {0, 1};
+  tOrderDescriptor* pDesc[2] = {tOrderDesCreate(orderIdx, 1, pModel, TSDB_ORDER_ASC),
+                                tOrderDesCreate(orderIdx, 2, cloneColumnModel(pModel), TSDB_ORDER_ASC)};
+
+  int64_t elapsed[2] = {0};
+  for (int32_t k = 0; k < 2; ++k) {
+    srand(0);
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      ((int64_t*)data)[i] = 1500000000000L + (((int64_t)rand() << 16) ^ rand());
+      ((int64_t*)data)[numOfRows + i] = 1;
+    }
+
+    int64_t st = taosGetTimestampUs();
+    tColDataQSort(pDesc[k], numOfRows, 0, numOfRows - 1, data, TSDB_ORDER_ASC);
+    elapsed[k] = taosGetTimestampUs() - st;
+
+    for (int32_t i = 1; i < numOfRows; ++i) {
+      ASSERT_LE(((int64_t*)data)[i - 1], ((int64_t*)data)[i]);
+    }
+  }
+
+  printf("sort %d rows, radix sort:%" PRId64 "us, quick sort:%" PRId64 "us\n", numOfRows, elapsed[0], elapsed[1]);
+
+  free(data);
+  tOrderDescDestroy(pDesc[0]);
+  tOrderDescDestroy(pDesc[1]);
+}
+}  // namespace
+
+TEST(testCase, extMemBufferTest) {
+  sealTest();
+}
+
+TEST(testCase, mergeGroupsTest) {
+  mergeGroupsTest(TSDB_ORDER_ASC);
+  mergeGroupsTest(TSDB_ORDER_DESC);
+}
+
+TEST(testCase, colDataSortTest) {
+  sortTest<int8_t>(TSDB_DATA_TYPE_TINYINT, TSDB_ORDER_ASC, TSDB_ORDER_ASC);
+  sortTest<int16_t>(TSDB_DATA_TYPE_SMALLINT, TSDB_ORDER_DESC, TSDB_ORDER_ASC);
+  sortTest<int32_t>(TSDB_DATA_TYPE_INT, TSDB_ORDER_ASC, TSDB_ORDER_ASC);
+  sortTest<int32_t>(TSDB_DATA_TYPE_INT, TSDB_ORDER_DESC, TSDB_ORDER_ASC);
+  sortTest<int64_t>(TSDB_DATA_TYPE_BIGINT, TSDB_ORDER_DESC, TSDB_ORDER_ASC);
+  sortTest<int64_t>(TSDB_DATA_TYPE_TIMESTAMP, TSDB_ORDER_ASC, TSDB_ORDER_DESC);
+  sortTest<double>(TSDB_DATA_TYPE_DOUBLE, TSDB_ORDER_ASC, TSDB_ORDER_ASC);
+}
+
+TEST(testCase, colDataSort_perf_test) {
+  sortPerfTest();
+}
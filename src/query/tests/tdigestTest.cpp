@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "qtdigest.h"
+
+namespace {
+double exactQuantile(std::vector<double>& data, double q) {
+  std::sort(data.begin(), data.end());
+  double index = q * (data.size() - 1);
+
+  size_t lo = (size_t)floor(index);
+  size_t hi = (size_t)ceil(index);
+  return data[lo] + (data[hi] - data[lo]) * (index - lo);
+}
+
+// the error is measured in the rank, i.e., the fraction of the points between the result and the exact value
+double rankError(std::vector<double>& data, double q, double val) {
+  std::sort(data.begin(), data.end());
+  size_t rank = std::lower_bound(data.begin(), data.end(), val) - data.begin();
+  return fabs((double)rank / data.size() - q);
+}
+}  // namespace
+
+TEST(testCase, tdigest_empty_test) {
+  STDigest* pDigest = tdigestCreate(TDIGEST_COMPRESSION);
+
+  ASSERT_TRUE(std::isnan(tdigestQuantile(pDigest, 0.5)));
+
+  tdigestAdd(pDigest, 10, 1);
+  ASSERT_EQ(tdigestQuantile(pDigest, 0), 10);
+  ASSERT_EQ(tdigestQuantile(pDigest, 0.5), 10);
+  ASSERT_EQ(tdigestQuantile(pDigest, 1), 10);
+
+  tdigestAdd(pDigest, 20, 1);
+  ASSERT_EQ(tdigestQuantile(pDigest, 0), 10);
+  ASSERT_EQ(tdigestQuantile(pDigest, 1), 20);
+
+  tdigestDestroy(pDigest);
+}
+
+TEST(testCase, tdigest_accuracy_test) {
+  STDigest* pDigest = tdigestCreate(TDIGEST_COMPRESSION);
+  std::vector<double> data;
+
+  // skewed data like latencies, with a long tail
+  srand(17);
+  for (int32_t i = 0; i < 100000; ++i) {
+    double v = -log((rand() + 1.0) / ((double)RAND_MAX + 2)) * 100;
+    data.push_back(v);
+    tdigestAdd(pDigest, v, 1);
+  }
+
+  ASSERT_EQ(pDigest->totalWeight, 100000);
+  ASSERT_LE(pDigest->numOfCentroids + pDigest->numOfBuffered, pDigest->numOfSlots);
+
+  ASSERT_EQ(tdigestQuantile(pDigest, 0), *std::min_element(data.begin(), data.end()));
+  ASSERT_EQ(tdigestQuantile(pDigest, 1), *std::max_element(data.begin(), data.end()));
+  ASSERT_LE(pDigest->numOfCentroids, TDIGEST_COMPRESSION + 2);
+
+  ASSERT_LT(rankError(data, 0.5, tdigestQuantile(pDigest, 0.5)), 0.01);
+  ASSERT_LT(rankError(data, 0.9, tdigestQuantile(pDigest, 0.9)), 0.005);
+
+  // much more accurate in the tails
+  double p99 = tdigestQuantile(pDigest, 0.99);
+  double p999 = tdigestQuantile(pDigest, 0.999);
+  ASSERT_LT(rankError(data, 0.99, p99), 0.001);
+  ASSERT_LT(rankError(data, 0.999, p999), 0.0005);
+  ASSERT_LT(fabs(p99 - exactQuantile(data, 0.99)) / exactQuantile(data, 0.99), 0.01);
+
+  tdigestDestroy(pDigest);
+}
+
+TEST(testCase, tdigest_merge_test) {
+  const int32_t numOfParts = 8;
+
+  STDigest* pAll = tdigestCreate(TDIGEST_COMPRESSION);
+  STDigest* pParts[numOfParts];
+  for (int32_t i = 0; i < numOfParts; ++i) {
+    pParts[i] = tdigestCreate(TDIGEST_COMPRESSION);
+  }
+
+  std::vector<double> data;
+  for (int32_t i = 0; i < 80000; ++i) {
+    double v = (i * 7919) % 80000;
+    data.push_back(v);
+
+    tdigestAdd(pAll, v, 1);
+    tdigestAdd(pParts[v < 40000 ? i % 2 : 2 + i % (numOfParts - 2)], v, 1);
+  }
+
+  // the digest is a flat buffer, so it could be copied as the intermediate result and merged elsewhere
+  std::vector<char> buf(TDIGEST_SIZE(TDIGEST_COMPRESSION));
+  STDigest* pMerged = tdigestCreateFrom(buf.data(), TDIGEST_COMPRESSION);
+  for (int32_t i = 0; i < numOfParts; ++i) {
+    std::vector<char> copy(TDIGEST_SIZE(TDIGEST_COMPRESSION));
+    memcpy(copy.data(), pParts[i], copy.size());
+
+    tdigestMerge(pMerged, (STDigest*)copy.data());
+  }
+
+  ASSERT_EQ(pMerged->totalWeight, pAll->totalWeight);
+  ASSERT_EQ(tdigestQuantile(pMerged, 0), 0);
+  ASSERT_EQ(tdigestQuantile(pMerged, 1), 79999);
+
+  double qs[] = {0.001, 0.01, 0.25, 0.5, 0.75, 0.99, 0.999};
+  for (size_t i = 0; i < sizeof(qs) / sizeof(qs[0]); ++i) {
+    double v1 = tdigestQuantile(pAll, qs[i]);
+    double v2 = tdigestQuantile(pMerged, qs[i]);
+
+    ASSERT_LT(rankError(data, qs[i], v1), 0.005);
+    ASSERT_LT(rankError(data, qs[i], v2), 0.005);
+  }
+
+  tdigestDestroy(pAll);
+  for (int32_t i = 0; i < numOfParts; ++i) {
+    tdigestDestroy(pParts[i]);
+  }
+}
@@ -20,6 +20,7 @@
 #include "ttime.h"
 #include "ttimer.h"
 #include "tutil.h"
+#include "tmetrics.h"
 #include "lz4.h"
 #include "taoserror.h"
 #include "tsocket.h"
@@ -133,6 +134,10 @@ int tsRpcMaxRetry;
 int tsRpcHeadSize;
 int tsRpcOverhead;
 
+// statistics of all rpc instances in this process
+static SMetric *rpcReqMetric = NULL;
+static SMetric *rpcRspMetric = NULL;
+
 // server:0 client:1  tcp:2 udp:0
 #define RPC_CONN_UDPS   0
 #define RPC_CONN_UDPC   1
@@ -210,6 +215,9 @@ void *rpcOpen(const SRpcInit *pInit) {
   tsRpcHeadSize = RPC_MSG_OVERHEAD; 
   tsRpcOverhead = sizeof(SRpcReqContext);
 
+  rpcReqMetric = taosRegisterMetric("taosd_rpc_requests_total", "rpc requests received", TAOS_METRIC_COUNTER);
+  rpcRspMetric = taosRegisterMetric("taosd_rpc_responses_total", "rpc responses received", TAOS_METRIC_COUNTER);
+
   pRpc = (SRpcInfo *)calloc(1, sizeof(SRpcInfo));
   if (pRpc == NULL) return NULL;
 
@@ -924,9 +932,11 @@ static void rpcProcessIncomingMsg(SRpcConn *pConn, SRpcHead *pHead) {
     rpcMsg.handle = pConn;
     pConn->destIp = pHead->destIp;
     taosTmrReset(rpcProcessProgressTimer, tsRpcTimer/2, pConn, pRpc->tmrCtrl, &pConn->pTimer);
+    taosMetricInc(rpcReqMetric, 1);
     (*(pRpc->cfp))(&rpcMsg);
   } else {
     // it's a response
+    taosMetricInc(rpcRspMetric, 1);
     SRpcReqContext *pContext = pConn->pContext;
     rpcMsg.handle = pContext->ahandle;
     pConn->pContext = NULL;
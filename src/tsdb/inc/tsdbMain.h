@@ -15,6 +15,8 @@
 #ifndef _TD_TSDB_MAIN_H_
 #define _TD_TSDB_MAIN_H_
 
+#include "hash.h"
+#include "tbitmap.h"
 #include "tglobal.h"
 #include "tlist.h"
 #include "tsdb.h"
@@ -72,8 +74,12 @@ typedef struct STable {
   SMemTable *    mem;
   SMemTable *    imem;
   void *         pIndex;         // For TSDB_SUPER_TABLE, it is the skiplist index
+  void *         pTagIndex;      // For TSDB_SUPER_TABLE, it is the inverted index of tag values
   void *         eventHandler;   // TODO
   void *         streamHandler;  // TODO
+  SDataRow       lastRow;         // copy of the row with the largest key, protected by the lock of repository
+  int32_t        lastRowVersion;  // version of the schema of lastRow
+  int8_t         lastRowLoaded;   // if the last row in files is merged into lastRow
   struct STable *next;           // TODO: remove the next
 } STable;
 
@@ -101,6 +107,7 @@ typedef struct {
 STsdbMeta *tsdbInitMeta(char *rootDir, int32_t maxTables);
 int32_t    tsdbFreeMeta(STsdbMeta *pMeta);
 STSchema * tsdbGetTableSchema(STsdbMeta *pMeta, STable *pTable);
+int32_t    tsdbGetTableSchemaVersion(STsdbMeta *pMeta, STable *pTable);
 STSchema * tsdbGetTableTagSchema(STsdbMeta *pMeta, STable *pTable);
 
 // ---- Operation on STable
@@ -202,6 +209,7 @@ typedef struct {
 
 typedef struct {
   int32_t fileId;
+  int8_t  level;  // level of the disk tier which the files are placed on, 0 is the data directory of repository
   SFile   files[TSDB_FILE_TYPE_MAX];
 } SFileGroup;
 
@@ -217,6 +225,7 @@ typedef struct {
 #define TSDB_MAX_FILE_ID(fh) (fh)->fGroup[(fh)->numOfFGroups - 1].fileId
 
 STsdbFileH *tsdbInitFileH(char *dataDir, int maxFiles);
+int         tsdbOpenTierFGroups(STsdbFileH *pFileH, char *dataDir, int8_t level);
 void        tsdbCloseFileH(STsdbFileH *pFileH);
 int         tsdbCreateFile(char *dataDir, int fileId, const char *suffix, int maxTables, SFile *pFile, int writeHeader,
                            int toClose);
@@ -317,6 +326,200 @@ int         tsdbCopyBlockDataInFile(SFile *pOutFile, SFile *pInFile, SCompInfo *
 SFileGroup *tsdbSearchFGroup(STsdbFileH *pFileH, int fid);
 void tsdbGetKeyRangeOfFileId(int32_t daysPerFile, int8_t precision, int32_t fileId, TSKEY *minKey, TSKEY *maxKey);
 
+// ------------------------------ TSDB BLOCK CACHE INTERFACES ------------------------------
+/*
+ * Cache of the block data read from files, shared by all query handles of a repository. The SCompData part of a
+ * block and each column of the block are cached separately, so a query only caches the columns it reads.
+ *
+ * The eviction policy is a simplified 2Q: a newly cached item is put into a FIFO queue, and it is promoted to the LRU
+ * queue only when it is hit again before being evicted. So the items accessed once by a big scan are evicted from the
+ * FIFO queue first, without flushing the frequently accessed items out of cache.
+ *
+ * Each file group has a generation in cache, which is increased to an odd number before its files are replaced by
+ * commit, and to the next even number after. A read helper gets the generation when it opens the files under the lock
+ * of repository, and uses the cache only if it is an even number. The generation is a part of the key and is checked again
+ * when an item is put, so an item read from the old files is never returned for the new ones.
+ */
+#define TSDB_BLOCK_CACHE_HEAD_COLID (-1)  // colId of the SCompData part of block
+
+typedef struct {
+  int32_t fid;
+  int16_t colId;
+  int16_t last;        // block is in .last file or .data file
+  int64_t offset;      // offset of block in file
+  int64_t generation;  // generation of the files the block is read from, -1 if the cache is not used
+} SBlockCacheKey;
+
+typedef struct SBlockCacheNode {
+  SBlockCacheKey          key;
+  struct SBlockCacheNode *prev;
+  struct SBlockCacheNode *next;
+  int8_t                  queue;
+  int32_t                 len;
+  char                    data[];
+} SBlockCacheNode;
+
+typedef struct {
+  SBlockCacheNode *head;  // the most recently inserted or used item
+  SBlockCacheNode *tail;
+  int64_t          bytes;
+} SBlockCacheQueue;
+
+typedef struct {
+  int64_t          maxBytes;
+  SHashObj *       pHash;
+  SHashObj *       pGenHash;  // fid -> generation of the files of file group
+  SBlockCacheQueue fifo;
+  SBlockCacheQueue lru;
+  pthread_mutex_t  mutex;
+} SBlockCache;
+
+SBlockCache *tsdbNewBlockCache(int64_t maxBytes);
+void         tsdbFreeBlockCache(SBlockCache *pCache);
+void         tsdbInitBlockCacheKey(SBlockCacheKey *pKey, int32_t fid, int64_t generation, SCompBlock *pCompBlock,
+                                   int16_t colId);
+bool         tsdbGetFromBlockCache(SBlockCache *pCache, SBlockCacheKey *pKey, void *buf, int32_t len);
+void         tsdbPutToBlockCache(SBlockCache *pCache, SBlockCacheKey *pKey, void *data, int32_t len);
+int64_t      tsdbGetBlockCacheGeneration(SBlockCache *pCache, int32_t fid);
+void         tsdbStartInvalidateBlockCache(SBlockCache *pCache, int32_t fid);
+void         tsdbInvalidateBlockCache(SBlockCache *pCache, int32_t fid);
+
+// ------------------------------ TSDB HEAD INDEX CACHE INTERFACES ------------------------------
+/*
+ * The .head file of a file group is read and verified once, and its content is shared read-only by all query
+ * handles, instead of reading the SCompIdx part and the SCompInfo of each table with lseek and read in every query.
+ *
+ * Each file group has a generation of its .head file in cache. Before a commit or compaction replaces the .head file,
+ * under the lock of repository, the cached index is removed and the generation is increased. A read helper gets the
+ * generation and the cached index when it opens the files under the same lock, and the index loaded from the opened
+ * file is put into cache only if the generation is not changed since then. The old index is freed when the last query
+ * handle using it releases it.
+ */
+typedef struct {
+  int32_t fid;
+  int32_t refCount;
+  int64_t generation;  // generation of the .head file which the index is loaded from
+  int64_t size;
+  char    data[];  // the whole content of .head file
+} SHeadIndex;
+
+#define TSDB_HEAD_INDEX_COMP_IDX(p) ((SCompIdx *)((p)->data + TSDB_FILE_HEAD_SIZE))
+
+typedef struct {
+  int32_t         maxTables;
+  SHashObj *      pHash;     // fid -> SHeadIndex *
+  SHashObj *      pGenHash;  // fid -> generation of .head file
+  pthread_mutex_t mutex;
+} SHeadIndexCache;
+
+SHeadIndexCache *tsdbNewHeadIndexCache(int32_t maxTables);
+void             tsdbFreeHeadIndexCache(SHeadIndexCache *pCache);
+SHeadIndex *     tsdbAcquireHeadIndex(SHeadIndexCache *pCache, int32_t fid, int64_t *pGeneration);
+SHeadIndex *     tsdbLoadHeadIndex(SHeadIndexCache *pCache, SFile *pHeadF, int32_t fid, int64_t generation);
+void             tsdbReleaseHeadIndex(SHeadIndex *pIdx);
+void             tsdbInvalidateHeadIndex(SHeadIndexCache *pCache, int32_t fid);
+
+// ------------------------------ TSDB COMPACTOR INTERFACES ------------------------------
+/*
+ * The compactor rewrites a file group in background when the blocks of it are fragmented by out-of-order data, so
+ * that each table has only full super-blocks without sub-blocks, and at most one small block in .last file.
+ *
+ * The new files are written aside and renamed over the old files only if no commit touched the file group during the
+ * compaction, otherwise the compaction of the file group is abandoned and retried in the next round.
+ */
+typedef struct {
+  pthread_t thread;
+  int8_t    stop;
+  int8_t    aborted;  // set by commit if it writes to the file group being compacted
+  int32_t   fid;      // the file group being compacted, -1 if none
+  int64_t   startTime;
+  int64_t   bytes;    // bytes read and written in the current compaction, for throttling
+} STsdbCompactor;
+
+// ------------------------------ TSDB DISK TIER INTERFACES ------------------------------
+/*
+ * The file groups are placed on several disk tiers, e.g. NVMe for the hot data and HDD for the cold data. Level 0 is
+ * the data directory of repository where the file groups are created, and the lower tiers are the mount points in
+ * tierDataDir. The mover migrates a file group to level n in background when all of its data is older than n times
+ * tierDays.
+ *
+ * The files of a file group are always accessed by the names in SFileGroup, so commit, compaction and query follow
+ * the placement. A move is abandoned if a commit writes to the file group in the meantime, and the old files are
+ * removed in the next round, so that the queries which got the old names still read them.
+ */
+#define TSDB_MAX_DISK_TIERS 3
+
+typedef struct {
+  int32_t   numOfLevels;
+  char      dirs[TSDB_MAX_DISK_TIERS][TSDB_FILENAME_LEN];  // data directory of each level
+  pthread_t thread;
+  int8_t    stop;
+  int8_t    aborted;    // set by commit if it writes to the file group being moved
+  int32_t   fid;        // the file group being moved, -1 if none
+  int64_t   startTime;
+  int64_t   bytes;      // bytes copied in the current move, for throttling
+  SList *   pRemoved;   // the old file groups to remove in the next round
+} STsdbDiskTier;
+
+// ------------------------------ TSDB ROLLUP INTERFACES ------------------------------
+/*
+ * The rollups of a table are the count/sum/min/max of each column in the buckets of the configured intervals, e.g.
+ * 1m and 1h. They are accumulated from the rows being committed while they are still in SDataCols, and kept in a
+ * file of each file group in the rollup directory, so an interval query reads the tiny buckets instead of scanning
+ * the raw blocks.
+ *
+ * The rollup file is made up of the file head, an index of maxTables SRollupIdx, and the chunks appended by each
+ * commit. The chunks of a series are chained from the newest one, and the chain is merged into one chunk when it is
+ * too long. A rollup is used only if its number of rows equals the rows of the table in the file group, otherwise the
+ * query falls back to the raw blocks, and the rollup is rebuilt from the blocks in the next commit of the table.
+ */
+#define TSDB_MAX_ROLLUPS 4
+#define TSDB_ROLLUP_DIR_NAME "rollup"
+#define TSDB_ROLLUP_VERSION 0
+#define TSDB_ROLLUP_MAX_CHUNKS 8  // max chunks in the chain of a series
+
+typedef struct {
+  int16_t colId;
+  int8_t  type;
+  int8_t  reserved;
+} SRollupCol;
+
+// sum/min/max keep the bits of double for float and double columns, the same as SDataStatis
+typedef struct {
+  int64_t count;  // number of non-null values
+  int64_t sum;
+  int64_t min;
+  int64_t max;
+} SRollupAgg;
+
+typedef struct {
+  TSKEY      firstKey;
+  TSKEY      lastKey;
+  int64_t    rows;
+  SRollupAgg aggs[];
+} SRollupBucket;
+
+typedef struct {
+  int64_t interval;
+  int32_t numOfBuckets;
+  int32_t maxBuckets;
+  char *  buckets;  // sorted by key
+} SRollupSeries;
+
+typedef struct {
+  uint64_t      uid;
+  int64_t       rows;  // number of rows rolled up
+  int32_t       numOfCols;
+  int32_t       bucketSize;
+  SRollupCol    cols[TSDB_MAX_COLUMNS];
+  int32_t       numOfSeries;
+  SRollupSeries series[TSDB_MAX_ROLLUPS];
+} STableRollup;
+
+#define TSDB_ROLLUP_BUCKET_SIZE(numOfCols) (sizeof(SRollupBucket) + sizeof(SRollupAgg) * (numOfCols))
+#define TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, idx) \
+  ((SRollupBucket *)((pSeries)->buckets + (size_t)(pRollup)->bucketSize * (idx)))
+
 // TSDB repository definition
 typedef struct _tsdb_repo {
   char *rootDir;
@@ -331,16 +534,30 @@ typedef struct _tsdb_repo {
   // The cache Handle
   STsdbCache *tsdbCache;
 
+  // The cache of block data read from files
+  SBlockCache *pBlockCache;
+
+  // The cache of .head file content of each file group
+  SHeadIndexCache *pHeadIdxCache;
+
   // The TSDB file handle
   STsdbFileH *tsdbFileH;
 
-  // Disk tier handle for multi-tier storage
-  void *diskTier;
+  // Disk tier handle for multi-tier storage, NULL if all files are placed in the data directory of repository
+  STsdbDiskTier *diskTier;
 
   pthread_mutex_t mutex;
 
   int       commit;
   pthread_t commitThread;
+  int32_t   commitFid;  // the file group being committed, -1 if none
+
+  // The background compactor of file groups
+  STsdbCompactor *pCompactor;
+
+  // The intervals of rollups in the precision of repository, in ascending order
+  int32_t numOfRollups;
+  int64_t rollupIntervals[TSDB_MAX_ROLLUPS];
 
   // A limiter to monitor the resources used by tsdb
   void *limiter;
@@ -374,6 +591,49 @@ int32_t tsdbTriggerCommit(TsdbRepoT *repo);
 int32_t tsdbLockRepo(TsdbRepoT *repo);
 int32_t tsdbUnLockRepo(TsdbRepoT *repo);
 
+STsdbCompactor *tsdbStartCompactor(STsdbRepo *pRepo);
+void            tsdbStopCompactor(STsdbCompactor *pCompactor);
+
+int  tsdbOpenDiskTier(STsdbRepo *pRepo, char *dataDir);
+void tsdbCloseDiskTier(STsdbRepo *pRepo, bool toRemove);
+
+int           tsdbInitRollupCfg(STsdbRepo *pRepo);
+STableRollup *tsdbNewTableRollup(STsdbRepo *pRepo, STable *pTable);
+void          tsdbFreeTableRollup(STableRollup *pRollup);
+void          tsdbFreeTableRollups(STableRollup **pRollups, int numOfTables);
+int           tsdbRollupDataCols(STableRollup *pRollup, SDataCols *pDataCols, int rows);
+int           tsdbCommitRollups(STsdbRepo *pRepo, SFileGroup *pGroup, STableRollup **pRollups);
+int           tsdbOpenRollupFile(STsdbRepo *pRepo, int fid);
+STableRollup *tsdbLoadTableRollup(STsdbRepo *pRepo, int fd, STable *pTable, int64_t interval);
+
+void     tsdbUpdateTableLastRow(STsdbRepo *pRepo, STable *pTable, SDataRow row);
+SDataRow tsdbGetTableLastRow(STsdbRepo *pRepo, STable *pTable);
+
+// ------------------------------ TSDB TAG INDEX INTERFACES ------------------------------
+/*
+ * Inverted index of the tag values of a super table. Each indexed tag maps a tag value to the bitmap of tids of the
+ * child tables with this value, so the equal conditions on tags are resolved by looking up and combining bitmaps,
+ * instead of checking the tags of every child table.
+ *
+ * The tags of integer and binary types are indexed. The float tags are not, since the equal of float is seldom used,
+ * and the nchar tags are not either, since their length is not kept correctly in the tag row.
+ */
+typedef struct {
+  int32_t          numOfTags;
+  int8_t           invalid;  // set if a table fails to be added, then the index is not used any more
+  SBitmap *        pTables;  // tids of all child tables
+  SHashObj **      pValues;  // tag value -> SBitmap * for each tag, NULL if the tag is not indexed
+  pthread_rwlock_t rwLock;
+} STagIndex;
+
+STagIndex *tsdbNewTagIndex(STSchema *pTagSchema);
+void       tsdbFreeTagIndex(STagIndex *pIndex);
+int        tsdbAddIntoTagIndex(STagIndex *pIndex, STSchema *pTagSchema, STable *pTable);
+void       tsdbRemoveFromTagIndex(STagIndex *pIndex, STSchema *pTagSchema, STable *pTable);
+bool       tsdbIsTagIndexed(STagIndex *pIndex, int32_t col);
+SBitmap *  tsdbGetTagIndexAllTables(STagIndex *pIndex);
+SBitmap *  tsdbGetTagIndexTables(STagIndex *pIndex, int32_t col, const char *val, int32_t len);
+
 typedef enum { TSDB_WRITE_HELPER, TSDB_READ_HELPER } tsdb_rw_helper_t;
 
 typedef struct {
@@ -426,6 +686,15 @@ typedef struct {
   SCompData *pCompData;
   SDataCols *pDataCols[2];
 
+  STsdbRepo *  pRepo;          // only used by read helper, the files are opened under the lock of repository
+  SBlockCache *pBlockCache;    // only used by read helper
+  int64_t      blockCacheGen;  // generation of the files of current file group in block cache, -1 if not used
+
+  SHeadIndexCache *pHeadIdxCache;  // only used by read helper
+  SHeadIndex *     pHeadIdx;       // index of current file group, NULL if it is read from file
+
+  int64_t blockReadBytes;  // bytes of block data read from file, for statistics purpose
+
 } SRWHelper;
 
 // --------- Helper state
@@ -459,11 +728,15 @@ int  tsdbCloseHelperFile(SRWHelper *pHelper, bool hasError);
 int tsdbLoadCompIdx(SRWHelper *pHelper, void *target);
 int tsdbLoadCompInfo(SRWHelper *pHelper, void *target);
 int tsdbLoadCompData(SRWHelper *pHelper, SCompBlock *pCompBlock, void *target);
-int tsdbLoadBlockDataCols(SRWHelper *pHelper, SDataCols *pDataCols, int blkIdx, int16_t *colIds, int numOfColIds);
+int tsdbLoadBlockDataCols(SRWHelper *pHelper, SCompBlock *pCompBlock, SDataCols *pDataCols, int16_t *colIds,
+                          int numOfColIds);
 int tsdbLoadBlockData(SRWHelper *pHelper, SCompBlock *pCompBlock, SDataCols *target);
+void tsdbPrefetchBlock(SRWHelper *pHelper, SCompBlock *pCompBlock);
 
 // --------- For write operations
 int tsdbWriteDataBlock(SRWHelper *pHelper, SDataCols *pDataCols);
+int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDataCols, int rowsToWrite, SCompBlock *pCompBlock,
+                         bool isLast, bool isSuperBlock);
 int tsdbMoveLastBlockIfNeccessary(SRWHelper *pHelper);
 int tsdbWriteCompInfo(SRWHelper *pHelper);
 int tsdbWriteCompIdx(SRWHelper *pHelper);
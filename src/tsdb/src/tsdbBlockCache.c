@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "tulog.h"
+#include "tsdb.h"
+#include "tsdbMain.h"
+
+#define TSDB_BLOCK_CACHE_FIFO 0
+#define TSDB_BLOCK_CACHE_LRU 1
+
+// the FIFO queue takes a quarter of the cache at most
+#define TSDB_BLOCK_CACHE_FIFO_RATIO 4
+
+// statistics of all repositories in this process
+static int64_t tsdbBlockCacheHitNum = 0;
+static int64_t tsdbBlockCacheMissNum = 0;
+
+static void tsdbBlockCacheUnlink(SBlockCacheQueue *pQueue, SBlockCacheNode *pNode) {
+  if (pNode->prev != NULL) {
+    pNode->prev->next = pNode->next;
+  } else {
+    pQueue->head = pNode->next;
+  }
+
+  if (pNode->next != NULL) {
+    pNode->next->prev = pNode->prev;
+  } else {
+    pQueue->tail = pNode->prev;
+  }
+
+  pNode->prev = pNode->next = NULL;
+  pQueue->bytes -= pNode->len;
+}
+
+static void tsdbBlockCachePushHead(SBlockCacheQueue *pQueue, SBlockCacheNode *pNode) {
+  pNode->prev = NULL;
+  pNode->next = pQueue->head;
+
+  if (pQueue->head != NULL) {
+    pQueue->head->prev = pNode;
+  } else {
+    pQueue->tail = pNode;
+  }
+
+  pQueue->head = pNode;
+  pQueue->bytes += pNode->len;
+}
+
+static SBlockCacheQueue *tsdbBlockCacheQueueOf(SBlockCache *pCache, SBlockCacheNode *pNode) {
+  return (pNode->queue == TSDB_BLOCK_CACHE_FIFO) ? &pCache->fifo : &pCache->lru;
+}
+
+static void tsdbBlockCacheRemoveNode(SBlockCache *pCache, SBlockCacheNode *pNode) {
+  tsdbBlockCacheUnlink(tsdbBlockCacheQueueOf(pCache, pNode), pNode);
+  taosHashRemove(pCache->pHash, (const char *)&pNode->key, sizeof(SBlockCacheKey));
+  free(pNode);
+}
+
+// evict the oldest items from the FIFO queue when it is larger than its share, otherwise from the LRU queue
+static void tsdbBlockCacheEvict(SBlockCache *pCache, int32_t bytes) {
+  while (pCache->fifo.bytes + pCache->lru.bytes + bytes > pCache->maxBytes) {
+    SBlockCacheNode *pNode = NULL;
+    if (pCache->fifo.tail != NULL &&
+        (pCache->fifo.bytes > pCache->maxBytes / TSDB_BLOCK_CACHE_FIFO_RATIO || pCache->lru.tail == NULL)) {
+      pNode = pCache->fifo.tail;
+    } else {
+      pNode = pCache->lru.tail;
+    }
+
+    if (pNode == NULL) break;
+    tsdbBlockCacheRemoveNode(pCache, pNode);
+  }
+}
+
+SBlockCache *tsdbNewBlockCache(int64_t maxBytes) {
+  if (maxBytes <= 0) return NULL;
+
+  SBlockCache *pCache = (SBlockCache *)calloc(1, sizeof(SBlockCache));
+  if (pCache == NULL) return NULL;
+
+  pCache->maxBytes = maxBytes;
+  pCache->pHash = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+  pCache->pGenHash = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
+  if (pCache->pHash == NULL || pCache->pGenHash == NULL) {
+    taosHashCleanup(pCache->pHash);
+    taosHashCleanup(pCache->pGenHash);
+    free(pCache);
+    return NULL;
+  }
+
+  pthread_mutex_init(&pCache->mutex, NULL);
+  return pCache;
+}
+
+void tsdbFreeBlockCache(SBlockCache *pCache) {
+  if (pCache == NULL) return;
+
+  SBlockCacheQueue *queues[] = {&pCache->fifo, &pCache->lru};
+  for (int i = 0; i < tListLen(queues); i++) {
+    SBlockCacheNode *pNode = queues[i]->head;
+    while (pNode != NULL) {
+      SBlockCacheNode *pNext = pNode->next;
+      free(pNode);
+      pNode = pNext;
+    }
+  }
+
+  taosHashCleanup(pCache->pHash);
+  taosHashCleanup(pCache->pGenHash);
+  pthread_mutex_destroy(&pCache->mutex);
+  free(pCache);
+}
+
+void tsdbInitBlockCacheKey(SBlockCacheKey *pKey, int32_t fid, int64_t generation, SCompBlock *pCompBlock,
+                           int16_t colId) {
+  memset(pKey, 0, sizeof(SBlockCacheKey));  // the key is hashed in bytes, padding included
+
+  pKey->fid = fid;
+  pKey->colId = colId;
+  pKey->last = pCompBlock->last;
+  pKey->offset = pCompBlock->offset;
+  pKey->generation = generation;
+}
+
+static int64_t tsdbGetFidGeneration(SBlockCache *pCache, int32_t fid) {
+  int64_t *pGen = taosHashGet(pCache->pGenHash, (const char *)&fid, sizeof(fid));
+  return (pGen == NULL) ? 0 : *pGen;
+}
+
+bool tsdbGetFromBlockCache(SBlockCache *pCache, SBlockCacheKey *pKey, void *buf, int32_t len) {
+  if (pCache == NULL || pKey->generation < 0) return false;
+
+  pthread_mutex_lock(&pCache->mutex);
+
+  SBlockCacheNode **ppNode = taosHashGet(pCache->pHash, (const char *)pKey, sizeof(SBlockCacheKey));
+  if (ppNode == NULL || (*ppNode)->len != len) {
+    pthread_mutex_unlock(&pCache->mutex);
+    atomic_add_fetch_64(&tsdbBlockCacheMissNum, 1);
+    return false;
+  }
+
+  // the item hit again is promoted to the LRU queue, or moved to the head of LRU queue
+  SBlockCacheNode *pNode = *ppNode;
+  tsdbBlockCacheUnlink(tsdbBlockCacheQueueOf(pCache, pNode), pNode);
+  pNode->queue = TSDB_BLOCK_CACHE_LRU;
+  tsdbBlockCachePushHead(&pCache->lru, pNode);
+
+  memcpy(buf, pNode->data, len);
+  pthread_mutex_unlock(&pCache->mutex);
+
+  atomic_add_fetch_64(&tsdbBlockCacheHitNum, 1);
+  return true;
+}
+
+void tsdbPutToBlockCache(SBlockCache *pCache, SBlockCacheKey *pKey, void *data, int32_t len) {
+  if (pCache == NULL || pKey->generation < 0 || len > pCache->maxBytes / TSDB_BLOCK_CACHE_FIFO_RATIO) return;
+
+  SBlockCacheNode *pNode = (SBlockCacheNode *)malloc(sizeof(SBlockCacheNode) + len);
+  if (pNode == NULL) return;
+
+  pNode->key = *pKey;
+  pNode->queue = TSDB_BLOCK_CACHE_FIFO;
+  pNode->len = len;
+  memcpy(pNode->data, data, len);
+
+  pthread_mutex_lock(&pCache->mutex);
+
+  // the files are replaced after the block is read
+  if (pKey->generation != tsdbGetFidGeneration(pCache, pKey->fid)) {
+    pthread_mutex_unlock(&pCache->mutex);
+    free(pNode);
+    return;
+  }
+
+  // cached by another query handle concurrently
+  SBlockCacheNode **ppNode = taosHashGet(pCache->pHash, (const char *)pKey, sizeof(SBlockCacheKey));
+  if (ppNode != NULL) {
+    tsdbBlockCacheRemoveNode(pCache, *ppNode);
+  }
+
+  tsdbBlockCacheEvict(pCache, len);
+
+  taosHashPut(pCache->pHash, (const char *)pKey, sizeof(SBlockCacheKey), &pNode, POINTER_BYTES);
+  tsdbBlockCachePushHead(&pCache->fifo, pNode);
+
+  pthread_mutex_unlock(&pCache->mutex);
+}
+
+/*
+ * Get the generation of the files of a file group, -1 is returned if the files are being replaced, or the cache is
+ * not used.
+ */
+int64_t tsdbGetBlockCacheGeneration(SBlockCache *pCache, int32_t fid) {
+  if (pCache == NULL) return -1;
+
+  pthread_mutex_lock(&pCache->mutex);
+  int64_t generation = tsdbGetFidGeneration(pCache, fid);
+  pthread_mutex_unlock(&pCache->mutex);
+
+  return (generation % 2 == 0) ? generation : -1;
+}
+
+// called before the files of a file group are replaced, the blocks read from now on are not put into cache
+void tsdbStartInvalidateBlockCache(SBlockCache *pCache, int32_t fid) {
+  if (pCache == NULL) return;
+
+  pthread_mutex_lock(&pCache->mutex);
+
+  int64_t generation = tsdbGetFidGeneration(pCache, fid);
+  if (generation % 2 == 0) {
+    generation++;
+    taosHashPut(pCache->pGenHash, (const char *)&fid, sizeof(fid), &generation, sizeof(generation));
+  }
+
+  pthread_mutex_unlock(&pCache->mutex);
+}
+
+/*
+ * The files of a file group are rewritten by commit, so the cached items of the file group are all removed, since
+ * the offset of block may be reused by the new file.
+ */
+void tsdbInvalidateBlockCache(SBlockCache *pCache, int32_t fid) {
+  if (pCache == NULL) return;
+
+  pthread_mutex_lock(&pCache->mutex);
+
+  int64_t generation = (tsdbGetFidGeneration(pCache, fid) | 1) + 1;
+  taosHashPut(pCache->pGenHash, (const char *)&fid, sizeof(fid), &generation, sizeof(generation));
+
+  int32_t           num = 0;
+  SBlockCacheQueue *queues[] = {&pCache->fifo, &pCache->lru};
+  for (int i = 0; i < tListLen(queues); i++) {
+    SBlockCacheNode *pNode = queues[i]->head;
+    while (pNode != NULL) {
+      SBlockCacheNode *pNext = pNode->next;
+      if (pNode->key.fid == fid) {
+        tsdbBlockCacheRemoveNode(pCache, pNode);
+        num++;
+      }
+
+      pNode = pNext;
+    }
+  }
+
+  pthread_mutex_unlock(&pCache->mutex);
+  uTrace("%d items of fid:%d are removed from block cache", num, fid);
+}
+
+void tsdbGetBlockCacheStatis(int64_t *hitNum, int64_t *missNum) {
+  *hitNum = atomic_exchange_64(&tsdbBlockCacheHitNum, 0);
+  *missNum = atomic_exchange_64(&tsdbBlockCacheMissNum, 0);
+}
@@ -0,0 +1,505 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "tulog.h"
+#include "tchecksum.h"
+#include "ttime.h"
+#include "tsdbMain.h"
+
+#define TSDB_COMPACT_SLEEP_MS 100
+
+// a file group is compacted if a quarter of its blocks are fragmented, or half of its data files are dead
+#define TSDB_COMPACT_FRAG_RATIO 4
+#define TSDB_COMPACT_DEAD_RATIO 2
+
+static const char *tsdbCompactSuffix[] = {
+    ".ch",  // TSDB_FILE_TYPE_HEAD
+    ".cd",  // TSDB_FILE_TYPE_DATA
+    ".cl"   // TSDB_FILE_TYPE_LAST
+};
+
+// the names which the old files are renamed to during the swap
+static const char *tsdbBackupSuffix[] = {
+    ".bh",  // TSDB_FILE_TYPE_HEAD
+    ".bd",  // TSDB_FILE_TYPE_DATA
+    ".bl"   // TSDB_FILE_TYPE_LAST
+};
+
+typedef struct {
+  SCompIdx * pCompIdx;   // the SCompIdx part of new .head file
+  SCompInfo *pCompInfo;  // the SCompInfo of current table
+  int32_t    numOfBlocks;
+  int32_t    maxBlocks;
+  SDataCols *pDataCols;  // the rows loaded from fragmented blocks and not written yet
+  SFile      files[TSDB_FILE_TYPE_MAX];
+  SFile      backups[TSDB_FILE_TYPE_MAX];  // only the names are used
+} SCompactH;
+
+static bool tsdbCompactStopped(STsdbCompactor *pCompactor) { return pCompactor->stop || pCompactor->aborted; }
+
+// sleep if the bytes read and written go beyond the bandwidth budget
+static void tsdbCompactThrottle(STsdbCompactor *pCompactor, int64_t bytes) {
+  pCompactor->bytes += bytes;
+
+  int64_t budget = (int64_t)tsCompactMaxMBPerSec * 1024 * 1024;
+  int64_t expected = pCompactor->bytes * 1000 / budget;
+  int64_t elapsed = taosGetTimestampMs() - pCompactor->startTime;
+
+  while (expected > elapsed && !tsdbCompactStopped(pCompactor)) {
+    taosMsleep(MIN(expected - elapsed, TSDB_COMPACT_SLEEP_MS));
+    elapsed = taosGetTimestampMs() - pCompactor->startTime;
+  }
+}
+
+static int64_t tsdbGetBlockBytes(SRWHelper *pHelper, SCompBlock *pCompBlock) {
+  if (pCompBlock->numOfSubBlocks <= 1) return pCompBlock->len;
+
+  int64_t     bytes = 0;
+  SCompBlock *pSubBlock = (SCompBlock *)((char *)pHelper->pCompInfo + pCompBlock->offset);
+  for (int i = 0; i < pCompBlock->numOfSubBlocks; i++) {
+    bytes += pSubBlock[i].len;
+  }
+
+  return bytes;
+}
+
+static int64_t tsdbGetFileBytes(SFile *pFile) {
+  struct stat fstatus;
+  if (pFile->fd < 0 || fstat(pFile->fd, &fstatus) < 0) return 0;
+
+  return fstatus.st_size - TSDB_FILE_HEAD_SIZE;
+}
+
+static bool tsdbShouldCompact(STsdbRepo *pRepo, SRWHelper *pHelper) {
+  STsdbMeta *pMeta = pRepo->tsdbMeta;
+  int32_t    numOfBlocks = 0;
+  int32_t    numOfFragBlocks = 0;
+  int64_t    liveBytes = 0;
+
+  for (int tid = 0; tid < pRepo->config.maxTables; tid++) {
+    SCompIdx *pIdx = pHelper->pCompIdx + tid;
+    if (pIdx->offset <= 0) continue;
+
+    // the data of dropped tables are dead
+    STable *pTable = pMeta->tables[tid];
+    if (pTable == NULL) continue;
+
+    tsdbSetHelperTable(pHelper, pTable, pRepo);
+    if (tsdbLoadCompInfo(pHelper, NULL) < 0) return false;
+    if (pHelper->pCompInfo->uid != pTable->tableId.uid) continue;
+
+    for (int i = 0; i < pIdx->numOfSuperBlocks; i++) {
+      SCompBlock *pCompBlock = blockAtIdx(pHelper, i);
+      if (pCompBlock->numOfSubBlocks > 1 ||
+          (!pCompBlock->last && pCompBlock->numOfPoints < pHelper->config.minRowsPerFileBlock)) {
+        numOfFragBlocks++;
+      }
+
+      numOfBlocks++;
+      liveBytes += tsdbGetBlockBytes(pHelper, pCompBlock);
+    }
+  }
+
+  int64_t fileBytes = tsdbGetFileBytes(&pHelper->files.dataF) + tsdbGetFileBytes(&pHelper->files.lastF);
+  int64_t deadBytes = fileBytes - liveBytes;
+
+  uTrace("vgId:%d fid:%d has %d blocks, %d fragmented, %" PRId64 " of %" PRId64 " bytes dead", pRepo->config.tsdbId,
+         pHelper->files.fid, numOfBlocks, numOfFragBlocks, deadBytes, fileBytes);
+
+  if (numOfFragBlocks > 0 && numOfFragBlocks * TSDB_COMPACT_FRAG_RATIO >= numOfBlocks) return true;
+  if (deadBytes > 0 && deadBytes * TSDB_COMPACT_DEAD_RATIO >= fileBytes) return true;
+
+  return false;
+}
+
+static int tsdbAddCompactBlock(SCompactH *pCompactH, SCompBlock *pCompBlock) {
+  if (pCompactH->numOfBlocks >= pCompactH->maxBlocks) {
+    int32_t    maxBlocks = (pCompactH->maxBlocks == 0) ? 64 : pCompactH->maxBlocks * 2;
+    SCompInfo *pCompInfo =
+        (SCompInfo *)realloc(pCompactH->pCompInfo, sizeof(SCompInfo) + sizeof(SCompBlock) * maxBlocks + sizeof(TSCKSUM));
+    if (pCompInfo == NULL) return -1;
+
+    pCompactH->pCompInfo = pCompInfo;
+    pCompactH->maxBlocks = maxBlocks;
+  }
+
+  pCompactH->pCompInfo->blocks[pCompactH->numOfBlocks++] = *pCompBlock;
+  return 0;
+}
+
+// write the first rows of the loaded rows as a new super-block
+static int tsdbFlushCompactRows(STsdbCompactor *pCompactor, SRWHelper *pHelper, SCompactH *pCompactH, int rows) {
+  SDataCols *pDataCols = pCompactH->pDataCols;
+  SCompBlock compBlock;
+
+  bool   isLast = (rows == pDataCols->numOfPoints) && (rows < pHelper->config.minRowsPerFileBlock);
+  SFile *pFile = isLast ? &pCompactH->files[TSDB_FILE_TYPE_LAST] : &pCompactH->files[TSDB_FILE_TYPE_DATA];
+
+  if (tsdbWriteBlockToFile(pHelper, pFile, pDataCols, rows, &compBlock, isLast, true) < 0) return -1;
+  if (tsdbAddCompactBlock(pCompactH, &compBlock) < 0) return -1;
+
+  tdPopDataColsPoints(pDataCols, rows);
+  tsdbCompactThrottle(pCompactor, compBlock.len);
+  return 0;
+}
+
+// copy a full super-block without sub-blocks from the old .data file as it is
+static int tsdbCopyCompactBlock(STsdbCompactor *pCompactor, SRWHelper *pHelper, SCompactH *pCompactH,
+                                SCompBlock *pCompBlock) {
+  SFile *    pFile = &pCompactH->files[TSDB_FILE_TYPE_DATA];
+  SCompBlock compBlock = *pCompBlock;
+
+  compBlock.offset = lseek(pFile->fd, 0, SEEK_END);
+  if (compBlock.offset < 0) return -1;
+
+  if (lseek(pHelper->files.dataF.fd, pCompBlock->offset, SEEK_SET) < 0) return -1;
+  if (tsendfile(pFile->fd, pHelper->files.dataF.fd, NULL, pCompBlock->len) < pCompBlock->len) return -1;
+
+  if (tsdbAddCompactBlock(pCompactH, &compBlock) < 0) return -1;
+
+  tsdbCompactThrottle(pCompactor, (int64_t)pCompBlock->len * 2);
+  return 0;
+}
+
+static int tsdbCompactTable(STsdbCompactor *pCompactor, STsdbRepo *pRepo, SRWHelper *pHelper, SCompactH *pCompactH,
+                            STable *pTable) {
+  SDataCols *pDataCols = pCompactH->pDataCols;
+  int        minRows = pHelper->config.minRowsPerFileBlock;
+  int        maxRows = pHelper->config.maxRowsPerFileBlock;
+  int        defaultRows = maxRows * 4 / 5;
+
+  tsdbSetHelperTable(pHelper, pTable, pRepo);
+  if (tsdbLoadCompInfo(pHelper, NULL) < 0) return -1;
+  if (pHelper->pCompInfo->uid != pTable->tableId.uid) return 0;
+
+  tdInitDataCols(pDataCols, tsdbGetTableSchema(pRepo->tsdbMeta, pTable));
+  pCompactH->numOfBlocks = 0;
+
+  SCompIdx *pIdx = pHelper->pCompIdx + pTable->tableId.tid;
+  for (int i = 0; i < pIdx->numOfSuperBlocks; i++) {
+    if (tsdbCompactStopped(pCompactor)) return -1;
+
+    SCompBlock *pCompBlock = blockAtIdx(pHelper, i);
+    if (pCompBlock->numOfSubBlocks == 1 && !pCompBlock->last && pCompBlock->numOfPoints >= minRows &&
+        (pDataCols->numOfPoints == 0 || pDataCols->numOfPoints >= minRows)) {
+      if (pDataCols->numOfPoints > 0 && tsdbFlushCompactRows(pCompactor, pHelper, pCompactH, pDataCols->numOfPoints) < 0) {
+        return -1;
+      }
+
+      if (tsdbCopyCompactBlock(pCompactor, pHelper, pCompactH, pCompBlock) < 0) return -1;
+      continue;
+    }
+
+    // the block with sub-blocks or too few rows is merged with its neighbours
+    int64_t readBytes = pHelper->blockReadBytes;
+    if (tsdbLoadBlockData(pHelper, pCompBlock, NULL) < 0) return -1;
+    if (tdMergeDataCols(pDataCols, pHelper->pDataCols[0], pHelper->pDataCols[0]->numOfPoints) < 0) return -1;
+    tsdbCompactThrottle(pCompactor, pHelper->blockReadBytes - readBytes);
+
+    while (pDataCols->numOfPoints >= defaultRows) {
+      int rows = (pDataCols->numOfPoints <= maxRows) ? pDataCols->numOfPoints : defaultRows;
+      if (tsdbFlushCompactRows(pCompactor, pHelper, pCompactH, rows) < 0) return -1;
+    }
+  }
+
+  if (pDataCols->numOfPoints > 0 && tsdbFlushCompactRows(pCompactor, pHelper, pCompactH, pDataCols->numOfPoints) < 0) {
+    return -1;
+  }
+
+  // write the SCompInfo part of the table to the new .head file
+  SFile *    pHeadF = &pCompactH->files[TSDB_FILE_TYPE_HEAD];
+  SCompIdx * pNewIdx = pCompactH->pCompIdx + pTable->tableId.tid;
+  SCompInfo *pCompInfo = pCompactH->pCompInfo;
+  int32_t    len = sizeof(SCompInfo) + sizeof(SCompBlock) * pCompactH->numOfBlocks + sizeof(TSCKSUM);
+
+  pCompInfo->delimiter = TSDB_FILE_DELIMITER;
+  pCompInfo->uid = pTable->tableId.uid;
+  pCompInfo->checksum = 0;
+  taosCalcChecksumAppend(0, (uint8_t *)pCompInfo, len);
+
+  pNewIdx->offset = lseek(pHeadF->fd, 0, SEEK_END);
+  if (pNewIdx->offset < 0) return -1;
+  if (twrite(pHeadF->fd, (void *)pCompInfo, len) < len) return -1;
+
+  pNewIdx->len = len;
+  pNewIdx->numOfSuperBlocks = pCompactH->numOfBlocks;
+  pNewIdx->hasLast = pCompInfo->blocks[pCompactH->numOfBlocks - 1].last;
+  pNewIdx->maxKey = pCompInfo->blocks[pCompactH->numOfBlocks - 1].keyLast;
+
+  return 0;
+}
+
+static void tsdbCloseCompactFiles(SCompactH *pCompactH, bool toRemove) {
+  for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+    SFile *pFile = &pCompactH->files[type];
+    if (pFile->fd >= 0) {
+      fsync(pFile->fd);
+      tsdbCloseFile(pFile);
+    }
+
+    if (toRemove && pFile->fname[0] != 0) remove(pFile->fname);
+  }
+}
+
+static int tsdbCreateCompactFiles(STsdbRepo *pRepo, SFileGroup *pGroup, SCompactH *pCompactH) {
+  char *fnameDup = strdup(pGroup->files[TSDB_FILE_TYPE_HEAD].fname);
+  if (fnameDup == NULL) return -1;
+  char *dataDir = dirname(fnameDup);
+
+  int code = 0;
+  for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+    SFile *pFile = &pCompactH->files[type];
+
+    // the files left by a compaction failed before are removed
+    tsdbGetFileName(dataDir, pGroup->fileId, tsdbCompactSuffix[type], pFile->fname);
+    tsdbGetFileName(dataDir, pGroup->fileId, tsdbBackupSuffix[type], pCompactH->backups[type].fname);
+    remove(pFile->fname);
+
+    if (tsdbCreateFile(dataDir, pGroup->fileId, tsdbCompactSuffix[type], pRepo->config.maxTables, pFile,
+                       type == TSDB_FILE_TYPE_HEAD, 0) < 0) {
+      code = -1;
+      break;
+    }
+  }
+
+  free(fnameDup);
+  return code;
+}
+
+static int tsdbRenameCompactFile(STsdbRepo *pRepo, char *oldName, char *newName) {
+  if (rename(oldName, newName) < 0) {
+    uError("vgId:%d failed to rename %s to %s, reason:%s", pRepo->config.tsdbId, oldName, newName, strerror(errno));
+    return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * Replace the files of the file group with the new files, unless a commit wrote to the file group in the meantime.
+ *
+ * The old files are renamed to backups before the new files are renamed over them. If a rename fails, the renames
+ * done are reverted, so the file group is left with the old files instead of a mix of old and new ones, and the caller
+ * removes the new files. The swap is done under the lock of repository, under which a query opens the files, since
+ * the offsets of blocks in the old .head file are not valid in the new .data file.
+ */
+static bool tsdbSwapCompactFiles(STsdbRepo *pRepo, STsdbCompactor *pCompactor, SFileGroup *pGroup,
+                                 SCompactH *pCompactH) {
+  bool swapped = false;
+  int  backed = TSDB_FILE_TYPE_HEAD;
+  int  replaced = TSDB_FILE_TYPE_HEAD;
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+
+  if (!tsdbCompactStopped(pCompactor)) {
+    tsdbStartInvalidateBlockCache(pRepo->pBlockCache, pGroup->fileId);
+    tsdbInvalidateHeadIndex(pRepo->pHeadIdxCache, pGroup->fileId);
+
+    for (; backed < TSDB_FILE_TYPE_MAX; backed++) {
+      if (tsdbRenameCompactFile(pRepo, pGroup->files[backed].fname, pCompactH->backups[backed].fname) < 0) break;
+    }
+
+    for (; backed == TSDB_FILE_TYPE_MAX && replaced < TSDB_FILE_TYPE_MAX; replaced++) {
+      if (tsdbRenameCompactFile(pRepo, pCompactH->files[replaced].fname, pGroup->files[replaced].fname) < 0) break;
+    }
+
+    swapped = (replaced == TSDB_FILE_TYPE_MAX);
+
+    while (!swapped && --replaced >= TSDB_FILE_TYPE_HEAD) {
+      tsdbRenameCompactFile(pRepo, pGroup->files[replaced].fname, pCompactH->files[replaced].fname);
+    }
+
+    while (!swapped && --backed >= TSDB_FILE_TYPE_HEAD) {
+      tsdbRenameCompactFile(pRepo, pCompactH->backups[backed].fname, pGroup->files[backed].fname);
+    }
+
+    // the old files are still read by the queries which opened them before
+    for (int type = TSDB_FILE_TYPE_HEAD; swapped && type < TSDB_FILE_TYPE_MAX; type++) {
+      remove(pCompactH->backups[type].fname);
+    }
+
+    tsdbInvalidateBlockCache(pRepo->pBlockCache, pGroup->fileId);
+  }
+
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  return swapped;
+}
+
+static int tsdbCompactFGroupImpl(STsdbRepo *pRepo, SFileGroup *pGroup) {
+  STsdbCompactor *pCompactor = pRepo->pCompactor;
+  SRWHelper       helper = {0};
+  SCompactH       compactH = {0};
+  int             code = 0;
+  size_t          idxSize = sizeof(SCompIdx) * pRepo->config.maxTables + sizeof(TSCKSUM);
+
+  for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+    compactH.files[type].fd = -1;
+  }
+
+  if (tsdbInitReadHelper(&helper, pRepo) < 0) return -1;
+  if (tsdbSetAndOpenHelperFile(&helper, pGroup) < 0) goto _err;
+  if (!tsdbShouldCompact(pRepo, &helper)) goto _exit;
+
+  if (tsdbCreateCompactFiles(pRepo, pGroup, &compactH) < 0) goto _err;
+
+  compactH.pCompIdx = (SCompIdx *)calloc(1, idxSize);
+  compactH.pDataCols = tdNewDataCols(pRepo->tsdbMeta->maxRowBytes, pRepo->tsdbMeta->maxCols,
+                                     pRepo->config.maxRowsPerFileBlock * 2);
+  if (compactH.pCompIdx == NULL || compactH.pDataCols == NULL) goto _err;
+
+  for (int tid = 0; tid < pRepo->config.maxTables; tid++) {
+    if (helper.pCompIdx[tid].offset <= 0) continue;
+
+    STable *pTable = pRepo->tsdbMeta->tables[tid];
+    if (pTable == NULL) continue;
+
+    if (tsdbCompactTable(pCompactor, pRepo, &helper, &compactH, pTable) < 0) goto _err;
+  }
+
+  SFile *pHeadF = &compactH.files[TSDB_FILE_TYPE_HEAD];
+  taosCalcChecksumAppend(0, (uint8_t *)compactH.pCompIdx, idxSize);
+  if (lseek(pHeadF->fd, TSDB_FILE_HEAD_SIZE, SEEK_SET) < 0) goto _err;
+  if (twrite(pHeadF->fd, (void *)compactH.pCompIdx, idxSize) < idxSize) goto _err;
+
+  tsdbCloseHelperFile(&helper, false);
+  tsdbCloseCompactFiles(&compactH, false);
+
+  if (tsdbSwapCompactFiles(pRepo, pCompactor, pGroup, &compactH)) {
+    uPrint("vgId:%d fid:%d is compacted, %" PRId64 " bytes read and written in %" PRId64 " ms", pRepo->config.tsdbId,
+           pGroup->fileId, pCompactor->bytes, taosGetTimestampMs() - pCompactor->startTime);
+  } else {
+    uTrace("vgId:%d compaction of fid:%d is abandoned", pRepo->config.tsdbId, pGroup->fileId);
+    tsdbCloseCompactFiles(&compactH, true);
+  }
+
+  goto _exit;
+
+_err:
+  code = -1;
+  if (!tsdbCompactStopped(pCompactor)) {
+    uError("vgId:%d failed to compact fid:%d", pRepo->config.tsdbId, pGroup->fileId);
+  }
+  tsdbCloseCompactFiles(&compactH, true);
+
+_exit:
+  tsdbDestroyHelper(&helper);
+  tfree(compactH.pCompIdx);
+  tfree(compactH.pCompInfo);
+  tdFreeDataCols(compactH.pDataCols);
+  return code;
+}
+
+static int tsdbCompactFGroup(STsdbRepo *pRepo, int fid) {
+  STsdbCompactor *pCompactor = pRepo->pCompactor;
+  SFileGroup      fGroup;
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+
+  // the file group being moved to another disk tier is left to the next round
+  SFileGroup *pGroup = tsdbSearchFGroup(pRepo->tsdbFileH, fid);
+  if (pGroup == NULL || pRepo->commitFid == fid || (pRepo->diskTier != NULL && pRepo->diskTier->fid == fid)) {
+    tsdbUnLockRepo((TsdbRepoT *)pRepo);
+    return 0;
+  }
+
+  // the group is copied since the file group array may be changed by commit
+  fGroup = *pGroup;
+  pCompactor->fid = fid;
+  pCompactor->aborted = 0;
+  pCompactor->bytes = 0;
+  pCompactor->startTime = taosGetTimestampMs();
+
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  int code = tsdbCompactFGroupImpl(pRepo, &fGroup);
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  pCompactor->fid = -1;
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  return code;
+}
+
+static void tsdbCompactRepo(STsdbRepo *pRepo) {
+  STsdbCompactor *pCompactor = pRepo->pCompactor;
+  STsdbCfg *      pCfg = &pRepo->config;
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+
+  STsdbFileH *pFileH = pRepo->tsdbFileH;
+  int         numOfFGroups = pFileH->numOfFGroups;
+  int *       fids = (int *)malloc(sizeof(int) * (numOfFGroups + 1));
+  for (int i = 0; fids != NULL && i < numOfFGroups; i++) {
+    fids[i] = pFileH->fGroup[i].fileId;
+  }
+
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+  if (fids == NULL) return;
+
+  // the file group of current time is still being written by in-order data, so it is left to the next round
+  int curFid = tsdbGetKeyFileId(taosGetTimestamp(pCfg->precision), pCfg->daysPerFile, pCfg->precision);
+  for (int i = 0; i < numOfFGroups && !pCompactor->stop; i++) {
+    if (fids[i] >= curFid) continue;
+    tsdbCompactFGroup(pRepo, fids[i]);
+  }
+
+  free(fids);
+}
+
+static void *tsdbCompactorThread(void *param) {
+  STsdbRepo *     pRepo = (STsdbRepo *)param;
+  STsdbCompactor *pCompactor = pRepo->pCompactor;
+  int64_t         lastTime = taosGetTimestampMs();
+
+  while (!pCompactor->stop) {
+    taosMsleep(TSDB_COMPACT_SLEEP_MS);
+
+    int64_t now = taosGetTimestampMs();
+    if (tsCompactInterval <= 0 || now - lastTime < (int64_t)tsCompactInterval * 1000) continue;
+
+    tsdbCompactRepo(pRepo);
+    lastTime = taosGetTimestampMs();
+  }
+
+  return NULL;
+}
+
+STsdbCompactor *tsdbStartCompactor(STsdbRepo *pRepo) {
+  if (tsCompactInterval <= 0) return NULL;
+
+  STsdbCompactor *pCompactor = (STsdbCompactor *)calloc(1, sizeof(STsdbCompactor));
+  if (pCompactor == NULL) return NULL;
+
+  pCompactor->fid = -1;
+  pRepo->pCompactor = pCompactor;
+
+  if (pthread_create(&pCompactor->thread, NULL, tsdbCompactorThread, (void *)pRepo) != 0) {
+    uError("vgId:%d failed to create compactor thread, reason:%s", pRepo->config.tsdbId, strerror(errno));
+    pRepo->pCompactor = NULL;
+    free(pCompactor);
+    return NULL;
+  }
+
+  return pCompactor;
+}
+
+void tsdbStopCompactor(STsdbCompactor *pCompactor) {
+  if (pCompactor == NULL) return;
+
+  pCompactor->stop = 1;
+  pthread_join(pCompactor->thread, NULL);
+  free(pCompactor);
+}
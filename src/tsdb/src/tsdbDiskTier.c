@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <libgen.h>
+
+#include "os.h"
+#include "tulog.h"
+#include "ttime.h"
+#include "tsdbMain.h"
+
+#define TSDB_DISK_TIER_SLEEP_MS 100
+#define TSDB_DISK_TIER_CHECK_MS (60 * 1000)
+#define TSDB_DISK_TIER_COPY_BYTES (1024 * 1024)
+
+static const char *tsdbMoveSuffix[] = {
+    ".mh",  // TSDB_FILE_TYPE_HEAD
+    ".md",  // TSDB_FILE_TYPE_DATA
+    ".ml"   // TSDB_FILE_TYPE_LAST
+};
+
+static bool tsdbMoveStopped(STsdbDiskTier *pTier) { return pTier->stop || pTier->aborted; }
+
+// sleep if the bytes read and written go beyond the bandwidth budget, which is shared with compaction
+static void tsdbMoveThrottle(STsdbDiskTier *pTier, int64_t bytes) {
+  pTier->bytes += bytes;
+
+  int64_t budget = (int64_t)tsCompactMaxMBPerSec * 1024 * 1024;
+  int64_t expected = pTier->bytes * 1000 / budget;
+  int64_t elapsed = taosGetTimestampMs() - pTier->startTime;
+
+  while (expected > elapsed && !tsdbMoveStopped(pTier)) {
+    taosMsleep(MIN(expected - elapsed, TSDB_DISK_TIER_SLEEP_MS));
+    elapsed = taosGetTimestampMs() - pTier->startTime;
+  }
+}
+
+static int tsdbCopyTierFile(STsdbDiskTier *pTier, char *src, char *dst) {
+  int sfd = open(src, O_RDONLY);
+  if (sfd < 0) return -1;
+
+  int dfd = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+  if (dfd < 0) {
+    close(sfd);
+    return -1;
+  }
+
+  int         code = 0;
+  struct stat fstatus;
+  if (fstat(sfd, &fstatus) < 0) code = -1;
+
+  for (int64_t left = fstatus.st_size; code == 0 && left > 0;) {
+    if (tsdbMoveStopped(pTier)) {
+      code = -1;
+      break;
+    }
+
+    size_t bytes = MIN(left, TSDB_DISK_TIER_COPY_BYTES);
+    if (tsendfile(dfd, sfd, NULL, bytes) < bytes) code = -1;
+
+    left -= bytes;
+    tsdbMoveThrottle(pTier, (int64_t)bytes * 2);
+  }
+
+  if (code == 0 && fsync(dfd) < 0) code = -1;
+
+  close(sfd);
+  close(dfd);
+  return code;
+}
+
+// replace the files of the file group with the moved files, unless a commit wrote to the file group in the meantime
+static bool tsdbSwapMovedFiles(STsdbRepo *pRepo, SFileGroup *pGroup, SFileGroup *pMoved, SFile *pTmpFiles) {
+  STsdbDiskTier *pTier = pRepo->diskTier;
+  bool           swapped = false;
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+
+  SFileGroup *pCurGroup = tsdbSearchFGroup(pRepo->tsdbFileH, pGroup->fileId);
+  if (!tsdbMoveStopped(pTier) && pCurGroup != NULL) {
+    int type = TSDB_FILE_TYPE_HEAD;
+    for (; type < TSDB_FILE_TYPE_MAX; type++) {
+      if (rename(pTmpFiles[type].fname, pMoved->files[type].fname) < 0) {
+        uError("vgId:%d failed to rename %s to %s, reason:%s", pRepo->config.tsdbId, pTmpFiles[type].fname,
+               pMoved->files[type].fname, strerror(errno));
+        break;
+      }
+    }
+
+    swapped = (type == TSDB_FILE_TYPE_MAX);
+
+    // the files renamed are put back, so no partial file group is left in the new level, and the caller removes them
+    while (!swapped && --type >= TSDB_FILE_TYPE_HEAD) {
+      if (rename(pMoved->files[type].fname, pTmpFiles[type].fname) < 0) {
+        uError("vgId:%d failed to rename %s back to %s, reason:%s", pRepo->config.tsdbId, pMoved->files[type].fname,
+               pTmpFiles[type].fname, strerror(errno));
+        remove(pMoved->files[type].fname);
+      }
+    }
+
+    if (swapped) {
+      *pCurGroup = *pMoved;
+      tdListAppend(pTier->pRemoved, pGroup);
+    }
+  }
+
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  return swapped;
+}
+
+static int tsdbMoveFGroupImpl(STsdbRepo *pRepo, SFileGroup *pGroup, int8_t level) {
+  STsdbDiskTier *pTier = pRepo->diskTier;
+  SFileGroup     moved = *pGroup;
+  SFile          tmpFiles[TSDB_FILE_TYPE_MAX];
+  int            code = 0;
+
+  moved.level = level;
+  for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+    SFile *pFile = &moved.files[type];
+    pFile->fd = -1;
+    tsdbGetFileName(pTier->dirs[level], pGroup->fileId, tsdbFileSuffix[type], pFile->fname);
+
+    // the files left by a move failed before are overwritten
+    tsdbGetFileName(pTier->dirs[level], pGroup->fileId, tsdbMoveSuffix[type], tmpFiles[type].fname);
+    if (tsdbCopyTierFile(pTier, pGroup->files[type].fname, tmpFiles[type].fname) < 0) {
+      code = -1;
+      break;
+    }
+  }
+
+  if (code == 0 && tsdbSwapMovedFiles(pRepo, pGroup, &moved, tmpFiles)) {
+    uPrint("vgId:%d fid:%d is moved to disk tier level %d, %" PRId64 " bytes copied in %" PRId64 " ms",
+           pRepo->config.tsdbId, pGroup->fileId, level, pTier->bytes / 2, taosGetTimestampMs() - pTier->startTime);
+    return 0;
+  }
+
+  if (code < 0 && !tsdbMoveStopped(pTier)) {
+    uError("vgId:%d failed to move fid:%d to %s, reason:%s", pRepo->config.tsdbId, pGroup->fileId, pTier->dirs[level],
+           strerror(errno));
+  } else {
+    uTrace("vgId:%d move of fid:%d is abandoned", pRepo->config.tsdbId, pGroup->fileId);
+  }
+
+  for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+    remove(tmpFiles[type].fname);
+  }
+
+  return -1;
+}
+
+static int tsdbMoveFGroup(STsdbRepo *pRepo, int fid, int8_t level) {
+  STsdbDiskTier *pTier = pRepo->diskTier;
+  SFileGroup     fGroup;
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+
+  // the file group being committed or compacted is left to the next round
+  SFileGroup *pGroup = tsdbSearchFGroup(pRepo->tsdbFileH, fid);
+  if (pGroup == NULL || pGroup->level >= level || pRepo->commitFid == fid ||
+      (pRepo->pCompactor != NULL && pRepo->pCompactor->fid == fid)) {
+    tsdbUnLockRepo((TsdbRepoT *)pRepo);
+    return 0;
+  }
+
+  // the group is copied since the file group array may be changed by commit
+  fGroup = *pGroup;
+  pTier->fid = fid;
+  pTier->aborted = 0;
+  pTier->bytes = 0;
+  pTier->startTime = taosGetTimestampMs();
+
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  int code = tsdbMoveFGroupImpl(pRepo, &fGroup, level);
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  pTier->fid = -1;
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  return code;
+}
+
+static void tsdbRemoveMovedFiles(STsdbDiskTier *pTier) {
+  SListNode *pNode = NULL;
+  while ((pNode = tdListPopHead(pTier->pRemoved)) != NULL) {
+    SFileGroup fGroup;
+    tdListNodeGetData(pTier->pRemoved, pNode, &fGroup);
+    free(pNode);
+
+    for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+      remove(fGroup.files[type].fname);
+    }
+  }
+}
+
+static void tsdbMoveRepo(STsdbRepo *pRepo) {
+  STsdbDiskTier *pTier = pRepo->diskTier;
+  STsdbCfg *     pCfg = &pRepo->config;
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+
+  // the files moved in the last round are not read by queries any more
+  tsdbRemoveMovedFiles(pTier);
+
+  STsdbFileH *pFileH = pRepo->tsdbFileH;
+  int         numOfFGroups = pFileH->numOfFGroups;
+  int *       fids = (int *)malloc(sizeof(int) * (numOfFGroups + 1));
+  for (int i = 0; fids != NULL && i < numOfFGroups; i++) {
+    fids[i] = pFileH->fGroup[i].fileId;
+  }
+
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+  if (fids == NULL) return;
+
+  TSKEY   now = taosGetTimestamp(pCfg->precision);
+  int64_t tierKeys = (int64_t)tsTierDays * tsMsPerDay[pCfg->precision];
+  for (int i = 0; i < numOfFGroups && !pTier->stop; i++) {
+    TSKEY minKey = 0, maxKey = 0;
+    tsdbGetKeyRangeOfFileId(pCfg->daysPerFile, pCfg->precision, fids[i], &minKey, &maxKey);
+    if (maxKey >= now) continue;
+
+    int64_t level = (now - maxKey) / tierKeys;
+    if (level <= 0) continue;
+    if (level >= pTier->numOfLevels) level = pTier->numOfLevels - 1;
+
+    tsdbMoveFGroup(pRepo, fids[i], (int8_t)level);
+  }
+
+  free(fids);
+}
+
+static void *tsdbDiskTierThread(void *param) {
+  STsdbRepo *    pRepo = (STsdbRepo *)param;
+  STsdbDiskTier *pTier = pRepo->diskTier;
+  int64_t        lastTime = 0;
+
+  while (!pTier->stop) {
+    taosMsleep(TSDB_DISK_TIER_SLEEP_MS);
+
+    int64_t now = taosGetTimestampMs();
+    if (now - lastTime < TSDB_DISK_TIER_CHECK_MS) continue;
+
+    tsdbMoveRepo(pRepo);
+    lastTime = taosGetTimestampMs();
+  }
+
+  return NULL;
+}
+
+static int tsdbMakeTierDir(char *dir) {
+  if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+    uError("failed to create disk tier directory %s, reason:%s", dir, strerror(errno));
+    return -1;
+  }
+
+  return 0;
+}
+
+static int tsdbInitTierDirs(STsdbRepo *pRepo, STsdbDiskTier *pTier, char *dataDir) {
+  strncpy(pTier->dirs[0], dataDir, TSDB_FILENAME_LEN - 1);
+  pTier->numOfLevels = 1;
+
+  char *tierDirs = strdup(tsTierDataDir);
+  if (tierDirs == NULL) return -1;
+
+  int   code = 0;
+  char *p = tierDirs;
+  for (char *dir = strsep(&p, ","); dir != NULL; dir = strsep(&p, ",")) {
+    strtrim(dir);
+    if (dir[0] == 0) continue;
+
+    if (pTier->numOfLevels >= TSDB_MAX_DISK_TIERS) {
+      uError("vgId:%d only %d disk tiers are supported, %s is ignored", pRepo->config.tsdbId, TSDB_MAX_DISK_TIERS, dir);
+      break;
+    }
+
+    char *tierDir = pTier->dirs[pTier->numOfLevels];
+    snprintf(tierDir, TSDB_FILENAME_LEN, "%s/vnode%d", dir, pRepo->config.tsdbId);
+    if (tsdbMakeTierDir(tierDir) < 0) {
+      code = -1;
+      break;
+    }
+
+    snprintf(tierDir, TSDB_FILENAME_LEN, "%s/vnode%d/data", dir, pRepo->config.tsdbId);
+    if (tsdbMakeTierDir(tierDir) < 0) {
+      code = -1;
+      break;
+    }
+
+    pTier->numOfLevels++;
+  }
+
+  free(tierDirs);
+  return code;
+}
+
+/*
+ * Load the file groups on the lower disk tiers and start the mover. The repository fails to open if a tier is not
+ * accessible, otherwise its file groups would be missed.
+ */
+int tsdbOpenDiskTier(STsdbRepo *pRepo, char *dataDir) {
+  pRepo->diskTier = NULL;
+  if (tsTierDataDir[0] == 0) return 0;
+
+  STsdbDiskTier *pTier = (STsdbDiskTier *)calloc(1, sizeof(STsdbDiskTier));
+  if (pTier == NULL) return -1;
+
+  pTier->fid = -1;
+  pTier->pRemoved = tdListNew(sizeof(SFileGroup));
+  if (pTier->pRemoved == NULL || tsdbInitTierDirs(pRepo, pTier, dataDir) < 0) goto _err;
+
+  for (int8_t level = 1; level < pTier->numOfLevels; level++) {
+    if (tsdbOpenTierFGroups(pRepo->tsdbFileH, pTier->dirs[level], level) < 0) {
+      uError("vgId:%d failed to open file groups in %s", pRepo->config.tsdbId, pTier->dirs[level]);
+      goto _err;
+    }
+  }
+
+  pRepo->diskTier = pTier;
+  if (pTier->numOfLevels <= 1) return 0;
+
+  if (pthread_create(&pTier->thread, NULL, tsdbDiskTierThread, (void *)pRepo) != 0) {
+    uError("vgId:%d failed to create disk tier thread, reason:%s", pRepo->config.tsdbId, strerror(errno));
+    pRepo->diskTier = NULL;
+    goto _err;
+  }
+
+  return 0;
+
+_err:
+  tdListFree(pTier->pRemoved);
+  free(pTier);
+  return -1;
+}
+
+// remove the files and directories on the lower disk tiers when the repository is dropped
+static void tsdbRemoveTierFiles(STsdbRepo *pRepo, STsdbDiskTier *pTier) {
+  STsdbFileH *pFileH = pRepo->tsdbFileH;
+
+  for (int i = 0; pFileH != NULL && i < pFileH->numOfFGroups; i++) {
+    SFileGroup *pGroup = pFileH->fGroup + i;
+    if (pGroup->level == 0) continue;
+
+    for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+      remove(pGroup->files[type].fname);
+    }
+  }
+
+  for (int level = 1; level < pTier->numOfLevels; level++) {
+    rmdir(pTier->dirs[level]);
+    rmdir(dirname(pTier->dirs[level]));
+  }
+}
+
+void tsdbCloseDiskTier(STsdbRepo *pRepo, bool toRemove) {
+  STsdbDiskTier *pTier = pRepo->diskTier;
+  if (pTier == NULL) return;
+
+  pTier->stop = 1;
+  if (pTier->numOfLevels > 1) pthread_join(pTier->thread, NULL);
+
+  tsdbRemoveMovedFiles(pTier);
+  if (toRemove) tsdbRemoveTierFiles(pRepo, pTier);
+
+  tdListFree(pTier->pRemoved);
+  free(pTier);
+  pRepo->diskTier = NULL;
+}
@@ -38,7 +38,7 @@ static int compFGroupKey(const void *key, const void *fgroup);
 static int compFGroup(const void *arg1, const void *arg2);
 static int tsdbWriteFileHead(SFile *pFile);
 static int tsdbWriteHeadFileIdx(SFile *pFile, int maxTables);
-static int tsdbOpenFGroup(STsdbFileH *pFileH, char *dataDir, int fid);
+static int tsdbOpenFGroup(STsdbFileH *pFileH, char *dataDir, int fid, int8_t level);
 
 STsdbFileH *tsdbInitFileH(char *dataDir, int maxFiles) {
   STsdbFileH *pFileH = (STsdbFileH *)calloc(1, sizeof(STsdbFileH) + sizeof(SFileGroup) * maxFiles);
@@ -59,7 +59,7 @@ STsdbFileH *tsdbInitFileH(char *dataDir, int maxFiles) {
     if (strncmp(dp->d_name, ".", 1) == 0 || strncmp(dp->d_name, "..", 1) == 0) continue;
     int fid = 0;
     sscanf(dp->d_name, "f%d", &fid);
-    if (tsdbOpenFGroup(pFileH, dataDir, fid) < 0) {
+    if (tsdbOpenFGroup(pFileH, dataDir, fid, 0) < 0) {
       break;
       // TODO
     }
@@ -69,6 +69,28 @@ STsdbFileH *tsdbInitFileH(char *dataDir, int maxFiles) {
   return pFileH;
 }
 
+/*
+ * Load the file groups placed on a lower disk tier, which should be called in the order of level. A file group found
+ * on several tiers is moved but the old files are not removed yet, so the files on the lowest tier are used, and the
+ * files on the upper tiers are removed, unless they are modified later.
+ */
+int tsdbOpenTierFGroups(STsdbFileH *pFileH, char *dataDir, int8_t level) {
+  DIR *dir = opendir(dataDir);
+  if (dir == NULL) return -1;
+
+  struct dirent *dp = NULL;
+  while ((dp = readdir(dir)) != NULL) {
+    int fid = 0;
+    if (sscanf(dp->d_name, "f%d", &fid) != 1) continue;
+
+    // the files of a file group not moved completely are left, and they are overwritten by the next move
+    tsdbOpenFGroup(pFileH, dataDir, fid, level);
+  }
+  closedir(dir);
+
+  return 0;
+}
+
 void tsdbCloseFileH(STsdbFileH *pFileH) { free(pFileH); }
 
 static int tsdbInitFile(char *dataDir, int fid, const char *suffix, SFile *pFile) {
@@ -80,15 +102,39 @@ static int tsdbInitFile(char *dataDir, int fid, const char *suffix, SFile *pFile
   return 0;
 }
 
-static int tsdbOpenFGroup(STsdbFileH *pFileH, char *dataDir, int fid) {
-  if (tsdbSearchFGroup(pFileH, fid) != NULL) return 0;
+static time_t tsdbGetFileMTime(SFile *pFile) {
+  struct stat fstatus;
+  if (stat(pFile->fname, &fstatus) < 0) return 0;
+  return fstatus.st_mtime;
+}
+
+static int tsdbOpenFGroup(STsdbFileH *pFileH, char *dataDir, int fid, int8_t level) {
+  SFileGroup *pGroup = tsdbSearchFGroup(pFileH, fid);
+  if (pGroup != NULL && pGroup->level >= level) return 0;
 
   SFileGroup fGroup = {0};
   fGroup.fileId = fid;
+  fGroup.level = level;
 
   for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
     if (tsdbInitFile(dataDir, fid, tsdbFileSuffix[type], &fGroup.files[type]) < 0) return -1;
   }
+
+  if (pGroup != NULL) {
+    // the files written after the move, e.g. the lower tier was not configured for a while, are kept
+    SFileGroup *pRemoved = (tsdbGetFileMTime(&pGroup->files[TSDB_FILE_TYPE_HEAD]) >
+                            tsdbGetFileMTime(&fGroup.files[TSDB_FILE_TYPE_HEAD]))
+                               ? &fGroup
+                               : pGroup;
+    for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
+      remove(pRemoved->files[type].fname);
+    }
+
+    if (pRemoved == pGroup) *pGroup = fGroup;
+    return 0;
+  }
+
+  if (pFileH->numOfFGroups >= pFileH->maxFGroups) return -1;
   pFileH->fGroup[pFileH->numOfFGroups++] = fGroup;
   qsort((void *)(pFileH->fGroup), pFileH->numOfFGroups, sizeof(SFileGroup), compFGroup);
   return 0;
@@ -108,6 +154,7 @@ SFileGroup *tsdbCreateFGroup(STsdbFileH *pFileH, char *dataDir, int fid, int max
   SFileGroup *pGroup = tsdbSearchFGroup(pFileH, fid);
   if (pGroup == NULL) {  // if not exists, create one
     pFGroup->fileId = fid;
+    pFGroup->level = 0;
     for (int type = TSDB_FILE_TYPE_HEAD; type < TSDB_FILE_TYPE_MAX; type++) {
       if (tsdbCreateFile(dataDir, fid, tsdbFileSuffix[type], maxTables, &(pFGroup->files[type]),
                          type == TSDB_FILE_TYPE_HEAD ? 1 : 0, 1) < 0)
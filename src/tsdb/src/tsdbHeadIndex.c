@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "tulog.h"
+#include "tchecksum.h"
+#include "tsdbMain.h"
+
+// read the whole .head file opened, and verify the SCompIdx part and the SCompInfo of all tables
+static SHeadIndex *tsdbReadHeadIndex(SHeadIndexCache *pCache, SFile *pHeadF, int32_t fid, int64_t generation) {
+  SHeadIndex *pIdx = NULL;
+  int         fd = pHeadF->fd;
+
+  struct stat fstatus;
+  if (fstat(fd, &fstatus) < 0 || lseek(fd, 0, SEEK_SET) < 0) goto _err;
+
+  int64_t size = fstatus.st_size;
+  int64_t idxSize = sizeof(SCompIdx) * pCache->maxTables + sizeof(TSCKSUM);
+  if (size < TSDB_FILE_HEAD_SIZE + idxSize) goto _err;
+
+  pIdx = (SHeadIndex *)malloc(sizeof(SHeadIndex) + size);
+  if (pIdx == NULL) goto _err;
+
+  pIdx->fid = fid;
+  pIdx->refCount = 1;
+  pIdx->generation = generation;
+  pIdx->size = size;
+  if (tread(fd, pIdx->data, size) < size) goto _err;
+
+  SCompIdx *pCompIdx = TSDB_HEAD_INDEX_COMP_IDX(pIdx);
+  if (!taosCheckChecksumWhole((uint8_t *)pCompIdx, idxSize)) goto _err;
+
+  for (int32_t i = 0; i < pCache->maxTables; i++) {
+    if (pCompIdx[i].offset <= 0) continue;
+
+    if (pCompIdx[i].offset + pCompIdx[i].len > size ||
+        !taosCheckChecksumWhole((uint8_t *)(pIdx->data + pCompIdx[i].offset), pCompIdx[i].len)) {
+      goto _err;
+    }
+  }
+
+  return pIdx;
+
+_err:
+  uError("failed to load head index from file %s", pHeadF->fname);
+  free(pIdx);
+  return NULL;
+}
+
+static int64_t tsdbGetFidGeneration(SHeadIndexCache *pCache, int32_t fid) {
+  int64_t *pGen = taosHashGet(pCache->pGenHash, (const char *)&fid, sizeof(fid));
+  return (pGen == NULL) ? 0 : *pGen;
+}
+
+SHeadIndexCache *tsdbNewHeadIndexCache(int32_t maxTables) {
+  SHeadIndexCache *pCache = (SHeadIndexCache *)calloc(1, sizeof(SHeadIndexCache));
+  if (pCache == NULL) return NULL;
+
+  pCache->maxTables = maxTables;
+  pCache->pHash = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
+  pCache->pGenHash = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
+  if (pCache->pHash == NULL || pCache->pGenHash == NULL) {
+    taosHashCleanup(pCache->pHash);
+    taosHashCleanup(pCache->pGenHash);
+    free(pCache);
+    return NULL;
+  }
+
+  pthread_mutex_init(&pCache->mutex, NULL);
+  return pCache;
+}
+
+void tsdbFreeHeadIndexCache(SHeadIndexCache *pCache) {
+  if (pCache == NULL) return;
+
+  SHashMutableIterator *pIter = taosHashCreateIter(pCache->pHash);
+  while (taosHashIterNext(pIter)) {
+    SHeadIndex **ppIdx = taosHashIterGet(pIter);
+    tsdbReleaseHeadIndex(*ppIdx);
+  }
+
+  taosHashDestroyIter(pIter);
+  taosHashCleanup(pCache->pHash);
+  taosHashCleanup(pCache->pGenHash);
+  pthread_mutex_destroy(&pCache->mutex);
+  free(pCache);
+}
+
+/*
+ * Get the index of a file group from cache, which is called when the files are opened under the lock of repository.
+ * The generation of the .head file is returned in pGeneration, and the index is used only if it is loaded from the
+ * file of the same generation. NULL is returned if it is not cached, and the caller loads it by tsdbLoadHeadIndex.
+ * The returned index must be released by tsdbReleaseHeadIndex.
+ */
+SHeadIndex *tsdbAcquireHeadIndex(SHeadIndexCache *pCache, int32_t fid, int64_t *pGeneration) {
+  SHeadIndex *pIdx = NULL;
+
+  *pGeneration = -1;
+  if (pCache == NULL) return NULL;
+
+  pthread_mutex_lock(&pCache->mutex);
+
+  *pGeneration = tsdbGetFidGeneration(pCache, fid);
+  SHeadIndex **ppIdx = taosHashGet(pCache->pHash, (const char *)&fid, sizeof(fid));
+  if (ppIdx != NULL && (*ppIdx)->generation == *pGeneration) {
+    pIdx = *ppIdx;
+    atomic_add_fetch_32(&pIdx->refCount, 1);
+  }
+
+  pthread_mutex_unlock(&pCache->mutex);
+
+  return pIdx;
+}
+
+/*
+ * Load the index of a file group from the .head file opened, and put it into cache unless the file has been replaced
+ * since the generation is got. The returned index must be released by tsdbReleaseHeadIndex. NULL is returned if the
+ * file fails to load, and the caller should read the file directly.
+ */
+SHeadIndex *tsdbLoadHeadIndex(SHeadIndexCache *pCache, SFile *pHeadF, int32_t fid, int64_t generation) {
+  if (pCache == NULL || generation < 0) return NULL;
+
+  SHeadIndex *pIdx = tsdbReadHeadIndex(pCache, pHeadF, fid, generation);
+  if (pIdx == NULL) return NULL;
+
+  pthread_mutex_lock(&pCache->mutex);
+
+  SHeadIndex **ppIdx = taosHashGet(pCache->pHash, (const char *)&fid, sizeof(fid));
+  if (generation == tsdbGetFidGeneration(pCache, fid) && ppIdx == NULL) {
+    atomic_add_fetch_32(&pIdx->refCount, 1);  // one reference is held by cache
+    taosHashPut(pCache->pHash, (const char *)&fid, sizeof(fid), &pIdx, POINTER_BYTES);
+  }
+
+  pthread_mutex_unlock(&pCache->mutex);
+
+  uTrace("head index of fid:%d is loaded from file %s, size:%" PRId64, fid, pHeadF->fname, pIdx->size);
+  return pIdx;
+}
+
+void tsdbReleaseHeadIndex(SHeadIndex *pIdx) {
+  if (pIdx == NULL) return;
+
+  if (atomic_sub_fetch_32(&pIdx->refCount, 1) == 0) {
+    free(pIdx);
+  }
+}
+
+// called under the lock of repository before the .head file of a file group is replaced by commit or compaction
+void tsdbInvalidateHeadIndex(SHeadIndexCache *pCache, int32_t fid) {
+  if (pCache == NULL) return;
+
+  SHeadIndex *pIdx = NULL;
+
+  pthread_mutex_lock(&pCache->mutex);
+
+  int64_t generation = tsdbGetFidGeneration(pCache, fid) + 1;
+  taosHashPut(pCache->pGenHash, (const char *)&fid, sizeof(fid), &generation, sizeof(generation));
+  SHeadIndex **ppIdx = taosHashGet(pCache->pHash, (const char *)&fid, sizeof(fid));
+  if (ppIdx != NULL) {
+    pIdx = *ppIdx;
+    taosHashRemove(pCache->pHash, (const char *)&fid, sizeof(fid));
+  }
+
+  pthread_mutex_unlock(&pCache->mutex);
+
+  tsdbReleaseHeadIndex(pIdx);
+}
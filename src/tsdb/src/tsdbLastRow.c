@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "tulog.h"
+#include "tsdbMain.h"
+
+// keep a copy of the row if its key is larger than the last row of table, the repository must be locked
+static void tsdbSetLastRow(STable *pTable, SDataRow row, int32_t sversion) {
+  if (pTable->lastRow != NULL && dataRowKey(pTable->lastRow) >= dataRowKey(row)) return;
+
+  if (pTable->lastRow == NULL || dataRowLen(pTable->lastRow) != dataRowLen(row)) {
+    SDataRow lastRow = (SDataRow)realloc(pTable->lastRow, dataRowLen(row));
+    if (lastRow == NULL) {
+      uError("failed to keep last row of table uid:%" PRIu64 ", tid:%d", pTable->tableId.uid, pTable->tableId.tid);
+      return;
+    }
+
+    pTable->lastRow = lastRow;
+  }
+
+  dataRowCpy(pTable->lastRow, row);
+  pTable->lastRowVersion = sversion;
+}
+
+// get the row of the largest key in the cache of table, the repository must be locked
+static SDataRow tsdbGetLastRowInCache(STable *pTable) {
+  SDataRow   row = NULL;
+  SMemTable *mems[] = {pTable->mem, pTable->imem};
+
+  for (int i = 0; i < tListLen(mems); i++) {
+    SMemTable *pMem = mems[i];
+    if (pMem == NULL || pMem->numOfPoints <= 0) continue;
+    if (row != NULL && dataRowKey(row) >= pMem->keyLast) continue;
+
+    SSkipListIterator *pIter =
+        tSkipListCreateIterFromVal(pMem->pData, (const char *)&pMem->keyLast, TSDB_DATA_TYPE_TIMESTAMP, TSDB_ORDER_DESC);
+    if (pIter == NULL) continue;
+
+    if (tSkipListIterNext(pIter)) {
+      SSkipListNode *pNode = tSkipListIterGet(pIter);
+      if (pNode != NULL) row = SL_GET_NODE_DATA(pNode);
+    }
+    tSkipListDestroyIter(pIter);
+  }
+
+  return row;
+}
+
+// the columns are packed in the row one by one in the order of schema, the same as the rows in submit block
+static SDataRow tsdbGetDataColsRow(SDataCols *pCols, int idx) {
+  int32_t len = TD_DATA_ROW_HEAD_SIZE;
+  for (int i = 0; i < pCols->numOfCols; i++) {
+    len += pCols->cols[i].bytes;
+  }
+
+  SDataRow row = (SDataRow)malloc(len);
+  if (row == NULL) return NULL;
+
+  dataRowSetLen(row, len);
+  dataRowSetFLen(row, len);
+
+  int32_t offset = TD_DATA_ROW_HEAD_SIZE;
+  for (int i = 0; i < pCols->numOfCols; i++) {
+    SDataCol *pCol = pCols->cols + i;
+    memcpy(dataRowAt(row, offset), (char *)pCol->pData + pCol->bytes * idx, pCol->bytes);
+    offset += pCol->bytes;
+  }
+
+  return row;
+}
+
+/*
+ * The blocks of a table in a file group are ordered by key, so the last row in files is the last row of the last
+ * block of the table in the newest file group which has data of it.
+ */
+static int tsdbLoadLastRowFromFile(STsdbRepo *pRepo, STable *pTable, SDataRow *pRow) {
+  SRWHelper      helper;
+  SFileGroupIter iter;
+  SFileGroup *   pGroup = NULL;
+
+  *pRow = NULL;
+  if (tsdbInitReadHelper(&helper, pRepo) < 0) return -1;
+
+  tsdbInitFileGroupIter(pRepo->tsdbFileH, &iter, TSDB_FGROUP_ITER_BACKWARD);
+  while ((pGroup = tsdbGetFileGroupNext(&iter)) != NULL) {
+    if (tsdbSetAndOpenHelperFile(&helper, pGroup) < 0) goto _err;
+
+    SCompIdx *pIdx = helper.pCompIdx + pTable->tableId.tid;
+    if (pIdx->offset <= 0 || pIdx->numOfSuperBlocks <= 0) continue;
+
+    tsdbSetHelperTable(&helper, pTable, pRepo);
+    if (tsdbLoadCompInfo(&helper, NULL) < 0) goto _err;
+
+    // the data of a dropped table with the same tid
+    if (helper.pCompInfo->uid != pTable->tableId.uid) continue;
+
+    SCompBlock *pCompBlock = blockAtIdx(&helper, pIdx->numOfSuperBlocks - 1);
+    if (tsdbLoadBlockData(&helper, pCompBlock, NULL) < 0) goto _err;
+
+    SDataCols *pCols = helper.pDataCols[0];
+    if (pCols->numOfPoints <= 0) continue;
+
+    *pRow = tsdbGetDataColsRow(pCols, pCols->numOfPoints - 1);
+    if (*pRow == NULL) goto _err;
+
+    uTrace("vgId:%d last row of table uid:%" PRIu64 ", tid:%d is loaded from fid:%d, key:%" PRId64,
+           pRepo->config.tsdbId, pTable->tableId.uid, pTable->tableId.tid, pGroup->fileId, dataRowKey(*pRow));
+    break;
+  }
+
+  tsdbDestroyHelper(&helper);
+  return 0;
+
+_err:
+  uError("vgId:%d failed to load last row of table uid:%" PRIu64 ", tid:%d from files", pRepo->config.tsdbId,
+         pTable->tableId.uid, pTable->tableId.tid);
+  tsdbDestroyHelper(&helper);
+  return -1;
+}
+
+// called by insert with the row of the largest key in a submit block
+void tsdbUpdateTableLastRow(STsdbRepo *pRepo, STable *pTable, SDataRow row) {
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  tsdbSetLastRow(pTable, row, tsdbGetTableSchemaVersion(pRepo->tsdbMeta, pTable));
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+}
+
+/*
+ * Get a copy of the last row of table, which should be freed by the caller. NULL is returned if the table has no data,
+ * or the last row fails to be loaded from files.
+ *
+ * The last row in files is loaded at the first call after the repository is opened, instead of at open, so a
+ * repository with many tables opens without reading the blocks of every table. The rows inserted after open are
+ * kept by insert, so the last row is the larger one of them.
+ *
+ * The row is packed in the schema of its version. If the schema of table is changed, the row is dropped, and the last
+ * row is loaded again from files and the cache of table.
+ */
+SDataRow tsdbGetTableLastRow(STsdbRepo *pRepo, STable *pTable) {
+  SDataRow row = NULL;
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  int32_t sversion = tsdbGetTableSchemaVersion(pRepo->tsdbMeta, pTable);
+  if (pTable->lastRow != NULL && pTable->lastRowVersion != sversion) {
+    uTrace("vgId:%d last row of table uid:%" PRIu64 ", tid:%d in sversion:%d is dropped, sversion:%d",
+           pRepo->config.tsdbId, pTable->tableId.uid, pTable->tableId.tid, pTable->lastRowVersion, sversion);
+    tfree(pTable->lastRow);
+    pTable->lastRowLoaded = 0;
+  }
+  int8_t loaded = pTable->lastRowLoaded;
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  if (!loaded) {
+    if (tsdbLoadLastRowFromFile(pRepo, pTable, &row) < 0) return NULL;
+
+    tsdbLockRepo((TsdbRepoT *)pRepo);
+    if (row != NULL) tsdbSetLastRow(pTable, row, sversion);
+
+    SDataRow cacheRow = tsdbGetLastRowInCache(pTable);
+    if (cacheRow != NULL) tsdbSetLastRow(pTable, cacheRow, sversion);
+
+    pTable->lastRowLoaded = 1;
+    tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+    tdFreeDataRow(row);
+    row = NULL;
+  }
+
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  if (pTable->lastRow != NULL && pTable->lastRowVersion == sversion) row = tdDataRowDup(pTable->lastRow);
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  return row;
+}
@@ -4,6 +4,8 @@
 #include "tsdb.h"
 #include "tsdbMain.h"
 #include "tscompression.h"
+#include "ttime.h"
+#include "tmetrics.h"
 
 #define TSDB_DEFAULT_PRECISION TSDB_PRECISION_MILLI  // default precision
 #define IS_VALID_PRECISION(precision) (((precision) >= TSDB_PRECISION_MILLI) && ((precision) <= TSDB_PRECISION_NANO))
@@ -52,6 +54,8 @@ static int     tsdbHasDataToCommit(SSkipListIterator **iters, int nIters, TSKEY
 // static int tsdbWriteBlockToFileImpl(SFile *pFile, SDataCols *pCols, int pointsToWrite, int64_t *offset, int32_t *len,
 //                                     int64_t uid);
 
+static SMetric *tsdbCommitMetric = NULL;
+
 #define TSDB_GET_TABLE_BY_ID(pRepo, sid) (((STSDBRepo *)pRepo)->pTableList)[sid]
 #define TSDB_GET_TABLE_BY_NAME(pRepo, name)
 #define TSDB_IS_REPO_ACTIVE(pRepo) ((pRepo)->state == TSDB_REPO_STATE_ACTIVE)
@@ -148,11 +152,17 @@ int32_t tsdbDropRepo(TsdbRepoT *repo) {
 
   pRepo->state = TSDB_REPO_STATE_CLOSED;
 
+  tsdbStopCompactor(pRepo->pCompactor);
+  pRepo->pCompactor = NULL;
+  tsdbCloseDiskTier(pRepo, true);
+
   // Free the metaHandle
   tsdbFreeMeta(pRepo->tsdbMeta);
 
   // Free the cache
   tsdbFreeCache(pRepo->tsdbCache);
+  tsdbFreeBlockCache(pRepo->pBlockCache);
+  tsdbFreeHeadIndexCache(pRepo->pHeadIdxCache);
 
   // Destroy the repository info
   tsdbDestroyRepoEnv(pRepo);
@@ -210,8 +220,28 @@ TsdbRepoT *tsdbOpenRepo(char *tsdbDir, STsdbAppH *pAppH) {
     return NULL;
   }
 
+  if (tsdbOpenDiskTier(pRepo, dataDir) < 0) {
+    tsdbCloseFileH(pRepo->tsdbFileH);
+    tsdbFreeCache(pRepo->tsdbCache);
+    tsdbFreeMeta(pRepo->tsdbMeta);
+    free(pRepo->rootDir);
+    free(pRepo);
+    return NULL;
+  }
+
+  // the caches are optional, the query reads from files directly if they are disabled or failed to create
+  pRepo->pBlockCache = tsdbNewBlockCache((int64_t)tsBlockCacheSize * 1024 * 1024);
+  pRepo->pHeadIdxCache = tsdbNewHeadIndexCache(pRepo->config.maxTables);
+  tsdbInitRollupCfg(pRepo);
+
+  tsdbCommitMetric =
+      taosRegisterMetric("taosd_tsdb_commit_duration_seconds", "duration of commit to data files", TAOS_METRIC_HISTOGRAM);
+
+  pRepo->commitFid = -1;
   pRepo->state = TSDB_REPO_STATE_ACTIVE;
 
+  tsdbStartCompactor(pRepo);
+
   return (TsdbRepoT *)pRepo;
 }
 
@@ -252,6 +282,10 @@ int32_t tsdbCloseRepo(TsdbRepoT *repo) {
   pRepo->tsdbCache->curBlock = NULL;
   tsdbUnLockRepo(repo);
 
+  tsdbStopCompactor(pRepo->pCompactor);
+  pRepo->pCompactor = NULL;
+  tsdbCloseDiskTier(pRepo, false);
+
   tsdbCommitData((void *)repo);
 
   tsdbCloseFileH(pRepo->tsdbFileH);
@@ -259,6 +293,8 @@ int32_t tsdbCloseRepo(TsdbRepoT *repo) {
   tsdbFreeMeta(pRepo->tsdbMeta);
 
   tsdbFreeCache(pRepo->tsdbCache);
+  tsdbFreeBlockCache(pRepo->pBlockCache);
+  tsdbFreeHeadIndexCache(pRepo->pHeadIdxCache);
 
   tfree(pRepo->rootDir);
   tfree(pRepo);
@@ -533,7 +569,7 @@ SSubmitBlk *tsdbGetSubmitMsgNext(SSubmitMsgIter *pIter) {
   pBlock->tid = htonl(pBlock->tid);
   
   pBlock->sversion = htonl(pBlock->sversion);
-  pBlock->padding = htonl(pBlock->padding);
+  pBlock->flag = htonl(pBlock->flag);
   
   pIter->len = pIter->len + sizeof(SSubmitBlk) + pBlock->len;
   if (pIter->len >= pIter->totalLen) {
@@ -717,14 +753,14 @@ static int32_t tsdbDestroyRepoEnv(STsdbRepo *pRepo) {
 //   return 0;
 // }
 
-static int32_t tdInsertRowToTable(STsdbRepo *pRepo, SDataRow row, STable *pTable) {
-  // TODO
+// allocate the skiplist node of a row with len bytes from cache, the row is filled by the caller
+static SSkipListNode *tsdbAllocMemRow(STsdbRepo *pRepo, STable *pTable, int32_t len, TSKEY key) {
   int32_t level = 0;
   int32_t headSize = 0;
 
   if (pTable->mem == NULL) {
     pTable->mem = (SMemTable *)calloc(1, sizeof(SMemTable));
-    if (pTable->mem == NULL) return -1;
+    if (pTable->mem == NULL) return NULL;
     pTable->mem->pData = tSkipListCreate(5, TSDB_DATA_TYPE_TIMESTAMP, TYPE_BYTES[TSDB_DATA_TYPE_TIMESTAMP], 0, 0, 0, getTupleKey);
     pTable->mem->keyFirst = INT64_MAX;
     pTable->mem->keyLast = 0;
@@ -732,35 +768,118 @@ static int32_t tdInsertRowToTable(STsdbRepo *pRepo, SDataRow row, STable *pTable
 
   tSkipListNewNodeInfo(pTable->mem->pData, &level, &headSize);
 
-  TSKEY key = dataRowKey(row);
-  // printf("insert:%lld, size:%d\n", key, pTable->mem->numOfPoints);
-  
-  // Copy row into the memory
-  SSkipListNode *pNode = tsdbAllocFromCache(pRepo->tsdbCache, headSize + dataRowLen(row), key);
-  if (pNode == NULL) {
-    // TODO: deal with allocate failure
-  }
+  SSkipListNode *pNode = tsdbAllocFromCache(pRepo->tsdbCache, headSize + len, key);
+  if (pNode == NULL) return NULL;
 
   pNode->level = level;
-  dataRowCpy(SL_GET_NODE_DATA(pNode), row);
+  return pNode;
+}
 
-  // Insert the skiplist node into the data
-  if (pTable->mem == NULL) {
-    pTable->mem = (SMemTable *)calloc(1, sizeof(SMemTable));
-    if (pTable->mem == NULL) return -1;
-    pTable->mem->pData = tSkipListCreate(5, TSDB_DATA_TYPE_TIMESTAMP, TYPE_BYTES[TSDB_DATA_TYPE_TIMESTAMP], 0, 0, 0, getTupleKey);
-    pTable->mem->keyFirst = INT64_MAX;
-    pTable->mem->keyLast = 0;
-  }
+static void tsdbPutMemRow(STable *pTable, SSkipListNode *pNode, TSKEY key) {
   tSkipListPut(pTable->mem->pData, pNode);
   if (key > pTable->mem->keyLast) pTable->mem->keyLast = key;
   if (key < pTable->mem->keyFirst) pTable->mem->keyFirst = key;
-  
+
   pTable->mem->numOfPoints = tSkipListGetSize(pTable->mem->pData);
+}
+
+static int32_t tdInsertRowToTable(STsdbRepo *pRepo, SDataRow row, STable *pTable) {
+  TSKEY key = dataRowKey(row);
+  // printf("insert:%lld, size:%d\n", key, pTable->mem->numOfPoints);
+
+  // Copy row into the memory
+  SSkipListNode *pNode = tsdbAllocMemRow(pRepo, pTable, dataRowLen(row), key);
+  if (pNode == NULL) return -1;
+
+  dataRowCpy(SL_GET_NODE_DATA(pNode), row);
+  tsdbPutMemRow(pTable, pNode, key);
 
   return 0;
 }
 
+/*
+ * The rows of a columnar submit block are assembled in the skiplist nodes directly, so no intermediate row is
+ * built. The value is set to null of its type if the bit in null bitmap is set. Each node is put into the table
+ * once it is filled: the cache can not take a node back, and may commit between two allocations.
+ */
+static int32_t tdInsertColumnarBlockToTable(STsdbRepo *pRepo, SSubmitBlk *pBlock, STable *pTable) {
+  STSchema *pSchema = tsdbGetTableSchema(pRepo->tsdbMeta, pTable);
+  if (pSchema == NULL) return TSDB_CODE_INVALID_TABLE_ID;
+
+  int32_t numOfRows = pBlock->numOfRows;
+  int32_t numOfCols = schemaNCols(pSchema);
+  int32_t bitmapLen = TSDB_SUBMIT_BITMAP_LEN(numOfRows);
+  int32_t flen = 0;
+  int32_t len = 0;
+
+  for (int32_t i = 0; i < numOfCols; i++) {
+    STColumn *pCol = schemaColAt(pSchema, i);
+    if (colType(pCol) == TSDB_DATA_TYPE_BINARY || colType(pCol) == TSDB_DATA_TYPE_NCHAR) {
+      return TSDB_CODE_INVALID_VALUE;
+    }
+
+    flen += colBytes(pCol);
+    len += bitmapLen + colBytes(pCol) * numOfRows;
+  }
+
+  if (numOfRows <= 0 || len != pBlock->len) {
+    uError("vgId:%d invalid columnar submit block of table uid:%" PRIu64 ", rows:%d len:%d expected:%d",
+           pRepo->config.tsdbId, pTable->tableId.uid, numOfRows, pBlock->len, len);
+    return TSDB_CODE_INVALID_MSG_LEN;
+  }
+
+  // the newest row is copied out, as the cache block of its node may be freed by a commit before the block ends
+  SDataRow lastRow = malloc(TD_DATA_ROW_HEAD_SIZE + flen);
+  if (lastRow == NULL) return TSDB_CODE_SERV_OUT_OF_MEMORY;
+
+  // the timestamps are the values of the first column, right after its bitmap
+  TSKEY * keys = (TSKEY *)(pBlock->data + bitmapLen);
+  int32_t last = -1;
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  for (int32_t r = 0; r < numOfRows; r++) {
+    SSkipListNode *pNode = tsdbAllocMemRow(pRepo, pTable, TD_DATA_ROW_HEAD_SIZE + flen, keys[r]);
+    if (pNode == NULL) {
+      code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+      break;
+    }
+
+    SDataRow row = SL_GET_NODE_DATA(pNode);
+    dataRowSetLen(row, TD_DATA_ROW_HEAD_SIZE + flen);
+    dataRowSetFLen(row, TD_DATA_ROW_HEAD_SIZE + flen);
+
+    char *  pData = pBlock->data;
+    int32_t offset = TD_DATA_ROW_HEAD_SIZE;
+    for (int32_t i = 0; i < numOfCols; i++) {
+      STColumn *pCol = schemaColAt(pSchema, i);
+      uint8_t * bitmap = (uint8_t *)pData;
+      char *    values = pData + bitmapLen;
+
+      char *dst = dataRowAt(row, offset);
+      if (bitmap[r >> 3] & (1u << (r & 7))) {
+        setNull(dst, colType(pCol), colBytes(pCol));
+      } else {
+        memcpy(dst, values + colBytes(pCol) * r, colBytes(pCol));
+      }
+
+      offset += colBytes(pCol);
+      pData = values + colBytes(pCol) * numOfRows;
+    }
+
+    tsdbPutMemRow(pTable, pNode, keys[r]);
+    if (last < 0 || keys[r] > keys[last]) {
+      dataRowCpy(lastRow, row);
+      last = r;
+    }
+  }
+
+  // the rows put before a failure stay in the table, as in the row path
+  if (last >= 0) tsdbUpdateTableLastRow(pRepo, pTable, lastRow);
+
+  free(lastRow);
+  return code;
+}
+
 static int32_t tsdbInsertDataToTable(TsdbRepoT *repo, SSubmitBlk *pBlock) {
   STsdbRepo *pRepo = (STsdbRepo *)repo;
 
@@ -771,16 +890,26 @@ static int32_t tsdbInsertDataToTable(TsdbRepoT *repo, SSubmitBlk *pBlock) {
     return TSDB_CODE_INVALID_TABLE_ID;
   }
 
+  if (pBlock->flag & TSDB_SUBMIT_BLK_COLUMNAR) {
+    return tdInsertColumnarBlockToTable(pRepo, pBlock, pTable);
+  }
+
   SSubmitBlkIter blkIter;
   SDataRow row;
+  SDataRow lastRow = NULL;
 
   tsdbInitSubmitBlkIter(pBlock, &blkIter);
   while ((row = tsdbGetSubmitBlkNext(&blkIter)) != NULL) {
     if (tdInsertRowToTable(pRepo, row, pTable) < 0) {
       return -1;
     }
+
+    if (lastRow == NULL || dataRowKey(row) > dataRowKey(lastRow)) lastRow = row;
   }
 
+  // the last row of table is updated once for a block, not for each row
+  if (lastRow != NULL) tsdbUpdateTableLastRow(pRepo, pTable, lastRow);
+
   return TSDB_CODE_SUCCESS;
 }
 
@@ -854,6 +983,7 @@ static void *tsdbCommitData(void *arg) {
   STsdbCfg *  pCfg = &(pRepo->config);
   SDataCols * pDataCols = NULL;
   SRWHelper   whelper = {0};
+  int64_t     st = taosGetTimestampUs();
   if (pCache->imem == NULL) return NULL;
 
   // Create the iterator to read from cache
@@ -897,6 +1027,7 @@ _exit:
   }
   tsdbUnLockRepo(arg);
 
+  taosMetricObserve(tsdbCommitMetric, taosGetTimestampUs() - st);
   return NULL;
 }
 
@@ -906,6 +1037,8 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SSkipListIterator **iters
   STsdbFileH *pFileH = pRepo->tsdbFileH;
   STsdbCfg *  pCfg = &pRepo->config;
   SFileGroup *pGroup = NULL;
+  char        dataDir[128] = "\0";
+  STableRollup **pRollups = NULL;
 
   TSKEY minKey = 0, maxKey = 0;
   tsdbGetKeyRangeOfFileId(pCfg->daysPerFile, pCfg->precision, fid, &minKey, &maxKey);
@@ -914,6 +1047,13 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SSkipListIterator **iters
   int hasDataToCommit = tsdbHasDataToCommit(iters, pCfg->maxTables, minKey, maxKey);
   if (!hasDataToCommit) return 0;  // No data to commit, just return
 
+  // The compaction or move of the file group is abandoned, since the files it read are changed by this commit
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  pRepo->commitFid = fid;
+  if (pRepo->pCompactor != NULL && pRepo->pCompactor->fid == fid) pRepo->pCompactor->aborted = 1;
+  if (pRepo->diskTier != NULL && pRepo->diskTier->fid == fid) pRepo->diskTier->aborted = 1;
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
   // Create and open files for commit
   tsdbGetDataDirName(pRepo, dataDir);
   if ((pGroup = tsdbCreateFGroup(pFileH, dataDir, fid, pCfg->maxTables)) == NULL) goto _err;
@@ -921,6 +1061,9 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SSkipListIterator **iters
   // Open files for write/read
   if (tsdbSetAndOpenHelperFile(pHelper, pGroup) < 0) goto _err;
 
+  // The rollups of the rows committed, a table without rollup here keeps its stale rollup until the next commit
+  if (pRepo->numOfRollups > 0) pRollups = (STableRollup **)calloc(pCfg->maxTables, sizeof(STableRollup *));
+
   // Loop to commit data in each table
   for (int tid = 0; tid < pCfg->maxTables; tid++) {
     STable *           pTable = pMeta->tables[tid];
@@ -949,6 +1092,14 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SSkipListIterator **iters
       if (rowsWritten < 0) goto _err;
       ASSERT(rowsWritten <= pDataCols->numOfPoints);
 
+      if (pRollups != NULL) {
+        if (pRollups[tid] == NULL) pRollups[tid] = tsdbNewTableRollup(pRepo, pTable);
+        if (pRollups[tid] != NULL && tsdbRollupDataCols(pRollups[tid], pDataCols, rowsWritten) < 0) {
+          tsdbFreeTableRollup(pRollups[tid]);
+          pRollups[tid] = NULL;
+        }
+      }
+
       tdPopDataColsPoints(pDataCols, rowsWritten);
       maxRowsToRead = pCfg->maxRowsPerFileBlock * 4 / 5 - pDataCols->numOfPoints;
     }
@@ -965,17 +1116,33 @@ static int tsdbCommitToFile(STsdbRepo *pRepo, int fid, SSkipListIterator **iters
 
   if (tsdbWriteCompIdx(pHelper) < 0) goto _err;
 
+  // the new .head and .last files are renamed over the old ones when they are closed, under the lock of repository,
+  // so a query opens either the old files or the new ones
+  tsdbLockRepo((TsdbRepoT *)pRepo);
+  tsdbStartInvalidateBlockCache(pRepo->pBlockCache, fid);
+  tsdbInvalidateHeadIndex(pRepo->pHeadIdxCache, fid);
   tsdbCloseHelperFile(pHelper, 0);
   // TODO: make it atomic with some methods
   pGroup->files[TSDB_FILE_TYPE_HEAD] = pHelper->files.headF;
   pGroup->files[TSDB_FILE_TYPE_DATA] = pHelper->files.dataF;
   pGroup->files[TSDB_FILE_TYPE_LAST] = pHelper->files.lastF;
 
+  tsdbInvalidateBlockCache(pRepo->pBlockCache, fid);
+  tsdbUnLockRepo((TsdbRepoT *)pRepo);
+
+  if (pRollups != NULL) {
+    tsdbCommitRollups(pRepo, pGroup, pRollups);
+    tsdbFreeTableRollups(pRollups, pCfg->maxTables);
+  }
+
+  pRepo->commitFid = -1;
   return 0;
 
   _err:
   ASSERT(false);
   tsdbCloseHelperFile(pHelper, 1);
+  tsdbFreeTableRollups(pRollups, pCfg->maxTables);
+  pRepo->commitFid = -1;
   return -1;
 }
 
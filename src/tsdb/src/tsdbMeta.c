@@ -119,6 +119,7 @@ int tsdbRestoreTable(void *pHandle, void *cont, int contLen) {
     STColumn* pColSchema = schemaColAt(pTable->tagSchema, 0);
     pTable->pIndex = tSkipListCreate(TSDB_SUPER_TABLE_SL_LEVEL, pColSchema->type, pColSchema->bytes,
                                     1, 0, 0, getTagIndexKey);
+    pTable->pTagIndex = tsdbNewTagIndex(pTable->tagSchema);
   }
 
   tsdbAddTableToMeta(pMeta, pTable, false);
@@ -213,6 +214,19 @@ STSchema *tsdbGetTableSchema(STsdbMeta *pMeta, STable *pTable) {
   }
 }
 
+// the version of the schema returned by tsdbGetTableSchema, -1 if the schema is not found
+int32_t tsdbGetTableSchemaVersion(STsdbMeta *pMeta, STable *pTable) {
+  if (pTable->type == TSDB_NORMAL_TABLE || pTable->type == TSDB_SUPER_TABLE) {
+    return pTable->sversion;
+  } else if (pTable->type == TSDB_CHILD_TABLE) {
+    STable *pSuper = tsdbGetTableByUid(pMeta, pTable->superUid);
+    if (pSuper == NULL) return -1;
+    return pSuper->sversion;
+  } else {
+    return -1;
+  }
+}
+
 STSchema * tsdbGetTableTagSchema(STsdbMeta *pMeta, STable *pTable) {
   if (pTable->type == TSDB_SUPER_TABLE) {
     return pTable->tagSchema;
@@ -269,6 +283,7 @@ int32_t tsdbCreateTableImpl(STsdbMeta *pMeta, STableCfg *pCfg) {
       super->tableId.uid = pCfg->superUid;
       super->tableId.tid = -1;
       super->superUid = TSDB_INVALID_SUPER_TABLE_ID;
+      super->sversion = pCfg->sversion;
       super->schema = tdDupSchema(pCfg->schema);
       super->tagSchema = tdDupSchema(pCfg->tagSchema);
       super->tagVal = tdDataRowDup(pCfg->tagValues);
@@ -286,6 +301,9 @@ int32_t tsdbCreateTableImpl(STsdbMeta *pMeta, STableCfg *pCfg) {
         free(super);
         return -1;
       }
+
+      // a super table without the tag index is still queried by the skiplist index
+      super->pTagIndex = tsdbNewTagIndex(super->tagSchema);
     } else {
       if (super->type != TSDB_SUPER_TABLE) return -1;
     }
@@ -306,9 +324,13 @@ int32_t tsdbCreateTableImpl(STsdbMeta *pMeta, STableCfg *pCfg) {
   } else { // TSDB_NORMAL_TABLE
     table->type = TSDB_NORMAL_TABLE;
     table->superUid = -1;
+    table->sversion = pCfg->sversion;
     table->schema = tdDupSchema(pCfg->schema);
   }
 
+  // a new table has no data in files
+  table->lastRowLoaded = 1;
+
   // Register to meta
   if (newSuper) tsdbAddTableToMeta(pMeta, super, true);
   tsdbAddTableToMeta(pMeta, table, true);
@@ -391,10 +413,12 @@ static int tsdbFreeTable(STable *pTable) {
   // Free content
   if (TSDB_TABLE_IS_SUPER_TABLE(pTable)) {
     tSkipListDestroy(pTable->pIndex);
+    tsdbFreeTagIndex(pTable->pTagIndex);
   }
 
   tsdbFreeMemTable(pTable->mem);
   tsdbFreeMemTable(pTable->imem);
+  tdFreeDataRow(pTable->lastRow);
 
   tfree(pTable->name);
   free(pTable);
@@ -479,12 +503,19 @@ static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable) {
   
   tSkipListPut(list, pNode);
 
+  if (pSTable->pTagIndex != NULL) tsdbAddIntoTagIndex(pSTable->pTagIndex, pSTable->tagSchema, pTable);
+
   return 0;
 }
 
 static int tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable) {
   assert(pTable->type == TSDB_CHILD_TABLE);
-  // TODO
+  STable* pSTable = tsdbGetTableByUid(pMeta, pTable->superUid);
+  assert(pSTable != NULL);
+
+  if (pSTable->pTagIndex != NULL) tsdbRemoveFromTagIndex(pSTable->pTagIndex, pSTable->tagSchema, pTable);
+
+  // TODO: remove the table from skiplist index
   return 0;
 }
 
@@ -24,8 +24,6 @@
 static int  tsdbInitHelperFile(SRWHelper *pHelper);
 // static void tsdbClearHelperFile(SHelperFile *pHFile);
 static bool tsdbShouldCreateNewLast(SRWHelper *pHelper);
-static int  tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDataCols, int rowsToWrite,
-                                 SCompBlock *pCompBlock, bool isLast, bool isSuperBlock);
 static int compareKeyBlock(const void *arg1, const void *arg2);
 static int tsdbMergeDataWithBlock(SRWHelper *pHelper, int blkIdx, SDataCols *pDataCols);
 static int tsdbInsertSuperBlock(SRWHelper *pHelper, SCompBlock *pCompBlock, int blkIdx);
@@ -121,6 +119,11 @@ static int tsdbInitHelper(SRWHelper *pHelper, STsdbRepo *pRepo, tsdb_rw_helper_t
   pHelper->config.compress = pRepo->config.compression;
 
   pHelper->state = TSDB_HELPER_CLEAR_STATE;
+  if (type == TSDB_READ_HELPER) {
+    pHelper->pRepo = pRepo;
+    pHelper->pBlockCache = pRepo->pBlockCache;
+    pHelper->pHeadIdxCache = pRepo->pHeadIdxCache;
+  }
 
   // Init file part
   if (tsdbInitHelperFile(pHelper) < 0) goto _err;
@@ -181,8 +184,14 @@ int tsdbSetAndOpenHelperFile(SRWHelper *pHelper, SFileGroup *pGroup) {
 
   ASSERT(pHelper->state == TSDB_HELPER_CLEAR_STATE);
 
+  // The files of a file group are replaced by commit and compaction, and moved by disk tier, under the lock of
+  // repository, so a read helper gets the names and opens the files under the lock, and never opens a mix of the old
+  // and new files. The old files opened are still read after they are replaced.
+  if (TSDB_HELPER_TYPE(pHelper) == TSDB_READ_HELPER) tsdbLockRepo((TsdbRepoT *)pHelper->pRepo);
+
   // Set the files
   pHelper->files.fid = pGroup->fileId;
+  pHelper->blockCacheGen = -1;
   pHelper->files.headF = pGroup->files[TSDB_FILE_TYPE_HEAD];
   pHelper->files.dataF = pGroup->files[TSDB_FILE_TYPE_DATA];
   pHelper->files.lastF = pGroup->files[TSDB_FILE_TYPE_LAST];
@@ -194,11 +203,29 @@ int tsdbSetAndOpenHelperFile(SRWHelper *pHelper, SFileGroup *pGroup) {
     tsdbGetFileName(dataDir, pHelper->files.fid, ".h", pHelper->files.nHeadF.fname);
     tsdbGetFileName(dataDir, pHelper->files.fid, ".l", pHelper->files.nLastF.fname);
     free((void *)fnameDup);
+  } else {
+    int64_t headIdxGen = -1;
+    pHelper->pHeadIdx = tsdbAcquireHeadIndex(pHelper->pHeadIdxCache, pHelper->files.fid, &headIdxGen);
+    pHelper->blockCacheGen = tsdbGetBlockCacheGeneration(pHelper->pBlockCache, pHelper->files.fid);
+
+    int code = 0;
+    if (tsdbOpenFile(&(pHelper->files.headF), O_RDONLY) < 0 || tsdbOpenFile(&(pHelper->files.dataF), O_RDONLY) < 0 ||
+        tsdbOpenFile(&(pHelper->files.lastF), O_RDONLY) < 0) {
+      code = -1;
+    }
+
+    tsdbUnLockRepo((TsdbRepoT *)pHelper->pRepo);
+    if (code < 0) goto _err;
+
+    // the index is loaded out of the lock, from the .head file opened
+    if (pHelper->pHeadIdx == NULL) {
+      pHelper->pHeadIdx = tsdbLoadHeadIndex(pHelper->pHeadIdxCache, &pHelper->files.headF, pHelper->files.fid, headIdxGen);
+    }
   }
 
   // Open the files
-  if (tsdbOpenFile(&(pHelper->files.headF), O_RDONLY) < 0) goto _err;
   if (TSDB_HELPER_TYPE(pHelper) == TSDB_WRITE_HELPER) {
+    if (tsdbOpenFile(&(pHelper->files.headF), O_RDONLY) < 0) goto _err;
     if (tsdbOpenFile(&(pHelper->files.dataF), O_RDWR) < 0) goto _err;
     if (tsdbOpenFile(&(pHelper->files.lastF), O_RDWR) < 0) goto _err;
 
@@ -212,9 +239,6 @@ int tsdbSetAndOpenHelperFile(SRWHelper *pHelper, SFileGroup *pGroup) {
       if (tsdbOpenFile(&(pHelper->files.nLastF), O_WRONLY | O_CREAT) < 0) goto _err;
       if (tsendfile(pHelper->files.nLastF.fd, pHelper->files.lastF.fd, NULL, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE) goto _err;
     }
-  } else {
-    if (tsdbOpenFile(&(pHelper->files.dataF), O_RDONLY) < 0) goto _err;
-    if (tsdbOpenFile(&(pHelper->files.lastF), O_RDONLY) < 0) goto _err;
   }
 
   helperSetState(pHelper, TSDB_HELPER_FILE_SET_AND_OPEN);
@@ -226,6 +250,9 @@ int tsdbSetAndOpenHelperFile(SRWHelper *pHelper, SFileGroup *pGroup) {
 }
 
 int tsdbCloseHelperFile(SRWHelper *pHelper, bool hasError) {
+  tsdbReleaseHeadIndex(pHelper->pHeadIdx);
+  pHelper->pHeadIdx = NULL;
+
   if (pHelper->files.headF.fd > 0) {
     close(pHelper->files.headF.fd);
     pHelper->files.headF.fd = -1;
@@ -431,7 +458,10 @@ int tsdbWriteCompIdx(SRWHelper *pHelper) {
 int tsdbLoadCompIdx(SRWHelper *pHelper, void *target) {
   ASSERT(pHelper->state == TSDB_HELPER_FILE_SET_AND_OPEN);
 
-  if (!helperHasState(pHelper, TSDB_HELPER_IDX_LOAD)) {
+  if (!helperHasState(pHelper, TSDB_HELPER_IDX_LOAD) && pHelper->pHeadIdx != NULL) {
+    // The index is verified when it is loaded into cache
+    memcpy(pHelper->pCompIdx, TSDB_HEAD_INDEX_COMP_IDX(pHelper->pHeadIdx), tsizeof(pHelper->pCompIdx));
+  } else if (!helperHasState(pHelper, TSDB_HELPER_IDX_LOAD)) {
     // If not load from file, just load it in object
     int fd = pHelper->files.headF.fd;
 
@@ -458,7 +488,11 @@ int tsdbLoadCompInfo(SRWHelper *pHelper, void *target) {
   int fd = pHelper->files.headF.fd;
 
   if (!helperHasState(pHelper, TSDB_HELPER_INFO_LOAD)) {
-    if (pIdx->offset > 0) {
+    if (pIdx->offset > 0 && pHelper->pHeadIdx != NULL) {
+      pHelper->pCompInfo = trealloc((void *)pHelper->pCompInfo, pIdx->len);
+      if (pHelper->pCompInfo == NULL) return -1;
+      memcpy((void *)pHelper->pCompInfo, pHelper->pHeadIdx->data + pIdx->offset, pIdx->len);
+    } else if (pIdx->offset > 0) {
       if (lseek(fd, pIdx->offset, SEEK_SET) < 0) return -1;
 
       pHelper->pCompInfo = trealloc((void *)pHelper->pCompInfo, pIdx->len);
@@ -501,7 +535,8 @@ static int comparColIdDataCol(const void *arg1, const void *arg2) {
 }
 
 static int tsdbLoadSingleColumnData(int fd, SCompBlock *pCompBlock, SCompCol *pCompCol, void *buf) {
-  size_t tsize = sizeof(SCompData) + sizeof(SCompCol) * pCompBlock->numOfCols;
+  // the column data follows the SCompData part and its checksum
+  size_t tsize = sizeof(SCompData) + sizeof(SCompCol) * pCompBlock->numOfCols + sizeof(TSCKSUM);
   if (lseek(fd, pCompBlock->offset + tsize + pCompCol->offset, SEEK_SET) < 0) return -1;
   if (tread(fd, buf, pCompCol->len) < pCompCol->len) return -1;
 
@@ -510,46 +545,97 @@ static int tsdbLoadSingleColumnData(int fd, SCompBlock *pCompBlock, SCompCol *pC
 
 static int tsdbLoadSingleBlockDataCols(SRWHelper *pHelper, SCompBlock *pCompBlock, int16_t *colIds, int numOfColIds,
                                        SDataCols *pDataCols) {
-  if (tsdbLoadCompData(pHelper, pCompBlock, NULL) < 0) return -1;
+  SBlockCacheKey key;
+  size_t         tsize = sizeof(SCompData) + sizeof(SCompCol) * pCompBlock->numOfCols + sizeof(TSCKSUM);
+
+  tsdbInitBlockCacheKey(&key, pHelper->files.fid, pHelper->blockCacheGen, pCompBlock, TSDB_BLOCK_CACHE_HEAD_COLID);
+  pHelper->pCompData = trealloc((void *)pHelper->pCompData, tsize);
+  if (pHelper->pCompData == NULL) return -1;
+
+  if (!tsdbGetFromBlockCache(pHelper->pBlockCache, &key, pHelper->pCompData, tsize)) {
+    if (tsdbLoadCompData(pHelper, pCompBlock, NULL) < 0) return -1;
+    tsdbPutToBlockCache(pHelper->pBlockCache, &key, pHelper->pCompData, tsize);
+  }
+
   int fd = (pCompBlock->last) ? pHelper->files.lastF.fd : pHelper->files.dataF.fd;
 
   void *ptr = NULL;
   for (int i = 0; i < numOfColIds; i++) {
     int16_t colId = colIds[i];
 
-    ptr = bsearch((void *)&colId, (void *)pHelper->pCompData->cols, pHelper->pCompData->numOfCols, sizeof(SCompCol), comparColIdCompCol);
-    if (ptr == NULL) continue;
-    SCompCol *pCompCol = (SCompCol *)ptr;
-
     ptr = bsearch((void *)&colId, (void *)(pDataCols->cols), pDataCols->numOfCols, sizeof(SDataCol), comparColIdDataCol);
     ASSERT(ptr != NULL);
     SDataCol *pDataCol = (SDataCol *)ptr;
 
+    // the column added after the block is written is null in this block
+    ptr = bsearch((void *)&colId, (void *)pHelper->pCompData->cols, pHelper->pCompData->numOfCols, sizeof(SCompCol), comparColIdCompCol);
+    if (ptr == NULL) {
+      setNullN(pDataCol->pData, pDataCol->type, pDataCol->bytes, pCompBlock->numOfPoints);
+      pDataCol->len = pDataCol->bytes * pCompBlock->numOfPoints;
+      continue;
+    }
+    SCompCol *pCompCol = (SCompCol *)ptr;
+
     pDataCol->len = pCompCol->len;
+
+    tsdbInitBlockCacheKey(&key, pHelper->files.fid, pHelper->blockCacheGen, pCompBlock, colId);
+    if (tsdbGetFromBlockCache(pHelper->pBlockCache, &key, pDataCol->pData, pCompCol->len)) continue;
+
     if (tsdbLoadSingleColumnData(fd, pCompBlock, pCompCol, pDataCol->pData) < 0) return -1;
+    tsdbPutToBlockCache(pHelper->pBlockCache, &key, pDataCol->pData, pCompCol->len);
+
+    pHelper->blockReadBytes += pCompCol->len;
   }
 
+  pDataCols->numOfPoints = pCompBlock->numOfPoints;
   return 0;
 }
 
-// Load specific column data from file
-int tsdbLoadBlockDataCols(SRWHelper *pHelper, SDataCols *pDataCols, int blkIdx, int16_t *colIds, int numOfColIds) {
-  SCompBlock *pCompBlock = pHelper->pCompInfo->blocks + blkIdx;
+/*
+ * Ask the kernel to read the block into page cache in background, so that it is in memory when it is loaded later.
+ * The super block with sub-blocks is not prefetched, since the sub-blocks are not contiguous in file.
+ */
+void tsdbPrefetchBlock(SRWHelper *pHelper, SCompBlock *pCompBlock) {
+  if (pCompBlock->numOfSubBlocks > 1) return;
 
+  int fd = (pCompBlock->last) ? pHelper->files.lastF.fd : pHelper->files.dataF.fd;
+  if (fd < 0) return;
+
+#if defined(LINUX)
+  posix_fadvise(fd, pCompBlock->offset, pCompBlock->len, POSIX_FADV_WILLNEED);
+#endif
+}
+
+// Load specific column data from file, the columns that are not specified are left untouched
+int tsdbLoadBlockDataCols(SRWHelper *pHelper, SCompBlock *pCompBlock, SDataCols *pDataCols, int16_t *colIds,
+                          int numOfColIds) {
   ASSERT(pCompBlock->numOfSubBlocks >= 1); // Must be super block
 
   int numOfSubBlocks = pCompBlock->numOfSubBlocks;
   SCompBlock *pStartBlock =
-      (numOfSubBlocks == 1) ? pCompBlock : (SCompBlock *)((char *)pHelper->pCompInfo->blocks + pCompBlock->offset);
+      (numOfSubBlocks == 1) ? pCompBlock : (SCompBlock *)((char *)pHelper->pCompInfo + pCompBlock->offset);
 
+  tdResetDataCols(pDataCols);
   if (tsdbLoadSingleBlockDataCols(pHelper, pStartBlock, colIds, numOfColIds, pDataCols) < 0) return -1;
+  if (numOfSubBlocks == 1) return 0;
+
+  // the sub-blocks are loaded into a buffer with the same layout and merged one by one
+  SDataCols *pSubCols = tdDupDataCols(pDataCols, false);
+  if (pSubCols == NULL) return -1;
+
   for (int i = 1; i < numOfSubBlocks; i++) {
     pStartBlock++;
-    if (tsdbLoadSingleBlockDataCols(pHelper, pStartBlock, colIds, numOfColIds, pHelper->pDataCols[1]) < 0) return -1;
-    tdMergeDataCols(pDataCols, pHelper->pDataCols[1], pHelper->pDataCols[1]->numOfPoints);
+    tdResetDataCols(pSubCols);
+    if (tsdbLoadSingleBlockDataCols(pHelper, pStartBlock, colIds, numOfColIds, pSubCols) < 0) goto _err;
+    if (tdMergeDataCols(pDataCols, pSubCols, pSubCols->numOfPoints) < 0) goto _err;
   }
 
+  tdFreeDataCols(pSubCols);
   return 0;
+
+_err:
+  tdFreeDataCols(pSubCols);
+  return -1;
 }
 
 /**
@@ -566,6 +652,8 @@ static int tsdbLoadBlockDataImpl(SRWHelper *pHelper, SCompBlock *pCompBlock, SDa
   if (tread(fd, (void *)pCompData, pCompBlock->len) < pCompBlock->len) goto _err;
   ASSERT(pCompData->numOfCols == pCompBlock->numOfCols);
 
+  pHelper->blockReadBytes += pCompBlock->len;
+
   // TODO : check the checksum
   size_t tsize = sizeof(SCompData) + sizeof(SCompCol) * pCompBlock->numOfCols + sizeof(TSCKSUM);
   if (!taosCheckChecksumWhole((uint8_t *)pCompData, tsize)) goto _err;
@@ -672,8 +760,8 @@ static bool tsdbShouldCreateNewLast(SRWHelper *pHelper) {
   return false;
 }
 
-static int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDataCols, int rowsToWrite, SCompBlock *pCompBlock,
-                                bool isLast, bool isSuperBlock) {
+int tsdbWriteBlockToFile(SRWHelper *pHelper, SFile *pFile, SDataCols *pDataCols, int rowsToWrite, SCompBlock *pCompBlock,
+                         bool isLast, bool isSuperBlock) {
   ASSERT(rowsToWrite > 0 && rowsToWrite <= pDataCols->numOfPoints &&
          rowsToWrite <= pHelper->config.maxRowsPerFileBlock);
 
@@ -867,7 +955,8 @@ static int tsdbMergeDataWithBlock(SRWHelper *pHelper, int blkIdx, SDataCols *pDa
       // tdResetDataCols(pHelper->pDataCols[1]);
       while (true) {
         if (iter1 >= pHelper->pDataCols[0]->numOfPoints && iter2 >= rows3) break;
-        tdMergeTwoDataCols(pHelper->pDataCols[1], pHelper->pDataCols[0], &iter1, pDataCols, &iter2, pHelper->config.maxRowsPerFileBlock * 4 / 5);
+        tdMergeTwoDataCols(pHelper->pDataCols[1], pHelper->pDataCols[0], &iter1, pHelper->pDataCols[0]->numOfPoints,
+                           pDataCols, &iter2, rows3, pHelper->config.maxRowsPerFileBlock * 4 / 5);
         ASSERT(pHelper->pDataCols[1]->numOfPoints > 0);
         if (tsdbWriteBlockToFile(pHelper, &(pHelper->files.dataF), pHelper->pDataCols[1],
                                  pHelper->pDataCols[1]->numOfPoints, &compBlock, false, true) < 0)
@@ -18,6 +18,7 @@
 #include "talgo.h"
 #include "tutil.h"
 #include "tcompare.h"
+#include "ttime.h"
 
 #include "../../../query/inc/qast.h"  // todo move to common module
 #include "../../../query/inc/tlosertree.h"  // todo move to util module
@@ -73,6 +74,11 @@ typedef struct STableCheckInfo {
 
   SDataCols*         pDataCols;
   SSkipListIterator* iter;
+  SDataRow           lastRow;  // copy of the last row of table, for the last row query
+
+  STableRollup*           pRollup;         // rollup of the table in current file, see setRollupBlocks
+  struct STableBlockInfo* pRollupBlocks;   // the buckets and blocks read instead of pCompInfo if pRollup is set
+  int32_t                 maxRollupBlocks;
 } STableCheckInfo;
 
 typedef struct {
@@ -85,6 +91,8 @@ typedef struct STableBlockInfo {
   STableCheckInfo* pTableCheckInfo;
   int32_t          blockIndex;
   int32_t          groupIdx; /* number of group is less than the total number of tables */
+  SRollupBucket*   pBucket;  // a bucket of rollup returned as a block of pre-aggregated values, compBlock is NULL
+  TSKEY            ekey;     // the rows of block after ekey are not returned
 } STableBlockInfo;
 
 typedef struct SBlockOrderSupporter {
@@ -111,15 +119,20 @@ typedef struct STsdbQueryHandle {
   int32_t     realNumOfRows;
   SArray*     pTableCheckInfo;
   int32_t     activeIndex;
+  int32_t     prefetchSlot;  // the farthest block prefetched in current file
   bool        checkFiles;  // check file stage
+  bool        lastRowOnly;  // only the last row of each table is returned, see tsdbQueryLastRow
   void*       qinfo;  // query info handle, for debug purpose
   
   STableBlockInfo* pDataBlockInfo;
+  int64_t          rollupInterval;  // the rollups of this interval are read instead of blocks, 0 if not used
+  SDataStatis*     statis;          // the statistics of the columns of current bucket
 
   SFileGroup*    pFileGroup;
   SFileGroupIter fileIter;
   SCompIdx*      compIndex;
   SRWHelper rhelper;
+  STsdbQueryCost cost;
 } STsdbQueryHandle;
 
 static void tsdbInitDataBlockLoadInfo(SDataBlockLoadInfo* pBlockLoadInfo) {
@@ -142,6 +155,7 @@ TsdbQueryHandleT* tsdbQueryTables(TsdbRepoT* tsdb, STsdbQueryCond* pCond, STable
   pQueryHandle->order  = pCond->order;
   pQueryHandle->window = pCond->twindow;
   pQueryHandle->pTsdb  = tsdb;
+  pQueryHandle->rollupInterval = ASCENDING_ORDER_TRAVERSE(pCond->order) ? pCond->rollupInterval : 0;
   pQueryHandle->compIndex = calloc(10000, sizeof(SCompIdx));
   tsdbInitReadHelper(&pQueryHandle->rhelper, (STsdbRepo*) tsdb);
 
@@ -200,6 +214,56 @@ TsdbQueryHandleT* tsdbQueryTables(TsdbRepoT* tsdb, STsdbQueryCond* pCond, STable
   return (TsdbQueryHandleT)pQueryHandle;
 }
 
+TsdbQueryHandleT* tsdbQueryLastRow(TsdbRepoT* tsdb, STsdbQueryCond* pCond, STableGroupInfo* groupList) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*) tsdbQueryTables(tsdb, pCond, groupList);
+  pQueryHandle->lastRowOnly = true;
+  pQueryHandle->activeIndex = -1;
+
+  TSKEY skey = MIN(pQueryHandle->window.skey, pQueryHandle->window.ekey);
+  TSKEY ekey = MAX(pQueryHandle->window.skey, pQueryHandle->window.ekey);
+
+  size_t  sizeOfGroup = taosArrayGetSize(groupList->pGroupList);
+  SArray* pTableCheckInfo = taosArrayInit(sizeOfGroup, sizeof(STableCheckInfo));
+  int32_t index = 0;
+
+  // the last row of a group is the last row of the table with the largest key in it, other tables are discarded
+  for (int32_t i = 0; i < sizeOfGroup; ++i) {
+    SArray* group = *(SArray**) taosArrayGet(groupList->pGroupList, i);
+    STableCheckInfo* pLast = NULL;
+
+    size_t gsize = taosArrayGetSize(group);
+    for (int32_t j = 0; j < gsize; ++j) {
+      STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, index++);
+
+      SDataRow row = tsdbGetTableLastRow((STsdbRepo*) tsdb, pCheckInfo->pTableObj);
+      if (row == NULL || dataRowKey(row) < skey || dataRowKey(row) > ekey ||
+          (pLast != NULL && dataRowKey(row) <= dataRowKey(pLast->lastRow))) {
+        tdFreeDataRow(row);
+        continue;
+      }
+
+      if (pLast != NULL) {
+        tfree(pLast->lastRow);
+      }
+
+      pCheckInfo->lastRow = row;
+      pLast = pCheckInfo;
+    }
+
+    if (pLast != NULL) {
+      taosArrayPush(pTableCheckInfo, pLast);
+    }
+  }
+
+  uTrace("%p last row query, %d tables in %d groups, %d tables have qualified last row", pQueryHandle,
+         taosArrayGetSize(pQueryHandle->pTableCheckInfo), sizeOfGroup, taosArrayGetSize(pTableCheckInfo));
+
+  taosArrayDestroy(pQueryHandle->pTableCheckInfo);
+  pQueryHandle->pTableCheckInfo = pTableCheckInfo;
+
+  return (TsdbQueryHandleT)pQueryHandle;
+}
+
 static bool hasMoreDataInCache(STsdbQueryHandle* pHandle) {
   size_t size = taosArrayGetSize(pHandle->pTableCheckInfo);
   assert(pHandle->activeIndex < size && pHandle->activeIndex >= 0 && size >= 1);
@@ -244,6 +308,7 @@ static bool hasMoreDataInCache(STsdbQueryHandle* pHandle) {
     return false;
   }
 
+  pHandle->cost.numOfCacheBlocks += 1;
   return true;
 }
 
@@ -284,12 +349,89 @@ static int32_t binarySearchForBlockImpl(SCompBlock* pBlock, int32_t numOfBlocks,
   return midSlot;
 }
 
+static int32_t addRollupBlocks(STableCheckInfo* pCheckInfo, int32_t numOfBlocks) {
+  if (numOfBlocks <= pCheckInfo->maxRollupBlocks) return TSDB_CODE_SUCCESS;
+
+  int32_t maxBlocks = MAX(numOfBlocks, pCheckInfo->maxRollupBlocks * 2);
+  char*   tmp = realloc(pCheckInfo->pRollupBlocks, sizeof(STableBlockInfo) * maxBlocks);
+  if (tmp == NULL) return TSDB_CODE_SERV_OUT_OF_MEMORY;
+
+  pCheckInfo->pRollupBlocks = (STableBlockInfo*)tmp;
+  pCheckInfo->maxRollupBlocks = maxBlocks;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * Read the buckets of rollup covered by the query window [s, e] instead of the blocks of the table in current file,
+ * and the rows out of these buckets from the blocks, i.e. the rows before the first bucket and after the last one.
+ * The rollup is used only if it has the same rows as the table in file, otherwise it is stale.
+ */
+static void setRollupBlocks(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, int fd, int64_t rows,
+                            TSKEY s, TSKEY e) {
+  STableRollup* pRollup = tsdbLoadTableRollup(pQueryHandle->pTsdb, fd, pCheckInfo->pTableObj, pQueryHandle->rollupInterval);
+  if (pRollup == NULL) return;
+
+  SRollupSeries* pSeries = &pRollup->series[0];
+  int32_t        first = 0;
+  while (first < pSeries->numOfBuckets && TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, first)->firstKey < s) first++;
+
+  int32_t last = first;
+  while (last < pSeries->numOfBuckets) {
+    SRollupBucket* pBucket = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, last);
+    if (pBucket->lastKey > e || pBucket->rows > INT32_MAX) break;
+    last++;
+  }
+
+  int32_t numOfBlocks = pCheckInfo->numOfBlocks * 2 + (last - first);
+  if (pRollup->rows != rows || first == last || addRollupBlocks(pCheckInfo, numOfBlocks) != TSDB_CODE_SUCCESS) {
+    tsdbFreeTableRollup(pRollup);
+    return;
+  }
+
+  TSKEY       headEnd = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, first)->firstKey - 1;
+  TSKEY       tailStart = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, last - 1)->lastKey + 1;
+  SCompBlock* pBlock = pCheckInfo->pCompInfo->blocks;
+  int32_t     num = 0;
+
+  STableBlockInfo info = {.pTableCheckInfo = pCheckInfo};
+  for (int32_t i = 0; i < pCheckInfo->numOfBlocks && pBlock[i].keyFirst <= headEnd; ++i) {
+    info.pBlock.compBlock = &pBlock[i];
+    info.ekey = headEnd;
+    pCheckInfo->pRollupBlocks[num++] = info;
+  }
+
+  info.pBlock.compBlock = NULL;
+  for (int32_t i = first; i < last; ++i) {
+    info.pBucket = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, i);
+    info.ekey = info.pBucket->lastKey;
+    pCheckInfo->pRollupBlocks[num++] = info;
+  }
+
+  info.pBucket = NULL;
+  for (int32_t i = 0; i < pCheckInfo->numOfBlocks; ++i) {
+    if (pBlock[i].keyLast < tailStart) continue;
+
+    info.pBlock.compBlock = &pBlock[i];
+    info.ekey = e;
+    pCheckInfo->pRollupBlocks[num++] = info;
+  }
+
+  uTrace("%p table uid:%" PRIu64 " reads %d buckets of rollup and %d blocks instead of %d blocks", pQueryHandle,
+         pCheckInfo->tableId.uid, last - first, num - (last - first), pCheckInfo->numOfBlocks);
+
+  pCheckInfo->pRollup = pRollup;
+  pCheckInfo->numOfBlocks = num;
+}
+
 static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlocks, int32_t type) {
   // todo check open file failed
   SFileGroup* fileGroup = pQueryHandle->pFileGroup;
   
   assert(fileGroup->files[TSDB_FILE_TYPE_HEAD].fname > 0);
+
+  int64_t st = taosGetTimestampUs();
   tsdbSetAndOpenHelperFile(&pQueryHandle->rhelper, fileGroup);
+  pQueryHandle->cost.numOfFiles += 1;
 
   // load all the comp offset value for all tables in this file
   // tsdbLoadCompIdx(fileGroup, pQueryHandle->compIndex, 10000);  // todo set dynamic max tables
@@ -297,9 +439,17 @@ static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlo
   *numOfBlocks = 0;
   size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
 
+  int rollupFd = -1;
+  if (pQueryHandle->rollupInterval > 0) rollupFd = tsdbOpenRollupFile(pQueryHandle->pTsdb, fileGroup->fileId);
+
   for (int32_t i = 0; i < numOfTables; ++i) {
     STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
 
+    // the blocks and the rollup of the previous file are not used any more
+    pCheckInfo->numOfBlocks = 0;
+    tsdbFreeTableRollup(pCheckInfo->pRollup);
+    pCheckInfo->pRollup = NULL;
+
     SCompIdx* compIndex = &pQueryHandle->rhelper.pCompIdx[pCheckInfo->tableId.tid];
     if (compIndex->len == 0 || compIndex->numOfSuperBlocks == 0) {  // no data block in this file, try next file
       continue;//no data blocks in the file belongs to pCheckInfo->pTable
@@ -326,6 +476,11 @@ static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlo
       TSKEY s = MIN(pCheckInfo->lastKey, pQueryHandle->window.ekey);
       TSKEY e = MAX(pCheckInfo->lastKey, pQueryHandle->window.ekey);
       
+      int64_t rows = 0;
+      for (int32_t j = 0; rollupFd >= 0 && j < compIndex->numOfSuperBlocks; ++j) {
+        rows += pCompInfo->blocks[j].numOfPoints;
+      }
+
       // discard the unqualified data block based on the query time window
       int32_t start = binarySearchForBlockImpl(pCompInfo->blocks, compIndex->numOfSuperBlocks, s, TSDB_ORDER_ASC);
       int32_t end = start;
@@ -345,10 +500,17 @@ static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlo
         memmove(pCompInfo->blocks, &pCompInfo->blocks[start], pCheckInfo->numOfBlocks * sizeof(SCompBlock));
       }
 
+      if (rollupFd >= 0) {
+        setRollupBlocks(pQueryHandle, pCheckInfo, rollupFd, rows, s, e);
+      }
+
       (*numOfBlocks) += pCheckInfo->numOfBlocks;
     }
   }
 
+  if (rollupFd >= 0) close(rollupFd);
+
+  pQueryHandle->cost.loadCompInfoUs += (taosGetTimestampUs() - st);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -393,30 +555,40 @@ static SArray* getDefaultLoadColumns(STsdbQueryHandle* pQueryHandle, bool loadTS
 }
 
 static void    filterDataInDataBlock(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, SCompBlock* pBlock,
-                                     SArray* sa);
+                                     TSKEY ekey, SArray* sa);
 static int32_t binarySearchForKey(char* pValue, int num, TSKEY key, int order);
 
 static bool doLoadFileDataBlock(STsdbQueryHandle* pQueryHandle, SCompBlock* pBlock, STableCheckInfo* pCheckInfo) {
-  SCompData* data = calloc(1, sizeof(SCompData) + sizeof(SCompCol) * pBlock->numOfCols);
+  STsdbRepo* pTsdb = pQueryHandle->pTsdb;
+  STSchema*  pSchema = tsdbGetTableSchema(tsdbGetMeta(pTsdb), pCheckInfo->pTableObj);
 
-  data->numOfCols = pBlock->numOfCols;
-  data->uid = pCheckInfo->pTableObj->tableId.uid;
-
-  bool    blockLoaded = false;
-  SArray* sa = getDefaultLoadColumns(pQueryHandle, true);
+  // the buffer is sized from the table schema, and created again if the schema is enlarged
+  int32_t    maxRowSize = tdMaxRowBytesFromSchema(pSchema);
+  SDataCols* pCols = pCheckInfo->pDataCols;
+  if (pCols != NULL && (pCols->maxCols < schemaNCols(pSchema) || pCols->maxRowSize < maxRowSize ||
+                        pCols->maxPoints < pBlock->numOfPoints)) {
+    tdFreeDataCols(pCols);
+    pCheckInfo->pDataCols = NULL;
+  }
 
   if (pCheckInfo->pDataCols == NULL) {
-    pCheckInfo->pDataCols = tdNewDataCols(1000, 2, 4096);
+    int32_t numOfRows = pBlock->numOfPoints;
+    int32_t maxRows = MAX(pTsdb->config.maxRowsPerFileBlock, numOfRows);
+    if ((pCheckInfo->pDataCols = tdNewDataCols(maxRowSize, schemaNCols(pSchema), maxRows)) == NULL) {
+      return false;
+    }
   }
 
-  tdInitDataCols(pCheckInfo->pDataCols, tsdbGetTableSchema(tsdbGetMeta(pQueryHandle->pTsdb), pCheckInfo->pTableObj));
+  tdInitDataCols(pCheckInfo->pDataCols, pSchema);
 
-  // SFile* pFile = &pQueryHandle->pFileGroup->files[TSDB_FILE_TYPE_DATA];
-  // if (pFile->fd == FD_INITIALIZER) {
-  //   pFile->fd = open(pFile->fname, O_RDONLY);
-  // }
+  // only the required columns and the primary timestamp column are loaded from file
+  bool    blockLoaded = false;
+  SArray* sa = getDefaultLoadColumns(pQueryHandle, true);
+  int64_t readBytes = pQueryHandle->rhelper.blockReadBytes;
+  int64_t st = taosGetTimestampUs();
 
-  if (tsdbLoadBlockData(&(pQueryHandle->rhelper), pBlock, NULL) == 0) {
+  if (tsdbLoadBlockDataCols(&(pQueryHandle->rhelper), pBlock, pCheckInfo->pDataCols, sa->pData,
+                            taosArrayGetSize(sa)) == 0) {
     SDataBlockLoadInfo* pBlockLoadInfo = &pQueryHandle->dataBlockLoadInfo;
 
     pBlockLoadInfo->fileGroup = pQueryHandle->pFileGroup;
@@ -426,19 +598,34 @@ static bool doLoadFileDataBlock(STsdbQueryHandle* pQueryHandle, SCompBlock* pBlo
     blockLoaded = true;
   }
 
-  taosArrayDestroy(sa);
-  tfree(data);
+  pQueryHandle->cost.loadBlocksUs += (taosGetTimestampUs() - st);
+  pQueryHandle->cost.numOfFileBlocks += 1;
+
+  uTrace("%p load %d of %d columns from block, rows:%d, read bytes:%" PRId64, pQueryHandle,
+         (int32_t)taosArrayGetSize(sa), pBlock->numOfCols, pBlock->numOfPoints,
+         pQueryHandle->rhelper.blockReadBytes - readBytes);
 
+  taosArrayDestroy(sa);
   return blockLoaded;
 }
 
-static bool loadFileDataBlock(STsdbQueryHandle* pQueryHandle, SCompBlock* pBlock, STableCheckInfo* pCheckInfo) {
+static bool loadFileDataBlock(STsdbQueryHandle* pQueryHandle, STableBlockInfo* pBlockInfo) {
+  STableCheckInfo* pCheckInfo = pBlockInfo->pTableCheckInfo;
+  SCompBlock*      pBlock = pBlockInfo->pBlock.compBlock;
+
+  // nothing to load for a bucket of rollup
+  if (pBlockInfo->pBucket != NULL) {
+    pQueryHandle->realNumOfRows = (int32_t)pBlockInfo->pBucket->rows;
+    pCheckInfo->lastKey = pBlockInfo->pBucket->lastKey + 1;
+    return true;
+  }
+
   SArray*        sa = getDefaultLoadColumns(pQueryHandle, true);
   SQueryFilePos* cur = &pQueryHandle->cur;
 
   if (ASCENDING_ORDER_TRAVERSE(pQueryHandle->order)) {
     // query ended in current block
-    if (pQueryHandle->window.ekey < pBlock->keyLast || pCheckInfo->lastKey > pBlock->keyFirst) {
+    if (pBlockInfo->ekey < pBlock->keyLast || pCheckInfo->lastKey > pBlock->keyFirst) {
       if (!doLoadFileDataBlock(pQueryHandle, pBlock, pCheckInfo)) {
         return false;
       }
@@ -451,13 +638,13 @@ static bool loadFileDataBlock(STsdbQueryHandle* pQueryHandle, SCompBlock* pBlock
         cur->pos = 0;
       }
 
-      filterDataInDataBlock(pQueryHandle, pCheckInfo, pBlock, sa);
+      filterDataInDataBlock(pQueryHandle, pCheckInfo, pBlock, pBlockInfo->ekey, sa);
     } else {  // the whole block is loaded in to buffer
       pQueryHandle->realNumOfRows = pBlock->numOfPoints;
     }
   } else {
     // query ended in current block
-    if (pQueryHandle->window.ekey > pBlock->keyFirst) {
+    if (pBlockInfo->ekey > pBlock->keyFirst) {
       if (!doLoadFileDataBlock(pQueryHandle, pBlock, pCheckInfo)) {
         return false;
       }
@@ -470,7 +657,7 @@ static bool loadFileDataBlock(STsdbQueryHandle* pQueryHandle, SCompBlock* pBlock
         cur->pos = pBlock->numOfPoints - 1;
       }
       
-      filterDataInDataBlock(pQueryHandle, pCheckInfo, pBlock, sa);
+      filterDataInDataBlock(pQueryHandle, pCheckInfo, pBlock, pBlockInfo->ekey, sa);
     } else {
       pQueryHandle->realNumOfRows = pBlock->numOfPoints;
     }
@@ -543,26 +730,27 @@ static int vnodeBinarySearchKey(char* pValue, int num, TSKEY key, int order) {
 }
 
 // only return the qualified data to client in terms of query time window, data rows in the same block but do not
-// be included in the query time window will be discarded
+// be included in the query time window will be discarded. ekey is the end of window, or the key just before the
+// buckets of rollup following the block.
 static void filterDataInDataBlock(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, SCompBlock* pBlock,
-                                  SArray* sa) {
+                                  TSKEY ekey, SArray* sa) {
   SQueryFilePos* cur = &pQueryHandle->cur;
   SDataBlockInfo blockInfo = getTrueDataBlockInfo(pCheckInfo, pBlock);
 
   SDataCols* pCols = pCheckInfo->pDataCols;
 
   int32_t endPos = cur->pos;
-  if (ASCENDING_ORDER_TRAVERSE(pQueryHandle->order) && pQueryHandle->window.ekey > blockInfo.window.ekey) {
+  if (ASCENDING_ORDER_TRAVERSE(pQueryHandle->order) && ekey > blockInfo.window.ekey) {
     endPos = blockInfo.rows - 1;
     pQueryHandle->realNumOfRows = endPos - cur->pos + 1;
     pCheckInfo->lastKey = blockInfo.window.ekey + 1;
-  } else if (!ASCENDING_ORDER_TRAVERSE(pQueryHandle->order) && pQueryHandle->window.ekey < blockInfo.window.skey) {
+  } else if (!ASCENDING_ORDER_TRAVERSE(pQueryHandle->order) && ekey < blockInfo.window.skey) {
     endPos = 0;
     pQueryHandle->realNumOfRows = cur->pos + 1;
     pCheckInfo->lastKey = blockInfo.window.ekey - 1;
   } else {
     int32_t order = (pQueryHandle->order == TSDB_ORDER_ASC)? TSDB_ORDER_DESC:TSDB_ORDER_ASC;
-    endPos = vnodeBinarySearchKey(pCols->cols[0].pData, pCols->numOfPoints, pQueryHandle->window.ekey, order);
+    endPos = vnodeBinarySearchKey(pCols->cols[0].pData, pCols->numOfPoints, ekey, order);
 
     if (ASCENDING_ORDER_TRAVERSE(pQueryHandle->order)) {
       if (endPos < cur->pos) {
@@ -594,13 +782,20 @@ static void filterDataInDataBlock(STsdbQueryHandle* pQueryHandle, STableCheckInf
     for (int32_t j = 0; j < numOfCols; ++j) {
       SColumnInfoData* pCol = taosArrayGet(pQueryHandle->pColumns, j);
 
-      if (pCol->info.colId == colId) {
-        // SDataCol* pDataCol = &pCols->cols[i];
-//        pCol->pData = pQueryHandle->rhelper.pDataCols[0]->cols[i].pData + pCol->info.bytes * start;
-         memmove(pCol->pData, pQueryHandle->rhelper.pDataCols[0]->cols[i].pData + pCol->info.bytes * start,
-                 pQueryHandle->realNumOfRows * pCol->info.bytes);
-        break;
+      if (pCol->info.colId != colId) {
+        continue;
+      }
+
+      for (int32_t k = 0; k < pCols->numOfCols; ++k) {
+        SDataCol* pDataCol = &pCols->cols[k];
+        if (pDataCol->colId == colId) {
+          memmove(pCol->pData, pDataCol->pData + pCol->info.bytes * start,
+                  pQueryHandle->realNumOfRows * pCol->info.bytes);
+          break;
+        }
       }
+
+      break;
     }
   }
 
@@ -701,6 +896,14 @@ static int32_t dataBlockOrderCompar(const void* pLeft, const void* pRight, void*
   STableBlockInfo* pLeftBlockInfoEx = &pSupporter->pDataBlockInfo[leftTableIndex][leftTableBlockIndex];
   STableBlockInfo* pRightBlockInfoEx = &pSupporter->pDataBlockInfo[rightTableIndex][rightTableBlockIndex];
 
+  // the buckets of rollup are in memory, they are returned before the blocks to read
+  if (pLeftBlockInfoEx->pBucket != NULL || pRightBlockInfoEx->pBucket != NULL) {
+    if (pLeftBlockInfoEx->pBucket == NULL) return 1;
+    if (pRightBlockInfoEx->pBucket == NULL) return -1;
+    if (pLeftBlockInfoEx->pBucket->firstKey == pRightBlockInfoEx->pBucket->firstKey) return 0;
+    return pLeftBlockInfoEx->pBucket->firstKey > pRightBlockInfoEx->pBucket->firstKey ? 1 : -1;
+  }
+
   //    assert(pLeftBlockInfoEx->pBlock.compBlock->offset != pRightBlockInfoEx->pBlock.compBlock->offset);
   if (pLeftBlockInfoEx->pBlock.compBlock->offset == pRightBlockInfoEx->pBlock.compBlock->offset &&
       pLeftBlockInfoEx->pBlock.compBlock->last == pRightBlockInfoEx->pBlock.compBlock->last) {
@@ -712,6 +915,12 @@ static int32_t dataBlockOrderCompar(const void* pLeft, const void* pRight, void*
 }
 
 static int32_t createDataBlocksInfo(STsdbQueryHandle* pQueryHandle, int32_t numOfBlocks, int32_t* numOfAllocBlocks) {
+  // realloc with zero size frees the buffer and returns NULL, so a file group without qualified blocks is skipped here
+  if (numOfBlocks == 0) {
+    *numOfAllocBlocks = 0;
+    return TSDB_CODE_SUCCESS;
+  }
+
   char* tmp = realloc(pQueryHandle->pDataBlockInfo, sizeof(STableBlockInfo) * numOfBlocks);
   if (tmp == NULL) {
     return TSDB_CODE_SERV_OUT_OF_MEMORY;
@@ -756,8 +965,15 @@ static int32_t createDataBlocksInfo(STsdbQueryHandle* pQueryHandle, int32_t numO
     for (int32_t k = 0; k < pTableCheck->numOfBlocks; ++k) {
       STableBlockInfo* pBlockInfoEx = &sup.pDataBlockInfo[numOfQualTables][k];
 
+      if (pTableCheck->pRollup != NULL) {
+        *pBlockInfoEx = pTableCheck->pRollupBlocks[k];
+        cnt++;
+        continue;
+      }
+
       pBlockInfoEx->pBlock.compBlock = &pBlock[k];
       pBlockInfoEx->pBlock.fields = NULL;
+      pBlockInfoEx->ekey = pQueryHandle->window.ekey;
 
       pBlockInfoEx->pTableCheckInfo = pTableCheck;
       //      pBlockInfoEx->groupIdx = pTableCheckInfo[j]->groupIdx;     // set the group index
@@ -811,6 +1027,29 @@ static int32_t createDataBlocksInfo(STsdbQueryHandle* pQueryHandle, int32_t numO
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * Issue the reads of the following blocks in the ordered block list before the current block is loaded, so that the
+ * disk reads them while the current block is processed. Each block is prefetched once in a file.
+ */
+static void prefetchDataBlocks(STsdbQueryHandle* pQueryHandle) {
+  if (tsBlockPrefetchNum <= 0) return;
+
+  SQueryFilePos* cur = &pQueryHandle->cur;
+  int32_t        step = ASCENDING_ORDER_TRAVERSE(pQueryHandle->order)? 1:-1;
+
+  int32_t slot = cur->slot + step;
+  if ((pQueryHandle->prefetchSlot - cur->slot) * step > 0) {
+    slot = pQueryHandle->prefetchSlot + step;
+  }
+
+  for (; slot >= 0 && slot < pQueryHandle->numOfBlocks && (slot - cur->slot) * step <= tsBlockPrefetchNum;
+       slot += step) {
+    if (pQueryHandle->pDataBlockInfo[slot].pBucket != NULL) continue;
+    tsdbPrefetchBlock(&pQueryHandle->rhelper, pQueryHandle->pDataBlockInfo[slot].pBlock.compBlock);
+    pQueryHandle->prefetchSlot = slot;
+  }
+}
+
 // todo opt for only one table case
 static bool getDataBlocksInFilesImpl(STsdbQueryHandle* pQueryHandle) {
   pQueryHandle->numOfBlocks = 0;
@@ -852,10 +1091,11 @@ static bool getDataBlocksInFilesImpl(STsdbQueryHandle* pQueryHandle) {
   cur->fid = pQueryHandle->pFileGroup->fileId;
   
   STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[cur->slot];
-  STableCheckInfo* pCheckInfo = pBlockInfo->pTableCheckInfo;
-  SCompBlock*      pBlock = pBlockInfo->pBlock.compBlock;
   
-  return loadFileDataBlock(pQueryHandle, pBlock, pCheckInfo);
+  pQueryHandle->prefetchSlot = cur->slot;
+  prefetchDataBlocks(pQueryHandle);
+
+  return loadFileDataBlock(pQueryHandle, pBlockInfo);
 }
 
 static bool getDataBlocksInFiles(STsdbQueryHandle* pQueryHandle) {
@@ -871,12 +1111,19 @@ static bool getDataBlocksInFiles(STsdbQueryHandle* pQueryHandle) {
     tsdbInitFileGroupIter(pFileHandle, &pQueryHandle->fileIter, pQueryHandle->order);
     tsdbSeekFileGroupIter(&pQueryHandle->fileIter, fid);
 
-    return getDataBlocksInFilesImpl(pQueryHandle);
-  } else {
+    if (getDataBlocksInFilesImpl(pQueryHandle)) {
+      return true;
+    }
+  }
+
+  // the block without qualified rows is skipped, e.g. its rows are all in the buckets of rollup
+  while (cur->fid >= 0) {
     if ((cur->slot == pQueryHandle->numOfBlocks - 1 && ASCENDING_ORDER_TRAVERSE(pQueryHandle->order)) ||
         (cur->slot == 0 && !ASCENDING_ORDER_TRAVERSE(pQueryHandle->order))) { // all blocks
       
-      return getDataBlocksInFilesImpl(pQueryHandle);
+      if (getDataBlocksInFilesImpl(pQueryHandle)) {
+        return true;
+      }
     } else {  // next block of the same file
       int32_t step = ASCENDING_ORDER_TRAVERSE(pQueryHandle->order)? 1:-1;
       cur->slot += step;
@@ -888,9 +1135,14 @@ static bool getDataBlocksInFiles(STsdbQueryHandle* pQueryHandle) {
         cur->pos = pBlockInfo->pBlock.compBlock->numOfPoints - 1;
       }
 
-      return loadFileDataBlock(pQueryHandle, pBlockInfo->pBlock.compBlock, pBlockInfo->pTableCheckInfo);
+      prefetchDataBlocks(pQueryHandle);
+      if (loadFileDataBlock(pQueryHandle, pBlockInfo)) {
+        return true;
+      }
     }
   }
+
+  return false;
 }
 
 static bool doHasDataInBuffer(STsdbQueryHandle* pQueryHandle) {
@@ -913,6 +1165,13 @@ bool tsdbNextDataBlock(TsdbQueryHandleT* pqHandle) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*) pqHandle;
   
   size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+
+  // each last row is returned as a block of one row
+  if (pQueryHandle->lastRowOnly) {
+    pQueryHandle->cur.fid = -1;
+    return (++pQueryHandle->activeIndex) < numOfTables;
+  }
+
   assert(numOfTables > 0);
   
   if (ASCENDING_ORDER_TRAVERSE(pQueryHandle->order)) {
@@ -1007,6 +1266,33 @@ static int tsdbReadRowsFromCache(SSkipListIterator* pIter, TSKEY maxKey, int max
   return numOfRows;
 }
 
+static void tsdbCopyLastRowToColumns(STsdbQueryHandle* pHandle, STableCheckInfo* pCheckInfo) {
+  STSchema* pSchema = tsdbGetTableSchema(tsdbGetMeta(pHandle->pTsdb), pCheckInfo->pTableObj);
+  int32_t   numOfCols = taosArrayGetSize(pHandle->pColumns);
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pHandle->pColumns, i);
+
+    // the columns are packed in row one by one in the order of schema
+    int32_t   offset = 0;
+    STColumn* pCol = NULL;
+    for (int32_t j = 0; j < schemaNCols(pSchema); ++j) {
+      if (colColId(schemaColAt(pSchema, j)) == pColInfo->info.colId) {
+        pCol = schemaColAt(pSchema, j);
+        break;
+      }
+
+      offset += colBytes(schemaColAt(pSchema, j));
+    }
+
+    if (pCol == NULL) {
+      setNull(pColInfo->pData, pColInfo->info.type, pColInfo->info.bytes);
+    } else {
+      memcpy(pColInfo->pData, dataRowTuple(pCheckInfo->lastRow) + offset, pColInfo->info.bytes);
+    }
+  }
+}
+
 // copy data from cache into data block
 SDataBlockInfo tsdbRetrieveDataBlockInfo(TsdbQueryHandleT* pQueryHandle) {
   STsdbQueryHandle* pHandle = (STsdbQueryHandle*)pQueryHandle;
@@ -1018,12 +1304,35 @@ SDataBlockInfo tsdbRetrieveDataBlockInfo(TsdbQueryHandleT* pQueryHandle) {
 
   int32_t step = ASCENDING_ORDER_TRAVERSE(pHandle->order)? 1:-1;
   
-  // data in file
-  if (pHandle->cur.fid >= 0) {
+  if (pHandle->lastRowOnly) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pHandle->pTableCheckInfo, pHandle->activeIndex);
+    pTable = pCheckInfo->pTableObj;
+
+    tsdbCopyLastRowToColumns(pHandle, pCheckInfo);
+    pHandle->cost.numOfCacheBlocks += 1;
+
+    rows = 1;
+    skey = ekey = dataRowKey(pCheckInfo->lastRow);
+    pCheckInfo->lastKey = ekey + step;
+  } else if (pHandle->cur.fid >= 0) {  // data in file
     STableBlockInfo* pBlockInfo = &pHandle->pDataBlockInfo[pHandle->cur.slot];
 
     pTable = pBlockInfo->pTableCheckInfo->pTableObj;
 
+    if (pBlockInfo->pBucket != NULL) {
+      SRollupBucket* pBucket = pBlockInfo->pBucket;
+      pBlockInfo->pTableCheckInfo->lastKey = pBucket->lastKey + 1;
+
+      SDataBlockInfo binfo = {
+          .window = {.skey = pBucket->firstKey, .ekey = pBucket->lastKey},
+          .numOfCols = QH_GET_NUM_OF_COLS(pHandle),
+          .rows = (int32_t)pBucket->rows,
+          .sid = pTable->tableId.tid,
+          .uid = pTable->tableId.uid,
+      };
+      return binfo;
+    }
+
     SDataBlockInfo binfo = getTrueDataBlockInfo(pBlockInfo->pTableCheckInfo, pBlockInfo->pBlock.compBlock);
     if (binfo.rows == pHandle->realNumOfRows) {
       pBlockInfo->pTableCheckInfo->lastKey = pBlockInfo->pBlock.compBlock->keyLast + 1;
@@ -1065,9 +1374,46 @@ SDataBlockInfo tsdbRetrieveDataBlockInfo(TsdbQueryHandleT* pQueryHandle) {
   return blockInfo;
 }
 
-// return null for data block in cache
+// return null for data block in cache, only the buckets of rollup have the statistics now
 int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT* pQueryHandle, SDataStatis** pBlockStatis) {
+  STsdbQueryHandle* pHandle = (STsdbQueryHandle*)pQueryHandle;
   *pBlockStatis = NULL;
+
+  if (pHandle->lastRowOnly || pHandle->cur.fid < 0 || pHandle->pDataBlockInfo[pHandle->cur.slot].pBucket == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  STableBlockInfo* pBlockInfo = &pHandle->pDataBlockInfo[pHandle->cur.slot];
+  STableRollup*    pRollup = pBlockInfo->pTableCheckInfo->pRollup;
+  SRollupBucket*   pBucket = pBlockInfo->pBucket;
+  size_t           numOfCols = QH_GET_NUM_OF_COLS(pHandle);
+
+  if (pHandle->statis == NULL) {
+    pHandle->statis = calloc(numOfCols, sizeof(SDataStatis));
+    if (pHandle->statis == NULL) return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pCol = taosArrayGet(pHandle->pColumns, i);
+    SDataStatis*     pStatis = &pHandle->statis[i];
+
+    memset(pStatis, 0, sizeof(SDataStatis));
+    pStatis->colId = pCol->info.colId;
+    pStatis->numOfNull = (int32_t)pBucket->rows;  // the column added after the rows is null
+
+    for (int32_t j = 0; j < pRollup->numOfCols; ++j) {
+      if (pRollup->cols[j].colId != pCol->info.colId) continue;
+
+      SRollupAgg* pAgg = &pBucket->aggs[j];
+      pStatis->numOfNull = (int32_t)(pBucket->rows - pAgg->count);
+      pStatis->sum = pAgg->sum;
+      pStatis->min = pAgg->min;
+      pStatis->max = pAgg->max;
+      break;
+    }
+  }
+
+  *pBlockStatis = pHandle->statis;
   return TSDB_CODE_SUCCESS;
 }
 
@@ -1084,6 +1430,10 @@ SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
     STableBlockInfo* pBlockInfoEx = &pHandle->pDataBlockInfo[pHandle->cur.slot];
     STableCheckInfo*   pCheckInfo = pBlockInfoEx->pTableCheckInfo;
 
+    if (pBlockInfoEx->pBucket != NULL) {
+      return NULL;
+    }
+
     SDataBlockInfo binfo = getTrueDataBlockInfo(pCheckInfo, pBlockInfoEx->pBlock.compBlock);
     assert(pHandle->realNumOfRows <= binfo.rows);
 
@@ -1092,14 +1442,18 @@ SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
     } else {
       // data block has been loaded, todo extract method
       SDataBlockLoadInfo* pBlockLoadInfo = &pHandle->dataBlockLoadInfo;
-      if (pBlockLoadInfo->slot == pHandle->cur.slot && pBlockLoadInfo->sid == pCheckInfo->pTableObj->tableId.tid) {
+      if (pBlockLoadInfo->fileGroup == pHandle->pFileGroup && pBlockLoadInfo->slot == pHandle->cur.slot &&
+          pBlockLoadInfo->sid == pCheckInfo->pTableObj->tableId.tid) {
         return pHandle->pColumns;
       } else {
         SCompBlock* pBlock = pBlockInfoEx->pBlock.compBlock;
         doLoadFileDataBlock(pHandle, pBlock, pCheckInfo);
 
+        // the whole block is qualified, the position is not set by loadFileDataBlock yet
+        pHandle->cur.pos = ASCENDING_ORDER_TRAVERSE(pHandle->order) ? 0 : binfo.rows - 1;
+
         SArray* sa = getDefaultLoadColumns(pHandle, true);
-        filterDataInDataBlock(pHandle, pCheckInfo, pBlock, sa);
+        filterDataInDataBlock(pHandle, pCheckInfo, pBlock, pBlockInfoEx->ekey, sa);
         taosArrayDestroy(sa);
 
         return pHandle->pColumns;
@@ -1182,6 +1536,8 @@ static void getTagColumnInfo(SExprTreeSupporter* pSupporter, SSchema* pSchema, i
         pSupporter->pTagSchema[*index].colId == pSchema->colId) {
       break;
     }
+
+    (*index) += 1;
   }
 }
 
@@ -1431,6 +1787,126 @@ static int32_t doQueryTableList(STable* pSTable, SArray* pRes, tExprNode* pExpr)
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * Get the tables of the equal (or not equal) condition on an indexed tag from the tag index. The type of value should
+ * be the same class of the tag, so the value is compared in the same way as the filter on skiplist index.
+ */
+static bool queryTagIndexByCond(STagIndex* pIndex, STSchema* pTagSchema, tExprNode* pExpr, SBitmap** pTables) {
+  tExprNode* pLeft  = pExpr->_node.pLeft;
+  tExprNode* pRight = pExpr->_node.pRight;
+  if (pLeft->nodeType != TSQL_NODE_COL || pRight->nodeType != TSQL_NODE_VALUE) {
+    return false;
+  }
+
+  if (strcasecmp(pLeft->pSchema->name, TSQL_TBNAME_L) == 0) {
+    return false;
+  }
+
+  int32_t col = 0;
+  while (col < schemaNCols(pTagSchema) && schemaColAt(pTagSchema, col)->colId != pLeft->pSchema->colId) {
+    col += 1;
+  }
+
+  if (col >= schemaNCols(pTagSchema) || !tsdbIsTagIndexed(pIndex, col)) {
+    return false;
+  }
+
+  int8_t    type = schemaColAt(pTagSchema, col)->type;
+  tVariant* pVar = pRight->pVal;
+
+  char    buf[sizeof(int64_t)] = {0};
+  char*   val = buf;
+  int32_t len = TYPE_BYTES[type];
+
+  if (type == TSDB_DATA_TYPE_BINARY) {
+    if (pVar->nType != TSDB_DATA_TYPE_BINARY) {
+      return false;
+    }
+
+    val = pVar->pz;
+    len = pVar->nLen;
+  } else {
+    if (pVar->nType < TSDB_DATA_TYPE_BOOL || pVar->nType > TSDB_DATA_TYPE_BIGINT || tVariantDump(pVar, buf, type) != 0) {
+      return false;
+    }
+  }
+
+  *pTables = tsdbGetTagIndexTables(pIndex, col, val, len);
+  if (*pTables == NULL || pExpr->_node.optr == TSDB_RELATION_EQUAL) {
+    return *pTables != NULL;
+  }
+
+  SBitmap* pAll = tsdbGetTagIndexAllTables(pIndex);
+  SBitmap* pRes = (pAll == NULL) ? NULL : tBitmapAndNot(pAll, *pTables);
+
+  tBitmapDestroy(pAll);
+  tBitmapDestroy(*pTables);
+
+  *pTables = pRes;
+  return pRes != NULL;
+}
+
+/*
+ * Resolve the tag condition by the tag index of super table, instead of filtering every table in the skiplist index.
+ * Only the equal and not equal conditions on indexed tags, and their combination by AND and OR, are supported. false
+ * is returned for the other conditions, and the tables should be filtered by the skiplist index.
+ */
+static bool queryTagIndex(STagIndex* pIndex, STSchema* pTagSchema, tExprNode* pExpr, SBitmap** pTables) {
+  *pTables = NULL;
+  if (pExpr->nodeType != TSQL_NODE_EXPR) {
+    return false;
+  }
+
+  uint8_t optr = pExpr->_node.optr;
+  if (optr == TSDB_RELATION_EQUAL || optr == TSDB_RELATION_NOT_EQUAL) {
+    return queryTagIndexByCond(pIndex, pTagSchema, pExpr, pTables);
+  }
+
+  if (optr != TSDB_RELATION_AND && optr != TSDB_RELATION_OR) {
+    return false;
+  }
+
+  SBitmap* pLeft = NULL;
+  SBitmap* pRight = NULL;
+  if (!queryTagIndex(pIndex, pTagSchema, pExpr->_node.pLeft, &pLeft)) {
+    return false;
+  }
+
+  if (!queryTagIndex(pIndex, pTagSchema, pExpr->_node.pRight, &pRight)) {
+    tBitmapDestroy(pLeft);
+    return false;
+  }
+
+  *pTables = (optr == TSDB_RELATION_AND) ? tBitmapAnd(pLeft, pRight) : tBitmapOr(pLeft, pRight);
+
+  tBitmapDestroy(pLeft);
+  tBitmapDestroy(pRight);
+  return *pTables != NULL;
+}
+
+// the table of a tid may be dropped, or replaced by a table of another super table, after the tag index is queried
+static void getTableListFromTids(STsdbMeta* pMeta, STable* pSTable, SBitmap* pTables, SArray* pRes) {
+  int64_t   num = tBitmapCardinality(pTables);
+  uint32_t* tids = malloc(sizeof(uint32_t) * (num + 1));
+  if (tids == NULL) {
+    return;
+  }
+
+  num = tBitmapToArray(pTables, tids);
+  for (int64_t i = 0; i < num; ++i) {
+    if (tids[i] >= pMeta->maxTables) {
+      continue;
+    }
+
+    STable* pTable = pMeta->tables[tids[i]];
+    if (pTable != NULL && pTable->type == TSDB_CHILD_TABLE && pTable->superUid == pSTable->tableId.uid) {
+      taosArrayPush(pRes, &pTable);
+    }
+  }
+
+  free(tids);
+}
+
 int32_t tsdbQueryByTagsCond(TsdbRepoT* tsdb, int64_t uid, const char* pTagCond, size_t len, STableGroupInfo* pGroupInfo,
     SColIndex* pColIndex, int32_t numOfCols) {
   
@@ -1465,8 +1941,15 @@ int32_t tsdbQueryByTagsCond(TsdbRepoT* tsdb, int64_t uid, const char* pTagCond,
     return ret;
   }
 
-  doQueryTableList(pSTable, res, pExprNode);
-  
+  SBitmap* pTables = NULL;
+  if (pSTable->pTagIndex != NULL && queryTagIndex(pSTable->pTagIndex, pTagSchema, pExprNode, &pTables)) {
+    getTableListFromTids(tsdbGetMeta(tsdb), pSTable, pTables, res);
+    tBitmapDestroy(pTables);
+    tExprTreeDestroy(&pExprNode, destroyHelper);
+  } else {
+    doQueryTableList(pSTable, res, pExprNode);
+  }
+
   pGroupInfo->numOfTables = taosArrayGetSize(res);
   pGroupInfo->pGroupList  = createTableGroup(res, pTagSchema, pColIndex, numOfCols);
 
@@ -1490,6 +1973,22 @@ int32_t tsdbGetOneTableGroup(TsdbRepoT* tsdb, int64_t uid, STableGroupInfo* pGro
   
   return TSDB_CODE_SUCCESS;
 }
+void tsdbGetQueryCost(TsdbQueryHandleT queryHandle, STsdbQueryCost* pCost) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
+  if (pQueryHandle == NULL) {
+    return;
+  }
+
+  STsdbQueryCost* pSrc = &pQueryHandle->cost;
+
+  pCost->loadCompInfoUs   += pSrc->loadCompInfoUs;
+  pCost->loadBlocksUs     += pSrc->loadBlocksUs;
+  pCost->readBytes        += pQueryHandle->rhelper.blockReadBytes;
+  pCost->numOfFiles       += pSrc->numOfFiles;
+  pCost->numOfFileBlocks  += pSrc->numOfFileBlocks;
+  pCost->numOfCacheBlocks += pSrc->numOfCacheBlocks;
+}
+
 void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
   if (pQueryHandle == NULL) {
@@ -1508,8 +2007,13 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
     tfree(pTableCheckInfo->pDataCols);
 
     tfree(pTableCheckInfo->pCompInfo);
+    tfree(pTableCheckInfo->lastRow);
+    tsdbFreeTableRollup(pTableCheckInfo->pRollup);
+    tfree(pTableCheckInfo->pRollupBlocks);
   }
 
+  uTrace("%p total %" PRId64 " bytes of data blocks read from file", pQueryHandle, pQueryHandle->rhelper.blockReadBytes);
+
   taosArrayDestroy(pQueryHandle->pTableCheckInfo);
   tfree(pQueryHandle->compIndex);
 
@@ -1522,6 +2026,7 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   taosArrayDestroy(pQueryHandle->pColumns);
   
   tfree(pQueryHandle->pDataBlockInfo);
+  tfree(pQueryHandle->statis);
   tsdbDestroyHelper(&pQueryHandle->rhelper);
   tfree(pQueryHandle);
 }
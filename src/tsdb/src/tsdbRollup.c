@@ -0,0 +1,858 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "tulog.h"
+#include "tchecksum.h"
+#include "ttime.h"
+#include "tsdbMain.h"
+
+#define TSDB_ROLLUP_FILE_SUFFIX ".rollup"
+#define TSDB_ROLLUP_TMP_SUFFIX ".rollup.t"
+
+// the rollup file is rewritten if half of it is dead, i.e. the chunks merged into others, and it is larger than 1MB
+#define TSDB_ROLLUP_DEAD_RATIO 2
+#define TSDB_ROLLUP_MIN_DEAD_BYTES (1024 * 1024)
+
+typedef struct {
+  uint32_t delimiter;
+  int32_t  version;
+  int32_t  maxTables;
+  int32_t  numOfSeries;
+  int64_t  intervals[TSDB_MAX_ROLLUPS];
+} SRollupFileHead;
+
+typedef struct {
+  uint64_t uid;  // 0 if the table has no rollup
+  int64_t  rows;
+  int64_t  bytes;  // bytes of all chunks of the table
+  int64_t  offset[TSDB_MAX_ROLLUPS];  // offset of the newest chunk of each series
+  int32_t  len[TSDB_MAX_ROLLUPS];
+  int32_t  numOfChunks[TSDB_MAX_ROLLUPS];
+} SRollupIdx;
+
+typedef struct {
+  uint64_t uid;
+  int64_t  rows;  // rows of the table rolled up until this chunk
+  int64_t  interval;
+  int64_t  prevOffset;  // the previous chunk of the series, 0 if none
+  int32_t  prevLen;
+  int32_t  numOfCols;
+  int32_t  numOfBuckets;
+  int32_t  reserved;
+  // SRollupCol cols[], padded to 8 bytes
+  // SRollupBucket buckets[]
+  // TSCKSUM checksum
+} SRollupChunk;
+
+#define TSDB_ROLLUP_IDX_OFFSET(tid) (TSDB_FILE_HEAD_SIZE + sizeof(SRollupIdx) * (tid))
+#define TSDB_ROLLUP_COLS_SIZE(numOfCols) (((numOfCols) * sizeof(SRollupCol) + 7) / 8 * 8)
+#define TSDB_ROLLUP_CHUNK_SIZE(numOfCols, numOfBuckets)                      \
+  (sizeof(SRollupChunk) + TSDB_ROLLUP_COLS_SIZE(numOfCols) +                 \
+   (size_t)TSDB_ROLLUP_BUCKET_SIZE(numOfCols) * (numOfBuckets) + sizeof(TSCKSUM))
+#define TSDB_ROLLUP_CHUNK_COLS(pChunk) ((SRollupCol *)((char *)(pChunk) + sizeof(SRollupChunk)))
+#define TSDB_ROLLUP_CHUNK_BUCKETS(pChunk) \
+  ((char *)(pChunk) + sizeof(SRollupChunk) + TSDB_ROLLUP_COLS_SIZE((pChunk)->numOfCols))
+
+#define TSDB_ROLLUP_IS_FLOAT(type) ((type) == TSDB_DATA_TYPE_FLOAT || (type) == TSDB_DATA_TYPE_DOUBLE)
+#define TSDB_ROLLUP_IS_NUMERIC(type) \
+  (((type) >= TSDB_DATA_TYPE_TINYINT && (type) <= TSDB_DATA_TYPE_DOUBLE) || (type) == TSDB_DATA_TYPE_TIMESTAMP)
+
+/*
+ * Parse the intervals in rollupInterval. Only the units from second to week are accepted, since the buckets are
+ * aligned to the multiples of interval, the same as the time windows of interval query in these units.
+ */
+int tsdbInitRollupCfg(STsdbRepo *pRepo) {
+  pRepo->numOfRollups = 0;
+
+  char *intervals = strdup(tsRollupInterval);
+  if (intervals == NULL) return -1;
+
+  char *p = intervals;
+  for (char *token = strsep(&p, ","); token != NULL; token = strsep(&p, ",")) {
+    strtrim(token);
+    int32_t len = (int32_t)strlen(token);
+    if (len == 0) continue;
+
+    int64_t interval = 0;
+    if (strchr("smhdw", token[len - 1]) == NULL || getTimestampInUsFromStr(token, len, &interval) < 0 ||
+        interval <= 0) {
+      uError("vgId:%d invalid rollup interval %s is ignored", pRepo->config.tsdbId, token);
+      continue;
+    }
+    if (pRepo->config.precision == TSDB_TIME_PRECISION_MILLI) interval /= 1000;
+
+    if (pRepo->numOfRollups >= TSDB_MAX_ROLLUPS) {
+      uError("vgId:%d only %d rollups are supported, %s is ignored", pRepo->config.tsdbId, TSDB_MAX_ROLLUPS, token);
+      break;
+    }
+
+    // keep the intervals in ascending order without duplicates
+    int32_t pos = 0;
+    while (pos < pRepo->numOfRollups && pRepo->rollupIntervals[pos] < interval) pos++;
+    if (pos < pRepo->numOfRollups && pRepo->rollupIntervals[pos] == interval) continue;
+
+    memmove(pRepo->rollupIntervals + pos + 1, pRepo->rollupIntervals + pos,
+            sizeof(int64_t) * (pRepo->numOfRollups - pos));
+    pRepo->rollupIntervals[pos] = interval;
+    pRepo->numOfRollups++;
+  }
+
+  free(intervals);
+  return 0;
+}
+
+/*
+ * Return the largest rollup interval which divides both the interval of query and the start of its first window, so
+ * that each window is made up of whole buckets. 0 is returned if no rollup fits.
+ */
+int64_t tsdbGetRollupInterval(TsdbRepoT *repo, int64_t interval, int64_t start) {
+  STsdbRepo *pRepo = (STsdbRepo *)repo;
+
+  for (int32_t i = pRepo->numOfRollups - 1; i >= 0; --i) {
+    int64_t rollup = pRepo->rollupIntervals[i];
+    if (interval % rollup == 0 && start % rollup == 0) return rollup;
+  }
+
+  return 0;
+}
+
+static TSKEY tsdbGetRollupBucketKey(TSKEY key, int64_t interval) {
+  TSKEY bkey = key / interval * interval;
+  if (bkey > key) bkey -= interval;  // for the negative keys
+  return bkey;
+}
+
+static void tsdbInitTableRollup(STableRollup *pRollup, uint64_t uid, int32_t numOfCols) {
+  pRollup->uid = uid;
+  pRollup->rows = 0;
+  pRollup->numOfCols = numOfCols;
+  pRollup->bucketSize = TSDB_ROLLUP_BUCKET_SIZE(numOfCols);
+  pRollup->numOfSeries = 0;
+}
+
+STableRollup *tsdbNewTableRollup(STsdbRepo *pRepo, STable *pTable) {
+  STSchema *pSchema = tsdbGetTableSchema(pRepo->tsdbMeta, pTable);
+  if (pSchema == NULL) return NULL;
+
+  STableRollup *pRollup = (STableRollup *)calloc(1, sizeof(STableRollup));
+  if (pRollup == NULL) return NULL;
+
+  tsdbInitTableRollup(pRollup, pTable->tableId.uid, schemaNCols(pSchema));
+  for (int32_t i = 0; i < schemaNCols(pSchema); ++i) {
+    STColumn *pCol = schemaColAt(pSchema, i);
+    pRollup->cols[i].colId = colColId(pCol);
+    pRollup->cols[i].type = colType(pCol);
+  }
+
+  pRollup->numOfSeries = pRepo->numOfRollups;
+  for (int32_t i = 0; i < pRepo->numOfRollups; ++i) {
+    pRollup->series[i].interval = pRepo->rollupIntervals[i];
+  }
+
+  return pRollup;
+}
+
+void tsdbFreeTableRollup(STableRollup *pRollup) {
+  if (pRollup == NULL) return;
+
+  for (int32_t i = 0; i < pRollup->numOfSeries; ++i) {
+    tfree(pRollup->series[i].buckets);
+  }
+  free(pRollup);
+}
+
+void tsdbFreeTableRollups(STableRollup **pRollups, int numOfTables) {
+  if (pRollups == NULL) return;
+
+  for (int i = 0; i < numOfTables; ++i) {
+    tsdbFreeTableRollup(pRollups[i]);
+  }
+  free(pRollups);
+}
+
+// get the bucket of the key, a new bucket is inserted if not exists
+static SRollupBucket *tsdbGetRollupBucket(STableRollup *pRollup, SRollupSeries *pSeries, TSKEY key) {
+  TSKEY bkey = tsdbGetRollupBucketKey(key, pSeries->interval);
+
+  // the rows are committed in order of key, so the last bucket is hit in most cases
+  int32_t pos = pSeries->numOfBuckets;
+  if (pos > 0) {
+    SRollupBucket *pLast = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, pos - 1);
+    TSKEY          lastKey = tsdbGetRollupBucketKey(pLast->firstKey, pSeries->interval);
+    if (lastKey == bkey) return pLast;
+
+    if (lastKey > bkey) {
+      int32_t low = 0, high = pos - 1;
+      while (low < high) {
+        int32_t mid = (low + high) / 2;
+        if (tsdbGetRollupBucketKey(TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, mid)->firstKey, pSeries->interval) < bkey) {
+          low = mid + 1;
+        } else {
+          high = mid;
+        }
+      }
+
+      SRollupBucket *pBucket = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, low);
+      if (tsdbGetRollupBucketKey(pBucket->firstKey, pSeries->interval) == bkey) return pBucket;
+      pos = low;
+    }
+  }
+
+  if (pSeries->numOfBuckets >= pSeries->maxBuckets) {
+    int32_t maxBuckets = (pSeries->maxBuckets == 0) ? 16 : pSeries->maxBuckets * 2;
+    char *  buckets = realloc(pSeries->buckets, (size_t)pRollup->bucketSize * maxBuckets);
+    if (buckets == NULL) return NULL;
+
+    pSeries->buckets = buckets;
+    pSeries->maxBuckets = maxBuckets;
+  }
+
+  SRollupBucket *pBucket = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, pos);
+  memmove((char *)pBucket + pRollup->bucketSize, pBucket, (size_t)pRollup->bucketSize * (pSeries->numOfBuckets - pos));
+  memset(pBucket, 0, pRollup->bucketSize);
+  pBucket->firstKey = key;
+  pBucket->lastKey = key;
+  pSeries->numOfBuckets++;
+
+  return pBucket;
+}
+
+static void tsdbRollupValues(int8_t type, char *pData, int32_t bytes, int32_t start, int32_t end, SRollupAgg *pAgg) {
+  for (int32_t i = start; i < end; ++i) {
+    char *val = pData + (size_t)bytes * i;
+    if (isNull(val, type)) continue;
+
+    int64_t v = 0;
+    double  d = 0;
+    switch (type) {
+      case TSDB_DATA_TYPE_TINYINT:
+        v = *(int8_t *)val;
+        break;
+      case TSDB_DATA_TYPE_SMALLINT:
+        v = *(int16_t *)val;
+        break;
+      case TSDB_DATA_TYPE_INT:
+        v = *(int32_t *)val;
+        break;
+      case TSDB_DATA_TYPE_BIGINT:
+      case TSDB_DATA_TYPE_TIMESTAMP:
+        v = *(int64_t *)val;
+        break;
+      case TSDB_DATA_TYPE_FLOAT:
+        d = *(float *)val;
+        break;
+      case TSDB_DATA_TYPE_DOUBLE:
+        d = GET_DOUBLE_VAL(val);
+        break;
+      default:  // only the non-null values are counted for the other types
+        pAgg->count++;
+        continue;
+    }
+
+    if (TSDB_ROLLUP_IS_FLOAT(type)) {
+      if (pAgg->count == 0) {
+        *(double *)&pAgg->sum = d;
+        *(double *)&pAgg->min = d;
+        *(double *)&pAgg->max = d;
+      } else {
+        *(double *)&pAgg->sum += d;
+        if (d < GET_DOUBLE_VAL(&pAgg->min)) *(double *)&pAgg->min = d;
+        if (d > GET_DOUBLE_VAL(&pAgg->max)) *(double *)&pAgg->max = d;
+      }
+    } else {
+      if (pAgg->count == 0) {
+        pAgg->sum = v;
+        pAgg->min = v;
+        pAgg->max = v;
+      } else {
+        pAgg->sum += v;
+        if (v < pAgg->min) pAgg->min = v;
+        if (v > pAgg->max) pAgg->max = v;
+      }
+    }
+    pAgg->count++;
+  }
+}
+
+/*
+ * Add the first rows of pDataCols into each series of the rollup. The rows are in ascending order of key, so each run
+ * of rows in the same bucket is aggregated at once.
+ */
+int tsdbRollupDataCols(STableRollup *pRollup, SDataCols *pDataCols, int rows) {
+  if (rows <= 0) return 0;
+
+  // the index of each column of rollup in pDataCols, -1 if not found
+  int32_t colIdx[TSDB_MAX_COLUMNS];
+  for (int32_t i = 0; i < pRollup->numOfCols; ++i) {
+    colIdx[i] = -1;
+    for (int32_t j = 0; j < pDataCols->numOfCols; ++j) {
+      SDataCol *pCol = pDataCols->cols + j;
+      if (pCol->colId == pRollup->cols[i].colId && pCol->type == pRollup->cols[i].type && pCol->pData != NULL) {
+        colIdx[i] = j;
+        break;
+      }
+    }
+  }
+
+  TSKEY *keys = (TSKEY *)keyCol(pDataCols)->pData;
+  for (int32_t s = 0; s < pRollup->numOfSeries; ++s) {
+    SRollupSeries *pSeries = &pRollup->series[s];
+
+    for (int32_t start = 0; start < rows;) {
+      SRollupBucket *pBucket = tsdbGetRollupBucket(pRollup, pSeries, keys[start]);
+      if (pBucket == NULL) return -1;
+
+      TSKEY   bkey = tsdbGetRollupBucketKey(keys[start], pSeries->interval);
+      int32_t end = start + 1;
+      while (end < rows && keys[end] >= bkey && keys[end] < bkey + pSeries->interval) end++;
+
+      pBucket->firstKey = MIN(pBucket->firstKey, keys[start]);
+      pBucket->lastKey = MAX(pBucket->lastKey, keys[end - 1]);
+      pBucket->rows += end - start;
+
+      for (int32_t i = 0; i < pRollup->numOfCols; ++i) {
+        if (colIdx[i] < 0) continue;
+
+        SDataCol *pCol = pDataCols->cols + colIdx[i];
+        tsdbRollupValues(pCol->type, pCol->pData, pCol->bytes, start, end, &pBucket->aggs[i]);
+      }
+
+      start = end;
+    }
+  }
+
+  pRollup->rows += rows;
+  return 0;
+}
+
+static void tsdbMergeRollupAgg(int8_t type, SRollupAgg *pDst, SRollupAgg *pSrc) {
+  if (pSrc->count == 0) return;
+  if (pDst->count == 0) {
+    *pDst = *pSrc;
+    return;
+  }
+
+  pDst->count += pSrc->count;
+  if (!TSDB_ROLLUP_IS_NUMERIC(type)) return;
+
+  if (TSDB_ROLLUP_IS_FLOAT(type)) {
+    *(double *)&pDst->sum += GET_DOUBLE_VAL(&pSrc->sum);
+    if (GET_DOUBLE_VAL(&pSrc->min) < GET_DOUBLE_VAL(&pDst->min)) pDst->min = pSrc->min;
+    if (GET_DOUBLE_VAL(&pSrc->max) > GET_DOUBLE_VAL(&pDst->max)) pDst->max = pSrc->max;
+  } else {
+    pDst->sum += pSrc->sum;
+    if (pSrc->min < pDst->min) pDst->min = pSrc->min;
+    if (pSrc->max > pDst->max) pDst->max = pSrc->max;
+  }
+}
+
+// merge the buckets of a chunk into the series, the columns are matched by colId since the schema may be changed
+static int tsdbMergeRollupChunk(STableRollup *pRollup, SRollupSeries *pSeries, SRollupChunk *pChunk) {
+  SRollupCol *cols = TSDB_ROLLUP_CHUNK_COLS(pChunk);
+  char *      buckets = TSDB_ROLLUP_CHUNK_BUCKETS(pChunk);
+  int32_t     bucketSize = TSDB_ROLLUP_BUCKET_SIZE(pChunk->numOfCols);
+
+  int32_t colIdx[TSDB_MAX_COLUMNS];
+  for (int32_t j = 0; j < pChunk->numOfCols; ++j) {
+    colIdx[j] = -1;
+    for (int32_t i = 0; i < pRollup->numOfCols; ++i) {
+      if (pRollup->cols[i].colId == cols[j].colId && pRollup->cols[i].type == cols[j].type) {
+        colIdx[j] = i;
+        break;
+      }
+    }
+  }
+
+  for (int32_t b = 0; b < pChunk->numOfBuckets; ++b) {
+    SRollupBucket *pSrc = (SRollupBucket *)(buckets + (size_t)bucketSize * b);
+    SRollupBucket *pDst = tsdbGetRollupBucket(pRollup, pSeries, pSrc->firstKey);
+    if (pDst == NULL) return -1;
+
+    pDst->firstKey = MIN(pDst->firstKey, pSrc->firstKey);
+    pDst->lastKey = MAX(pDst->lastKey, pSrc->lastKey);
+    pDst->rows += pSrc->rows;
+
+    for (int32_t j = 0; j < pChunk->numOfCols; ++j) {
+      if (colIdx[j] < 0) continue;
+      tsdbMergeRollupAgg(cols[j].type, &pDst->aggs[colIdx[j]], &pSrc->aggs[j]);
+    }
+  }
+
+  return 0;
+}
+
+static void tsdbGetRollupFileName(STsdbRepo *pRepo, int fid, const char *suffix, char *fname) {
+  snprintf(fname, TSDB_FILENAME_LEN, "%s/%s/f%d%s", pRepo->rootDir, TSDB_ROLLUP_DIR_NAME, fid, suffix);
+}
+
+static void tsdbInitRollupFileHead(STsdbRepo *pRepo, char *buf) {
+  memset(buf, 0, TSDB_FILE_HEAD_SIZE);
+
+  SRollupFileHead *pHead = (SRollupFileHead *)buf;
+  pHead->delimiter = TSDB_FILE_DELIMITER;
+  pHead->version = TSDB_ROLLUP_VERSION;
+  pHead->maxTables = pRepo->config.maxTables;
+  pHead->numOfSeries = pRepo->numOfRollups;
+  memcpy(pHead->intervals, pRepo->rollupIntervals, sizeof(int64_t) * pRepo->numOfRollups);
+
+  taosCalcChecksumAppend(0, (uint8_t *)buf, TSDB_FILE_HEAD_SIZE);
+}
+
+// the rollup file is valid only if it is created with the same configuration
+static bool tsdbIsRollupFileValid(STsdbRepo *pRepo, int fd) {
+  char expected[TSDB_FILE_HEAD_SIZE];
+  char buf[TSDB_FILE_HEAD_SIZE];
+
+  tsdbInitRollupFileHead(pRepo, expected);
+  if (lseek(fd, 0, SEEK_SET) < 0 || tread(fd, buf, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE) return false;
+
+  return memcmp(buf, expected, TSDB_FILE_HEAD_SIZE) == 0;
+}
+
+int tsdbOpenRollupFile(STsdbRepo *pRepo, int fid) {
+  char fname[TSDB_FILENAME_LEN] = "\0";
+  tsdbGetRollupFileName(pRepo, fid, TSDB_ROLLUP_FILE_SUFFIX, fname);
+
+  int fd = open(fname, O_RDONLY);
+  if (fd < 0) return -1;
+
+  if (!tsdbIsRollupFileValid(pRepo, fd)) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+// create the rollup file with an empty index
+static int tsdbCreateRollupFile(STsdbRepo *pRepo, char *fname) {
+  int fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, 0755);
+  if (fd < 0) return -1;
+
+  int32_t size = TSDB_ROLLUP_IDX_OFFSET(pRepo->config.maxTables);
+  char *  buf = (char *)calloc(1, size);
+  if (buf == NULL) {
+    close(fd);
+    return -1;
+  }
+
+  tsdbInitRollupFileHead(pRepo, buf);
+  if (twrite(fd, buf, size) < size) {
+    free(buf);
+    close(fd);
+    return -1;
+  }
+
+  free(buf);
+  return fd;
+}
+
+static int tsdbOpenRollupFileForCommit(STsdbRepo *pRepo, int fid) {
+  char fname[TSDB_FILENAME_LEN] = "\0";
+
+  snprintf(fname, TSDB_FILENAME_LEN, "%s/%s", pRepo->rootDir, TSDB_ROLLUP_DIR_NAME);
+  if (mkdir(fname, 0755) < 0 && errno != EEXIST) {
+    uError("vgId:%d failed to create rollup directory %s, reason:%s", pRepo->config.tsdbId, fname, strerror(errno));
+    return -1;
+  }
+
+  tsdbGetRollupFileName(pRepo, fid, TSDB_ROLLUP_FILE_SUFFIX, fname);
+  int fd = open(fname, O_RDWR);
+  if (fd >= 0) {
+    if (tsdbIsRollupFileValid(pRepo, fd)) return fd;
+
+    // the rollup intervals are changed, all the rollups are rebuilt
+    uTrace("vgId:%d rollup file %s is recreated", pRepo->config.tsdbId, fname);
+    close(fd);
+  }
+
+  return tsdbCreateRollupFile(pRepo, fname);
+}
+
+static SRollupIdx *tsdbLoadRollupIdx(STsdbRepo *pRepo, int fd) {
+  int32_t     size = sizeof(SRollupIdx) * pRepo->config.maxTables;
+  SRollupIdx *pIdx = (SRollupIdx *)malloc(size);
+  if (pIdx == NULL) return NULL;
+
+  if (lseek(fd, TSDB_FILE_HEAD_SIZE, SEEK_SET) < 0 || tread(fd, pIdx, size) < size) {
+    free(pIdx);
+    return NULL;
+  }
+
+  return pIdx;
+}
+
+static SRollupChunk *tsdbReadRollupChunk(int fd, int64_t offset, int32_t len, uint64_t uid, int64_t interval) {
+  if (offset < TSDB_FILE_HEAD_SIZE || len < (int32_t)(sizeof(SRollupChunk) + sizeof(TSCKSUM))) return NULL;
+
+  char *buf = (char *)malloc(len);
+  if (buf == NULL) return NULL;
+
+  SRollupChunk *pChunk = (SRollupChunk *)buf;
+  if (lseek(fd, offset, SEEK_SET) < 0 || tread(fd, buf, len) < len ||
+      !taosCheckChecksumWhole((uint8_t *)buf, len) || pChunk->uid != uid || pChunk->interval != interval ||
+      pChunk->numOfCols <= 0 || pChunk->numOfCols > TSDB_MAX_COLUMNS || pChunk->numOfBuckets < 0 ||
+      TSDB_ROLLUP_CHUNK_SIZE(pChunk->numOfCols, pChunk->numOfBuckets) != (size_t)len) {
+    free(buf);
+    return NULL;
+  }
+
+  return pChunk;
+}
+
+/*
+ * Read the chunks of a series from the newest one. The chunks are freed by the caller, and the total bytes of them
+ * are returned in pBytes.
+ */
+static int tsdbReadRollupChain(int fd, SRollupIdx *pIdx, int s, int64_t interval, SRollupChunk **chunks,
+                               int64_t *pBytes) {
+  int32_t num = pIdx->numOfChunks[s];
+  if (num <= 0 || num > TSDB_ROLLUP_MAX_CHUNKS) return -1;
+
+  int64_t offset = pIdx->offset[s];
+  int32_t len = pIdx->len[s];
+  *pBytes = 0;
+
+  for (int32_t i = 0; i < num; ++i) {
+    chunks[i] = tsdbReadRollupChunk(fd, offset, len, pIdx->uid, interval);
+    if (chunks[i] == NULL || (i == 0 && chunks[i]->rows != pIdx->rows) ||
+        (i < num - 1 && chunks[i]->prevOffset == 0)) {
+      for (int32_t j = 0; j <= i; ++j) tfree(chunks[j]);
+      return -1;
+    }
+
+    *pBytes += len;
+    offset = chunks[i]->prevOffset;
+    len = chunks[i]->prevLen;
+  }
+
+  return num;
+}
+
+// merge the chain of a series into pSeries from the oldest chunk
+static int tsdbLoadRollupSeries(int fd, SRollupIdx *pIdx, int s, STableRollup *pRollup, SRollupSeries *pSeries,
+                                int64_t *pBytes) {
+  SRollupChunk *chunks[TSDB_ROLLUP_MAX_CHUNKS] = {0};
+
+  int32_t num = tsdbReadRollupChain(fd, pIdx, s, pSeries->interval, chunks, pBytes);
+  if (num < 0) return -1;
+
+  int code = 0;
+  for (int32_t i = num - 1; i >= 0; --i) {
+    if (code == 0 && tsdbMergeRollupChunk(pRollup, pSeries, chunks[i]) < 0) code = -1;
+    free(chunks[i]);
+  }
+
+  return code;
+}
+
+// append the series s of rollup as the newest chunk of the series in pIdx, or as a new chain if not chained
+static int tsdbWriteRollupChunk(int fd, STableRollup *pRollup, int s, SRollupIdx *pIdx, bool chained) {
+  SRollupSeries *pSeries = &pRollup->series[s];
+  int32_t        len = TSDB_ROLLUP_CHUNK_SIZE(pRollup->numOfCols, pSeries->numOfBuckets);
+
+  char *buf = (char *)calloc(1, len);
+  if (buf == NULL) return -1;
+
+  SRollupChunk *pChunk = (SRollupChunk *)buf;
+  pChunk->uid = pRollup->uid;
+  pChunk->rows = pIdx->rows;
+  pChunk->interval = pSeries->interval;
+  pChunk->numOfCols = pRollup->numOfCols;
+  pChunk->numOfBuckets = pSeries->numOfBuckets;
+  if (chained) {
+    pChunk->prevOffset = pIdx->offset[s];
+    pChunk->prevLen = pIdx->len[s];
+  }
+
+  memcpy(TSDB_ROLLUP_CHUNK_COLS(pChunk), pRollup->cols, sizeof(SRollupCol) * pRollup->numOfCols);
+  memcpy(TSDB_ROLLUP_CHUNK_BUCKETS(pChunk), pSeries->buckets, (size_t)pRollup->bucketSize * pSeries->numOfBuckets);
+  taosCalcChecksumAppend(0, (uint8_t *)buf, len);
+
+  int64_t offset = lseek(fd, 0, SEEK_END);
+  if (offset < 0 || twrite(fd, buf, len) < len) {
+    free(buf);
+    return -1;
+  }
+  free(buf);
+
+  pIdx->offset[s] = offset;
+  pIdx->len[s] = len;
+  pIdx->numOfChunks[s] = chained ? pIdx->numOfChunks[s] + 1 : 1;
+  pIdx->bytes += len;
+
+  return 0;
+}
+
+// write all series of rollup as new chains of the table
+static int tsdbWriteTableRollup(int fd, STableRollup *pRollup, SRollupIdx *pIdx) {
+  memset(pIdx, 0, sizeof(*pIdx));
+  pIdx->uid = pRollup->uid;
+  pIdx->rows = pRollup->rows;
+
+  for (int32_t s = 0; s < pRollup->numOfSeries; ++s) {
+    if (tsdbWriteRollupChunk(fd, pRollup, s, pIdx, false) < 0) return -1;
+  }
+
+  return 0;
+}
+
+// get the rows of the table in file group, which is the sum of rows of its super blocks
+static int tsdbGetTableRowsInFile(STsdbRepo *pRepo, SRWHelper *pHelper, STable *pTable, int64_t *rows) {
+  SCompIdx *pCompIdx = pHelper->pCompIdx + pTable->tableId.tid;
+
+  *rows = 0;
+  if (pCompIdx->len <= 0 || pCompIdx->numOfSuperBlocks <= 0) return 0;
+
+  tsdbSetHelperTable(pHelper, pTable, pRepo);
+  if (tsdbLoadCompInfo(pHelper, NULL) < 0) return -1;
+  if (pHelper->pCompInfo->uid != pTable->tableId.uid) return 0;
+
+  for (int32_t i = 0; i < pCompIdx->numOfSuperBlocks; ++i) {
+    *rows += blockAtIdx(pHelper, i)->numOfPoints;
+  }
+
+  return 0;
+}
+
+// build the rollup of the table from all its blocks in file group, the SCompInfo of table is loaded already
+static STableRollup *tsdbBuildTableRollup(STsdbRepo *pRepo, SRWHelper *pHelper, STable *pTable) {
+  STableRollup *pRollup = tsdbNewTableRollup(pRepo, pTable);
+  if (pRollup == NULL) return NULL;
+
+  SCompIdx *pCompIdx = pHelper->pCompIdx + pTable->tableId.tid;
+  for (int32_t i = 0; i < pCompIdx->numOfSuperBlocks; ++i) {
+    if (tsdbLoadBlockData(pHelper, blockAtIdx(pHelper, i), NULL) < 0 ||
+        tsdbRollupDataCols(pRollup, pHelper->pDataCols[0], pHelper->pDataCols[0]->numOfPoints) < 0) {
+      tsdbFreeTableRollup(pRollup);
+      return NULL;
+    }
+  }
+
+  return pRollup;
+}
+
+/*
+ * Append the rollup of the rows just committed to the chains of table. A chain too long is merged into one chunk
+ * with the new rows. If the rollup in file does not cover all the other rows of the table, e.g. the rollups are
+ * enabled after some data is committed, the rollup is rebuilt from the blocks.
+ */
+static int tsdbCommitTableRollup(STsdbRepo *pRepo, int fd, SRWHelper *pHelper, STable *pTable, SRollupIdx *pIdx,
+                                 STableRollup *pDelta) {
+  int64_t rows = 0;
+  if (tsdbGetTableRowsInFile(pRepo, pHelper, pTable, &rows) < 0) return -1;
+
+  if (pIdx->uid == pDelta->uid && pIdx->rows + pDelta->rows == rows) {
+    pIdx->rows = rows;
+
+    int32_t s = 0;
+    for (; s < pDelta->numOfSeries; ++s) {
+      if (pIdx->numOfChunks[s] < TSDB_ROLLUP_MAX_CHUNKS) {
+        if (tsdbWriteRollupChunk(fd, pDelta, s, pIdx, true) < 0) return -1;
+        continue;
+      }
+
+      int64_t bytes = 0;
+      pIdx->rows -= pDelta->rows;  // the newest chunk in file has the rows before this commit
+      int code = tsdbLoadRollupSeries(fd, pIdx, s, pDelta, &pDelta->series[s], &bytes);
+      pIdx->rows = rows;
+      if (code < 0) break;
+
+      pIdx->bytes -= bytes;
+      if (tsdbWriteRollupChunk(fd, pDelta, s, pIdx, false) < 0) return -1;
+    }
+
+    if (s == pDelta->numOfSeries) return 0;
+  } else if (pDelta->rows == rows) {
+    return tsdbWriteTableRollup(fd, pDelta, pIdx);
+  }
+
+  STableRollup *pRollup = tsdbBuildTableRollup(pRepo, pHelper, pTable);
+  if (pRollup == NULL) return -1;
+
+  int code = (pRollup->rows == rows) ? tsdbWriteTableRollup(fd, pRollup, pIdx) : -1;
+  tsdbFreeTableRollup(pRollup);
+
+  return code;
+}
+
+// the rollup of the table rebuilt from its chains in the old file, used to rewrite the rollup file
+static STableRollup *tsdbMergeTableRollup(STsdbRepo *pRepo, int fd, STable *pTable, SRollupIdx *pIdx) {
+  STableRollup *pRollup = tsdbNewTableRollup(pRepo, pTable);
+  if (pRollup == NULL) return NULL;
+
+  pRollup->rows = pIdx->rows;
+  for (int32_t s = 0; s < pRollup->numOfSeries; ++s) {
+    int64_t bytes = 0;
+    if (tsdbLoadRollupSeries(fd, pIdx, s, pRollup, &pRollup->series[s], &bytes) < 0) {
+      tsdbFreeTableRollup(pRollup);
+      return NULL;
+    }
+  }
+
+  return pRollup;
+}
+
+// rewrite the rollup file with one chunk for each series, the rollup of a table is dropped if it fails to merge
+static int tsdbRewriteRollupFile(STsdbRepo *pRepo, int fid, int fd, SRollupIdx *pIdx) {
+  STsdbMeta *pMeta = pRepo->tsdbMeta;
+  char       fname[TSDB_FILENAME_LEN] = "\0";
+  char       tname[TSDB_FILENAME_LEN] = "\0";
+
+  tsdbGetRollupFileName(pRepo, fid, TSDB_ROLLUP_FILE_SUFFIX, fname);
+  tsdbGetRollupFileName(pRepo, fid, TSDB_ROLLUP_TMP_SUFFIX, tname);
+
+  int tfd = tsdbCreateRollupFile(pRepo, tname);
+  if (tfd < 0) return -1;
+
+  SRollupIdx *pNewIdx = (SRollupIdx *)calloc(pRepo->config.maxTables, sizeof(SRollupIdx));
+  if (pNewIdx == NULL) goto _err;
+
+  for (int32_t tid = 0; tid < pRepo->config.maxTables; ++tid) {
+    STable *pTable = pMeta->tables[tid];
+    if (pIdx[tid].uid == 0 || pTable == NULL || pTable->tableId.uid != pIdx[tid].uid) continue;
+
+    STableRollup *pRollup = tsdbMergeTableRollup(pRepo, fd, pTable, pIdx + tid);
+    if (pRollup == NULL) continue;
+
+    int code = tsdbWriteTableRollup(tfd, pRollup, pNewIdx + tid);
+    tsdbFreeTableRollup(pRollup);
+    if (code < 0) goto _err;
+  }
+
+  int32_t size = sizeof(SRollupIdx) * pRepo->config.maxTables;
+  if (fsync(tfd) < 0 || lseek(tfd, TSDB_FILE_HEAD_SIZE, SEEK_SET) < 0 || twrite(tfd, pNewIdx, size) < size ||
+      fsync(tfd) < 0) {
+    goto _err;
+  }
+
+  if (rename(tname, fname) < 0) goto _err;
+
+  free(pNewIdx);
+  close(tfd);
+  return 0;
+
+_err:
+  tfree(pNewIdx);
+  close(tfd);
+  remove(tname);
+  return -1;
+}
+
+/*
+ * Write the rollups of the tables committed to the file group, which is called after the data files are committed.
+ * A failure here does not fail the commit, since the stale rollups are never used and will be rebuilt.
+ */
+int tsdbCommitRollups(STsdbRepo *pRepo, SFileGroup *pGroup, STableRollup **pRollups) {
+  STsdbMeta * pMeta = pRepo->tsdbMeta;
+  SRollupIdx *pIdx = NULL;
+  SRWHelper   rhelper = {0};
+  int         fd = -1;
+  int         code = -1;
+
+  if (tsdbInitReadHelper(&rhelper, pRepo) < 0) return -1;
+  if (tsdbSetAndOpenHelperFile(&rhelper, pGroup) < 0) goto _exit;
+
+  fd = tsdbOpenRollupFileForCommit(pRepo, pGroup->fileId);
+  if (fd < 0) goto _exit;
+
+  pIdx = tsdbLoadRollupIdx(pRepo, fd);
+  if (pIdx == NULL) goto _exit;
+
+  for (int32_t tid = 0; tid < pRepo->config.maxTables; ++tid) {
+    STable *pTable = pMeta->tables[tid];
+    if (pRollups[tid] == NULL || pTable == NULL || pTable->tableId.uid != pRollups[tid]->uid) continue;
+
+    if (tsdbCommitTableRollup(pRepo, fd, &rhelper, pTable, pIdx + tid, pRollups[tid]) < 0) {
+      uError("vgId:%d failed to commit rollup of table uid:%" PRIu64 " in fid:%d", pRepo->config.tsdbId,
+             pTable->tableId.uid, pGroup->fileId);
+      memset(pIdx + tid, 0, sizeof(SRollupIdx));
+    }
+  }
+
+  // the chunks are synced before the index refers to them
+  int32_t size = sizeof(SRollupIdx) * pRepo->config.maxTables;
+  if (fsync(fd) < 0 || lseek(fd, TSDB_FILE_HEAD_SIZE, SEEK_SET) < 0 || twrite(fd, pIdx, size) < size ||
+      fsync(fd) < 0) {
+    goto _exit;
+  }
+
+  int64_t fsize = lseek(fd, 0, SEEK_END);
+  int64_t live = TSDB_ROLLUP_IDX_OFFSET(pRepo->config.maxTables);
+  for (int32_t tid = 0; tid < pRepo->config.maxTables; ++tid) {
+    if (pIdx[tid].uid != 0) live += pIdx[tid].bytes;
+  }
+
+  if (fsize - live >= TSDB_ROLLUP_MIN_DEAD_BYTES && (fsize - live) * TSDB_ROLLUP_DEAD_RATIO >= fsize) {
+    if (tsdbRewriteRollupFile(pRepo, pGroup->fileId, fd, pIdx) < 0) {
+      uError("vgId:%d failed to rewrite rollup file of fid:%d", pRepo->config.tsdbId, pGroup->fileId);
+    } else {
+      uTrace("vgId:%d rollup file of fid:%d is rewritten, %" PRId64 " of %" PRId64 " bytes are dead",
+             pRepo->config.tsdbId, pGroup->fileId, fsize - live, fsize);
+    }
+  }
+
+  code = 0;
+
+_exit:
+  if (code < 0) {
+    uError("vgId:%d failed to commit rollups in fid:%d, reason:%s", pRepo->config.tsdbId, pGroup->fileId,
+           strerror(errno));
+  }
+  tsdbDestroyHelper(&rhelper);
+  tfree(pIdx);
+  if (fd >= 0) close(fd);
+  return code;
+}
+
+/*
+ * Load the series of a table in the rollup file for query. The columns are those of the newest chunk. NULL is
+ * returned if the table has no valid rollup of the interval.
+ */
+STableRollup *tsdbLoadTableRollup(STsdbRepo *pRepo, int fd, STable *pTable, int64_t interval) {
+  int32_t s = 0;
+  while (s < pRepo->numOfRollups && pRepo->rollupIntervals[s] != interval) s++;
+  if (s == pRepo->numOfRollups) return NULL;
+
+  SRollupIdx idx = {0};
+  if (lseek(fd, TSDB_ROLLUP_IDX_OFFSET(pTable->tableId.tid), SEEK_SET) < 0 ||
+      tread(fd, &idx, sizeof(idx)) < (int32_t)sizeof(idx) || idx.uid != pTable->tableId.uid) {
+    return NULL;
+  }
+
+  SRollupChunk *chunks[TSDB_ROLLUP_MAX_CHUNKS] = {0};
+  int64_t       bytes = 0;
+  int32_t       num = tsdbReadRollupChain(fd, &idx, s, interval, chunks, &bytes);
+  if (num < 0) return NULL;
+
+  STableRollup *pRollup = (STableRollup *)calloc(1, sizeof(STableRollup));
+  if (pRollup != NULL) {
+    tsdbInitTableRollup(pRollup, idx.uid, chunks[0]->numOfCols);
+    memcpy(pRollup->cols, TSDB_ROLLUP_CHUNK_COLS(chunks[0]), sizeof(SRollupCol) * chunks[0]->numOfCols);
+    pRollup->rows = idx.rows;
+    pRollup->numOfSeries = 1;
+    pRollup->series[0].interval = interval;
+  }
+
+  for (int32_t i = num - 1; i >= 0; --i) {
+    if (pRollup != NULL && tsdbMergeRollupChunk(pRollup, &pRollup->series[0], chunks[i]) < 0) {
+      tsdbFreeTableRollup(pRollup);
+      pRollup = NULL;
+    }
+    free(chunks[i]);
+  }
+
+  return pRollup;
+}
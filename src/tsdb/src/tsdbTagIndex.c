@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "tulog.h"
+#include "tsdbMain.h"
+
+static bool tsdbIsIndexedTagType(int8_t type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+    case TSDB_DATA_TYPE_SMALLINT:
+    case TSDB_DATA_TYPE_INT:
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_BINARY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+ * The tags are appended to the tag row in the order of tag schema. The fixed part keeps the value of a fixed length
+ * tag, or the offset of the value of a binary tag, which is appended after the fixed part without the terminating
+ * null, so its length is up to the value of next binary tag or the end of row.
+ */
+static char *tsdbGetTagValue(STSchema *pTagSchema, SDataRow row, int32_t col, int32_t *len) {
+  int32_t offset = TD_DATA_ROW_HEAD_SIZE;
+  for (int32_t i = 0; i < col; i++) {
+    offset += TYPE_BYTES[schemaColAt(pTagSchema, i)->type];
+  }
+
+  STColumn *pCol = schemaColAt(pTagSchema, col);
+  if (pCol->type != TSDB_DATA_TYPE_BINARY && pCol->type != TSDB_DATA_TYPE_NCHAR) {
+    *len = TYPE_BYTES[pCol->type];
+    return dataRowAt(row, offset);
+  }
+
+  int32_t start = *(int32_t *)dataRowAt(row, offset);
+  int32_t end = dataRowLen(row);
+
+  offset += TYPE_BYTES[pCol->type];
+  for (int32_t i = col + 1; i < schemaNCols(pTagSchema); i++) {
+    int8_t type = schemaColAt(pTagSchema, i)->type;
+    if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR) {
+      end = *(int32_t *)dataRowAt(row, offset);
+      break;
+    }
+
+    offset += TYPE_BYTES[type];
+  }
+
+  *len = end - start;
+  return dataRowAt(row, start);
+}
+
+static void tsdbFreeTagIndexBitmap(void *data) { tBitmapDestroy(*(SBitmap **)data); }
+
+STagIndex *tsdbNewTagIndex(STSchema *pTagSchema) {
+  STagIndex *pIndex = (STagIndex *)calloc(1, sizeof(STagIndex));
+  if (pIndex == NULL) return NULL;
+
+  pIndex->numOfTags = schemaNCols(pTagSchema);
+  pIndex->pTables = tBitmapCreate();
+  pIndex->pValues = (SHashObj **)calloc(pIndex->numOfTags, sizeof(SHashObj *));
+  if (pIndex->pTables == NULL || pIndex->pValues == NULL) goto _err;
+
+  for (int32_t i = 0; i < pIndex->numOfTags; i++) {
+    if (!tsdbIsIndexedTagType(schemaColAt(pTagSchema, i)->type)) continue;
+
+    pIndex->pValues[i] = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+    if (pIndex->pValues[i] == NULL) goto _err;
+    taosHashSetFreecb(pIndex->pValues[i], tsdbFreeTagIndexBitmap);
+  }
+
+  pthread_rwlock_init(&pIndex->rwLock, NULL);
+  return pIndex;
+
+_err:
+  uError("failed to create tag index since out of memory");
+  if (pIndex->pValues != NULL) {
+    for (int32_t i = 0; i < pIndex->numOfTags; i++) {
+      taosHashCleanup(pIndex->pValues[i]);
+    }
+  }
+
+  tfree(pIndex->pValues);
+  tBitmapDestroy(pIndex->pTables);
+  free(pIndex);
+  return NULL;
+}
+
+void tsdbFreeTagIndex(STagIndex *pIndex) {
+  if (pIndex == NULL) return;
+
+  for (int32_t i = 0; i < pIndex->numOfTags; i++) {
+    taosHashCleanup(pIndex->pValues[i]);
+  }
+
+  free(pIndex->pValues);
+  tBitmapDestroy(pIndex->pTables);
+  pthread_rwlock_destroy(&pIndex->rwLock);
+  free(pIndex);
+}
+
+int tsdbAddIntoTagIndex(STagIndex *pIndex, STSchema *pTagSchema, STable *pTable) {
+  uint32_t tid = (uint32_t)pTable->tableId.tid;
+  int      code = 0;
+
+  pthread_rwlock_wrlock(&pIndex->rwLock);
+
+  for (int32_t i = 0; i < pIndex->numOfTags; i++) {
+    if (pIndex->pValues[i] == NULL) continue;
+
+    int32_t len = 0;
+    char *  val = tsdbGetTagValue(pTagSchema, pTable->tagVal, i, &len);
+
+    SBitmap **ppTables = (SBitmap **)taosHashGet(pIndex->pValues[i], val, len);
+    if (ppTables == NULL) {
+      SBitmap *pTables = tBitmapCreate();
+      if (pTables == NULL || taosHashPut(pIndex->pValues[i], val, len, &pTables, POINTER_BYTES) < 0) {
+        tBitmapDestroy(pTables);
+        code = -1;
+        break;
+      }
+
+      ppTables = (SBitmap **)taosHashGet(pIndex->pValues[i], val, len);
+    }
+
+    if (tBitmapAdd(*ppTables, tid) < 0) {
+      code = -1;
+      break;
+    }
+  }
+
+  if (code == 0) code = tBitmapAdd(pIndex->pTables, tid);
+  if (code < 0) pIndex->invalid = 1;
+
+  pthread_rwlock_unlock(&pIndex->rwLock);
+
+  if (code < 0) {
+    uError("failed to add table uid:%" PRIu64 ", tid:%d into tag index", pTable->tableId.uid, pTable->tableId.tid);
+  }
+
+  return code;
+}
+
+void tsdbRemoveFromTagIndex(STagIndex *pIndex, STSchema *pTagSchema, STable *pTable) {
+  uint32_t tid = (uint32_t)pTable->tableId.tid;
+
+  pthread_rwlock_wrlock(&pIndex->rwLock);
+
+  for (int32_t i = 0; i < pIndex->numOfTags; i++) {
+    if (pIndex->pValues[i] == NULL) continue;
+
+    int32_t len = 0;
+    char *  val = tsdbGetTagValue(pTagSchema, pTable->tagVal, i, &len);
+
+    SBitmap **ppTables = (SBitmap **)taosHashGet(pIndex->pValues[i], val, len);
+    if (ppTables == NULL) continue;
+
+    tBitmapRemove(*ppTables, tid);
+    if (tBitmapCardinality(*ppTables) == 0) taosHashRemove(pIndex->pValues[i], val, len);
+  }
+
+  tBitmapRemove(pIndex->pTables, tid);
+
+  pthread_rwlock_unlock(&pIndex->rwLock);
+}
+
+bool tsdbIsTagIndexed(STagIndex *pIndex, int32_t col) {
+  return !pIndex->invalid && col >= 0 && col < pIndex->numOfTags && pIndex->pValues[col] != NULL;
+}
+
+// a copy of the tids of all child tables, which should be destroyed by the caller, NULL if out of memory
+SBitmap *tsdbGetTagIndexAllTables(STagIndex *pIndex) {
+  pthread_rwlock_rdlock(&pIndex->rwLock);
+  SBitmap *pTables = tBitmapDup(pIndex->pTables);
+  pthread_rwlock_unlock(&pIndex->rwLock);
+
+  return pTables;
+}
+
+/*
+ * A copy of the tids of child tables whose tag equals to the value, which should be destroyed by the caller. An empty
+ * bitmap is returned if no table has this value, and NULL if out of memory. The tag must be indexed.
+ */
+SBitmap *tsdbGetTagIndexTables(STagIndex *pIndex, int32_t col, const char *val, int32_t len) {
+  assert(col >= 0 && col < pIndex->numOfTags && pIndex->pValues[col] != NULL);
+
+  pthread_rwlock_rdlock(&pIndex->rwLock);
+
+  SBitmap **ppTables = (SBitmap **)taosHashGet(pIndex->pValues[col], val, len);
+  SBitmap * pTables = (ppTables == NULL) ? tBitmapCreate() : tBitmapDup(*ppTables);
+
+  pthread_rwlock_unlock(&pIndex->rwLock);
+
+  return pTables;
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include "tdataformat.h"
+
+// the value of a row tells the source it comes from, the key for the target and the key plus this for the source
+static const int32_t sourceMark = 100000;
+
+static STSchema *createMergeSchema() {
+  STSchema *pSchema = tdNewSchema(2);
+  tdSchemaAppendCol(pSchema, TSDB_DATA_TYPE_TIMESTAMP, 0, -1);
+  tdSchemaAppendCol(pSchema, TSDB_DATA_TYPE_INT, 1, -1);
+  return pSchema;
+}
+
+static SDataCols *createDataCols(STSchema *pSchema, int maxRows) {
+  SDataCols *pCols = tdNewDataCols(tdMaxRowBytesFromSchema(pSchema), schemaNCols(pSchema), maxRows);
+  tdInitDataCols(pCols, pSchema);
+  return pCols;
+}
+
+static void appendRows(SDataCols *pCols, STSchema *pSchema, TSKEY start, int64_t step, int rows, int32_t mark) {
+  SDataRow row = tdNewDataRowFromSchema(pSchema);
+
+  for (int i = 0; i < rows; i++) {
+    TSKEY   key = start + step * i;
+    int32_t val = (int32_t)key + mark;
+
+    tdInitDataRow(row, pSchema);
+    tdAppendColVal(row, &key, schemaColAt(pSchema, 0));
+    tdAppendColVal(row, &val, schemaColAt(pSchema, 1));
+    tdAppendDataRowToDataCol(row, pCols);
+  }
+
+  tdFreeDataRow(row);
+}
+
+static int32_t valAt(SDataCols *pCols, int idx) { return ((int32_t *)(pCols->cols[1].pData))[idx]; }
+
+// the keys must be ascending and the column lengths must follow the number of rows
+static void checkDataCols(SDataCols *pCols, int rows) {
+  ASSERT_EQ(pCols->numOfPoints, rows);
+  ASSERT_EQ(pCols->cols[0].len, (int)sizeof(TSKEY) * rows);
+  ASSERT_EQ(pCols->cols[1].len, (int)sizeof(int32_t) * rows);
+
+  for (int i = 1; i < rows; i++) {
+    ASSERT_LT(dataColsKeyAt(pCols, i - 1), dataColsKeyAt(pCols, i));
+  }
+}
+
+TEST(TdataformatTest, mergeSourceAfterTarget) {
+  STSchema * pSchema = createMergeSchema();
+  SDataCols *target = createDataCols(pSchema, 100);
+  SDataCols *source = createDataCols(pSchema, 100);
+
+  appendRows(target, pSchema, 0, 1, 10, 0);
+  appendRows(source, pSchema, 10, 1, 10, sourceMark);
+
+  ASSERT_EQ(tdMergeDataCols(target, source, source->numOfPoints), 0);
+  checkDataCols(target, 20);
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ(dataColsKeyAt(target, i), i);
+    ASSERT_EQ(valAt(target, i), (i < 10) ? i : i + sourceMark);
+  }
+
+  tdFreeDataCols(target);
+  tdFreeDataCols(source);
+  tdFreeSchema(pSchema);
+}
+
+TEST(TdataformatTest, mergeSourceBeforeTarget) {
+  STSchema * pSchema = createMergeSchema();
+  SDataCols *target = createDataCols(pSchema, 100);
+  SDataCols *source = createDataCols(pSchema, 100);
+
+  appendRows(target, pSchema, 50, 1, 10, 0);
+  appendRows(source, pSchema, 0, 1, 10, sourceMark);
+
+  ASSERT_EQ(tdMergeDataCols(target, source, source->numOfPoints), 0);
+  checkDataCols(target, 20);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(dataColsKeyAt(target, i), i);
+    ASSERT_EQ(valAt(target, i), i + sourceMark);
+    ASSERT_EQ(dataColsKeyAt(target, i + 10), 50 + i);
+    ASSERT_EQ(valAt(target, i + 10), 50 + i);
+  }
+
+  tdFreeDataCols(target);
+  tdFreeDataCols(source);
+  tdFreeSchema(pSchema);
+}
+
+TEST(TdataformatTest, mergeSourceIntoGap) {
+  STSchema * pSchema = createMergeSchema();
+  SDataCols *target = createDataCols(pSchema, 100);
+  SDataCols *source = createDataCols(pSchema, 100);
+
+  appendRows(target, pSchema, 0, 1, 10, 0);
+  appendRows(target, pSchema, 50, 1, 10, 0);
+  appendRows(source, pSchema, 20, 1, 10, sourceMark);
+
+  ASSERT_EQ(tdMergeDataCols(target, source, source->numOfPoints), 0);
+  checkDataCols(target, 30);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(valAt(target, i), i);
+    ASSERT_EQ(valAt(target, i + 10), 20 + i + sourceMark);
+    ASSERT_EQ(valAt(target, i + 20), 50 + i);
+  }
+
+  tdFreeDataCols(target);
+  tdFreeDataCols(source);
+  tdFreeSchema(pSchema);
+}
+
+TEST(TdataformatTest, mergeInterleavedKeys) {
+  STSchema * pSchema = createMergeSchema();
+  SDataCols *target = createDataCols(pSchema, 200);
+  SDataCols *source = createDataCols(pSchema, 200);
+
+  // target has the even keys and source the odd ones, so every run has a single row
+  appendRows(target, pSchema, 0, 2, 50, 0);
+  appendRows(source, pSchema, 1, 2, 50, sourceMark);
+
+  ASSERT_EQ(tdMergeDataCols(target, source, source->numOfPoints), 0);
+  checkDataCols(target, 100);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(dataColsKeyAt(target, i), i);
+    ASSERT_EQ(valAt(target, i), (i % 2 == 0) ? i : i + sourceMark);
+  }
+
+  tdFreeDataCols(target);
+  tdFreeDataCols(source);
+  tdFreeSchema(pSchema);
+}
+
+TEST(TdataformatTest, mergeDuplicateKeys) {
+  STSchema * pSchema = createMergeSchema();
+  SDataCols *target = createDataCols(pSchema, 100);
+  SDataCols *source = createDataCols(pSchema, 100);
+
+  // keys 5 to 9 are in both, and the rows of target are kept
+  appendRows(target, pSchema, 0, 1, 10, 0);
+  appendRows(source, pSchema, 5, 1, 10, sourceMark);
+
+  ASSERT_EQ(tdMergeDataCols(target, source, source->numOfPoints), 0);
+  checkDataCols(target, 15);
+  for (int i = 0; i < 15; i++) {
+    ASSERT_EQ(dataColsKeyAt(target, i), i);
+    ASSERT_EQ(valAt(target, i), (i < 10) ? i : i + sourceMark);
+  }
+
+  tdFreeDataCols(target);
+  tdFreeDataCols(source);
+  tdFreeSchema(pSchema);
+}
+
+TEST(TdataformatTest, mergePartOfSource) {
+  STSchema * pSchema = createMergeSchema();
+  SDataCols *target = createDataCols(pSchema, 100);
+  SDataCols *source = createDataCols(pSchema, 100);
+
+  appendRows(target, pSchema, 0, 10, 10, 0);
+  appendRows(source, pSchema, 5, 10, 10, sourceMark);
+
+  // only the first 4 rows of source, up to key 35, are merged
+  ASSERT_EQ(tdMergeDataCols(target, source, 4), 0);
+  checkDataCols(target, 14);
+  ASSERT_EQ(dataColsKeyAt(target, 7), 35);
+  ASSERT_EQ(valAt(target, 7), 35 + sourceMark);
+  ASSERT_EQ(dataColsKeyAt(target, 8), 40);
+  ASSERT_EQ(dataColsKeyAt(target, 13), 90);
+
+  tdFreeDataCols(target);
+  tdFreeDataCols(source);
+  tdFreeSchema(pSchema);
+}
+
+TEST(TdataformatTest, mergeTwoDataColsByRounds) {
+  STSchema * pSchema = createMergeSchema();
+  SDataCols *src1 = createDataCols(pSchema, 100);
+  SDataCols *src2 = createDataCols(pSchema, 100);
+  SDataCols *target = createDataCols(pSchema, 100);
+
+  appendRows(src1, pSchema, 0, 2, 30, 0);
+  appendRows(src2, pSchema, 21, 2, 30, sourceMark);
+
+  // each round takes at most 16 rows and resumes from the iterators of the last round
+  int   iter1 = 0, iter2 = 0;
+  TSKEY lastKey = -1;
+  int   total = 0;
+  while (iter1 < src1->numOfPoints || iter2 < src2->numOfPoints) {
+    tdMergeTwoDataCols(target, src1, &iter1, src1->numOfPoints, src2, &iter2, src2->numOfPoints, 16);
+    ASSERT_GT(target->numOfPoints, 0);
+    ASSERT_LE(target->numOfPoints, 16);
+    checkDataCols(target, target->numOfPoints);
+    ASSERT_GT(dataColsKeyFirst(target), lastKey);
+
+    lastKey = dataColsKeyLast(target);
+    total += target->numOfPoints;
+  }
+
+  ASSERT_EQ(total, 60);
+  ASSERT_EQ(iter1, 30);
+  ASSERT_EQ(iter2, 30);
+  ASSERT_EQ(lastKey, 79);
+
+  tdFreeDataCols(target);
+  tdFreeDataCols(src1);
+  tdFreeDataCols(src2);
+  tdFreeSchema(pSchema);
+}
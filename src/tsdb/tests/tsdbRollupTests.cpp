@@ -0,0 +1,375 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include "tdataformat.h"
+#include "tglobal.h"
+#include "tsdbMain.h"
+#include "ttime.h"
+#include "tutil.h"
+
+#define ROLLUP_TEST_DIR "/tmp/tsdbRollupTest"
+
+static const int64_t minute = 60 * 1000L;
+
+static STSchema *createRollupSchema() {
+  STSchema *pSchema = tdNewSchema(3);
+  tdSchemaAppendCol(pSchema, TSDB_DATA_TYPE_TIMESTAMP, 0, -1);
+  tdSchemaAppendCol(pSchema, TSDB_DATA_TYPE_INT, 1, -1);
+  tdSchemaAppendCol(pSchema, TSDB_DATA_TYPE_DOUBLE, 2, -1);
+  return pSchema;
+}
+
+// the value of each row is derived from its key, so the expected aggregates of any range are known
+static int32_t intValOfKey(TSKEY key) { return (int32_t)((key / 1000) % 97) - 40; }
+static double  doubleValOfKey(TSKEY key) { return (key / 1000) % 13 * 0.5; }
+
+static void appendRows(SDataCols *pCols, STSchema *pSchema, TSKEY start, int64_t step, int rows) {
+  SDataRow row = tdNewDataRowFromSchema(pSchema);
+
+  for (int i = 0; i < rows; i++) {
+    TSKEY   key = start + step * i;
+    int32_t ival = intValOfKey(key);
+    double  dval = doubleValOfKey(key);
+
+    tdInitDataRow(row, pSchema);
+    tdAppendColVal(row, &key, schemaColAt(pSchema, 0));
+    tdAppendColVal(row, &ival, schemaColAt(pSchema, 1));
+    tdAppendColVal(row, &dval, schemaColAt(pSchema, 2));
+    tdAppendDataRowToDataCol(row, pCols);
+  }
+
+  tdFreeDataRow(row);
+}
+
+static STableRollup *createTableRollup(STSchema *pSchema, int64_t *intervals, int numOfIntervals) {
+  STableRollup *pRollup = (STableRollup *)calloc(1, sizeof(STableRollup));
+
+  pRollup->uid = 1;
+  pRollup->numOfCols = schemaNCols(pSchema);
+  pRollup->bucketSize = TSDB_ROLLUP_BUCKET_SIZE(pRollup->numOfCols);
+  for (int i = 0; i < pRollup->numOfCols; i++) {
+    pRollup->cols[i].colId = colColId(schemaColAt(pSchema, i));
+    pRollup->cols[i].type = colType(schemaColAt(pSchema, i));
+  }
+
+  pRollup->numOfSeries = numOfIntervals;
+  for (int i = 0; i < numOfIntervals; i++) {
+    pRollup->series[i].interval = intervals[i];
+  }
+
+  return pRollup;
+}
+
+// check a bucket against the rows of [start, end] with the given step
+static void checkBucket(SRollupBucket *pBucket, TSKEY start, TSKEY end, int64_t step) {
+  int64_t count = 0, isum = 0, imin = INT64_MAX, imax = INT64_MIN;
+  double  dsum = 0, dmin = 1e300, dmax = -1e300;
+
+  for (TSKEY key = start; key <= end; key += step) {
+    int32_t ival = intValOfKey(key);
+    double  dval = doubleValOfKey(key);
+
+    count++;
+    isum += ival;
+    imin = MIN(imin, ival);
+    imax = MAX(imax, ival);
+    dsum += dval;
+    dmin = MIN(dmin, dval);
+    dmax = MAX(dmax, dval);
+  }
+
+  ASSERT_EQ(pBucket->firstKey, start);
+  ASSERT_EQ(pBucket->lastKey, end);
+  ASSERT_EQ(pBucket->rows, count);
+
+  ASSERT_EQ(pBucket->aggs[1].count, count);
+  ASSERT_EQ(pBucket->aggs[1].sum, isum);
+  ASSERT_EQ(pBucket->aggs[1].min, imin);
+  ASSERT_EQ(pBucket->aggs[1].max, imax);
+
+  ASSERT_EQ(pBucket->aggs[2].count, count);
+  ASSERT_DOUBLE_EQ(GET_DOUBLE_VAL(&pBucket->aggs[2].sum), dsum);
+  ASSERT_DOUBLE_EQ(GET_DOUBLE_VAL(&pBucket->aggs[2].min), dmin);
+  ASSERT_DOUBLE_EQ(GET_DOUBLE_VAL(&pBucket->aggs[2].max), dmax);
+}
+
+TEST(TsdbRollupTest, initRollupCfg) {
+  STsdbRepo repo;
+  memset(&repo, 0, sizeof(repo));
+  repo.config.precision = TSDB_TIME_PRECISION_MILLI;
+
+  char saved[64];
+  strcpy(saved, tsRollupInterval);
+
+  // the invalid and duplicated intervals are ignored, the others are sorted
+  strcpy(tsRollupInterval, "1h, 1m,1m,bad,10");
+  ASSERT_EQ(tsdbInitRollupCfg(&repo), 0);
+  ASSERT_EQ(repo.numOfRollups, 2);
+  ASSERT_EQ(repo.rollupIntervals[0], minute);
+  ASSERT_EQ(repo.rollupIntervals[1], 60 * minute);
+
+  // the largest rollup dividing both the interval and the start of query is used
+  ASSERT_EQ(tsdbGetRollupInterval(&repo, 2 * 60 * minute, 0), 60 * minute);
+  ASSERT_EQ(tsdbGetRollupInterval(&repo, 2 * 60 * minute, 30 * minute), minute);
+  ASSERT_EQ(tsdbGetRollupInterval(&repo, 5 * minute, 0), minute);
+  ASSERT_EQ(tsdbGetRollupInterval(&repo, 30 * 1000L, 0), 0);
+
+  strcpy(tsRollupInterval, "");
+  ASSERT_EQ(tsdbInitRollupCfg(&repo), 0);
+  ASSERT_EQ(repo.numOfRollups, 0);
+  ASSERT_EQ(tsdbGetRollupInterval(&repo, 60 * minute, 0), 0);
+
+  strcpy(tsRollupInterval, saved);
+}
+
+TEST(TsdbRollupTest, rollupDataCols) {
+  STSchema * pSchema = createRollupSchema();
+  SDataCols *pCols = tdNewDataCols(tdMaxRowBytesFromSchema(pSchema), schemaNCols(pSchema), 4096);
+  int64_t    intervals[] = {minute, 10 * minute};
+
+  STableRollup *pRollup = createTableRollup(pSchema, intervals, 2);
+  TSKEY         start = 1600000200000L;  // 10 minutes aligned
+  int64_t       step = 7000;
+
+  // the rows of a table are committed in two runs, the bucket across the runs is merged
+  tdInitDataCols(pCols, pSchema);
+  appendRows(pCols, pSchema, start, step, 100);
+  ASSERT_EQ(tsdbRollupDataCols(pRollup, pCols, 100), 0);
+
+  tdInitDataCols(pCols, pSchema);
+  appendRows(pCols, pSchema, start + step * 100, step, 200);
+  ASSERT_EQ(tsdbRollupDataCols(pRollup, pCols, 150), 0);  // only the first rows are rolled up
+
+  TSKEY last = start + step * 249;
+  ASSERT_EQ(pRollup->rows, 250);
+
+  for (int s = 0; s < 2; s++) {
+    SRollupSeries *pSeries = &pRollup->series[s];
+    int64_t        interval = intervals[s];
+    int64_t        rows = 0;
+
+    ASSERT_EQ(pSeries->numOfBuckets, (last - start) / interval + 1);
+    for (int i = 0; i < pSeries->numOfBuckets; i++) {
+      SRollupBucket *pBucket = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, i);
+      TSKEY          bstart = start + interval * i;
+      TSKEY          first = start + (bstart - start + step - 1) / step * step;
+      TSKEY          end = MIN(first + (bstart + interval - 1 - first) / step * step, last);
+
+      checkBucket(pBucket, first, end, step);
+      rows += pBucket->rows;
+    }
+    ASSERT_EQ(rows, 250);
+  }
+
+  tsdbFreeTableRollup(pRollup);
+  tdFreeDataCols(pCols);
+  tdFreeSchema(pSchema);
+}
+
+TEST(TsdbRollupTest, rollupOutOfOrderRuns) {
+  STSchema * pSchema = createRollupSchema();
+  SDataCols *pCols = tdNewDataCols(tdMaxRowBytesFromSchema(pSchema), schemaNCols(pSchema), 4096);
+  int64_t    intervals[] = {minute};
+
+  STableRollup *pRollup = createTableRollup(pSchema, intervals, 1);
+  TSKEY         start = 1600000200000L;
+
+  // a later commit may bring rows before the existing buckets, the buckets are kept sorted
+  tdInitDataCols(pCols, pSchema);
+  appendRows(pCols, pSchema, start + 5 * minute, 10000, 30);
+  ASSERT_EQ(tsdbRollupDataCols(pRollup, pCols, 30), 0);
+
+  tdInitDataCols(pCols, pSchema);
+  appendRows(pCols, pSchema, start, 10000, 12);
+  ASSERT_EQ(tsdbRollupDataCols(pRollup, pCols, 12), 0);
+
+  // and rows into the middle of an existing bucket
+  tdInitDataCols(pCols, pSchema);
+  appendRows(pCols, pSchema, start + 5 * minute + 5000, 10000, 6);
+  ASSERT_EQ(tsdbRollupDataCols(pRollup, pCols, 6), 0);
+
+  SRollupSeries *pSeries = &pRollup->series[0];
+  ASSERT_EQ(pSeries->numOfBuckets, 7);
+
+  checkBucket(TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, 0), start, start + 50000, 10000);
+  checkBucket(TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, 1), start + minute, start + minute + 50000, 10000);
+  for (int i = 3; i < 7; i++) {
+    TSKEY bstart = start + (i + 3) * minute;
+    checkBucket(TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, i), bstart, bstart + 50000, 10000);
+  }
+
+  SRollupBucket *pBucket = TSDB_ROLLUP_BUCKET_AT(pRollup, pSeries, 2);
+  ASSERT_EQ(pBucket->firstKey, start + 5 * minute);
+  ASSERT_EQ(pBucket->lastKey, start + 5 * minute + 55000);
+  ASSERT_EQ(pBucket->rows, 12);
+  ASSERT_EQ(pRollup->rows, 48);
+
+  tsdbFreeTableRollup(pRollup);
+  tdFreeDataCols(pCols);
+  tdFreeSchema(pSchema);
+}
+
+static int insertRows(TsdbRepoT *pRepo, STableCfg *pCfg, STSchema *pSchema, TSKEY start, int64_t step, int rows) {
+  int         rowsPerSubmit = 100;
+  SSubmitMsg *pMsg =
+      (SSubmitMsg *)malloc(sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + tdMaxRowBytesFromSchema(pSchema) * rowsPerSubmit);
+  if (pMsg == NULL) return -1;
+
+  for (int k = 0; k < rows; k += rowsPerSubmit) {
+    memset((void *)pMsg, 0, sizeof(SSubmitMsg) + sizeof(SSubmitBlk));
+    SSubmitBlk *pBlock = pMsg->blocks;
+    int         numOfRows = MIN(rowsPerSubmit, rows - k);
+
+    for (int i = 0; i < numOfRows; i++) {
+      TSKEY   key = start + step * (k + i);
+      int32_t ival = intValOfKey(key);
+      double  dval = doubleValOfKey(key);
+
+      SDataRow row = (SDataRow)(pBlock->data + pBlock->len);
+      tdInitDataRow(row, pSchema);
+      tdAppendColVal(row, &key, schemaColAt(pSchema, 0));
+      tdAppendColVal(row, &ival, schemaColAt(pSchema, 1));
+      tdAppendColVal(row, &dval, schemaColAt(pSchema, 2));
+      pBlock->len += dataRowLen(row);
+    }
+
+    pMsg->length = htonl(sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + pBlock->len);
+    pMsg->numOfBlocks = htonl(1);
+
+    pBlock->len = htonl(pBlock->len);
+    pBlock->numOfRows = htons(numOfRows);
+    pBlock->uid = htobe64(pCfg->tableId.uid);
+    pBlock->tid = htonl(pCfg->tableId.tid);
+    pBlock->sversion = htonl(pCfg->sversion);
+
+    if (tsdbInsertData(pRepo, pMsg) < 0) {
+      free(pMsg);
+      return -1;
+    }
+  }
+
+  free(pMsg);
+  return 0;
+}
+
+/*
+ * The rollups are built when the rows are committed to files, and an interval query made up of whole buckets reads
+ * the buckets as the blocks of statistics instead of the rows.
+ */
+TEST(TsdbRollupTest, commitAndQueryRollup) {
+  char saved[64];
+  strcpy(saved, tsRollupInterval);
+  strcpy(tsRollupInterval, "1m");
+
+  taosRemoveDir((char *)ROLLUP_TEST_DIR);
+
+  STsdbCfg config;
+  tsdbSetDefaultCfg(&config);
+  ASSERT_EQ(tsdbCreateRepo((char *)ROLLUP_TEST_DIR, &config, NULL), 0);
+
+  TsdbRepoT *pRepo = tsdbOpenRepo((char *)ROLLUP_TEST_DIR, NULL);
+  ASSERT_NE(pRepo, nullptr);
+
+  STableCfg tCfg;
+  ASSERT_EQ(tsdbInitTableCfg(&tCfg, TSDB_NORMAL_TABLE, 987607499877672L, 1), 0);
+  tsdbTableSetName(&tCfg, (char *)"rollup", false);
+
+  STSchema *pSchema = createRollupSchema();
+  tsdbTableSetSchema(&tCfg, pSchema, true);
+  ASSERT_EQ(tsdbCreateTable(pRepo, &tCfg), 0);
+
+  // 2 hours of rows at 10 seconds, ended a day ago so that they are in the files to keep
+  int64_t step = 10000;
+  int     rows = 720;
+  TSKEY   start = (taosGetTimestampMs() - 86400 * 1000L) / (60 * minute) * (60 * minute) - 2 * 60 * minute;
+  ASSERT_EQ(insertRows(pRepo, &tCfg, pSchema, start, step, rows), 0);
+
+  // close commits the rows to files, and the rollups with them
+  tsdbCloseRepo(pRepo);
+
+  pRepo = tsdbOpenRepo((char *)ROLLUP_TEST_DIR, NULL);
+  ASSERT_NE(pRepo, nullptr);
+  ASSERT_EQ(tsdbGetRollupInterval(pRepo, 5 * minute, start), minute);
+
+  STable *pTable = tsdbGetTableByUid(tsdbGetMeta(pRepo), tCfg.tableId.uid);
+  ASSERT_NE(pTable, nullptr);
+
+  SColumnInfoData colList[3];
+  memset(colList, 0, sizeof(colList));
+  for (int i = 0; i < 3; i++) {
+    colList[i].info.colId = colColId(schemaColAt(pSchema, i));
+    colList[i].info.type = colType(schemaColAt(pSchema, i));
+    colList[i].info.bytes = colBytes(schemaColAt(pSchema, i));
+  }
+
+  SPair   pair = {pTable, NULL};
+  SArray *group = (SArray *)taosArrayInit(1, sizeof(SPair));
+  taosArrayPush(group, &pair);
+
+  STableGroupInfo groupInfo = {1, (SArray *)taosArrayInit(1, POINTER_BYTES)};
+  taosArrayPush(groupInfo.pGroupList, &group);
+
+  // the window starts in the middle of a bucket, the rows before the first whole bucket are read from the blocks
+  STsdbQueryCond cond = {
+      .twindow = {start + 30000, start + 2 * 60 * minute - 1},
+      .order = TSDB_ORDER_ASC,
+      .numOfCols = 3,
+      .colList = colList,
+      .rollupInterval = minute,
+  };
+
+  TsdbQueryHandleT *pHandle = tsdbQueryTables(pRepo, &cond, &groupInfo);
+  ASSERT_NE(pHandle, nullptr);
+
+  int64_t totalRows = 0, isum = 0, numOfBuckets = 0;
+  TSKEY   lastKey = cond.twindow.skey - 1;
+
+  while (tsdbNextDataBlock(pHandle)) {
+    SDataBlockInfo info = tsdbRetrieveDataBlockInfo(pHandle);
+    ASSERT_GT(info.window.skey, lastKey);
+    lastKey = info.window.ekey;
+
+    SDataStatis *pStatis = NULL;
+    tsdbRetrieveDataBlockStatisInfo(pHandle, &pStatis);
+
+    SArray *pData = tsdbRetrieveDataBlock(pHandle, NULL);
+    if (pData == NULL) {
+      // a bucket of rollup, its statistics are of one whole minute
+      ASSERT_NE(pStatis, nullptr);
+      ASSERT_EQ(info.window.skey % minute, 0);
+      ASSERT_EQ(info.window.ekey, info.window.skey + minute - step);
+      ASSERT_EQ(info.rows, 6);
+      ASSERT_EQ(pStatis[1].numOfNull, 0);
+
+      numOfBuckets++;
+      isum += pStatis[1].sum;
+    } else {
+      SColumnInfoData *pKeyCol = (SColumnInfoData *)taosArrayGet(pData, 0);
+      SColumnInfoData *pValCol = (SColumnInfoData *)taosArrayGet(pData, 1);
+      for (int i = 0; i < info.rows; i++) {
+        TSKEY key = ((TSKEY *)pKeyCol->pData)[i];
+        ASSERT_EQ(((int32_t *)pValCol->pData)[i], intValOfKey(key));
+        isum += intValOfKey(key);
+      }
+    }
+
+    totalRows += info.rows;
+  }
+
+  int64_t expected = 0;
+  for (TSKEY key = cond.twindow.skey; key <= cond.twindow.ekey; key += step) expected += intValOfKey(key);
+
+  ASSERT_EQ(numOfBuckets, 119);
+  ASSERT_EQ(totalRows, rows - 3);
+  ASSERT_EQ(isum, expected);
+
+  tsdbCleanupQueryHandle(pHandle);
+  taosArrayDestroy(group);
+  taosArrayDestroy(groupInfo.pGroupList);
+
+  tsdbCloseRepo(pRepo);
+  tdFreeSchema(pSchema);
+  taosRemoveDir((char *)ROLLUP_TEST_DIR);
+
+  strcpy(tsRollupInterval, saved);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TBITMAP_H
+#define TDENGINE_TBITMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Compressed bitmap of 32-bit unsigned integers in the way of roaring bitmap. The values are partitioned by the high
+ * 16 bits into containers, a container keeps the low 16 bits in a sorted array if it holds a few values, otherwise
+ * in a bitset of 65536 bits. So a sparse bitmap costs about 2 bytes for each value, and a dense one about 1 bit.
+ *
+ * The bitmap is not thread safe, it should be protected by the caller if it is shared.
+ */
+typedef struct SBitmap SBitmap;
+
+SBitmap *tBitmapCreate();
+void     tBitmapDestroy(SBitmap *pBitmap);
+
+// 0 is returned if the value is added or it exists already, -1 if out of memory
+int32_t tBitmapAdd(SBitmap *pBitmap, uint32_t val);
+void    tBitmapRemove(SBitmap *pBitmap, uint32_t val);
+bool    tBitmapContains(const SBitmap *pBitmap, uint32_t val);
+int64_t tBitmapCardinality(const SBitmap *pBitmap);
+
+// the result is a new bitmap, NULL is returned if out of memory
+SBitmap *tBitmapDup(const SBitmap *pBitmap);
+SBitmap *tBitmapAnd(const SBitmap *pLeft, const SBitmap *pRight);
+SBitmap *tBitmapOr(const SBitmap *pLeft, const SBitmap *pRight);
+SBitmap *tBitmapAndNot(const SBitmap *pLeft, const SBitmap *pRight);
+
+// copy the values in ascending order to pValues, which holds at least tBitmapCardinality values
+int64_t tBitmapToArray(const SBitmap *pBitmap, uint32_t *pValues);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TBITMAP_H
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TMETRICS_H
+#define TDENGINE_TMETRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define TAOS_METRIC_COUNTER   0
+#define TAOS_METRIC_GAUGE     1
+#define TAOS_METRIC_HISTOGRAM 2
+
+#define TAOS_METRIC_NAME_LEN  64
+#define TAOS_METRIC_HELP_LEN  128
+#define TAOS_MAX_METRICS      128
+
+// upper bounds of histogram buckets in microseconds, the last bucket is +Inf
+#define TAOS_METRIC_BUCKETS   12
+
+typedef struct SMetric {
+  char    name[TAOS_METRIC_NAME_LEN];
+  char    help[TAOS_METRIC_HELP_LEN];
+  int8_t  type;
+  int64_t value;  // value of counter or gauge, or the sum of histogram in microseconds
+  int64_t count;  // number of observations of histogram
+  int64_t buckets[TAOS_METRIC_BUCKETS + 1];
+} SMetric;
+
+/*
+ * The metric with the same name is registered only once, and the registered metric is never freed, so the returned
+ * pointer can be kept in a static variable by the caller. NULL is returned if the registry is full.
+ */
+SMetric *taosRegisterMetric(const char *name, const char *help, int8_t type);
+
+void taosMetricInc(SMetric *pMetric, int64_t val);
+void taosMetricSet(SMetric *pMetric, int64_t val);
+void taosMetricObserve(SMetric *pMetric, int64_t us);
+
+// dump all metrics in Prometheus text format, the length of text is returned, -1 if the buffer is too small
+int32_t taosDumpMetrics(char *buf, int32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TMETRICS_H
@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "tbitmap.h"
+#include "tutil.h"
+
+// an array container is converted into bitset if it holds more values, and a bitset container is converted back
+// if it holds no more than half of them, so a container is not converted repeatedly by adding and removing one value
+#define TBITMAP_MAX_ARRAY_SIZE 4096
+#define TBITMAP_NUM_OF_WORDS   1024  // 65536 bits
+
+#define TBITMAP_OP_AND     0
+#define TBITMAP_OP_OR      1
+#define TBITMAP_OP_AND_NOT 2
+
+typedef struct SBitmapContainer {
+  uint16_t  key;       // high 16 bits of values in the container
+  int32_t   num;       // number of values
+  int32_t   capacity;  // capacity of values, 0 for a bitset container
+  uint16_t *values;    // sorted low 16 bits of values of an array container
+  uint64_t *bits;      // bitset of low 16 bits of values of a bitset container
+} SBitmapContainer;
+
+struct SBitmap {
+  int32_t           numOfContainers;
+  int32_t           capacity;
+  SBitmapContainer *pContainers;  // ordered by key
+};
+
+static void containerDestroy(SBitmapContainer *pContainer) {
+  tfree(pContainer->values);
+  tfree(pContainer->bits);
+}
+
+// the position of the value in the array, or the position to insert it if the value is not in the array
+static int32_t containerArraySearch(const SBitmapContainer *pContainer, uint16_t val, bool *found) {
+  int32_t s = 0, e = pContainer->num - 1;
+  *found = false;
+
+  while (s <= e) {
+    int32_t mid = s + (e - s) / 2;
+    if (pContainer->values[mid] == val) {
+      *found = true;
+      return mid;
+    } else if (pContainer->values[mid] < val) {
+      s = mid + 1;
+    } else {
+      e = mid - 1;
+    }
+  }
+
+  return s;
+}
+
+static int32_t containerToBitset(SBitmapContainer *pContainer) {
+  uint64_t *bits = calloc(TBITMAP_NUM_OF_WORDS, sizeof(uint64_t));
+  if (bits == NULL) return -1;
+
+  for (int32_t i = 0; i < pContainer->num; ++i) {
+    bits[pContainer->values[i] >> 6] |= (1ull << (pContainer->values[i] & 63));
+  }
+
+  tfree(pContainer->values);
+  pContainer->bits = bits;
+  pContainer->capacity = 0;
+  return 0;
+}
+
+static int32_t containerToArray(SBitmapContainer *pContainer) {
+  uint16_t *values = malloc(sizeof(uint16_t) * (pContainer->num > 0 ? pContainer->num : 1));
+  if (values == NULL) return -1;
+
+  int32_t n = 0;
+  for (int32_t i = 0; i < TBITMAP_NUM_OF_WORDS; ++i) {
+    uint64_t w = pContainer->bits[i];
+    while (w != 0) {
+      values[n++] = (uint16_t)((i << 6) + __builtin_ctzll(w));
+      w &= (w - 1);
+    }
+  }
+
+  tfree(pContainer->bits);
+  pContainer->values = values;
+  pContainer->capacity = (pContainer->num > 0 ? pContainer->num : 1);
+  return 0;
+}
+
+static int32_t containerAdd(SBitmapContainer *pContainer, uint16_t val) {
+  if (pContainer->bits != NULL) {
+    uint64_t mask = 1ull << (val & 63);
+    if ((pContainer->bits[val >> 6] & mask) == 0) {
+      pContainer->bits[val >> 6] |= mask;
+      pContainer->num += 1;
+    }
+
+    return 0;
+  }
+
+  bool    found = false;
+  int32_t pos = containerArraySearch(pContainer, val, &found);
+  if (found) return 0;
+
+  if (pContainer->num >= TBITMAP_MAX_ARRAY_SIZE) {
+    if (containerToBitset(pContainer) < 0) return -1;
+    return containerAdd(pContainer, val);
+  }
+
+  if (pContainer->num >= pContainer->capacity) {
+    int32_t   capacity = (pContainer->capacity == 0) ? 4 : pContainer->capacity * 2;
+    uint16_t *values = realloc(pContainer->values, sizeof(uint16_t) * capacity);
+    if (values == NULL) return -1;
+
+    pContainer->values = values;
+    pContainer->capacity = capacity;
+  }
+
+  memmove(pContainer->values + pos + 1, pContainer->values + pos, sizeof(uint16_t) * (pContainer->num - pos));
+  pContainer->values[pos] = val;
+  pContainer->num += 1;
+  return 0;
+}
+
+static void containerRemove(SBitmapContainer *pContainer, uint16_t val) {
+  if (pContainer->bits != NULL) {
+    uint64_t mask = 1ull << (val & 63);
+    if ((pContainer->bits[val >> 6] & mask) != 0) {
+      pContainer->bits[val >> 6] &= ~mask;
+      pContainer->num -= 1;
+    }
+
+    // keep the bitset if it fails to allocate the array
+    if (pContainer->num <= TBITMAP_MAX_ARRAY_SIZE / 2) {
+      containerToArray(pContainer);
+    }
+
+    return;
+  }
+
+  bool    found = false;
+  int32_t pos = containerArraySearch(pContainer, val, &found);
+  if (!found) return;
+
+  memmove(pContainer->values + pos, pContainer->values + pos + 1, sizeof(uint16_t) * (pContainer->num - pos - 1));
+  pContainer->num -= 1;
+}
+
+static bool containerContains(const SBitmapContainer *pContainer, uint16_t val) {
+  if (pContainer->bits != NULL) {
+    return (pContainer->bits[val >> 6] & (1ull << (val & 63))) != 0;
+  }
+
+  bool found = false;
+  containerArraySearch(pContainer, val, &found);
+  return found;
+}
+
+static int32_t containerCopy(SBitmapContainer *pDst, const SBitmapContainer *pSrc) {
+  *pDst = *pSrc;
+  pDst->values = NULL;
+  pDst->bits = NULL;
+
+  if (pSrc->bits != NULL) {
+    pDst->bits = malloc(sizeof(uint64_t) * TBITMAP_NUM_OF_WORDS);
+    if (pDst->bits == NULL) return -1;
+    memcpy(pDst->bits, pSrc->bits, sizeof(uint64_t) * TBITMAP_NUM_OF_WORDS);
+  } else {
+    pDst->capacity = (pSrc->num > 0) ? pSrc->num : 1;
+    pDst->values = malloc(sizeof(uint16_t) * pDst->capacity);
+    if (pDst->values == NULL) return -1;
+    memcpy(pDst->values, pSrc->values, sizeof(uint16_t) * pSrc->num);
+  }
+
+  return 0;
+}
+
+static void containerFillBitset(const SBitmapContainer *pContainer, uint64_t *bits) {
+  if (pContainer->bits != NULL) {
+    memcpy(bits, pContainer->bits, sizeof(uint64_t) * TBITMAP_NUM_OF_WORDS);
+  } else {
+    memset(bits, 0, sizeof(uint64_t) * TBITMAP_NUM_OF_WORDS);
+    for (int32_t i = 0; i < pContainer->num; ++i) {
+      bits[pContainer->values[i] >> 6] |= (1ull << (pContainer->values[i] & 63));
+    }
+  }
+}
+
+static int32_t containerArrayOp(SBitmapContainer *pDst, const SBitmapContainer *pLeft,
+                                const SBitmapContainer *pRight, int32_t op) {
+  int32_t capacity = (op == TBITMAP_OP_OR) ? pLeft->num + pRight->num : pLeft->num;
+  pDst->values = malloc(sizeof(uint16_t) * (capacity > 0 ? capacity : 1));
+  if (pDst->values == NULL) return -1;
+
+  pDst->capacity = (capacity > 0 ? capacity : 1);
+
+  int32_t i = 0, j = 0, n = 0;
+  while (i < pLeft->num && j < pRight->num) {
+    uint16_t l = pLeft->values[i], r = pRight->values[j];
+    if (l == r) {
+      if (op != TBITMAP_OP_AND_NOT) pDst->values[n++] = l;
+      i++;
+      j++;
+    } else if (l < r) {
+      if (op != TBITMAP_OP_AND) pDst->values[n++] = l;
+      i++;
+    } else {
+      if (op == TBITMAP_OP_OR) pDst->values[n++] = r;
+      j++;
+    }
+  }
+
+  if (op != TBITMAP_OP_AND) {
+    while (i < pLeft->num) pDst->values[n++] = pLeft->values[i++];
+  }
+
+  if (op == TBITMAP_OP_OR) {
+    while (j < pRight->num) pDst->values[n++] = pRight->values[j++];
+  }
+
+  pDst->num = n;
+  if (n > TBITMAP_MAX_ARRAY_SIZE) {
+    return containerToBitset(pDst);
+  }
+
+  return 0;
+}
+
+static int32_t containerBitsetOp(SBitmapContainer *pDst, const SBitmapContainer *pLeft,
+                                 const SBitmapContainer *pRight, int32_t op) {
+  uint64_t *bits = malloc(sizeof(uint64_t) * TBITMAP_NUM_OF_WORDS);
+  uint64_t *rbits = malloc(sizeof(uint64_t) * TBITMAP_NUM_OF_WORDS);
+  if (bits == NULL || rbits == NULL) {
+    tfree(bits);
+    tfree(rbits);
+    return -1;
+  }
+
+  containerFillBitset(pLeft, bits);
+  containerFillBitset(pRight, rbits);
+
+  int32_t num = 0;
+  for (int32_t i = 0; i < TBITMAP_NUM_OF_WORDS; ++i) {
+    if (op == TBITMAP_OP_AND) {
+      bits[i] &= rbits[i];
+    } else if (op == TBITMAP_OP_OR) {
+      bits[i] |= rbits[i];
+    } else {
+      bits[i] &= ~rbits[i];
+    }
+
+    num += __builtin_popcountll(bits[i]);
+  }
+
+  tfree(rbits);
+
+  pDst->bits = bits;
+  pDst->num = num;
+  pDst->capacity = 0;
+
+  if (num <= TBITMAP_MAX_ARRAY_SIZE) {
+    return containerToArray(pDst);
+  }
+
+  return 0;
+}
+
+static int32_t containerOp(SBitmapContainer *pDst, const SBitmapContainer *pLeft, const SBitmapContainer *pRight,
+                           int32_t op) {
+  memset(pDst, 0, sizeof(SBitmapContainer));
+  pDst->key = pLeft->key;
+
+  int32_t ret = 0;
+  if (pLeft->bits == NULL && pRight->bits == NULL) {
+    ret = containerArrayOp(pDst, pLeft, pRight, op);
+  } else {
+    ret = containerBitsetOp(pDst, pLeft, pRight, op);
+  }
+
+  if (ret < 0) containerDestroy(pDst);
+  return ret;
+}
+
+// the position of the container with the key, or the position to insert it if the container does not exist
+static int32_t bitmapSearch(const SBitmap *pBitmap, uint16_t key, bool *found) {
+  int32_t s = 0, e = pBitmap->numOfContainers - 1;
+  *found = false;
+
+  while (s <= e) {
+    int32_t mid = s + (e - s) / 2;
+    if (pBitmap->pContainers[mid].key == key) {
+      *found = true;
+      return mid;
+    } else if (pBitmap->pContainers[mid].key < key) {
+      s = mid + 1;
+    } else {
+      e = mid - 1;
+    }
+  }
+
+  return s;
+}
+
+static int32_t bitmapEnsureCapacity(SBitmap *pBitmap, int32_t num) {
+  if (num <= pBitmap->capacity) return 0;
+
+  int32_t capacity = (pBitmap->capacity == 0) ? 4 : pBitmap->capacity;
+  while (capacity < num) capacity *= 2;
+
+  SBitmapContainer *p = realloc(pBitmap->pContainers, sizeof(SBitmapContainer) * capacity);
+  if (p == NULL) return -1;
+
+  pBitmap->pContainers = p;
+  pBitmap->capacity = capacity;
+  return 0;
+}
+
+// the container is moved into the bitmap, and it is destroyed if it is empty
+static int32_t bitmapAppend(SBitmap *pBitmap, SBitmapContainer *pContainer) {
+  if (pContainer->num == 0) {
+    containerDestroy(pContainer);
+    return 0;
+  }
+
+  if (bitmapEnsureCapacity(pBitmap, pBitmap->numOfContainers + 1) < 0) {
+    containerDestroy(pContainer);
+    return -1;
+  }
+
+  pBitmap->pContainers[pBitmap->numOfContainers++] = *pContainer;
+  return 0;
+}
+
+SBitmap *tBitmapCreate() { return calloc(1, sizeof(SBitmap)); }
+
+void tBitmapDestroy(SBitmap *pBitmap) {
+  if (pBitmap == NULL) return;
+
+  for (int32_t i = 0; i < pBitmap->numOfContainers; ++i) {
+    containerDestroy(&pBitmap->pContainers[i]);
+  }
+
+  tfree(pBitmap->pContainers);
+  free(pBitmap);
+}
+
+int32_t tBitmapAdd(SBitmap *pBitmap, uint32_t val) {
+  bool    found = false;
+  int32_t pos = bitmapSearch(pBitmap, (uint16_t)(val >> 16), &found);
+
+  if (!found) {
+    if (bitmapEnsureCapacity(pBitmap, pBitmap->numOfContainers + 1) < 0) return -1;
+
+    memmove(pBitmap->pContainers + pos + 1, pBitmap->pContainers + pos,
+            sizeof(SBitmapContainer) * (pBitmap->numOfContainers - pos));
+    memset(&pBitmap->pContainers[pos], 0, sizeof(SBitmapContainer));
+    pBitmap->pContainers[pos].key = (uint16_t)(val >> 16);
+    pBitmap->numOfContainers += 1;
+  }
+
+  return containerAdd(&pBitmap->pContainers[pos], (uint16_t)(val & 0xFFFF));
+}
+
+void tBitmapRemove(SBitmap *pBitmap, uint32_t val) {
+  bool    found = false;
+  int32_t pos = bitmapSearch(pBitmap, (uint16_t)(val >> 16), &found);
+  if (!found) return;
+
+  SBitmapContainer *pContainer = &pBitmap->pContainers[pos];
+  containerRemove(pContainer, (uint16_t)(val & 0xFFFF));
+
+  if (pContainer->num == 0) {
+    containerDestroy(pContainer);
+    memmove(pBitmap->pContainers + pos, pBitmap->pContainers + pos + 1,
+            sizeof(SBitmapContainer) * (pBitmap->numOfContainers - pos - 1));
+    pBitmap->numOfContainers -= 1;
+  }
+}
+
+bool tBitmapContains(const SBitmap *pBitmap, uint32_t val) {
+  bool    found = false;
+  int32_t pos = bitmapSearch(pBitmap, (uint16_t)(val >> 16), &found);
+
+  return found && containerContains(&pBitmap->pContainers[pos], (uint16_t)(val & 0xFFFF));
+}
+
+int64_t tBitmapCardinality(const SBitmap *pBitmap) {
+  int64_t num = 0;
+  for (int32_t i = 0; i < pBitmap->numOfContainers; ++i) {
+    num += pBitmap->pContainers[i].num;
+  }
+
+  return num;
+}
+
+SBitmap *tBitmapDup(const SBitmap *pBitmap) {
+  SBitmap *pDst = tBitmapCreate();
+  if (pDst == NULL) return NULL;
+
+  for (int32_t i = 0; i < pBitmap->numOfContainers; ++i) {
+    SBitmapContainer c;
+    if (containerCopy(&c, &pBitmap->pContainers[i]) < 0 || bitmapAppend(pDst, &c) < 0) {
+      containerDestroy(&c);
+      tBitmapDestroy(pDst);
+      return NULL;
+    }
+  }
+
+  return pDst;
+}
+
+// the containers are merged by key in the way of merging two sorted arrays
+static SBitmap *bitmapOp(const SBitmap *pLeft, const SBitmap *pRight, int32_t op) {
+  SBitmap *pDst = tBitmapCreate();
+  if (pDst == NULL) return NULL;
+
+  int32_t i = 0, j = 0;
+  while (i < pLeft->numOfContainers || j < pRight->numOfContainers) {
+    const SBitmapContainer *l = (i < pLeft->numOfContainers) ? &pLeft->pContainers[i] : NULL;
+    const SBitmapContainer *r = (j < pRight->numOfContainers) ? &pRight->pContainers[j] : NULL;
+
+    SBitmapContainer c = {0};
+    int32_t          ret = 0;
+
+    if (l != NULL && r != NULL && l->key == r->key) {
+      ret = containerOp(&c, l, r, op);
+      i++;
+      j++;
+    } else if (r == NULL || (l != NULL && l->key < r->key)) {
+      if (op == TBITMAP_OP_AND) {
+        i++;
+        continue;
+      }
+
+      ret = containerCopy(&c, l);
+      i++;
+    } else {
+      if (op != TBITMAP_OP_OR) {
+        j++;
+        continue;
+      }
+
+      ret = containerCopy(&c, r);
+      j++;
+    }
+
+    if (ret < 0 || bitmapAppend(pDst, &c) < 0) {
+      containerDestroy(&c);
+      tBitmapDestroy(pDst);
+      return NULL;
+    }
+  }
+
+  return pDst;
+}
+
+SBitmap *tBitmapAnd(const SBitmap *pLeft, const SBitmap *pRight) { return bitmapOp(pLeft, pRight, TBITMAP_OP_AND); }
+
+SBitmap *tBitmapOr(const SBitmap *pLeft, const SBitmap *pRight) { return bitmapOp(pLeft, pRight, TBITMAP_OP_OR); }
+
+SBitmap *tBitmapAndNot(const SBitmap *pLeft, const SBitmap *pRight) {
+  return bitmapOp(pLeft, pRight, TBITMAP_OP_AND_NOT);
+}
+
+int64_t tBitmapToArray(const SBitmap *pBitmap, uint32_t *pValues) {
+  int64_t n = 0;
+
+  for (int32_t i = 0; i < pBitmap->numOfContainers; ++i) {
+    const SBitmapContainer *pContainer = &pBitmap->pContainers[i];
+    uint32_t                high = ((uint32_t)pContainer->key) << 16;
+
+    if (pContainer->bits != NULL) {
+      for (int32_t k = 0; k < TBITMAP_NUM_OF_WORDS; ++k) {
+        uint64_t w = pContainer->bits[k];
+        while (w != 0) {
+          pValues[n++] = high | (uint32_t)((k << 6) + __builtin_ctzll(w));
+          w &= (w - 1);
+        }
+      }
+    } else {
+      for (int32_t k = 0; k < pContainer->num; ++k) {
+        pValues[n++] = high | pContainer->values[k];
+      }
+    }
+  }
+
+  return n;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "tmetrics.h"
+
+static const int64_t taosMetricBounds[TAOS_METRIC_BUCKETS] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000,
+};
+
+static const char *taosMetricTypeStr[] = {"counter", "gauge", "histogram"};
+
+static SMetric         taosMetrics[TAOS_MAX_METRICS];
+static int32_t         taosNumOfMetrics = 0;
+static pthread_mutex_t taosMetricsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+SMetric *taosRegisterMetric(const char *name, const char *help, int8_t type) {
+  SMetric *pMetric = NULL;
+
+  pthread_mutex_lock(&taosMetricsMutex);
+
+  for (int32_t i = 0; i < taosNumOfMetrics; ++i) {
+    if (strcmp(taosMetrics[i].name, name) == 0) {
+      pMetric = &taosMetrics[i];
+      break;
+    }
+  }
+
+  if (pMetric == NULL && taosNumOfMetrics < TAOS_MAX_METRICS) {
+    pMetric = &taosMetrics[taosNumOfMetrics];
+    strncpy(pMetric->name, name, TAOS_METRIC_NAME_LEN - 1);
+    strncpy(pMetric->help, help, TAOS_METRIC_HELP_LEN - 1);
+    pMetric->type = type;
+
+    // the metric is visible to the dump only after it is initialized
+    atomic_add_fetch_32(&taosNumOfMetrics, 1);
+  }
+
+  pthread_mutex_unlock(&taosMetricsMutex);
+  return pMetric;
+}
+
+void taosMetricInc(SMetric *pMetric, int64_t val) {
+  if (pMetric == NULL) return;
+  atomic_add_fetch_64(&pMetric->value, val);
+}
+
+void taosMetricSet(SMetric *pMetric, int64_t val) {
+  if (pMetric == NULL) return;
+  atomic_store_64(&pMetric->value, val);
+}
+
+void taosMetricObserve(SMetric *pMetric, int64_t us) {
+  if (pMetric == NULL) return;
+
+  int32_t i = 0;
+  while (i < TAOS_METRIC_BUCKETS && us > taosMetricBounds[i]) {
+    i++;
+  }
+
+  atomic_add_fetch_64(&pMetric->buckets[i], 1);
+  atomic_add_fetch_64(&pMetric->count, 1);
+  atomic_add_fetch_64(&pMetric->value, us);
+}
+
+static int32_t taosDumpHistogram(SMetric *pMetric, char *buf, int32_t size) {
+  int32_t len = 0;
+  int64_t count = 0;
+
+  // the buckets are cumulative in Prometheus, and the durations are in seconds
+  for (int32_t i = 0; i <= TAOS_METRIC_BUCKETS && len < size; ++i) {
+    count += atomic_load_64(&pMetric->buckets[i]);
+    if (i < TAOS_METRIC_BUCKETS) {
+      len += snprintf(buf + len, size - len, "%s_bucket{le=\"%g\"} %" PRId64 "\n", pMetric->name,
+                      taosMetricBounds[i] / 1000000.0, count);
+    } else {
+      len += snprintf(buf + len, size - len, "%s_bucket{le=\"+Inf\"} %" PRId64 "\n", pMetric->name, count);
+    }
+  }
+
+  if (len < size) {
+    len += snprintf(buf + len, size - len, "%s_sum %f\n%s_count %" PRId64 "\n", pMetric->name,
+                    atomic_load_64(&pMetric->value) / 1000000.0, pMetric->name, count);
+  }
+
+  return len;
+}
+
+int32_t taosDumpMetrics(char *buf, int32_t size) {
+  int32_t len = 0;
+  int32_t num = atomic_load_32(&taosNumOfMetrics);
+
+  for (int32_t i = 0; i < num && len < size; ++i) {
+    SMetric *pMetric = &taosMetrics[i];
+    len += snprintf(buf + len, size - len, "# HELP %s %s\n# TYPE %s %s\n", pMetric->name, pMetric->help, pMetric->name,
+                    taosMetricTypeStr[pMetric->type]);
+    if (len >= size) break;
+
+    if (pMetric->type == TAOS_METRIC_HISTOGRAM) {
+      len += taosDumpHistogram(pMetric, buf + len, size - len);
+    } else {
+      len += snprintf(buf + len, size - len, "%s %" PRId64 "\n", pMetric->name, atomic_load_64(&pMetric->value));
+    }
+  }
+
+  return (len < size) ? len : -1;
+}
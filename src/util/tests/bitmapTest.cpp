@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "tbitmap.h"
+
+namespace {
+void checkBitmap(SBitmap* pBitmap, const std::set<uint32_t>& expected) {
+  ASSERT_EQ(tBitmapCardinality(pBitmap), (int64_t)expected.size());
+
+  std::vector<uint32_t> values(expected.size() + 1);
+  int64_t n = tBitmapToArray(pBitmap, values.data());
+  ASSERT_EQ(n, (int64_t)expected.size());
+
+  int32_t i = 0;
+  for (std::set<uint32_t>::const_iterator it = expected.begin(); it != expected.end(); ++it, ++i) {
+    ASSERT_EQ(values[i], *it);
+    ASSERT_TRUE(tBitmapContains(pBitmap, *it));
+  }
+}
+
+SBitmap* createBitmap(const std::set<uint32_t>& values) {
+  SBitmap* pBitmap = tBitmapCreate();
+  for (std::set<uint32_t>::const_iterator it = values.begin(); it != values.end(); ++it) {
+    tBitmapAdd(pBitmap, *it);
+  }
+
+  return pBitmap;
+}
+}  // namespace
+
+TEST(testCase, bitmap_add_remove_test) {
+  SBitmap* pBitmap = tBitmapCreate();
+  std::set<uint32_t> expected;
+
+  // sparse values in several containers, and one container turns into bitset
+  for (uint32_t i = 0; i < 10000; ++i) {
+    uint32_t v = (i % 3 == 0) ? i * 7 : 100000 + i;
+    ASSERT_EQ(tBitmapAdd(pBitmap, v), 0);
+    expected.insert(v);
+  }
+
+  ASSERT_EQ(tBitmapAdd(pBitmap, 21), 0);  // duplicated value
+  ASSERT_FALSE(tBitmapContains(pBitmap, 7));
+  checkBitmap(pBitmap, expected);
+
+  // remove values from the bitset container, it turns back into array when all values are removed below
+  for (uint32_t i = 0; i < 10000; i += 2) {
+    uint32_t v = 100000 + i;
+    tBitmapRemove(pBitmap, v);
+    expected.erase(v);
+  }
+
+  tBitmapRemove(pBitmap, 0xFFFFFFFF);  // value not exists
+  checkBitmap(pBitmap, expected);
+
+  for (std::set<uint32_t>::iterator it = expected.begin(); it != expected.end(); ++it) {
+    tBitmapRemove(pBitmap, *it);
+  }
+
+  ASSERT_EQ(tBitmapCardinality(pBitmap), 0);
+  tBitmapDestroy(pBitmap);
+}
+
+TEST(testCase, bitmap_set_operation_test) {
+  std::set<uint32_t> s1, s2;
+  for (uint32_t i = 0; i < 20000; ++i) {
+    s1.insert(i * 2);
+    if (i % 5 == 0) s2.insert(i * 3);
+  }
+
+  s2.insert(0x7FFFFFFF);
+
+  SBitmap* p1 = createBitmap(s1);
+  SBitmap* p2 = createBitmap(s2);
+
+  std::set<uint32_t> sAnd, sOr(s1), sAndNot;
+  for (std::set<uint32_t>::iterator it = s1.begin(); it != s1.end(); ++it) {
+    if (s2.count(*it) > 0) {
+      sAnd.insert(*it);
+    } else {
+      sAndNot.insert(*it);
+    }
+  }
+  sOr.insert(s2.begin(), s2.end());
+
+  SBitmap* pAnd = tBitmapAnd(p1, p2);
+  SBitmap* pOr = tBitmapOr(p1, p2);
+  SBitmap* pAndNot = tBitmapAndNot(p1, p2);
+  SBitmap* pDup = tBitmapDup(p1);
+
+  checkBitmap(pAnd, sAnd);
+  checkBitmap(pOr, sOr);
+  checkBitmap(pAndNot, sAndNot);
+  checkBitmap(pDup, s1);
+
+  // operation with empty bitmap
+  SBitmap* pEmpty = tBitmapCreate();
+  SBitmap* pRes = tBitmapAnd(p1, pEmpty);
+  ASSERT_EQ(tBitmapCardinality(pRes), 0);
+  tBitmapDestroy(pRes);
+
+  pRes = tBitmapOr(pEmpty, p2);
+  checkBitmap(pRes, s2);
+  tBitmapDestroy(pRes);
+
+  tBitmapDestroy(pEmpty);
+  tBitmapDestroy(p1);
+  tBitmapDestroy(p2);
+  tBitmapDestroy(pAnd);
+  tBitmapDestroy(pOr);
+  tBitmapDestroy(pAndNot);
+  tBitmapDestroy(pDup);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "tmetrics.h"
+
+TEST(testCase, metrics_register_test) {
+  SMetric* p1 = taosRegisterMetric("test_requests_total", "requests", TAOS_METRIC_COUNTER);
+  SMetric* p2 = taosRegisterMetric("test_requests_total", "requests", TAOS_METRIC_COUNTER);
+  ASSERT_TRUE(p1 != NULL);
+  ASSERT_EQ(p1, p2);
+
+  taosMetricInc(p1, 3);
+  taosMetricInc(p2, 2);
+  ASSERT_EQ(p1->value, 5);
+
+  SMetric* pGauge = taosRegisterMetric("test_queue_depth", "queue depth", TAOS_METRIC_GAUGE);
+  taosMetricInc(pGauge, 10);
+  taosMetricInc(pGauge, -4);
+  ASSERT_EQ(pGauge->value, 6);
+  taosMetricSet(pGauge, 1);
+  ASSERT_EQ(pGauge->value, 1);
+
+  // NULL metric is ignored
+  taosMetricInc(NULL, 1);
+  taosMetricObserve(NULL, 1);
+}
+
+TEST(testCase, metrics_dump_test) {
+  SMetric* pHist = taosRegisterMetric("test_latency_seconds", "latency", TAOS_METRIC_HISTOGRAM);
+  taosMetricObserve(pHist, 50);        // 0.0001
+  taosMetricObserve(pHist, 800);       // 0.001
+  taosMetricObserve(pHist, 800);       // 0.001
+  taosMetricObserve(pHist, 5000000);   // +Inf
+  ASSERT_EQ(pHist->count, 4);
+
+  char buf[16384] = {0};
+  int32_t len = taosDumpMetrics(buf, sizeof(buf));
+  ASSERT_GT(len, 0);
+  ASSERT_EQ(len, strlen(buf));
+
+  ASSERT_TRUE(strstr(buf, "# TYPE test_latency_seconds histogram\n") != NULL);
+  ASSERT_TRUE(strstr(buf, "test_latency_seconds_bucket{le=\"0.0001\"} 1\n") != NULL);
+  ASSERT_TRUE(strstr(buf, "test_latency_seconds_bucket{le=\"0.001\"} 3\n") != NULL);
+  ASSERT_TRUE(strstr(buf, "test_latency_seconds_bucket{le=\"1\"} 3\n") != NULL);
+  ASSERT_TRUE(strstr(buf, "test_latency_seconds_bucket{le=\"+Inf\"} 4\n") != NULL);
+  ASSERT_TRUE(strstr(buf, "test_latency_seconds_count 4\n") != NULL);
+
+  // the buffer is too small
+  ASSERT_EQ(taosDumpMetrics(buf, 16), -1);
+}
@@ -120,6 +120,7 @@ static int32_t vnodeProcessCreateTableMsg(SVnodeObj *pVnode, void *pCont, SRspRe
   
   STableCfg tCfg;
   tsdbInitTableCfg(&tCfg, pTable->tableType, uid, sid);
+  tCfg.sversion = htonl(pTable->sversion);
 
   STSchema *pDestSchema = tdNewSchema(numOfColumns);
   for (int i = 0; i < numOfColumns; i++) {
@@ -135,6 +136,7 @@ static int32_t vnodeProcessCreateTableMsg(SVnodeObj *pVnode, void *pCont, SRspRe
     }
     tsdbTableSetTagSchema(&tCfg, pDestTagSchema, false);
     tsdbTableSetSName(&tCfg, pTable->superTableId, false);
+    tsdbTableSetSuperUid(&tCfg, htobe64(pTable->superTableUid));
 
     char *pTagData = pTable->data + totalCols * sizeof(SSchema);
     int accumBytes = 0;
@@ -198,6 +200,7 @@ static int32_t vnodeProcessAlterTableMsg(SVnodeObj *pVnode, void *pCont, SRspRet
       tdSchemaAppendCol(pDestTagSchema, pSchema[i].type, htons(pSchema[i].colId), htons(pSchema[i].bytes));
     }
     tsdbTableSetTagSchema(&tCfg, pDestTagSchema, false);
+    tsdbTableSetSuperUid(&tCfg, htobe64(pTable->superTableUid));
 
     char *pTagData = pTable->data + totalCols * sizeof(SSchema);
     int accumBytes = 0;
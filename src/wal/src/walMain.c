@@ -27,6 +27,8 @@
 #include "tutil.h"
 #include "twal.h"
 #include "tqueue.h"
+#include "ttime.h"
+#include "tmetrics.h"
 
 #define walPrefix "wal"
 #define wError(...) if (wDebugFlag & DEBUG_ERROR) {taosPrintLog("ERROR WAL ", wDebugFlag, __VA_ARGS__);}
@@ -50,6 +52,7 @@ typedef struct {
 int wDebugFlag = 135;
 
 static uint32_t walSignature = 0xFAFBFDFE;
+static SMetric *walFsyncMetric = NULL;
 static int walHandleExistingFiles(const char *path);
 static int walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp);
 static int walRemoveWalFiles(const char *path);
@@ -67,6 +70,10 @@ void *walOpen(const char *path, const SWalCfg *pCfg) {
   strcpy(pWal->path, path);
   pthread_mutex_init(&pWal->mutex, NULL);
 
+  // registered only once for all vnodes, the same metric is returned for the following vnodes
+  walFsyncMetric = taosRegisterMetric("taosd_wal_fsync_duration_seconds", "latency of fsync of wal files",
+                                      TAOS_METRIC_HISTOGRAM);
+
   if (access(path, F_OK) != 0) mkdir(path, 0755);
   
   if (pCfg->keep == 1) return pWal;
@@ -177,8 +184,11 @@ void walFsync(void *handle) {
 
   SWal *pWal = handle;
 
-  if (pWal->level == TAOS_WAL_FSYNC) 
+  if (pWal->level == TAOS_WAL_FSYNC) {
+    int64_t st = taosGetTimestampUs();
     fsync(pWal->fd);
+    taosMetricObserve(walFsyncMetric, taosGetTimestampUs() - st);
+  }
 }
 
 int walRestore(void *handle, void *pVnode, int (*writeFp)(void *, void *, int)) {
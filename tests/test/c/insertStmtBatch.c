@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "tglobal.h"
+
+#define GREEN "\033[1;32m"
+#define NC "\033[0m"
+
+#define MAX_BATCH_ROWS 32767
+
+int64_t startTime = 1530374400000L;
+int     failed = 0;
+
+void taos_error(TAOS *con) {
+  fprintf(stderr, "TDengine error: %s\n", taos_errstr(con));
+  taos_close(con);
+  exit(1);
+}
+
+void check(int cond, const char *msg) {
+  if (cond) {
+    pPrint("%s %s passed %s", GREEN, msg, NC);
+  } else {
+    pError("%s failed", msg);
+    failed = 1;
+  }
+}
+
+// run a query returning one row of bigint values, return -1 if it fails
+int64_t queryValue(TAOS *taos, const char *sql, int col) {
+  if (taos_query(taos, sql) != 0) {
+    pError("failed to run sql:%s, reason:%s", sql, taos_errstr(taos));
+    return -1;
+  }
+
+  TAOS_RES *result = taos_use_result(taos);
+  TAOS_ROW  row = taos_fetch_row(result);
+  int64_t   value = (row == NULL || row[col] == NULL) ? -1 : *(int64_t *)row[col];
+
+  // the result is retrieved completely before it is freed, so the connection is kept for the next query
+  while (row != NULL) row = taos_fetch_row(result);
+  taos_free_result(result);
+
+  return value;
+}
+
+void prepareStmt(TAOS_STMT *stmt, const char *sql) {
+  int code = taos_stmt_prepare(stmt, sql, 0);
+  if (code != 0) {
+    pError("failed to prepare sql:%s, code:%d", sql, code);
+    exit(1);
+  }
+}
+
+void initBind(TAOS_MULTI_BIND *bind, int64_t *ts, int32_t *v, unsigned char *isNull, int num) {
+  memset(bind, 0, sizeof(TAOS_MULTI_BIND) * 2);
+
+  bind[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  bind[0].buffer = ts;
+  bind[0].buffer_length = sizeof(int64_t);
+  bind[0].num = num;
+
+  bind[1].buffer_type = TSDB_DATA_TYPE_INT;
+  bind[1].buffer = v;
+  bind[1].buffer_length = sizeof(int32_t);
+  bind[1].is_null = isNull;
+  bind[1].num = num;
+}
+
+// bind 1000 rows in one call, and the odd values are null
+void testBindBatch(TAOS *taos) {
+  const int num = 1000;
+
+  int64_t       ts[1000];
+  int32_t       v[1000];
+  unsigned char isNull[1000 / 8 + 1] = {0};
+  for (int i = 0; i < num; ++i) {
+    ts[i] = startTime + i;
+    v[i] = i;
+    if (i % 2 == 1) isNull[i / 8] |= (unsigned char)(1 << (i % 8));
+  }
+
+  TAOS_MULTI_BIND bind[2];
+  initBind(bind, ts, v, isNull, num);
+
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  prepareStmt(stmt, "insert into db.t1 values(?, ?)");
+  check(taos_stmt_bind_param_batch(stmt, bind) == 0, "bind batch");
+  check(taos_stmt_execute(stmt) == 0, "execute batch");
+  taos_stmt_close(stmt);
+
+  // sum of the even numbers below 1000
+  check(queryValue(taos, "select count(*) from db.t1", 0) == num, "count of batch");
+  check(queryValue(taos, "select count(v) from db.t1", 0) == num / 2, "count of null bitmap");
+  check(queryValue(taos, "select sum(v) from db.t1", 0) == 249500, "sum of batch");
+}
+
+// mix the rows bound one by one with the rows bound in batch
+void testBindMixed(TAOS *taos) {
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  prepareStmt(stmt, "insert into db.t2 values(?, ?)");
+
+  int64_t       ts = startTime;
+  int32_t       v = 1;
+  int           isNull = 0;
+  unsigned long len = sizeof(int64_t);
+  TAOS_BIND     single[2] = {{0}};
+  single[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  single[0].buffer = &ts;
+  single[0].length = &len;
+  single[0].is_null = &isNull;
+  single[1].buffer_type = TSDB_DATA_TYPE_INT;
+  single[1].buffer = &v;
+  single[1].length = &len;
+  single[1].is_null = &isNull;
+
+  check(taos_stmt_bind_param(stmt, single) == 0, "bind single row");
+  check(taos_stmt_add_batch(stmt) == 0, "add single row");
+
+  int64_t         tsBatch[10];
+  int32_t         vBatch[10];
+  TAOS_MULTI_BIND bind[2];
+  for (int i = 0; i < 10; ++i) {
+    tsBatch[i] = startTime + 1 + i;
+    vBatch[i] = 10;
+  }
+  initBind(bind, tsBatch, vBatch, NULL, 10);
+  check(taos_stmt_bind_param_batch(stmt, bind) == 0, "bind batch after single row");
+
+  // the row bound without taos_stmt_add_batch is inserted too
+  ts = startTime + 11;
+  v = 100;
+  check(taos_stmt_bind_param(stmt, single) == 0, "bind single row after batch");
+  check(taos_stmt_execute(stmt) == 0, "execute mixed rows");
+  taos_stmt_close(stmt);
+
+  check(queryValue(taos, "select count(*) from db.t2", 0) == 12, "count of mixed rows");
+  check(queryValue(taos, "select sum(v) from db.t2", 0) == 201, "sum of mixed rows");
+}
+
+// the number of rows of a submit block is limited, and a batch beyond it is rejected without changing the bound rows
+void testBindTooMany(TAOS *taos) {
+  const int num = MAX_BATCH_ROWS;
+
+  int64_t *ts = malloc(sizeof(int64_t) * (num + 1));
+  int32_t *v = malloc(sizeof(int32_t) * (num + 1));
+  for (int i = 0; i <= num; ++i) {
+    ts[i] = startTime + i;
+    v[i] = 1;
+  }
+
+  TAOS_MULTI_BIND bind[2];
+  TAOS_STMT *     stmt = taos_stmt_init(taos);
+  prepareStmt(stmt, "insert into db.t3 values(?, ?)");
+
+  initBind(bind, ts, v, NULL, num + 1);
+  check(taos_stmt_bind_param_batch(stmt, bind) != 0, "reject batch beyond limit");
+
+  initBind(bind, ts, v, NULL, num - 1);
+  check(taos_stmt_bind_param_batch(stmt, bind) == 0, "bind batch below limit");
+
+  initBind(bind, ts + num - 1, v, NULL, 2);
+  check(taos_stmt_bind_param_batch(stmt, bind) != 0, "reject batch exceeding limit in total");
+
+  initBind(bind, ts + num - 1, v, NULL, 1);
+  check(taos_stmt_bind_param_batch(stmt, bind) == 0, "bind batch up to limit");
+  check(taos_stmt_execute(stmt) == 0, "execute batch of limit");
+  taos_stmt_close(stmt);
+
+  check(queryValue(taos, "select count(*) from db.t3", 0) == num, "count of batch of limit");
+
+  free(ts);
+  free(v);
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+      strcpy(configDir, argv[++i]);
+    }
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(tsMasterIp, tsDefaultUser, tsDefaultPass, NULL, 0);
+  if (taos == NULL) taos_error(taos);
+
+  taos_query(taos, "drop database if exists db");
+  if (taos_query(taos, "create database db") != 0) taos_error(taos);
+
+  for (int i = 1; i <= 3; ++i) {
+    char sql[128];
+    sprintf(sql, "create table db.t%d (ts timestamp, v int)", i);
+    if (taos_query(taos, sql) != 0) taos_error(taos);
+
+    // taos_stmt_prepare does not wait for the table meta, so get it into cache in advance
+    sprintf(sql, "select count(*) from db.t%d", i);
+    queryValue(taos, sql, 0);
+  }
+
+  testBindBatch(taos);
+  testBindMixed(taos);
+  testBindTooMany(taos);
+
+  taos_close(taos);
+
+  if (failed) {
+    printf("some tests failed\n");
+    return 1;
+  }
+
+  printf("all finished\n");
+  return 0;
+}